@@ -0,0 +1,161 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+GLADloadproc HeadlessContext::getLoadProc()
+{
+    // Com EGL_KHR_get_all_proc_addresses o eglGetProcAddress devolve também
+    // as funções do core, então serve de loader para o GLAD e o ShaderCache
+    return (GLADloadproc)eglGetProcAddress;
+}
+
+bool HeadlessContext::create(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+
+    // A plataforma surfaceless não precisa de X11/Wayland nem de /dev/dri
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = EGL_NO_DISPLAY;
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "HeadlessContext: falha ao inicializar EGL" << std::endl;
+        return false;
+    }
+    m_display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "HeadlessContext: EGL sem suporte a OpenGL desktop" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    eglChooseConfig(display, configAttribs, &config, 1, &configCount);
+    if (configCount == 0)
+        config = nullptr; // EGL_KHR_no_config_context
+
+    const EGLint versions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 3, 3 } };
+    for (const EGLint* version : versions)
+    {
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        m_context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (m_context != EGL_NO_CONTEXT)
+            break;
+    }
+
+    if (m_context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context))
+    {
+        std::cerr << "HeadlessContext: falha ao criar contexto OpenGL sem superficie" << std::endl;
+        return false;
+    }
+
+    if (!gladLoadGLLoader(getLoadProc()))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+
+    return createFramebuffer();
+}
+
+bool HeadlessContext::createFramebuffer()
+{
+    glGenRenderbuffers(1, &m_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+
+    glGenRenderbuffers(1, &m_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "HeadlessContext: framebuffer incompleto" << std::endl;
+        return false;
+    }
+
+    bindFramebuffer();
+    return true;
+}
+
+void HeadlessContext::bindFramebuffer() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_width, m_height);
+}
+
+void HeadlessContext::destroy()
+{
+    if (m_context)
+    {
+        if (m_fbo)
+            glDeleteFramebuffers(1, &m_fbo);
+        if (m_colorBuffer)
+            glDeleteRenderbuffers(1, &m_colorBuffer);
+        if (m_depthBuffer)
+            glDeleteRenderbuffers(1, &m_depthBuffer);
+        m_fbo = m_colorBuffer = m_depthBuffer = 0;
+
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(m_display, m_context);
+        m_context = nullptr;
+    }
+
+    if (m_display)
+    {
+        eglTerminate(m_display);
+        m_display = nullptr;
+    }
+}
+
+static std::string glString(GLenum name)
+{
+    const GLubyte* s = glGetString(name);
+    return s ? (const char*)s : "";
+}
+
+std::string HeadlessContext::getRenderer() const
+{
+    return glString(GL_RENDERER);
+}
+
+std::string HeadlessContext::getVersion() const
+{
+    return glString(GL_VERSION);
+}
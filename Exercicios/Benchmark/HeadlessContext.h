@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <glad/glad.h>
+
+// Contexto OpenGL sem janela para rodar em máquinas sem GPU nem servidor
+// gráfico: EGL na plataforma surfaceless do Mesa (llvmpipe), sem superfície,
+// renderizando num framebuffer próprio (cor + profundidade) do tamanho pedido.
+class HeadlessContext
+{
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Cria o contexto (tenta 4.6 core e desce até 3.3), carrega o GLAD e o FBO
+    bool create(int width, int height);
+    void destroy();
+
+    // Deixa o FBO ligado com o viewport cobrindo a imagem inteira
+    void bindFramebuffer() const;
+
+    static GLADloadproc getLoadProc();
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    std::string getRenderer() const;
+    std::string getVersion() const;
+
+private:
+    bool createFramebuffer();
+
+    void* m_display = nullptr;
+    void* m_context = nullptr;
+    int m_width = 0;
+    int m_height = 0;
+    GLuint m_fbo = 0;
+    GLuint m_colorBuffer = 0;
+    GLuint m_depthBuffer = 0;
+};
@@ -0,0 +1,2346 @@
+#include "Scenes.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "CommandBuffer.h"
+#include "Geometry.h"
+#include "GeometryPool.h"
+#include "GpuCuller.h"
+#include "HotReload.h"
+#include "JobSystem.h"
+#include "LightmapBaker.h"
+#include "LodGenerator.h"
+#include "Meshlets.h"
+#include "OcclusionCuller.h"
+#include "Primitives.h"
+#include "RenderQueue.h"
+#include "ShadowMaps.h"
+#include "TextureArrays.h"
+#include "VertexBaker.h"
+#include "VertexPulling.h"
+
+SceneFrame scriptedCamera(int frameIndex, float aspect, float radius, float height)
+{
+    SceneFrame frame;
+    frame.index = frameIndex;
+    frame.time = frameIndex / 60.0f;
+
+    float angle = glm::two_pi<float>() * (frameIndex % 600) / 600.0f;
+    frame.cameraPos = glm::vec3(radius * sinf(angle), height, radius * cosf(angle));
+    frame.view = glm::lookAt(frame.cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    frame.projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+    return frame;
+}
+
+// ---------------------------------------------------------------------------
+// Modulo2: cubos coloridos, um draw por instância
+
+static const char* cubeVertexSource = R"glsl(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+
+out vec3 ourColor;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    ourColor = aColor;
+}
+)glsl";
+
+static const char* cubeFragmentSource = R"glsl(
+#version 330 core
+in vec3 ourColor;
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(ourColor, 1.0);
+}
+)glsl";
+
+class CubesScene : public BenchmarkScene
+{
+public:
+    // occlusion: testa cada cubo no OcclusionCuller antes do draw
+    CubesScene(const char* name, int gridSize, float spacing, bool occlusion)
+        : m_name(name), m_gridSize(gridSize), m_spacing(spacing), m_occlusion(occlusion) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return m_gridSize * m_spacing * 5.0f / 3.0f; }
+    float getOrbitHeight() const override { return m_gridSize * m_spacing * 0.5f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        m_program = shaders.getProgram("cores", cubeVertexSource, cubeFragmentSource);
+        if (m_program == 0)
+            return false;
+
+        // Mesmo cubo do Modulo2: indexado, posição + cor por face
+        PrimitiveLayout layout;
+        layout.normal = -1;
+        layout.uv = -1;
+        m_cube = &m_primitives.get(PrimitiveShape::cube(), layout);
+
+        m_modelLoc = glGetUniformLocation(m_program, "model");
+
+        if (m_occlusion)
+        {
+            m_positions = expandTriangles(*m_cube->mesh);
+            m_jobs = std::make_unique<JobSystem>();
+            m_culler = std::make_unique<OcclusionCuller>(256, 144, m_jobs.get());
+        }
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+
+        m_models.clear();
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int y = 0; y < m_gridSize; ++y)
+                for (int z = 0; z < m_gridSize; ++z)
+                {
+                    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, y - half, z - half) * m_spacing);
+                    m_models.push_back(glm::rotate(model, frame.time + x + y + z, glm::vec3(0, 1, 0)));
+                }
+
+        if (m_culler)
+        {
+            m_culler->beginFrame(frame.projection * frame.view);
+            for (const glm::mat4& model : m_models)
+                m_culler->addInstance(model, glm::vec3(-0.5f), glm::vec3(0.5f), &m_positions);
+            m_culler->cull();
+        }
+
+        glBindVertexArray(m_cube->VAO);
+        for (size_t i = 0; i < m_models.size(); ++i)
+        {
+            if (m_culler && !m_culler->isVisible((uint32_t)i))
+                continue;
+            glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(m_models[i]));
+            glDrawElements(GL_TRIANGLES, m_cube->indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+        glBindVertexArray(0);
+    }
+
+    void teardown() override
+    {
+        m_primitives.destroy();
+        glDeleteProgram(m_program);
+
+        if (m_culler)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_culler->printStats();
+        }
+        m_culler.reset();
+        m_jobs.reset();
+    }
+
+private:
+    const char* m_name;
+    int m_gridSize;
+    float m_spacing;
+    bool m_occlusion;
+    std::vector<glm::mat4> m_models;
+    std::vector<glm::vec3> m_positions;
+    std::unique_ptr<JobSystem> m_jobs;
+    std::unique_ptr<OcclusionCuller> m_culler;
+    PrimitiveLibrary m_primitives;
+    const Primitive* m_cube = nullptr;
+    GLuint m_program = 0;
+    GLint m_modelLoc = -1;
+};
+
+// ---------------------------------------------------------------------------
+// Os mesmos cubos, com culling (frustum + Hi-Z do frame anterior) num compute
+// shader e um único glMultiDrawElementsIndirect: a CPU não toca nas instâncias
+
+static const char* gpuCubeVertexSource = R"glsl(
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+layout(location = 4) in uint instanceId;
+
+out vec3 ourColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+void main()
+{
+    // Mesmo giro em y das cenas cubes*, com a fase guardada na instância
+    float angle = time + instances[instanceId].data[0];
+    float c = cos(angle), s = sin(angle);
+    vec3 p = vec3(c * aPos.x + s * aPos.z, aPos.y, -s * aPos.x + c * aPos.z);
+    gl_Position = projection * view * instances[instanceId].model * vec4(p, 1.0);
+    ourColor = aColor;
+}
+)glsl";
+
+class GpuCubesScene : public BenchmarkScene
+{
+public:
+    GpuCubesScene(const char* name, int gridSize, float spacing)
+        : m_name(name), m_gridSize(gridSize), m_spacing(spacing) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return m_gridSize * m_spacing * 5.0f / 3.0f; }
+    float getOrbitHeight() const override { return m_gridSize * m_spacing * 0.5f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        m_culler = std::make_unique<GpuCuller>(shaders);
+        if (!m_culler->isSupported())
+            return false;
+
+        // O fragment shader é o mesmo dos cubos
+        std::string vertexSource = std::string("#version 430 core\n") + GpuCuller::getShaderSource() + gpuCubeVertexSource;
+        m_program = shaders.getProgram("cores_gpu", vertexSource.c_str(), cubeFragmentSource);
+        if (m_program == 0)
+            return false;
+
+        PrimitiveLayout layout;
+        layout.normal = -1;
+        layout.uv = -1;
+        const Primitive& cube = m_primitives.get(PrimitiveShape::cube(), layout);
+        m_VAO = cube.VAO;
+
+        // Caixa que contém o cubo em qualquer ângulo do giro em y
+        Aabb bounds;
+        float r = 0.5f * sqrtf(2.0f);
+        bounds.grow(glm::vec3(-r, -0.5f, -r));
+        bounds.grow(glm::vec3(r, 0.5f, r));
+        m_culler->addMesh(cube.indexCount, 0, 0, bounds);
+
+        std::vector<GpuInstance> instances;
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int y = 0; y < m_gridSize; ++y)
+                for (int z = 0; z < m_gridSize; ++z)
+                {
+                    GpuInstance instance;
+                    instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, y - half, z - half) * m_spacing);
+                    instance.data[0] = (float)(x + y + z);
+                    instances.push_back(instance);
+                }
+        m_culler->setInstances(instances);
+        m_culler->attachInstanceIds(m_VAO, 4);
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        m_culler->cull(frame.projection * frame.view);
+
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform1f(glGetUniformLocation(m_program, "time"), frame.time);
+        glBindVertexArray(m_VAO);
+        m_culler->draw();
+        glBindVertexArray(0);
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        m_culler->updateHiZ(viewport[2], viewport[3]);
+    }
+
+    void teardown() override
+    {
+        std::cout << "  " << m_name << ": ";
+        m_culler->printStats();
+        m_culler->destroy();
+        m_culler.reset();
+        m_primitives.destroy();
+        glDeleteProgram(m_program);
+    }
+
+private:
+    const char* m_name;
+    int m_gridSize;
+    float m_spacing;
+    std::unique_ptr<GpuCuller> m_culler;
+    PrimitiveLibrary m_primitives;
+    GLuint m_VAO = 0;
+    GLuint m_program = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Modulo3/4/5: Suzanne texturizada, com Phong (mesmos shaders de assets/shaders),
+// só a textura como no Modulo3 ou com a luz assada nos vértices (baked.fs) ou
+// num lightmap (lightmap.fs)
+
+static const char* texturedVertexSource = R"glsl(
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    texCoord = vec2(texc.x, 1.0 - texc.y);
+}
+)glsl";
+
+static const char* texturedFragmentSource = R"glsl(
+#version 330 core
+in vec2 texCoord;
+
+uniform sampler2D tex_buffer;
+
+out vec4 color;
+
+void main()
+{
+    color = texture(tex_buffer, texCoord);
+}
+)glsl";
+
+class SuzanneScene : public BenchmarkScene
+{
+public:
+    enum Shading { TEXTURED, PHONG, BAKED, LIGHTMAP };
+
+    // BAKED/LIGHTMAP: instâncias paradas, cada uma com a iluminação assada na
+    // cor do vértice ou no seu lightmap
+    SuzanneScene(const std::string& assetsDir, const char* name, int gridSize, Shading shading)
+        : m_assetsDir(assetsDir), m_name(name), m_gridSize(gridSize), m_shading(shading) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return 3.0f + m_gridSize * 2.0f; }
+    float getOrbitHeight() const override { return 0.5f + m_gridSize * 0.5f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        if (m_shading != TEXTURED)
+        {
+            const char* fragment = m_shading == BAKED ? "baked" : m_shading == LIGHTMAP ? "lightmap" : "phong";
+            std::string vertexSource, fragmentSource;
+            if (!HotReload::readTextFile(m_assetsDir + "/shaders/phong.vs", vertexSource) ||
+                !HotReload::readTextFile(m_assetsDir + "/shaders/" + fragment + ".fs", fragmentSource))
+                return false;
+            m_program = shaders.getProgram(fragment, vertexSource.c_str(), fragmentSource.c_str());
+        }
+        else
+        {
+            m_program = shaders.getProgram("textured", texturedVertexSource, texturedFragmentSource);
+        }
+
+        // Malha e imagem ficam também na CPU para os renderizadores em CPU
+        if (m_program == 0 || !parseObj(m_assetsDir + "/Modelos3D/Suzanne.obj", m_mesh) ||
+            !decodeImage(m_assetsDir + "/tex/pixelWall.png", false, m_image))
+            return false;
+        m_geometry = uploadGeometry(m_mesh, &m_image);
+
+        glUseProgram(m_program);
+        glUniform3fv(glGetUniformLocation(m_program, "ka"), 1, glm::value_ptr(m_material.ka));
+        glUniform3fv(glGetUniformLocation(m_program, "kd"), 1, glm::value_ptr(m_material.kd));
+        glUniform3fv(glGetUniformLocation(m_program, "ks"), 1, glm::value_ptr(m_material.ks));
+        glUniform1f(glGetUniformLocation(m_program, "q"), m_material.q);
+        glUniform3fv(glGetUniformLocation(m_program, "lightPos"), 1, glm::value_ptr(m_light.position));
+        glUniform3fv(glGetUniformLocation(m_program, "lightColor"), 1, glm::value_ptr(m_light.color));
+        glUniform1i(glGetUniformLocation(m_program, "tex_buffer"), 0);
+        glUniform1i(glGetUniformLocation(m_program, "lightmap"), 1);
+        m_modelLoc = glGetUniformLocation(m_program, "model");
+
+        m_material.lit = m_shading != TEXTURED;
+        m_material.texture = &m_image;
+        return (m_shading != BAKED && m_shading != LIGHTMAP) || bakeInstances();
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform3fv(glGetUniformLocation(m_program, "camPos"), 1, glm::value_ptr(frame.cameraPos));
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_geometry.textureID);
+        glBindVertexArray(m_geometry.VAO);
+
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                glm::mat4 model = instanceModel(x, z, frame.time);
+                glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+                if (m_shading == BAKED)
+                    glBindVertexArray(m_bakedGeometries[x * m_gridSize + z].VAO);
+                if (m_shading == LIGHTMAP)
+                {
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, m_lightmaps[x * m_gridSize + z]);
+                    glActiveTexture(GL_TEXTURE0);
+                }
+                glDrawArrays(GL_TRIANGLES, 0, m_geometry.vertexCount);
+            }
+
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    bool describe(const SceneFrame& frame, CpuScene& scene) override
+    {
+        // A luz assada não tem equivalente nos renderizadores em CPU
+        if (m_shading == BAKED || m_shading == LIGHTMAP)
+            return false;
+
+        scene.view = frame.view;
+        scene.projection = frame.projection;
+        scene.cameraPos = frame.cameraPos;
+        scene.lights = { m_light };
+        scene.meshes.clear();
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+                scene.meshes.push_back({ &m_mesh, instanceModel(x, z, frame.time), m_material });
+        return true;
+    }
+
+    void teardown() override
+    {
+        destroyGeometry(m_geometry);
+        for (Geometry& baked : m_bakedGeometries)
+            destroyGeometry(baked);
+        m_bakedGeometries.clear();
+        if (!m_lightmaps.empty())
+            glDeleteTextures((GLsizei)m_lightmaps.size(), m_lightmaps.data());
+        m_lightmaps.clear();
+        glDeleteProgram(m_program);
+        m_mesh = MeshData();
+        m_image = ImageData();
+    }
+
+private:
+    glm::mat4 instanceModel(int x, int z, float time) const
+    {
+        float half = (m_gridSize - 1) * 0.5f;
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 2.5f);
+        if (m_shading != BAKED && m_shading != LIGHTMAP)
+            model = glm::rotate(model, time, glm::vec3(0, 1, 0));
+        return glm::scale(model, glm::vec3(0.7f));
+    }
+
+    // Luz (e sombras das vizinhas) de cada instância na cor do vértice de uma
+    // cópia da malha ou num lightmap; fora do tempo medido, que só vê o custo
+    // do baked.fs/lightmap.fs
+    bool bakeInstances()
+    {
+        CpuScene scene;
+        scene.lights = { m_light };
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+                scene.meshes.push_back({ &m_mesh, instanceModel(x, z, 0.0f), m_material });
+
+        JobSystem jobs;
+        VertexBaker vertexBaker(&jobs);
+        LightmapBaker lightmapBaker(&jobs);
+        vertexBaker.setScene(scene);
+        lightmapBaker.setScene(scene);
+
+        MeshData baked = m_mesh;
+        Lightmap lightmap;
+        double bakeMs = 0.0;
+        for (size_t i = 0; i < scene.meshes.size(); ++i)
+        {
+            if (m_shading == LIGHTMAP)
+            {
+                if (!lightmapBaker.bake(i, LightmapSettings(), lightmap))
+                    return false;
+                bakeMs += lightmapBaker.getStats().bakeMs;
+                m_lightmaps.push_back(uploadLightmap(lightmap));
+                continue;
+            }
+
+            if (!vertexBaker.bake(i, VertexBakeSettings(), baked.colors))
+                return false;
+            bakeMs += vertexBaker.getStats().bakeMs;
+            m_bakedGeometries.push_back(uploadGeometry(baked, nullptr));
+        }
+        std::cout << "  " << m_name << ": " << scene.meshes.size() << " instancias assadas em " << bakeMs << " ms"
+            << std::endl;
+        return true;
+    }
+
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_gridSize;
+    Shading m_shading;
+    GLuint m_program = 0;
+    GLint m_modelLoc = -1;
+    Geometry m_geometry;
+    std::vector<Geometry> m_bakedGeometries;   // BAKED: uma por instância, sem textura própria
+    std::vector<GLuint> m_lightmaps;            // LIGHTMAP: um por instância
+    MeshData m_mesh;
+    ImageData m_image;
+    SceneMaterial m_material;
+    SceneLight m_light = { glm::vec3(2.0f, 3.0f, 4.0f), glm::vec3(1.0f) };
+};
+
+// ---------------------------------------------------------------------------
+// LOD: campo de SuzanneSubdiv1 (4x os triângulos da Suzanne) com os níveis
+// gerados pelo LodGenerator; cada instância usa o nível mais simples cujo erro
+// projetado fica abaixo de 1 pixel. Sem LOD todas desenham a malha inteira.
+
+class LodScene : public BenchmarkScene
+{
+public:
+    LodScene(const std::string& assetsDir, const char* name, int gridSize, bool lod)
+        : m_assetsDir(assetsDir), m_name(name), m_gridSize(gridSize), m_lod(lod) {}
+
+    const char* getName() const override { return m_name; }
+    // Câmera dentro do campo: instâncias de perto e de longe no mesmo frame
+    float getOrbitRadius() const override { return m_gridSize * 0.75f; }
+    float getOrbitHeight() const override { return 1.5f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        std::string vertexSource, fragmentSource;
+        if (!HotReload::readTextFile(m_assetsDir + "/shaders/phong.vs", vertexSource) ||
+            !HotReload::readTextFile(m_assetsDir + "/shaders/phong.fs", fragmentSource))
+            return false;
+        m_program = shaders.getProgram("phong", vertexSource.c_str(), fragmentSource.c_str());
+
+        MeshData mesh;
+        ImageData image;
+        if (m_program == 0 || !parseObj(m_assetsDir + "/Modelos3D/SuzanneSubdiv1.obj", mesh) ||
+            !decodeImage(m_assetsDir + "/tex/pixelWall.png", false, image))
+            return false;
+
+        // Sem LOD a cadeia fica só com o nível original
+        LodSettings settings;
+        if (!m_lod)
+            settings.ratios = { 1.0f };
+        LodGenerator generator;
+        LodChain chain;
+        if (!generator.generate(mesh, settings, chain))
+            return false;
+        if (m_lod)
+        {
+            std::cout << "  " << m_name << ": ";
+            generator.printStats(chain);
+        }
+        m_geometry = uploadLodChain(chain, &image);
+
+        glUseProgram(m_program);
+        glUniform3f(glGetUniformLocation(m_program, "ka"), 0.1f, 0.1f, 0.1f);
+        glUniform3f(glGetUniformLocation(m_program, "kd"), 0.7f, 0.7f, 0.7f);
+        glUniform3f(glGetUniformLocation(m_program, "ks"), 1.0f, 1.0f, 1.0f);
+        glUniform1f(glGetUniformLocation(m_program, "q"), 32.0f);
+        glUniform3f(glGetUniformLocation(m_program, "lightPos"), 2.0f, 10.0f, 4.0f);
+        glUniform3f(glGetUniformLocation(m_program, "lightColor"), 1.0f, 1.0f, 1.0f);
+        glUniform1i(glGetUniformLocation(m_program, "tex_buffer"), 0);
+        m_modelLoc = glGetUniformLocation(m_program, "model");
+
+        m_levelDraws.assign(m_geometry.levels.size(), 0);
+        m_triangles = 0;
+        m_frames = 0;
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform3fv(glGetUniformLocation(m_program, "camPos"), 1, glm::value_ptr(frame.cameraPos));
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        float projectionScale = lodProjectionScale(frame.projection, viewport[3]);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_geometry.geometry.textureID);
+        glBindVertexArray(m_geometry.geometry.VAO);
+
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 2.5f);
+                model = glm::rotate(model, frame.time + x * 0.3f + z * 0.7f, glm::vec3(0, 1, 0));
+                model = glm::scale(model, glm::vec3(0.7f));
+
+                int level = m_lod ? selectLod(m_geometry, model, frame.cameraPos, projectionScale, 1.0f) : 0;
+                const LodRange& range = m_geometry.levels[level];
+                glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+                glDrawArrays(GL_TRIANGLES, range.first, range.count);
+
+                m_levelDraws[level]++;
+                m_triangles += range.count / 3;
+            }
+        m_frames++;
+
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void teardown() override
+    {
+        if (m_frames > 0)
+        {
+            std::cout << "  " << m_name << ": media de " << m_triangles / m_frames << " triangulos por frame; draws por nivel:";
+            for (uint64_t draws : m_levelDraws)
+                std::cout << " " << draws;
+            std::cout << std::endl;
+        }
+        destroyLodGeometry(m_geometry);
+        glDeleteProgram(m_program);
+    }
+
+private:
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_gridSize;
+    bool m_lod;
+    GLuint m_program = 0;
+    GLint m_modelLoc = -1;
+    LodGeometry m_geometry;
+    std::vector<uint64_t> m_levelDraws;
+    uint64_t m_triangles = 0;
+    uint64_t m_frames = 0;
+};
+
+// ---------------------------------------------------------------------------
+// O mesmo campo de Suzannes subdivididas, indexado e com GL_CULL_FACE; com
+// meshlets, os grupos fora do frustum ou de costas para a câmera nem vão para a GPU
+
+class MeshletScene : public BenchmarkScene
+{
+public:
+    MeshletScene(const std::string& assetsDir, const char* name, int gridSize, bool meshlets)
+        : m_assetsDir(assetsDir), m_name(name), m_gridSize(gridSize), m_meshlets(meshlets) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return m_gridSize * 0.75f; }
+    float getOrbitHeight() const override { return 1.5f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        std::string vertexSource, fragmentSource;
+        if (!HotReload::readTextFile(m_assetsDir + "/shaders/phong.vs", vertexSource) ||
+            !HotReload::readTextFile(m_assetsDir + "/shaders/phong.fs", fragmentSource))
+            return false;
+        m_program = shaders.getProgram("phong", vertexSource.c_str(), fragmentSource.c_str());
+
+        MeshData mesh;
+        ImageData image;
+        MeshletMesh clusters;
+        if (m_program == 0 || !parseObj(m_assetsDir + "/Modelos3D/SuzanneSubdiv1.obj", mesh) ||
+            !decodeImage(m_assetsDir + "/tex/pixelWall.png", false, image) ||
+            !buildMeshlets(mesh, MeshletSettings(), clusters))
+            return false;
+        if (m_meshlets)
+        {
+            std::cout << "  " << m_name << ": ";
+            printMeshletStats(clusters);
+            m_jobs = std::make_unique<JobSystem>();
+            m_culler = std::make_unique<MeshletCuller>(m_jobs.get());
+        }
+        m_geometry = uploadMeshlets(clusters, &image);
+
+        glUseProgram(m_program);
+        glUniform3f(glGetUniformLocation(m_program, "ka"), 0.1f, 0.1f, 0.1f);
+        glUniform3f(glGetUniformLocation(m_program, "kd"), 0.7f, 0.7f, 0.7f);
+        glUniform3f(glGetUniformLocation(m_program, "ks"), 1.0f, 1.0f, 1.0f);
+        glUniform1f(glGetUniformLocation(m_program, "q"), 32.0f);
+        glUniform3f(glGetUniformLocation(m_program, "lightPos"), 2.0f, 10.0f, 4.0f);
+        glUniform3f(glGetUniformLocation(m_program, "lightColor"), 1.0f, 1.0f, 1.0f);
+        glUniform1i(glGetUniformLocation(m_program, "tex_buffer"), 0);
+        m_modelLoc = glGetUniformLocation(m_program, "model");
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform3fv(glGetUniformLocation(m_program, "camPos"), 1, glm::value_ptr(frame.cameraPos));
+
+        m_models.clear();
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 2.5f);
+                model = glm::rotate(model, frame.time + x * 0.3f + z * 0.7f, glm::vec3(0, 1, 0));
+                m_models.push_back(glm::scale(model, glm::vec3(0.7f)));
+            }
+
+        if (m_culler)
+        {
+            m_culler->beginFrame(m_geometry, frame.projection * frame.view, frame.cameraPos);
+            for (const glm::mat4& model : m_models)
+                m_culler->addInstance(model);
+            m_culler->cull();
+        }
+
+        glEnable(GL_CULL_FACE);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_geometry.geometry.textureID);
+        glBindVertexArray(m_geometry.geometry.VAO);
+        for (size_t i = 0; i < m_models.size(); ++i)
+        {
+            glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(m_models[i]));
+            if (m_culler)
+                m_culler->draw((uint32_t)i);
+            else
+                glDrawElements(GL_TRIANGLES, m_geometry.indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDisable(GL_CULL_FACE);
+    }
+
+    void teardown() override
+    {
+        if (m_culler)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_culler->printStats();
+        }
+        m_culler.reset();
+        m_jobs.reset();
+        destroyMeshletGeometry(m_geometry);
+        glDeleteProgram(m_program);
+    }
+
+private:
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_gridSize;
+    bool m_meshlets;
+    GLuint m_program = 0;
+    GLint m_modelLoc = -1;
+    MeshletGeometry m_geometry;
+    std::vector<glm::mat4> m_models;
+    std::unique_ptr<JobSystem> m_jobs;
+    std::unique_ptr<MeshletCuller> m_culler;
+};
+
+// ---------------------------------------------------------------------------
+// Malhas variadas (Suzannes e primitivas) numa grade: cada malha no seu VAO,
+// todas no GeometryPool (um VAO, glDrawElementsBaseVertex), no pool com
+// culling e um glMultiDrawElementsIndirect só (GpuCuller) ou, no mesmo draw
+// indireto, no VertexPullingPool, cada malha no seu formato de vértice
+
+static const char* poolVertexSource = R"glsl(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+layout(location = 3) in vec3 aNormal;
+
+out vec3 vColor;
+out vec3 vNormal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vColor = aColor;
+    vNormal = mat3(model) * aNormal;
+}
+)glsl";
+
+static const char* poolIndirectVertexSource = R"glsl(
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+layout(location = 3) in vec3 aNormal;
+layout(location = 4) in uint instanceId;
+
+out vec3 vColor;
+out vec3 vNormal;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+void main()
+{
+    // Giro em y com a fase em data[0] e escala uniforme em data[1]
+    float angle = time + instances[instanceId].data[0];
+    float c = cos(angle), s = sin(angle);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+    vec3 p = rotation * aPos * instances[instanceId].data[1];
+    gl_Position = projection * view * instances[instanceId].model * vec4(p, 1.0);
+    vColor = aColor;
+    vNormal = mat3(instances[instanceId].model) * rotation * aNormal;
+}
+)glsl";
+
+static const char* pullingVertexSource = R"glsl(
+layout(location = 4) in uint instanceId;
+
+out vec3 vColor;
+out vec3 vNormal;
+out vec3 vWorldPos;
+flat out int vHasNormal;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+void main()
+{
+    // Formato do vértice em data[2]; giro e escala como em poolIndirectVertexSource
+    PulledVertex v = pullVertex(uint(instances[instanceId].data[2]));
+    float angle = time + instances[instanceId].data[0];
+    float c = cos(angle), s = sin(angle);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+    vec3 p = rotation * v.position * instances[instanceId].data[1];
+    vec4 world = instances[instanceId].model * vec4(p, 1.0);
+    gl_Position = projection * view * world;
+    vColor = v.color;
+    vNormal = mat3(instances[instanceId].model) * rotation * v.normal;
+    vWorldPos = world.xyz;
+    vHasNormal = v.hasNormal ? 1 : 0;
+}
+)glsl";
+
+// Formato sem normal (cubos do Modulo2, faces planas): normal da face pelas derivadas da posição
+static const char* pullingFragmentSource = R"glsl(
+#version 330 core
+in vec3 vColor;
+in vec3 vNormal;
+in vec3 vWorldPos;
+flat in int vHasNormal;
+out vec4 FragColor;
+
+void main()
+{
+    vec3 N = vHasNormal != 0 ? normalize(vNormal) : normalize(cross(dFdx(vWorldPos), dFdy(vWorldPos)));
+    float diffuse = max(dot(N, normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    FragColor = vec4(vColor * (0.3 + 0.7 * diffuse), 1.0);
+}
+)glsl";
+
+static const char* poolFragmentSource = R"glsl(
+#version 330 core
+in vec3 vColor;
+in vec3 vNormal;
+out vec4 FragColor;
+
+void main()
+{
+    float diffuse = max(dot(normalize(vNormal), normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    FragColor = vec4(vColor * (0.3 + 0.7 * diffuse), 1.0);
+}
+)glsl";
+
+class MeshPoolScene : public BenchmarkScene
+{
+public:
+    enum Mode { SEPARATE, POOL, INDIRECT, PULLING };
+
+    MeshPoolScene(const std::string& assetsDir, const char* name, int gridSize, Mode mode)
+        : m_assetsDir(assetsDir), m_name(name), m_gridSize(gridSize), m_mode(mode) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return m_gridSize * 1.4f; }
+    float getOrbitHeight() const override { return 3.0f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        MeshData suzanne, suzanneSubdiv;
+        if (!parseObj(m_assetsDir + "/Modelos3D/Suzanne.obj", suzanne) ||
+            !parseObj(m_assetsDir + "/Modelos3D/SuzanneSubdiv1.obj", suzanneSubdiv))
+            return false;
+        const PrimitiveShape shapes[] = {
+            PrimitiveShape::uvSphere(0.5f, 16, 24, glm::vec3(0.2f, 0.8f, 0.3f)),
+            PrimitiveShape::icosphere(0.5f, 2, glm::vec3(0.2f, 0.4f, 0.9f)),
+            PrimitiveShape::cube(),
+            PrimitiveShape::cylinder(0.4f, 1.0f, 24, glm::vec3(0.9f, 0.8f, 0.2f)),
+        };
+        m_scales = { 0.5f, 0.5f, 1.0f, 1.0f, 0.8f, 1.0f };
+
+        if (m_mode == SEPARATE)
+        {
+            for (const MeshData* mesh : { &suzanne, &suzanneSubdiv })
+            {
+                m_geometries.push_back(uploadGeometry(*mesh, nullptr));
+                m_meshes.push_back({ m_geometries.back().VAO, 0, (GLsizei)m_geometries.back().vertexCount });
+            }
+            for (const PrimitiveShape& shape : shapes)
+            {
+                const Primitive& primitive = m_primitives.get(shape, GEOMETRY_LAYOUT);
+                m_meshes.push_back({ primitive.VAO, primitive.indexCount, primitive.vertexCount });
+            }
+            m_program = shaders.getProgram("pool_separate", poolVertexSource, poolFragmentSource);
+            return m_program != 0;
+        }
+
+        m_formats.assign(6, 0);
+        if (m_mode == PULLING)
+        {
+            m_pulling = std::make_unique<VertexPullingPool>();
+            if (!m_pulling->isSupported())
+                return false;
+            // Suzannes no layout do uploadGeometry, primitivas no da PrimitiveLibrary, cubo só com posição e cor
+            uint32_t geometry = m_pulling->addFormat(VertexFormat::geometry());
+            uint32_t primitive = m_pulling->addFormat(VertexFormat::primitive());
+            m_formats = { geometry, geometry, primitive, primitive, m_pulling->addFormat(VertexFormat::colored()), primitive };
+            PulledMesh mesh;
+            for (int i = 0; i < 6; ++i)
+            {
+                bool added = i < 2 ? m_pulling->add(i == 0 ? suzanne : suzanneSubdiv, m_formats[i], mesh) :
+                    m_pulling->add(m_primitives.getMesh(shapes[i - 2]), m_formats[i], mesh);
+                if (!added)
+                    return false;
+                m_poolMeshes.push_back(mesh);
+            }
+        }
+        else
+        {
+            m_pool = std::make_unique<GeometryPool>();
+            m_poolMeshes.resize(6);
+            if (!m_pool->add(suzanne, m_poolMeshes[0]) || !m_pool->add(suzanneSubdiv, m_poolMeshes[1]))
+                return false;
+            for (int i = 0; i < 4; ++i)
+                if (!m_pool->add(m_primitives.getMesh(shapes[i]), m_poolMeshes[2 + i]))
+                    return false;
+        }
+
+        if (m_mode == POOL)
+        {
+            m_program = shaders.getProgram("pool_separate", poolVertexSource, poolFragmentSource);
+            return m_program != 0;
+        }
+
+        m_culler = std::make_unique<GpuCuller>(shaders);
+        if (!m_culler->isSupported())
+            return false;
+        std::string vertexSource = std::string("#version 430 core\n") + GpuCuller::getShaderSource();
+        if (m_pulling)
+        {
+            vertexSource += std::string(VertexPullingPool::getShaderSource()) + pullingVertexSource;
+            m_program = shaders.getProgram("pool_pulling", vertexSource.c_str(), pullingFragmentSource);
+        }
+        else
+        {
+            vertexSource += poolIndirectVertexSource;
+            m_program = shaders.getProgram("pool_indirect", vertexSource.c_str(), poolFragmentSource);
+        }
+        if (m_program == 0)
+            return false;
+
+        // Caixa que contém a malha em qualquer ângulo do giro em y, já na escala da instância
+        for (size_t i = 0; i < m_poolMeshes.size(); ++i)
+        {
+            const PoolMesh& mesh = m_poolMeshes[i];
+            glm::vec3 extent = glm::max(glm::abs(mesh.bounds.min), glm::abs(mesh.bounds.max)) * m_scales[i];
+            float r = sqrtf(extent.x * extent.x + extent.z * extent.z);
+            Aabb bounds;
+            bounds.grow(glm::vec3(-r, mesh.bounds.min.y * m_scales[i], -r));
+            bounds.grow(glm::vec3(r, mesh.bounds.max.y * m_scales[i], r));
+            m_culler->addMesh(mesh.indexCount, mesh.firstIndex, mesh.baseVertex, bounds);
+        }
+        std::vector<GpuInstance> instances;
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                GpuInstance instance;
+                instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 1.6f);
+                instance.mesh = meshOf(x, z);
+                instance.data[0] = x * 0.3f + z * 0.7f;
+                instance.data[1] = m_scales[instance.mesh];
+                instance.data[2] = (float)m_formats[instance.mesh];
+                instances.push_back(instance);
+            }
+        m_culler->setInstances(instances);
+        m_culler->attachInstanceIds(m_pulling ? m_pulling->getVAO() : m_pool->getVAO(), 4);
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        // O cull troca o programa em uso (compute shader), então vem antes
+        if (m_culler)
+            m_culler->cull(frame.projection * frame.view);
+
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+
+        if (m_culler)
+        {
+            glUniform1f(glGetUniformLocation(m_program, "time"), frame.time);
+            if (m_pulling)
+                m_pulling->bind();
+            else
+                glBindVertexArray(m_pool->getVAO());
+            m_culler->draw();
+            glBindVertexArray(0);
+            ++m_vaoBinds;
+            ++m_draws;
+            ++m_frames;
+
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            m_culler->updateHiZ(viewport[2], viewport[3]);
+            return;
+        }
+
+        GLint modelLoc = glGetUniformLocation(m_program, "model");
+        GLuint boundVAO = 0;
+        if (m_pool)
+        {
+            glBindVertexArray(m_pool->getVAO());
+            boundVAO = m_pool->getVAO();
+            ++m_vaoBinds;
+        }
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                uint32_t mesh = meshOf(x, z);
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 1.6f);
+                model = glm::rotate(model, frame.time + x * 0.3f + z * 0.7f, glm::vec3(0, 1, 0));
+                model = glm::scale(model, glm::vec3(m_scales[mesh]));
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+                if (m_pool)
+                {
+                    m_pool->draw(m_poolMeshes[mesh]);
+                }
+                else
+                {
+                    const SeparateMesh& separate = m_meshes[mesh];
+                    if (separate.VAO != boundVAO)
+                    {
+                        glBindVertexArray(separate.VAO);
+                        boundVAO = separate.VAO;
+                        ++m_vaoBinds;
+                    }
+                    if (separate.indexCount > 0)
+                        glDrawElements(GL_TRIANGLES, separate.indexCount, GL_UNSIGNED_INT, nullptr);
+                    else
+                        glDrawArrays(GL_TRIANGLES, 0, separate.vertexCount);
+                }
+                ++m_draws;
+            }
+        glBindVertexArray(0);
+        ++m_frames;
+    }
+
+    void teardown() override
+    {
+        if (m_frames > 0)
+            std::cout << "  " << m_name << ": " << (double)m_vaoBinds / m_frames << " VAOs ligados e "
+                << (double)m_draws / m_frames << " draws por frame" << std::endl;
+        if (m_culler)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_culler->printStats();
+            m_culler->destroy();
+            m_culler.reset();
+        }
+        if (m_pool)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_pool->printStats();
+            m_pool->destroy();
+            m_pool.reset();
+        }
+        if (m_pulling)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_pulling->printStats();
+            m_pulling->destroy();
+            m_pulling.reset();
+        }
+        for (Geometry& geometry : m_geometries)
+            destroyGeometry(geometry);
+        m_geometries.clear();
+        m_meshes.clear();
+        m_poolMeshes.clear();
+        m_primitives.destroy();
+        glDeleteProgram(m_program);
+    }
+
+private:
+    struct SeparateMesh
+    {
+        GLuint VAO;
+        GLsizei indexCount;         // 0 = desindexada (glDrawArrays)
+        GLsizei vertexCount;
+    };
+
+    // Vizinhas na grade quase sempre com malhas diferentes
+    static uint32_t meshOf(int x, int z) { return (uint32_t)(x * 7 + z * 3) % 6; }
+
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_gridSize;
+    Mode m_mode;
+    std::vector<float> m_scales;
+    PrimitiveLibrary m_primitives;
+    std::vector<Geometry> m_geometries;
+    std::vector<SeparateMesh> m_meshes;
+    std::unique_ptr<GeometryPool> m_pool;
+    std::unique_ptr<VertexPullingPool> m_pulling;
+    std::vector<PoolMesh> m_poolMeshes;
+    std::vector<uint32_t> m_formats;        // formato de cada malha no VertexPullingPool
+    std::unique_ptr<GpuCuller> m_culler;
+    GLuint m_program = 0;
+    uint64_t m_frames = 0;
+    uint64_t m_vaoBinds = 0;
+    uint64_t m_draws = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Grade com dois programas (Phong texturizado e cor por vértice), quatro
+// materiais, três texturas e quatro malhas misturados: RenderQueue ordenada
+// por chave ou na ordem em que a grade é percorrida. Com transparentes, uma
+// fila de vidros de dois materiais alternados em profundidade vai num passe
+// de trás para frente, desenhado com blending.
+
+static const char* glassFragmentSource = R"glsl(
+#version 330 core
+in vec3 vColor;
+in vec3 vNormal;
+out vec4 FragColor;
+
+uniform vec4 glassColor;
+
+void main()
+{
+    float facing = abs(dot(normalize(vNormal), normalize(vec3(0.4, 1.0, 0.6))));
+    FragColor = vec4(glassColor.rgb * (0.6 + 0.4 * facing), glassColor.a);
+}
+)glsl";
+
+class RenderQueueScene : public BenchmarkScene
+{
+public:
+    RenderQueueScene(const std::string& assetsDir, const char* name, int gridSize, bool sorting, bool transparent)
+        : m_assetsDir(assetsDir), m_name(name), m_gridSize(gridSize), m_sorting(sorting), m_transparent(transparent) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return m_gridSize * 1.4f; }
+    float getOrbitHeight() const override { return 3.0f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        std::string vertexSource, fragmentSource;
+        if (!HotReload::readTextFile(m_assetsDir + "/shaders/phong.vs", vertexSource) ||
+            !HotReload::readTextFile(m_assetsDir + "/shaders/phong.fs", fragmentSource))
+            return false;
+        m_phong = shaders.getProgram("phong", vertexSource.c_str(), fragmentSource.c_str());
+        m_flat = shaders.getProgram("pool_separate", poolVertexSource, poolFragmentSource);
+        m_glass = shaders.getProgram("queue_glass", poolVertexSource, glassFragmentSource);
+
+        MeshData suzanne;
+        if (m_phong == 0 || m_flat == 0 || m_glass == 0 ||
+            !parseObj(m_assetsDir + "/Modelos3D/Suzanne.obj", suzanne))
+            return false;
+        for (const char* path : { "/tex/pixelWall.png", "/Modelos3D/Suzanne.png", "/Modelos3D/SuzanneUV.png" })
+        {
+            ImageData image;
+            if (!decodeImage(m_assetsDir + path, false, image))
+                return false;
+            m_textures.push_back(uploadTexture(image));
+        }
+
+        m_suzanne = uploadGeometry(suzanne, nullptr);
+        m_meshes.push_back({ m_suzanne.VAO, false, (GLsizei)m_suzanne.vertexCount, 0.5f });
+        const PrimitiveShape shapes[] = {
+            PrimitiveShape::uvSphere(0.5f, 16, 24, glm::vec3(0.2f, 0.8f, 0.3f)),
+            PrimitiveShape::cube(),
+            PrimitiveShape::cylinder(0.4f, 1.0f, 24, glm::vec3(0.9f, 0.8f, 0.2f)),
+        };
+        for (const PrimitiveShape& shape : shapes)
+        {
+            const Primitive& primitive = m_primitives.get(shape, GEOMETRY_LAYOUT);
+            m_meshes.push_back({ primitive.VAO, true, primitive.indexCount, 1.0f });
+        }
+        const Primitive& pane = m_primitives.get(PrimitiveShape::plane(1.2f, 1.2f), GEOMETRY_LAYOUT);
+        m_pane = { pane.VAO, true, pane.indexCount, 1.0f };
+
+        glUseProgram(m_phong);
+        glUniform3f(glGetUniformLocation(m_phong, "ka"), 0.1f, 0.1f, 0.1f);
+        glUniform3f(glGetUniformLocation(m_phong, "ks"), 1.0f, 1.0f, 1.0f);
+        glUniform1f(glGetUniformLocation(m_phong, "q"), 32.0f);
+        glUniform3f(glGetUniformLocation(m_phong, "lightPos"), 2.0f, 10.0f, 4.0f);
+        glUniform3f(glGetUniformLocation(m_phong, "lightColor"), 1.0f, 1.0f, 1.0f);
+        glUniform1i(glGetUniformLocation(m_phong, "tex_buffer"), 0);
+
+        m_queue.setSorting(m_sorting);
+        m_queue.setBackToFront(GLASS_PASS, m_transparent);
+        m_queue.setProgramCallback([this](GLuint program) {
+            glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(m_frame.view));
+            glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(m_frame.projection));
+            if (program == m_phong)
+                glUniform3fv(glGetUniformLocation(program, "camPos"), 1, glm::value_ptr(m_frame.cameraPos));
+        });
+        m_queue.setMaterialCallback([this](uint32_t material, GLuint program) {
+            static const glm::vec3 diffuse[] = {
+                glm::vec3(0.7f), glm::vec3(0.9f, 0.5f, 0.5f), glm::vec3(0.5f, 0.9f, 0.5f), glm::vec3(0.5f, 0.5f, 0.9f) };
+            static const glm::vec4 glass[] = { glm::vec4(0.9f, 0.3f, 0.2f, 0.4f), glm::vec4(0.2f, 0.5f, 0.9f, 0.4f) };
+            if (program == m_phong)
+                glUniform3fv(glGetUniformLocation(program, "kd"), 1, glm::value_ptr(diffuse[material]));
+            if (program == m_glass)
+                glUniform4fv(glGetUniformLocation(program, "glassColor"), 1, glm::value_ptr(glass[material % 2]));
+        });
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        m_frame = frame;
+        m_queue.beginFrame(frame.view, 100.0f);
+
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                const QueueMesh& mesh = m_meshes[(x * 5 + z * 3) % m_meshes.size()];
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 1.6f);
+                model = glm::rotate(model, frame.time + x * 0.3f + z * 0.7f, glm::vec3(0, 1, 0));
+
+                DrawItem item;
+                item.model = glm::scale(model, glm::vec3(mesh.scale));
+                item.VAO = mesh.VAO;
+                item.indexed = mesh.indexed;
+                item.count = mesh.count;
+                if ((x * 7 + z * 11) % 3 == 0)
+                {
+                    item.program = m_flat;
+                }
+                else
+                {
+                    item.program = m_phong;
+                    item.material = (uint32_t)(x * 3 + z) % 4;
+                    item.texture = m_textures[(x + z * 2) % m_textures.size()];
+                }
+                m_queue.push(item);
+            }
+
+        // Vidros em pé numa fila ao longo de x, materiais alternados, empurrados
+        // fora de ordem: a ordem por estado juntaria os de mesmo material e o
+        // blending sairia errado
+        if (m_transparent)
+            for (int i = 0; i < m_gridSize; ++i)
+            {
+                int slot = (i * 7) % m_gridSize;
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((slot - half) * 1.6f, 1.5f, 0.0f));
+                DrawItem item;
+                item.pass = GLASS_PASS;
+                item.program = m_glass;
+                item.material = (uint32_t)(slot % 2);
+                item.model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0, 0, 1));
+                item.VAO = m_pane.VAO;
+                item.count = m_pane.count;
+                m_queue.push(item);
+            }
+
+        // Os opacos saem com alfa 1, então o blending só muda os vidros
+        if (m_transparent)
+        {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        m_queue.submit();
+        glDisable(GL_BLEND);
+    }
+
+    void teardown() override
+    {
+        std::cout << "  " << m_name << ": ";
+        m_queue.printStats();
+        destroyGeometry(m_suzanne);
+        m_meshes.clear();
+        m_primitives.destroy();
+        glDeleteTextures((GLsizei)m_textures.size(), m_textures.data());
+        m_textures.clear();
+        glDeleteProgram(m_phong);
+        glDeleteProgram(m_flat);
+        glDeleteProgram(m_glass);
+    }
+
+private:
+    struct QueueMesh
+    {
+        GLuint VAO;
+        bool indexed;
+        GLsizei count;
+        float scale;
+    };
+
+    static const uint32_t GLASS_PASS = 1;
+
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_gridSize;
+    bool m_sorting;
+    bool m_transparent;
+    RenderQueue m_queue;
+    SceneFrame m_frame = {};
+    PrimitiveLibrary m_primitives;
+    Geometry m_suzanne;
+    std::vector<QueueMesh> m_meshes;
+    QueueMesh m_pane = {};
+    std::vector<GLuint> m_textures;
+    GLuint m_phong = 0;
+    GLuint m_flat = 0;
+    GLuint m_glass = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Campo de Suzannes com três texturas e quatro cores difusas: um
+// glBindTexture e um draw por Suzanne, ou todas num glDrawArraysInstanced só,
+// com as texturas num GL_TEXTURE_2D_ARRAY (ou num atlas) e a camada vindo do
+// material de cada instância
+
+static const char* batchLightingSource = R"glsl(
+uniform vec3 camPos;
+
+vec3 shade(vec3 texColor, vec3 kd, vec3 N, vec3 fragPos)
+{
+    vec3 L = normalize(vec3(2.0, 10.0, 4.0) - fragPos);
+    vec3 V = normalize(camPos - fragPos);
+    float diff = max(dot(N, L), 0.0);
+    float spec = diff > 0.0 ? pow(max(dot(reflect(-L, N), V), 0.0), 32.0) : 0.0;
+    return (vec3(0.1) + diff * kd) * texColor + vec3(spec);
+}
+)glsl";
+
+static const char* batchSeparateVertexSource = R"glsl(
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+out vec3 vNormal;
+out vec3 fragPos;
+
+void main()
+{
+    fragPos = vec3(model * vec4(position, 1.0));
+    vNormal = mat3(model) * normal;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+    texCoord = vec2(texc.x, 1.0 - texc.y);
+}
+)glsl";
+
+static const char* batchSeparateFragmentSource = R"glsl(
+in vec2 texCoord;
+in vec3 vNormal;
+in vec3 fragPos;
+
+uniform sampler2D tex_buffer;
+uniform vec3 kd;
+
+out vec4 color;
+
+void main()
+{
+    color = vec4(shade(texture(tex_buffer, texCoord).rgb, kd, normalize(vNormal), fragPos), 1.0);
+}
+)glsl";
+
+static const char* batchArrayVertexSource = R"glsl(
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+struct BatchInstance
+{
+    mat4 model;
+    uvec4 material;     // só x
+};
+
+layout(std430, binding = 0) readonly buffer BatchInstances
+{
+    BatchInstance instances[];
+};
+
+layout(std430, binding = 1) readonly buffer Materials
+{
+    ArrayMaterial materials[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+out vec3 vNormal;
+out vec3 fragPos;
+flat out vec4 vUvRect;
+flat out vec3 vKd;
+flat out uint vLayer;
+
+void main()
+{
+    mat4 model = instances[gl_InstanceID].model;
+    fragPos = vec3(model * vec4(position, 1.0));
+    vNormal = mat3(model) * normal;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+    texCoord = vec2(texc.x, 1.0 - texc.y);
+    // Material lido uma vez por vértice, não por fragmento
+    ArrayMaterial material = materials[instances[gl_InstanceID].material.x];
+    vUvRect = material.uvRect;
+    vKd = material.kd;
+    vLayer = material.layer;
+}
+)glsl";
+
+static const char* batchArrayFragmentSource = R"glsl(
+in vec2 texCoord;
+in vec3 vNormal;
+in vec3 fragPos;
+flat in vec4 vUvRect;
+flat in vec3 vKd;
+flat in uint vLayer;
+
+uniform sampler2DArray textures;
+
+out vec4 color;
+
+void main()
+{
+    ArrayMaterial material = ArrayMaterial(vUvRect, vKd, vLayer);
+    vec3 texColor = sampleArrayMaterial(textures, material, texCoord).rgb;
+    color = vec4(shade(texColor, material.kd, normalize(vNormal), fragPos), 1.0);
+}
+)glsl";
+
+class TextureBatchScene : public BenchmarkScene
+{
+public:
+    enum Mode { SEPARATE, ARRAY, ATLAS };
+
+    TextureBatchScene(const std::string& assetsDir, const char* name, int gridSize, Mode mode)
+        : m_assetsDir(assetsDir), m_name(name), m_gridSize(gridSize), m_mode(mode) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return m_gridSize * 0.75f; }
+    float getOrbitHeight() const override { return 1.5f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        MeshData mesh;
+        if (!parseObj(m_assetsDir + "/Modelos3D/Suzanne.obj", mesh))
+            return false;
+        m_geometry = uploadGeometry(mesh, nullptr);
+
+        // Todos os modos com as mesmas texturas de 512x512, para as imagens baterem
+        std::vector<ImageData> images;
+        for (const char* path : { "/tex/pixelWall.png", "/Modelos3D/Suzanne.png", "/Modelos3D/SuzanneUV.png" })
+        {
+            ImageData image;
+            if (!decodeImage(m_assetsDir + path, false, image))
+                return false;
+            images.push_back(resampleImage(image, 512, 512));
+        }
+
+        std::string lighting = batchLightingSource;
+        if (m_mode == SEPARATE)
+        {
+            for (const ImageData& image : images)
+                m_textures.push_back(uploadTexture(image));
+            std::string fragmentSource = "#version 330 core\n" + lighting + batchSeparateFragmentSource;
+            m_program = shaders.getProgram("batch_separate", batchSeparateVertexSource, fragmentSource.c_str());
+            return m_program != 0;
+        }
+
+        if (GLVersion.major < 4 || (GLVersion.major == 4 && GLVersion.minor < 3))
+            return false;
+        TextureArraySettings settings;
+        if (m_mode == ARRAY)
+            settings.layerSize = 512;
+        else
+            settings.minGroup = 1000;           // nenhum grupo: tudo vai para o atlas
+        m_arrays = std::make_unique<TextureArrayAllocator>(settings);
+        std::vector<uint32_t> slots;
+        for (const ImageData& image : images)
+            slots.push_back(m_arrays->add(image));
+        m_arrays->build();
+        std::cout << "  " << m_name << ": ";
+        m_arrays->printStats();
+
+        // Material = textura x cor difusa
+        std::vector<ArrayMaterial> materials;
+        for (uint32_t slot : slots)
+            for (int k = 0; k < 4; ++k)
+            {
+                ArrayMaterial material;
+                material.uvRect = m_arrays->getSlot(slot).uvRect;
+                material.layer = m_arrays->getSlot(slot).layer;
+                material.kd = batchDiffuse(k);
+                materials.push_back(material);
+            }
+        m_arrayTexture = m_arrays->getSlot(slots[0]).array;
+
+        glGenBuffers(1, &m_materialBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_materialBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, materials.size() * sizeof(ArrayMaterial), materials.data(), GL_STATIC_DRAW);
+        glGenBuffers(1, &m_instanceBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_gridSize * m_gridSize * sizeof(BatchInstance), nullptr,
+            GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        std::string vertexSource = "#version 430 core\n" + std::string(TextureArrayAllocator::getMaterialSource()) +
+            batchArrayVertexSource;
+        std::string fragmentSource = "#version 430 core\n" + std::string(TextureArrayAllocator::getShaderSource()) +
+            lighting + batchArrayFragmentSource;
+        m_program = shaders.getProgram("batch_array", vertexSource.c_str(), fragmentSource.c_str());
+        return m_program != 0;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform3fv(glGetUniformLocation(m_program, "camPos"), 1, glm::value_ptr(frame.cameraPos));
+
+        m_instances.clear();
+        float half = (m_gridSize - 1) * 0.5f;
+        for (int x = 0; x < m_gridSize; ++x)
+            for (int z = 0; z < m_gridSize; ++z)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 1.5f);
+                model = glm::rotate(model, frame.time + x * 0.3f + z * 0.7f, glm::vec3(0, 1, 0));
+                BatchInstance instance;
+                instance.model = glm::scale(model, glm::vec3(0.5f));
+                instance.material[0] = (uint32_t)((x + z * 2) % 3) * 4 + (uint32_t)(x * 3 + z) % 4;
+                m_instances.push_back(instance);
+            }
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindVertexArray(m_geometry.VAO);
+        if (m_mode == SEPARATE)
+        {
+            GLint modelLoc = glGetUniformLocation(m_program, "model");
+            GLint kdLoc = glGetUniformLocation(m_program, "kd");
+            glUniform1i(glGetUniformLocation(m_program, "tex_buffer"), 0);
+            for (const BatchInstance& instance : m_instances)
+            {
+                glBindTexture(GL_TEXTURE_2D, m_textures[instance.material[0] / 4]);
+                glUniform3fv(kdLoc, 1, glm::value_ptr(batchDiffuse(instance.material[0] % 4)));
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(instance.model));
+                glDrawArrays(GL_TRIANGLES, 0, m_geometry.vertexCount);
+            }
+            m_draws += m_instances.size();
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        else
+        {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_instances.size() * sizeof(BatchInstance), m_instances.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_instanceBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_materialBuffer);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, m_arrayTexture);
+            glUniform1i(glGetUniformLocation(m_program, "textures"), 0);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, m_geometry.vertexCount, (GLsizei)m_instances.size());
+            m_draws++;
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        }
+        glBindVertexArray(0);
+        m_frames++;
+    }
+
+    void teardown() override
+    {
+        if (m_frames > 0)
+            std::cout << "  " << m_name << ": " << (double)m_draws / m_frames << " draws por frame" << std::endl;
+        if (m_arrays)
+        {
+            m_arrays->destroy();
+            m_arrays.reset();
+            glDeleteBuffers(1, &m_materialBuffer);
+            glDeleteBuffers(1, &m_instanceBuffer);
+        }
+        if (!m_textures.empty())
+            glDeleteTextures((GLsizei)m_textures.size(), m_textures.data());
+        m_textures.clear();
+        destroyGeometry(m_geometry);
+        glDeleteProgram(m_program);
+    }
+
+private:
+    // Layout std430 de BatchInstance no shader (80 bytes)
+    struct BatchInstance
+    {
+        glm::mat4 model;
+        uint32_t material[4] = {};
+    };
+
+    static glm::vec3 batchDiffuse(uint32_t k)
+    {
+        static const glm::vec3 diffuse[] = {
+            glm::vec3(0.7f), glm::vec3(0.9f, 0.5f, 0.5f), glm::vec3(0.5f, 0.9f, 0.5f), glm::vec3(0.5f, 0.5f, 0.9f) };
+        return diffuse[k];
+    }
+
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_gridSize;
+    Mode m_mode;
+    Geometry m_geometry;
+    std::vector<GLuint> m_textures;
+    std::unique_ptr<TextureArrayAllocator> m_arrays;
+    GLuint m_arrayTexture = 0;
+    GLuint m_materialBuffer = 0;
+    GLuint m_instanceBuffer = 0;
+    GLuint m_program = 0;
+    std::vector<BatchInstance> m_instances;
+    uint64_t m_frames = 0;
+    uint64_t m_draws = 0;
+};
+
+// ---------------------------------------------------------------------------
+// 100 mil objetos (4 malhas, 3 texturas, 2 programas) com um draw cada:
+// chamadas GL direto no laço, ou gravadas em command buffers por 1 a N
+// threads e reproduzidas na thread do contexto
+
+static const char* commandsDirectVertexSource = R"glsl(
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+uniform mat4 model;
+uniform vec4 tint;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+out vec3 vNormal;
+out vec4 vTint;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    vNormal = mat3(model) * normal;
+    texCoord = texc;
+    vTint = tint;
+}
+)glsl";
+
+static const char* commandsRecordedVertexSource = R"glsl(
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+out vec3 vNormal;
+out vec4 vTint;
+
+void main()
+{
+    mat4 model = mat4(drawData(0u), drawData(1u), drawData(2u), drawData(3u));
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    vNormal = mat3(model) * normal;
+    texCoord = texc;
+    vTint = drawData(4u);
+}
+)glsl";
+
+static const char* commandsFragmentSource = R"glsl(
+in vec2 texCoord;
+in vec3 vNormal;
+in vec4 vTint;
+
+uniform sampler2D tex_buffer;
+
+out vec4 color;
+
+void main()
+{
+    vec3 base = texture(tex_buffer, texCoord).rgb * vTint.rgb;
+#ifdef LIT
+    base *= 0.2 + 0.8 * max(dot(normalize(vNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+#endif
+    color = vec4(base, 1.0);
+}
+)glsl";
+
+class CommandBufferScene : public BenchmarkScene
+{
+public:
+    // threads = 0: chamadas GL direto, sem command buffers
+    CommandBufferScene(const std::string& assetsDir, const char* name, int objectCount, unsigned threads)
+        : m_assetsDir(assetsDir), m_name(name), m_objectCount(objectCount), m_threads(threads) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return 60.0f; }
+    float getOrbitHeight() const override { return 25.0f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        const PrimitiveShape shapes[] = {
+            PrimitiveShape::cube(),
+            PrimitiveShape::icosphere(0.5f, 1, glm::vec3(1.0f)),
+            PrimitiveShape::uvSphere(0.5f, 8, 12, glm::vec3(1.0f)),
+            PrimitiveShape::cylinder(0.4f, 1.0f, 12, glm::vec3(1.0f)),
+        };
+        for (const PrimitiveShape& shape : shapes)
+            m_meshes.push_back(&m_primitives.get(shape, GEOMETRY_LAYOUT));
+        for (const char* path : { "/tex/pixelWall.png", "/Modelos3D/Suzanne.png", "/Modelos3D/SuzanneUV.png" })
+        {
+            ImageData image;
+            if (!decodeImage(m_assetsDir + path, false, image))
+                return false;
+            m_textures.push_back(uploadTexture(image));
+        }
+
+        std::string fragment = commandsFragmentSource;
+        if (m_threads == 0)
+        {
+            std::string unlit = "#version 330 core\n" + fragment;
+            std::string lit = "#version 330 core\n#define LIT\n" + fragment;
+            m_programs[0] = shaders.getProgram("commands_direct_lit", commandsDirectVertexSource, lit.c_str());
+            m_programs[1] = shaders.getProgram("commands_direct_unlit", commandsDirectVertexSource, unlit.c_str());
+            return m_programs[0] != 0 && m_programs[1] != 0;
+        }
+
+        m_replayer = std::make_unique<CommandReplayer>();
+        if (!m_replayer->isSupported())
+            return false;
+        std::string vertex = "#version 430 core\n" + std::string(CommandReplayer::getShaderSource()) +
+            commandsRecordedVertexSource;
+        std::string unlit = "#version 430 core\n" + fragment;
+        std::string lit = "#version 430 core\n#define LIT\n" + fragment;
+        m_programs[0] = shaders.getProgram("commands_recorded_lit", vertex.c_str(), lit.c_str());
+        m_programs[1] = shaders.getProgram("commands_recorded_unlit", vertex.c_str(), unlit.c_str());
+        if (m_programs[0] == 0 || m_programs[1] == 0)
+            return false;
+        for (GLuint program : m_programs)
+        {
+            PipelineDesc pipeline;
+            pipeline.program = program;
+            m_replayer->addPipeline(pipeline);
+        }
+        for (const Primitive* mesh : m_meshes)
+            m_replayer->addGeometry(mesh->VAO);
+        for (GLuint texture : m_textures)
+            m_replayer->addTexture(texture);
+
+        // A thread do render também grava: threads - 1 workers
+        if (m_threads > 1)
+            m_jobs = std::make_unique<JobSystem>(m_threads - 1);
+        m_buffers.resize(m_threads);
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        for (GLuint program : m_programs)
+        {
+            glUseProgram(program);
+            glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+            glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE,
+                glm::value_ptr(frame.projection));
+            glUniform1i(glGetUniformLocation(program, "tex_buffer"), 0);
+        }
+        glActiveTexture(GL_TEXTURE0);
+
+        auto start = std::chrono::steady_clock::now();
+        if (m_threads == 0)
+            submitDirect(frame.time);
+        else
+        {
+            // Cada thread grava uma faixa contínua de objetos; o replay segue a ordem das faixas
+            auto recordRange = [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t)
+                {
+                    CommandBuffer& commands = m_buffers[t];
+                    commands.reset();
+                    int first = (int)((int64_t)m_objectCount * t / m_threads);
+                    int last = (int)((int64_t)m_objectCount * (t + 1) / m_threads);
+                    for (int i = first; i < last; ++i)
+                    {
+                        ObjectData data = objectData(i, frame.time);
+                        const Primitive& mesh = *m_meshes[meshOf(i)];
+                        commands.bindPipeline(pipelineOf(i));
+                        commands.bindGeometry(meshOf(i));
+                        commands.bindTexture(0, textureOf(i));
+                        commands.setDrawData(&data, sizeof(data));
+                        commands.drawIndexed(mesh.indexCount, 0, 0);
+                    }
+                }
+            };
+            if (m_jobs)
+                m_jobs->parallelFor(m_threads, 1, recordRange);
+            else
+                recordRange(0, 1);
+            auto recorded = std::chrono::steady_clock::now();
+            m_recordMs += std::chrono::duration<double, std::milli>(recorded - start).count();
+            m_replayer->replay(m_buffers.data(), m_buffers.size());
+        }
+        m_submitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_frames++;
+    }
+
+    void teardown() override
+    {
+        if (m_frames > 0)
+        {
+            std::cout << "  " << m_name << ": " << m_objectCount << " objetos, submissao " << m_submitMs / m_frames
+                << " ms por frame";
+            if (m_threads > 0)
+                std::cout << " (gravacao em " << m_threads << " threads " << m_recordMs / m_frames << " ms)";
+            std::cout << std::endl;
+        }
+        if (m_replayer)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_replayer->printStats();
+            m_replayer->destroy();
+            m_replayer.reset();
+        }
+        m_jobs.reset();
+        m_buffers.clear();
+        glDeleteTextures((GLsizei)m_textures.size(), m_textures.data());
+        m_textures.clear();
+        m_meshes.clear();
+        m_primitives.destroy();
+        for (GLuint& program : m_programs)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+private:
+    // Layout de drawData(): model em 0 a 3, cor em 4
+    struct ObjectData
+    {
+        glm::mat4 model;
+        glm::vec4 tint;
+    };
+
+    // Em blocos, para sobrar trabalho para o sombreamento de estado
+    static uint32_t meshOf(int i) { return (uint32_t)(i / 64) % 4; }
+    static uint32_t textureOf(int i) { return (uint32_t)(i / 512) % 3; }
+    static uint32_t pipelineOf(int i) { return (uint32_t)(i / 4096) % 2; }
+
+    ObjectData objectData(int i, float time) const
+    {
+        int side = (int)std::ceil(std::sqrt((float)m_objectCount));
+        float x = (i % side - side * 0.5f) * 0.3f;
+        float z = (i / side - side * 0.5f) * 0.3f;
+        ObjectData data;
+        data.model = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+        data.model = glm::rotate(data.model, time + i * 0.01f, glm::normalize(glm::vec3(1.0f, 1.0f + i % 3, 0.5f)));
+        data.model = glm::scale(data.model, glm::vec3(0.15f));
+        data.tint = glm::vec4(0.6f + 0.4f * std::sin(i * 0.37f), 0.6f + 0.4f * std::sin(i * 0.71f), 0.8f, 1.0f);
+        return data;
+    }
+
+    void submitDirect(float time)
+    {
+        GLint modelLoc[2], tintLoc[2];
+        for (int p = 0; p < 2; ++p)
+        {
+            modelLoc[p] = glGetUniformLocation(m_programs[p], "model");
+            tintLoc[p] = glGetUniformLocation(m_programs[p], "tint");
+        }
+
+        // Mesmo sombreamento de estado do replayer, escrito à mão
+        uint32_t program = ~0u, mesh = ~0u, texture = ~0u;
+        for (int i = 0; i < m_objectCount; ++i)
+        {
+            ObjectData data = objectData(i, time);
+            if (pipelineOf(i) != program)
+            {
+                program = pipelineOf(i);
+                glUseProgram(m_programs[program]);
+            }
+            if (meshOf(i) != mesh)
+            {
+                mesh = meshOf(i);
+                glBindVertexArray(m_meshes[mesh]->VAO);
+            }
+            if (textureOf(i) != texture)
+            {
+                texture = textureOf(i);
+                glBindTexture(GL_TEXTURE_2D, m_textures[texture]);
+            }
+            glUniformMatrix4fv(modelLoc[program], 1, GL_FALSE, glm::value_ptr(data.model));
+            glUniform4fv(tintLoc[program], 1, glm::value_ptr(data.tint));
+            glDrawElements(GL_TRIANGLES, m_meshes[mesh]->indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    std::string m_assetsDir;
+    const char* m_name;
+    int m_objectCount;
+    unsigned m_threads;
+    PrimitiveLibrary m_primitives;
+    std::vector<const Primitive*> m_meshes;
+    std::vector<GLuint> m_textures;
+    GLuint m_programs[2] = {};
+    std::unique_ptr<CommandReplayer> m_replayer;
+    std::unique_ptr<JobSystem> m_jobs;
+    std::vector<CommandBuffer> m_buffers;
+    uint64_t m_frames = 0;
+    double m_recordMs = 0.0;
+    double m_submitMs = 0.0;
+};
+
+// ---------------------------------------------------------------------------
+// Sombras: grade de Suzannes num chão, três luzes pontuais (cube maps) e um
+// sol (cascatas). Só a Suzanne do meio gira; o resto da cena é estático, então
+// com o cache ligado só as faces que enxergam ela são redesenhadas.
+
+static const char* shadowVertexSource = R"glsl(
+#version 400 core
+layout (location = 0) in vec3 position;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+out vec3 vNormal;
+out vec3 fragPos;
+
+void main()
+{
+    fragPos = vec3(model * vec4(position, 1.0));
+    vNormal = mat3(transpose(inverse(model))) * normal;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+    texCoord = vec2(texc.x, 1.0 - texc.y);
+}
+)glsl";
+
+static const char* shadowFragmentSource = R"glsl(
+in vec2 texCoord;
+in vec3 vNormal;
+in vec3 fragPos;
+
+uniform sampler2D tex_buffer;
+
+uniform vec3 pointLightPos[3];
+uniform vec3 pointLightColor;
+uniform vec3 sunDirection;
+uniform vec3 sunColor;
+uniform vec3 camPos;
+
+uniform vec3 ka;
+uniform vec3 kd;
+uniform vec3 ks;
+uniform float q;
+
+out vec4 color;
+
+vec3 phong(vec3 N, vec3 V, vec3 L, vec3 lightColor, float visibility, out vec3 specular)
+{
+    float diff = max(dot(N, L), 0.0);
+    float spec = diff > 0.0 ? pow(max(dot(reflect(-L, N), V), 0.0), q) : 0.0;
+    specular = visibility * spec * ks * lightColor;
+    return visibility * diff * kd * lightColor;
+}
+
+void main()
+{
+    vec3 N = normalize(vNormal);
+    vec3 V = normalize(camPos - fragPos);
+
+    vec3 diffuse = vec3(0.0), specular = vec3(0.0), s;
+    for (int i = 0; i < 3; ++i)
+    {
+        vec3 toLight = pointLightPos[i] - fragPos;
+        float distance = length(toLight);
+        float attenuation = 1.0 / (1.0 + 0.15 * distance * distance);
+        diffuse += phong(N, V, toLight / distance, pointLightColor * attenuation, pointShadow(i, fragPos, N), s);
+        specular += s;
+    }
+    diffuse += phong(N, V, -sunDirection, sunColor, directionalShadow(fragPos, N), s);
+    specular += s;
+
+    vec3 texColor = texture(tex_buffer, texCoord).rgb;
+    color = vec4((ka + diffuse) * texColor + specular, 1.0);
+}
+)glsl";
+
+class ShadowScene : public BenchmarkScene
+{
+public:
+    ShadowScene(const std::string& assetsDir, const char* name, bool caching, bool layered)
+        : m_assetsDir(assetsDir), m_name(name)
+    {
+        m_settings.caching = caching;
+        m_settings.layered = layered;
+    }
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return 13.0f; }
+    float getOrbitHeight() const override { return 4.0f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        m_shadows = std::make_unique<ShadowMaps>(shaders, m_settings);
+        if (!m_shadows->isSupported())
+            return false;
+
+        std::string fragmentSource = std::string("#version 400 core\n") + ShadowMaps::getShaderSource() +
+            shadowFragmentSource;
+        m_program = shaders.getProgram("phong_shadows", shadowVertexSource, fragmentSource.c_str());
+        if (m_program == 0 || !parseObj(m_assetsDir + "/Modelos3D/Suzanne.obj", m_mesh) ||
+            !decodeImage(m_assetsDir + "/tex/pixelWall.png", false, m_image))
+            return false;
+        m_suzanne = uploadGeometry(m_mesh, &m_image);
+
+        // Chão: um quad com a textura repetida
+        MeshData ground;
+        const glm::vec2 corners[6] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { 1, 1 }, { -1, 1 }, { -1, -1 } };
+        for (const glm::vec2& corner : corners)
+        {
+            ground.positions.push_back(glm::vec3(corner.x * 10.0f, -0.75f, -corner.y * 10.0f));
+            ground.uvs.push_back(corner * 5.0f);
+            ground.normals.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+        m_ground = uploadGeometry(ground, nullptr);
+
+        Aabb local;
+        for (const glm::vec3& p : m_mesh.positions)
+            local.grow(p);
+        for (int i = 0; i < GRID * GRID; ++i)
+        {
+            int caster = m_shadows->addCaster(m_suzanne.VAO, m_suzanne.vertexCount, local);
+            m_shadows->setCasterTransform(caster, instanceModel(i, 0.0f));
+        }
+        for (const glm::vec3& light : m_pointLights)
+            m_shadows->addPointLight(light, 8.0f);
+        m_shadows->setDirectionalLight(m_sunDirection);
+
+        glUseProgram(m_program);
+        glUniform3f(glGetUniformLocation(m_program, "ka"), 0.1f, 0.1f, 0.1f);
+        glUniform3f(glGetUniformLocation(m_program, "kd"), 0.6f, 0.6f, 0.6f);
+        glUniform3f(glGetUniformLocation(m_program, "ks"), 0.3f, 0.3f, 0.3f);
+        glUniform1f(glGetUniformLocation(m_program, "q"), 16.0f);
+        glUniform3fv(glGetUniformLocation(m_program, "pointLightPos"), 3, glm::value_ptr(m_pointLights[0]));
+        glUniform3f(glGetUniformLocation(m_program, "pointLightColor"), 1.0f, 0.9f, 0.8f);
+        glUniform3fv(glGetUniformLocation(m_program, "sunDirection"), 1, glm::value_ptr(glm::normalize(m_sunDirection)));
+        glUniform3f(glGetUniformLocation(m_program, "sunColor"), 0.5f, 0.5f, 0.6f);
+        glUniform1i(glGetUniformLocation(m_program, "tex_buffer"), 0);
+        m_modelLoc = glGetUniformLocation(m_program, "model");
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        for (int i = 0; i < GRID * GRID; ++i)
+            m_shadows->setCasterTransform(i, instanceModel(i, frame.time));
+        m_shadows->update(frame.view, frame.projection);
+
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform3fv(glGetUniformLocation(m_program, "camPos"), 1, glm::value_ptr(frame.cameraPos));
+        m_shadows->bind(m_program, 1);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_suzanne.textureID);
+        glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+        glBindVertexArray(m_ground.VAO);
+        glDrawArrays(GL_TRIANGLES, 0, m_ground.vertexCount);
+
+        glBindVertexArray(m_suzanne.VAO);
+        for (int i = 0; i < GRID * GRID; ++i)
+        {
+            glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(instanceModel(i, frame.time)));
+            glDrawArrays(GL_TRIANGLES, 0, m_suzanne.vertexCount);
+        }
+
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void teardown() override
+    {
+        if (m_shadows)
+        {
+            std::cout << "  " << m_name << ": ";
+            m_shadows->printStats();
+            m_shadows->destroy();
+        }
+        m_shadows.reset();
+        destroyGeometry(m_suzanne);
+        destroyGeometry(m_ground);
+        glDeleteProgram(m_program);
+        m_program = 0;
+        m_mesh = MeshData();
+        m_image = ImageData();
+    }
+
+private:
+    static const int GRID = 5;
+
+    // Só a do meio gira
+    glm::mat4 instanceModel(int i, float time) const
+    {
+        int x = i / GRID, z = i % GRID;
+        float half = (GRID - 1) * 0.5f;
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - half, 0.0f, z - half) * 2.5f);
+        if (x == GRID / 2 && z == GRID / 2)
+            model = glm::rotate(model, time, glm::vec3(0, 1, 0));
+        return glm::scale(model, glm::vec3(0.7f));
+    }
+
+    std::string m_assetsDir;
+    const char* m_name;
+    ShadowSettings m_settings;
+    std::unique_ptr<ShadowMaps> m_shadows;
+    GLuint m_program = 0;
+    GLint m_modelLoc = -1;
+    Geometry m_suzanne;
+    Geometry m_ground;
+    MeshData m_mesh;
+    ImageData m_image;
+    glm::vec3 m_pointLights[3] = { { -2.5f, 2.0f, -2.5f }, { 2.5f, 1.5f, 0.0f }, { -1.0f, 1.0f, 3.0f } };
+    glm::vec3 m_sunDirection = glm::vec3(-0.4f, -1.0f, -0.3f);
+};
+
+// ---------------------------------------------------------------------------
+// modulo_4_vivencial: esfera na frente de uma parede, três luzes pontuais com
+// atenuação 1/d² no difuso e a cor do vértice como cor do objeto. Sem as
+// sombras do original, para comparar com os renderizadores em CPU.
+
+static const char* vivencialVertexSource = R"glsl(
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec3 normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 fragPos;
+out vec3 vNormal;
+out vec3 vColor;
+
+void main()
+{
+    fragPos = vec3(model * vec4(position, 1.0));
+    vNormal = mat3(transpose(inverse(model))) * normal;
+    vColor = color;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+}
+)glsl";
+
+static const char* vivencialFragmentSource = R"glsl(
+#version 330 core
+in vec3 fragPos;
+in vec3 vNormal;
+in vec3 vColor;
+
+uniform vec3 lightPos[3];
+uniform vec3 camPos;
+uniform float ka;
+uniform float kd;
+uniform float ks;
+uniform float q;
+
+out vec4 color;
+
+void main()
+{
+    vec3 lightColor = vec3(1.0);
+    vec3 N = normalize(vNormal);
+    vec3 V = normalize(camPos - fragPos);
+
+    vec3 diffuse = vec3(0.0), specular = vec3(0.0);
+    for (int i = 0; i < 3; ++i)
+    {
+        vec3 toLight = lightPos[i] - fragPos;
+        vec3 L = normalize(toLight);
+        float attenuation = 1.0 / dot(toLight, toLight);
+        diffuse += kd * max(dot(N, L), 0.0) * lightColor * attenuation;
+        specular += ks * pow(max(dot(reflect(-L, N), V), 0.0), q) * lightColor;
+    }
+
+    color = vec4((ka * lightColor + diffuse) * vColor + specular, 1.0);
+}
+)glsl";
+
+class VivencialScene : public BenchmarkScene
+{
+public:
+    explicit VivencialScene(const char* name) : m_name(name) {}
+
+    const char* getName() const override { return m_name; }
+    float getOrbitRadius() const override { return 3.0f; }
+    float getOrbitHeight() const override { return 1.0f; }
+
+    bool setup(ShaderCache& shaders) override
+    {
+        m_program = shaders.getProgram("vivencial", vivencialVertexSource, vivencialFragmentSource);
+        if (m_program == 0)
+            return false;
+
+        m_sphere = &m_primitives.get(m_sphereShape);
+        m_wall = &m_primitives.get(m_wallShape);
+
+        // Mesmas malhas, desindexadas, para os renderizadores em CPU
+        m_sphereMesh = expandMesh(*m_sphere->mesh);
+        m_wallMesh = expandMesh(*m_wall->mesh);
+
+        glUseProgram(m_program);
+        glUniform3fv(glGetUniformLocation(m_program, "lightPos"), 3, glm::value_ptr(m_lights[0]));
+        glUniform1f(glGetUniformLocation(m_program, "ka"), 0.1f);
+        glUniform1f(glGetUniformLocation(m_program, "kd"), 0.5f);
+        glUniform1f(glGetUniformLocation(m_program, "ks"), 0.5f);
+        glUniform1f(glGetUniformLocation(m_program, "q"), 10.0f);
+        m_modelLoc = glGetUniformLocation(m_program, "model");
+
+        m_material.ka = glm::vec3(0.1f);
+        m_material.kd = glm::vec3(0.5f);
+        m_material.ks = glm::vec3(0.5f);
+        m_material.q = 10.0f;
+        return true;
+    }
+
+    void render(const SceneFrame& frame) override
+    {
+        glUseProgram(m_program);
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "view"), 1, GL_FALSE, glm::value_ptr(frame.view));
+        glUniformMatrix4fv(glGetUniformLocation(m_program, "projection"), 1, GL_FALSE, glm::value_ptr(frame.projection));
+        glUniform3fv(glGetUniformLocation(m_program, "camPos"), 1, glm::value_ptr(frame.cameraPos));
+
+        glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(sphereModel()));
+        glBindVertexArray(m_sphere->VAO);
+        glDrawElements(GL_TRIANGLES, m_sphere->indexCount, GL_UNSIGNED_INT, nullptr);
+
+        glUniformMatrix4fv(m_modelLoc, 1, GL_FALSE, glm::value_ptr(wallModel()));
+        glBindVertexArray(m_wall->VAO);
+        glDrawElements(GL_TRIANGLES, m_wall->indexCount, GL_UNSIGNED_INT, nullptr);
+
+        glBindVertexArray(0);
+    }
+
+    // Referência em CPU do módulo: com sombras, o RayTracer mostra a sombra da
+    // esfera na parede que o original tira dos cube maps
+    bool describe(const SceneFrame& frame, CpuScene& scene) override
+    {
+        scene.view = frame.view;
+        scene.projection = frame.projection;
+        scene.cameraPos = frame.cameraPos;
+        scene.lights.clear();
+        for (const glm::vec3& light : m_lights)
+            scene.lights.push_back({ light, glm::vec3(1.0f), true });
+
+        SceneMaterial sphere = m_material, wall = m_material;
+        sphere.baseColor = m_sphereShape.color;
+        wall.baseColor = m_wallShape.color;
+        scene.meshes = { { &m_sphereMesh, sphereModel(), sphere }, { &m_wallMesh, wallModel(), wall } };
+        return true;
+    }
+
+    void teardown() override
+    {
+        m_primitives.destroy();
+        glDeleteProgram(m_program);
+        m_program = 0;
+        m_sphere = m_wall = nullptr;
+        m_sphereMesh = MeshData();
+        m_wallMesh = MeshData();
+    }
+
+private:
+    static glm::mat4 sphereModel() { return glm::mat4(1.0f); }
+
+    // O plane() fica no plano XZ; de pé, atrás da esfera, virado para +z
+    static glm::mat4 wallModel()
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -0.8f));
+        return glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+
+    const char* m_name;
+    GLuint m_program = 0;
+    GLint m_modelLoc = -1;
+    PrimitiveLibrary m_primitives;
+    const PrimitiveShape m_sphereShape = PrimitiveShape::uvSphere(0.5f, 16, 16);
+    const PrimitiveShape m_wallShape = PrimitiveShape::plane(2.0f, 2.0f, 1, glm::vec3(0.8f));
+    const Primitive* m_sphere = nullptr;
+    const Primitive* m_wall = nullptr;
+    MeshData m_sphereMesh;
+    MeshData m_wallMesh;
+    SceneMaterial m_material;
+    glm::vec3 m_lights[3] = { { 0.6f, 0.7f, -0.5f }, { -0.6f, 1.1f, 0.0f }, { 0.0f, -0.7f, 0.5f } };
+};
+
+std::vector<std::unique_ptr<BenchmarkScene>> createScenes(const std::string& assetsDir)
+{
+    std::vector<std::unique_ptr<BenchmarkScene>> scenes;
+    scenes.push_back(std::make_unique<CubesScene>("cubes", 10, 1.5f, false));
+    scenes.push_back(std::make_unique<CubesScene>("cubes_dense", 16, 1.1f, false));
+    scenes.push_back(std::make_unique<CubesScene>("cubes_dense_occlusion", 16, 1.1f, true));
+    scenes.push_back(std::make_unique<GpuCubesScene>("cubes_dense_gpu", 16, 1.1f));
+    scenes.push_back(std::make_unique<GpuCubesScene>("cubes_huge_gpu", 64, 1.1f));
+    scenes.push_back(std::make_unique<SuzanneScene>(assetsDir, "suzanne_unlit", 1, SuzanneScene::TEXTURED));
+    scenes.push_back(std::make_unique<SuzanneScene>(assetsDir, "suzanne", 1, SuzanneScene::PHONG));
+    scenes.push_back(std::make_unique<SuzanneScene>(assetsDir, "suzanne_grid", 8, SuzanneScene::PHONG));
+    scenes.push_back(std::make_unique<SuzanneScene>(assetsDir, "suzanne_grid_baked", 8, SuzanneScene::BAKED));
+    scenes.push_back(std::make_unique<SuzanneScene>(assetsDir, "suzanne_lightmap", 1, SuzanneScene::LIGHTMAP));
+    scenes.push_back(std::make_unique<LodScene>(assetsDir, "suzanne_field", 16, false));
+    scenes.push_back(std::make_unique<LodScene>(assetsDir, "suzanne_field_lod", 16, true));
+    scenes.push_back(std::make_unique<MeshletScene>(assetsDir, "suzanne_field_indexed", 16, false));
+    scenes.push_back(std::make_unique<MeshletScene>(assetsDir, "suzanne_field_meshlets", 16, true));
+    scenes.push_back(std::make_unique<MeshPoolScene>(assetsDir, "mesh_mix", 16, MeshPoolScene::SEPARATE));
+    scenes.push_back(std::make_unique<MeshPoolScene>(assetsDir, "mesh_mix_pool", 16, MeshPoolScene::POOL));
+    scenes.push_back(std::make_unique<MeshPoolScene>(assetsDir, "mesh_mix_indirect", 16, MeshPoolScene::INDIRECT));
+    scenes.push_back(std::make_unique<MeshPoolScene>(assetsDir, "mesh_mix_pulling", 16, MeshPoolScene::PULLING));
+    scenes.push_back(std::make_unique<RenderQueueScene>(assetsDir, "queue_mix_unsorted", 16, false, false));
+    scenes.push_back(std::make_unique<RenderQueueScene>(assetsDir, "queue_mix", 16, true, false));
+    scenes.push_back(std::make_unique<RenderQueueScene>(assetsDir, "queue_mix_glass_unsorted", 16, false, true));
+    scenes.push_back(std::make_unique<RenderQueueScene>(assetsDir, "queue_mix_glass", 16, true, true));
+    scenes.push_back(std::make_unique<TextureBatchScene>(assetsDir, "suzanne_textures", 16, TextureBatchScene::SEPARATE));
+    scenes.push_back(std::make_unique<TextureBatchScene>(assetsDir, "suzanne_textures_array", 16, TextureBatchScene::ARRAY));
+    scenes.push_back(std::make_unique<TextureBatchScene>(assetsDir, "suzanne_textures_atlas", 16, TextureBatchScene::ATLAS));
+    scenes.push_back(std::make_unique<CommandBufferScene>(assetsDir, "commands_direct", 100000, 0));
+    scenes.push_back(std::make_unique<CommandBufferScene>(assetsDir, "commands_t1", 100000, 1));
+    scenes.push_back(std::make_unique<CommandBufferScene>(assetsDir, "commands_t2", 100000, 2));
+    scenes.push_back(std::make_unique<CommandBufferScene>(assetsDir, "commands_t4", 100000, 4));
+    scenes.push_back(std::make_unique<ShadowScene>(assetsDir, "shadows", true, true));
+    scenes.push_back(std::make_unique<ShadowScene>(assetsDir, "shadows_nocache", false, true));
+    scenes.push_back(std::make_unique<ShadowScene>(assetsDir, "shadows_naive", false, false));
+    scenes.push_back(std::make_unique<VivencialScene>("vivencial"));
+    return scenes;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CpuScene.h"
+#include "ShaderCache.h"
+
+// Estado de um frame do benchmark. A câmera é roteirizada pelo índice do
+// frame (e não pelo relógio), então toda execução desenha a mesma sequência.
+struct SceneFrame
+{
+    int index;
+    float time;         // index / 60, em segundos simulados
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 cameraPos;
+};
+
+// Órbita em torno da origem, uma volta a cada 600 frames
+SceneFrame scriptedCamera(int frameIndex, float aspect, float radius, float height);
+
+class BenchmarkScene
+{
+public:
+    virtual ~BenchmarkScene() = default;
+
+    virtual const char* getName() const = 0;
+    virtual bool setup(ShaderCache& shaders) = 0;
+    virtual void render(const SceneFrame& frame) = 0;
+    virtual void teardown() = 0;
+
+    // Mesmo frame descrito para os renderizadores em CPU (SoftwareRasterizer e
+    // RayTracer); false se a cena não tem caminho de CPU
+    virtual bool describe(const SceneFrame& /*frame*/, CpuScene& /*scene*/) { return false; }
+
+    // Raio/altura da órbita da câmera para enquadrar a cena
+    virtual float getOrbitRadius() const { return 3.0f; }
+    virtual float getOrbitHeight() const { return 0.5f; }
+};
+
+// Cenas dos módulos; assetsDir aponta para os assets do Modulo5
+std::vector<std::unique_ptr<BenchmarkScene>> createScenes(const std::string& assetsDir);
@@ -0,0 +1,666 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "HeadlessContext.h"
+#include "JobSystem.h"
+#include "LightmapBaker.h"
+#include "Profiler.h"
+#include "RayTracer.h"
+#include "Scenes.h"
+#include "ShaderCache.h"
+#include "SoftwareRasterizer.h"
+
+using namespace std;
+
+// Assets do Modulo5 na arvore de codigo (definido no CMakeLists)
+#ifndef ASSETS_SOURCE_DIR
+#define ASSETS_SOURCE_DIR "assets"
+#endif
+
+struct BenchmarkOptions
+{
+    int width = 1280;
+    int height = 720;
+    int frames = 300;
+    int warmup = 30;
+    string scene;           // vazio = todas
+    string output = "benchmark.json";
+    string assetsDir = ASSETS_SOURCE_DIR;
+    bool software = false;      // também mede o rasterizador em software
+    int softwareFrames = 30;
+    bool dumpImages = false;    // grava <cena>_gl.ppm, <cena>_cpu.ppm e <cena>_rt*.ppm das comparações
+    bool raytrace = false;      // também mede o RayTracer
+    int raytraceSamples = 16;   // amostras por pixel do path tracing
+    bool bake = false;          // também mede o LightmapBaker com 1, 2, 4, ... threads
+    int bakeSize = 256;
+};
+
+struct FrameStats
+{
+    double minMs = 0.0, meanMs = 0.0, p50Ms = 0.0, p95Ms = 0.0, p99Ms = 0.0, maxMs = 0.0, stddevMs = 0.0;
+};
+
+struct SceneResult
+{
+    string name;
+    bool ok = false;
+    FrameStats stats;
+};
+
+struct SoftwareScaling
+{
+    unsigned threads;
+    double frameMs;
+    double mpixelsPerSecond;
+};
+
+struct SoftwareResult
+{
+    string name;
+    bool ok = false;
+    string kernel;
+    double meanAbsDiff = 0.0;   // média da diferença absoluta por canal (0-255) contra o GL
+    double mismatchPercent = 0.0;
+    bool matches = false;
+    vector<SoftwareScaling> scaling;
+    double scalarMpixelsPerSecond = 0.0;
+};
+
+struct RaytraceResult
+{
+    string name;
+    bool ok = false;
+    double meanAbsDiff = 0.0;   // DIRECT sem sombras contra o GL
+    double mismatchPercent = 0.0;
+    bool matches = false;
+    RayTracerStats direct;      // DIRECT com sombras
+    RayTracerStats path;        // PATH com raytraceSamples amostras
+};
+
+struct BakeScaling
+{
+    unsigned threads;
+    double bakeMs;
+    double mraysPerSecond;
+};
+
+struct BakeResult
+{
+    bool ok = false;
+    LightmapStats stats;        // da execução com todos os núcleos
+    vector<BakeScaling> scaling;
+};
+
+// Pixel diferente = algum canal difere mais que isto do GL (filtragem de
+// textura e arredondamento nunca batem bit a bit)
+static const int PIXEL_TOLERANCE = 16;
+static const double MAX_MISMATCH_PERCENT = 2.0;
+static const glm::vec3 CLEAR_COLOR = glm::vec3(0.1f, 0.1f, 0.12f);
+
+static void printUsage()
+{
+    cout << "Uso: Benchmark [--frames N] [--warmup N] [--width W] [--height H] [--scene nome]"
+        << " [--assets dir] [--out arquivo.json] [--software] [--software-frames N] [--raytrace] [--raytrace-spp N]"
+        << " [--bake] [--bake-size N] [--dump-images]" << endl;
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue)
+            options.frames = max(1, atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue)
+            options.warmup = max(0, atoi(argv[++i]));
+        else if (arg == "--width" && hasValue)
+            options.width = max(1, atoi(argv[++i]));
+        else if (arg == "--height" && hasValue)
+            options.height = max(1, atoi(argv[++i]));
+        else if (arg == "--scene" && hasValue)
+            options.scene = argv[++i];
+        else if (arg == "--assets" && hasValue)
+            options.assetsDir = argv[++i];
+        else if (arg == "--out" && hasValue)
+            options.output = argv[++i];
+        else if (arg == "--software")
+            options.software = true;
+        else if (arg == "--software-frames" && hasValue)
+            options.softwareFrames = max(1, atoi(argv[++i]));
+        else if (arg == "--raytrace")
+            options.raytrace = true;
+        else if (arg == "--raytrace-spp" && hasValue)
+            options.raytraceSamples = max(1, atoi(argv[++i]));
+        else if (arg == "--bake")
+            options.bake = true;
+        else if (arg == "--bake-size" && hasValue)
+            options.bakeSize = max(1, atoi(argv[++i]));
+        else if (arg == "--dump-images")
+            options.dumpImages = true;
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Percentil pelo método nearest-rank sobre amostras já ordenadas
+static double percentile(const vector<double>& sorted, double p)
+{
+    size_t rank = (size_t)ceil(p * sorted.size());
+    return sorted[min(max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+static FrameStats computeStats(vector<double> samples)
+{
+    FrameStats stats;
+    sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double ms : samples)
+        sum += ms;
+    stats.meanMs = sum / samples.size();
+
+    double variance = 0.0;
+    for (double ms : samples)
+        variance += (ms - stats.meanMs) * (ms - stats.meanMs);
+    stats.stddevMs = sqrt(variance / samples.size());
+
+    stats.minMs = samples.front();
+    stats.maxMs = samples.back();
+    stats.p50Ms = percentile(samples, 0.50);
+    stats.p95Ms = percentile(samples, 0.95);
+    stats.p99Ms = percentile(samples, 0.99);
+    return stats;
+}
+
+static void writeJsonString(ostream& out, const string& text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+static bool writeReport(const string& path, const BenchmarkOptions& options, const HeadlessContext& context,
+    const vector<SceneResult>& results, const vector<SoftwareResult>& software, const vector<RaytraceResult>& raytrace,
+    const BakeResult& bake)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        cerr << "Benchmark: nao foi possivel gravar " << path << endl;
+        return false;
+    }
+
+    out.precision(4);
+    out << fixed << "{\n  \"renderer\": ";
+    writeJsonString(out, context.getRenderer());
+    out << ",\n  \"version\": ";
+    writeJsonString(out, context.getVersion());
+    out << ",\n  \"width\": " << options.width << ",\n  \"height\": " << options.height
+        << ",\n  \"frames\": " << options.frames << ",\n  \"warmup\": " << options.warmup
+        << ",\n  \"scenes\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const SceneResult& result = results[i];
+        const FrameStats& s = result.stats;
+        out << (i ? "," : "") << "\n    {\"name\": ";
+        writeJsonString(out, result.name);
+        out << ", \"ok\": " << (result.ok ? "true" : "false");
+        if (result.ok)
+        {
+            out << ", \"fps\": " << 1000.0 / s.meanMs
+                << ", \"frame_ms\": {\"min\": " << s.minMs << ", \"mean\": " << s.meanMs
+                << ", \"p50\": " << s.p50Ms << ", \"p95\": " << s.p95Ms << ", \"p99\": " << s.p99Ms
+                << ", \"max\": " << s.maxMs << ", \"stddev\": " << s.stddevMs << "}";
+        }
+        out << "}";
+    }
+    out << "\n  ]";
+
+    if (options.software)
+    {
+        out << ",\n  \"software\": [";
+        for (size_t i = 0; i < software.size(); ++i)
+        {
+            const SoftwareResult& result = software[i];
+            out << (i ? "," : "") << "\n    {\"name\": ";
+            writeJsonString(out, result.name);
+            out << ", \"ok\": " << (result.ok ? "true" : "false");
+            if (result.ok)
+            {
+                out << ", \"kernel\": \"" << result.kernel << "\", \"mean_abs_diff\": " << result.meanAbsDiff
+                    << ", \"mismatch_percent\": " << result.mismatchPercent
+                    << ", \"matches_gl\": " << (result.matches ? "true" : "false")
+                    << ", \"scalar_mpixels_per_s\": " << result.scalarMpixelsPerSecond << ", \"scaling\": [";
+                for (size_t j = 0; j < result.scaling.size(); ++j)
+                {
+                    const SoftwareScaling& s = result.scaling[j];
+                    out << (j ? ", " : "") << "{\"threads\": " << s.threads << ", \"frame_ms\": " << s.frameMs
+                        << ", \"mpixels_per_s\": " << s.mpixelsPerSecond << "}";
+                }
+                out << "]";
+            }
+            out << "}";
+        }
+        out << "\n  ]";
+    }
+
+    if (options.raytrace)
+    {
+        auto writeRays = [&](const char* key, const RayTracerStats& s)
+            {
+                out << ", \"" << key << "\": {\"ms\": " << s.renderMs << ", \"mrays_per_s\": " << s.mraysPerSecond
+                    << ", \"primary\": " << s.primaryRays << ", \"shadow\": " << s.shadowRays
+                    << ", \"bounce\": " << s.bounceRays << "}";
+            };
+
+        out << ",\n  \"raytrace\": [";
+        for (size_t i = 0; i < raytrace.size(); ++i)
+        {
+            const RaytraceResult& result = raytrace[i];
+            out << (i ? "," : "") << "\n    {\"name\": ";
+            writeJsonString(out, result.name);
+            out << ", \"ok\": " << (result.ok ? "true" : "false");
+            if (result.ok)
+            {
+                out << ", \"mean_abs_diff\": " << result.meanAbsDiff << ", \"mismatch_percent\": " << result.mismatchPercent
+                    << ", \"matches_gl\": " << (result.matches ? "true" : "false")
+                    << ", \"path_spp\": " << options.raytraceSamples;
+                writeRays("direct", result.direct);
+                writeRays("path", result.path);
+            }
+            out << "}";
+        }
+        out << "\n  ]";
+    }
+
+    if (options.bake)
+    {
+        out << ",\n  \"bake\": {\"ok\": " << (bake.ok ? "true" : "false");
+        if (bake.ok)
+        {
+            out << ", \"size\": " << options.bakeSize << ", \"texels\": " << bake.stats.texels
+                << ", \"overlapping\": " << bake.stats.overlapping << ", \"rays\": " << bake.stats.rays
+                << ", \"scaling\": [";
+            for (size_t j = 0; j < bake.scaling.size(); ++j)
+            {
+                const BakeScaling& s = bake.scaling[j];
+                out << (j ? ", " : "") << "{\"threads\": " << s.threads << ", \"ms\": " << s.bakeMs
+                    << ", \"speedup\": " << bake.scaling[0].bakeMs / s.bakeMs
+                    << ", \"mrays_per_s\": " << s.mraysPerSecond << "}";
+            }
+            out << "]";
+        }
+        out << "}";
+    }
+    out << "\n}\n";
+    return true;
+}
+
+static SceneResult runScene(BenchmarkScene& scene, const BenchmarkOptions& options, const HeadlessContext& context,
+    ShaderCache& shaders)
+{
+    SceneResult result;
+    result.name = scene.getName();
+    if (!scene.setup(shaders))
+    {
+        cerr << "Benchmark: falha ao preparar a cena " << result.name << endl;
+        return result;
+    }
+
+    float aspect = (float)options.width / (float)options.height;
+    vector<double> frameMs;
+    frameMs.reserve(options.frames);
+
+    glEnable(GL_DEPTH_TEST);
+    for (int i = 0; i < options.warmup + options.frames; ++i)
+    {
+        PROFILE_FRAME();
+        auto start = chrono::steady_clock::now();
+        {
+            PROFILE_SCOPE("Render");
+            context.bindFramebuffer();
+            glClearColor(CLEAR_COLOR.r, CLEAR_COLOR.g, CLEAR_COLOR.b, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            scene.render(scriptedCamera(i, aspect, scene.getOrbitRadius(), scene.getOrbitHeight()));
+
+            // Sem swap: o glFinish fecha o frame e inclui o tempo do driver na medida
+            glFinish();
+        }
+        auto end = chrono::steady_clock::now();
+
+        if (i >= options.warmup)
+            frameMs.push_back(chrono::duration<double, milli>(end - start).count());
+    }
+
+    scene.teardown();
+    result.stats = computeStats(frameMs);
+    result.ok = true;
+
+    cout << "  " << result.name << ": media " << result.stats.meanMs << " ms, p99 " << result.stats.p99Ms
+        << " ms (" << 1000.0 / result.stats.meanMs << " fps)" << endl;
+    return result;
+}
+
+// Frame de referência no GL, lido de volta com a linha 0 no topo
+static vector<uint32_t> readGlFrame(BenchmarkScene& scene, const SceneFrame& frame, const BenchmarkOptions& options,
+    const HeadlessContext& context)
+{
+    context.bindFramebuffer();
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(CLEAR_COLOR.r, CLEAR_COLOR.g, CLEAR_COLOR.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    scene.render(frame);
+
+    size_t pixels = (size_t)options.width * options.height;
+    vector<uint32_t> glPixels(pixels), flipped(pixels);
+    glReadPixels(0, 0, options.width, options.height, GL_RGBA, GL_UNSIGNED_BYTE, glPixels.data());
+    for (int y = 0; y < options.height; ++y)
+        copy_n(&glPixels[(size_t)(options.height - 1 - y) * options.width], options.width, &flipped[(size_t)y * options.width]);
+    return flipped;
+}
+
+// Diferença média por canal e porcentagem de pixels fora de PIXEL_TOLERANCE
+static bool compareImages(const vector<uint32_t>& reference, const vector<uint32_t>& image, double& meanAbsDiff,
+    double& mismatchPercent)
+{
+    size_t pixels = reference.size();
+    uint64_t diffSum = 0, mismatched = 0;
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        int worst = 0;
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            int d = abs((int)((reference[i] >> shift) & 0xFF) - (int)((image[i] >> shift) & 0xFF));
+            diffSum += d;
+            worst = max(worst, d);
+        }
+        mismatched += worst > PIXEL_TOLERANCE;
+    }
+    meanAbsDiff = (double)diffSum / (pixels * 3);
+    mismatchPercent = 100.0 * mismatched / pixels;
+    return mismatchPercent <= MAX_MISMATCH_PERCENT;
+}
+
+// Mpixels/s do rasterizador em software com "threads" participantes (1 = sem JobSystem)
+static SoftwareScaling measureSoftware(BenchmarkScene& scene, const BenchmarkOptions& options, unsigned threads,
+    bool simd)
+{
+    unique_ptr<JobSystem> jobs;
+    if (threads > 1)
+        jobs = make_unique<JobSystem>(threads - 1);
+    SoftwareRasterizer rasterizer(options.width, options.height, jobs.get());
+    rasterizer.setSimdEnabled(simd);
+
+    float aspect = (float)options.width / (float)options.height;
+    double totalMs = 0.0;
+    CpuScene cpuScene;
+    for (int i = -2; i < options.softwareFrames; ++i)
+    {
+        auto start = chrono::steady_clock::now();
+        rasterizer.beginFrame(CLEAR_COLOR);
+        scene.describe(scriptedCamera(max(i, 0), aspect, scene.getOrbitRadius(), scene.getOrbitHeight()), cpuScene);
+        rasterizer.drawScene(cpuScene);
+        rasterizer.endFrame();
+        auto end = chrono::steady_clock::now();
+        if (i >= 0)
+            totalMs += chrono::duration<double, milli>(end - start).count();
+    }
+
+    SoftwareScaling scaling;
+    scaling.threads = threads;
+    scaling.frameMs = totalMs / options.softwareFrames;
+    scaling.mpixelsPerSecond = (double)options.width * options.height / (scaling.frameMs * 1000.0);
+    return scaling;
+}
+
+static SoftwareResult runSoftware(BenchmarkScene& scene, const BenchmarkOptions& options, const HeadlessContext& context,
+    ShaderCache& shaders)
+{
+    SoftwareResult result;
+    result.name = scene.getName();
+    if (!scene.setup(shaders))
+        return result;
+
+    // 1) Mesmo frame no GL e na CPU, comparados pixel a pixel
+    float aspect = (float)options.width / (float)options.height;
+    SceneFrame frame = scriptedCamera(100, aspect, scene.getOrbitRadius(), scene.getOrbitHeight());
+
+    CpuScene cpuScene;
+    if (!scene.describe(frame, cpuScene))
+    {
+        scene.teardown();
+        return result;
+    }
+    vector<uint32_t> glPixels = readGlFrame(scene, frame, options, context);
+
+    JobSystem jobs;
+    SoftwareRasterizer rasterizer(options.width, options.height, &jobs);
+    rasterizer.beginFrame(CLEAR_COLOR);
+    rasterizer.drawScene(cpuScene);
+    rasterizer.endFrame();
+    result.kernel = rasterizer.getKernelName();
+    result.matches = compareImages(glPixels, rasterizer.getColorBuffer(), result.meanAbsDiff, result.mismatchPercent);
+
+    if (options.dumpImages)
+    {
+        writePpm(result.name + "_gl.ppm", glPixels, options.width, options.height);
+        rasterizer.writePpm(result.name + "_cpu.ppm");
+    }
+
+    // 2) Escala com o número de threads (1, 2, 4, ... até todos os núcleos)
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    for (unsigned threads = 1; ; threads = min(threads * 2, cores))
+    {
+        result.scaling.push_back(measureSoftware(scene, options, threads, true));
+        if (threads == cores)
+            break;
+    }
+    result.scalarMpixelsPerSecond = measureSoftware(scene, options, cores, false).mpixelsPerSecond;
+
+    scene.teardown();
+    result.ok = true;
+
+    cout << "  " << result.name << " (software, " << result.kernel << "): diferenca media " << result.meanAbsDiff
+        << ", " << result.mismatchPercent << "% pixels fora da tolerancia";
+    for (const SoftwareScaling& s : result.scaling)
+        cout << ", " << s.threads << "T " << s.mpixelsPerSecond << " Mpix/s";
+    cout << endl;
+    return result;
+}
+
+static RaytraceResult runRaytrace(BenchmarkScene& scene, const BenchmarkOptions& options,
+    const HeadlessContext& context, ShaderCache& shaders)
+{
+    RaytraceResult result;
+    result.name = scene.getName();
+    if (!scene.setup(shaders))
+        return result;
+
+    float aspect = (float)options.width / (float)options.height;
+    SceneFrame frame = scriptedCamera(100, aspect, scene.getOrbitRadius(), scene.getOrbitHeight());
+    CpuScene cpuScene;
+    if (!scene.describe(frame, cpuScene))
+    {
+        scene.teardown();
+        return result;
+    }
+    vector<uint32_t> glPixels = readGlFrame(scene, frame, options, context);
+
+    JobSystem jobs;
+    RayTracer tracer(&jobs);
+    tracer.setScene(cpuScene);
+
+    // 1) Sem sombras o traçado de raios tem que dar a mesma imagem do GL
+    RayTracerSettings settings;
+    settings.shadows = false;
+    tracer.render(options.width, options.height, settings);
+    result.matches = compareImages(glPixels, tracer.getColorBuffer(), result.meanAbsDiff, result.mismatchPercent);
+    if (options.dumpImages)
+        tracer.writePpm(result.name + "_rt.ppm");
+
+    // 2) Vazão: Whitted com sombras e path tracing
+    settings.shadows = true;
+    tracer.render(options.width, options.height, settings);
+    result.direct = tracer.getStats();
+    if (options.dumpImages)
+        tracer.writePpm(result.name + "_rt_shadows.ppm");
+
+    settings.mode = RayTracerSettings::PATH;
+    settings.samplesPerPixel = options.raytraceSamples;
+    tracer.render(options.width, options.height, settings);
+    result.path = tracer.getStats();
+    if (options.dumpImages)
+    {
+        tracer.writePpm(result.name + "_path.ppm");
+        tracer.writePfm(result.name + "_path.pfm");
+    }
+
+    scene.teardown();
+    result.ok = true;
+
+    cout << "  " << result.name << " (raytrace): diferenca media " << result.meanAbsDiff << ", "
+        << result.mismatchPercent << "% pixels fora da tolerancia, direto " << result.direct.mraysPerSecond
+        << " Mrays/s, path " << result.path.mraysPerSecond << " Mrays/s (" << result.path.renderMs << " ms)" << endl;
+    return result;
+}
+
+// Lightmap da Suzanne do Modulo5 (sem cache) com 1, 2, 4, ... threads
+static BakeResult runBake(const BenchmarkOptions& options)
+{
+    BakeResult result;
+    MeshData mesh;
+    ImageData image;
+    if (!parseObj(options.assetsDir + "/Modelos3D/Suzanne.obj", mesh) ||
+        !decodeImage(options.assetsDir + "/tex/pixelWall.png", false, image))
+        return result;
+
+    // Textura só como albedo da luz rebatida
+    SceneMaterial material;
+    material.texture = &image;
+
+    CpuScene scene;
+    scene.lights.push_back({ glm::vec3(2.0f, 3.0f, 4.0f), glm::vec3(1.0f) });
+    scene.meshes.push_back({ &mesh, glm::scale(glm::mat4(1.0f), glm::vec3(0.7f)), material });
+
+    LightmapSettings settings;
+    settings.size = options.bakeSize;
+    Lightmap lightmap;
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    for (unsigned threads = 1; ; threads = min(threads * 2, cores))
+    {
+        unique_ptr<JobSystem> jobs;
+        if (threads > 1)
+            jobs = make_unique<JobSystem>(threads - 1);
+        LightmapBaker baker(jobs.get());
+        baker.setScene(scene);
+        if (!baker.bake(0, settings, lightmap))
+            return result;
+
+        result.stats = baker.getStats();
+        result.scaling.push_back({ threads, result.stats.bakeMs, result.stats.rays / (result.stats.bakeMs * 1000.0) });
+        if (threads == cores)
+            break;
+    }
+
+    if (options.dumpImages)
+        writeHdr("suzanne_lightmap.hdr", lightmap);
+
+    result.ok = true;
+    cout << "  lightmap " << settings.size << "x" << settings.size << ": " << result.stats.texels << " texels ("
+        << result.stats.overlapping << " com UV sobreposta)";
+    for (const BakeScaling& s : result.scaling)
+        cout << ", " << s.threads << "T " << s.bakeMs << " ms";
+    cout << endl;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
+        return 1;
+
+    cout << "Renderer: " << context.getRenderer() << endl;
+    cout << "OpenGL version supported: " << context.getVersion() << endl;
+
+    ShaderCache shaders("shader_cache", HeadlessContext::getLoadProc());
+
+    vector<SceneResult> results;
+    vector<SoftwareResult> software;
+    vector<RaytraceResult> raytrace;
+    for (auto& scene : createScenes(options.assetsDir))
+    {
+        if (!options.scene.empty() && options.scene != scene->getName())
+            continue;
+        results.push_back(runScene(*scene, options, context, shaders));
+
+        if (options.software)
+        {
+            SoftwareResult result = runSoftware(*scene, options, context, shaders);
+            if (result.ok)
+                software.push_back(result);
+        }
+
+        if (options.raytrace)
+        {
+            RaytraceResult result = runRaytrace(*scene, options, context, shaders);
+            if (result.ok)
+                raytrace.push_back(result);
+        }
+    }
+
+    if (results.empty())
+    {
+        cerr << "Benchmark: cena desconhecida " << options.scene << endl;
+        return 1;
+    }
+
+    BakeResult bake;
+    if (options.bake)
+        bake = runBake(options);
+
+    shaders.printReport();
+    PROFILE_EXPORT("benchmark_trace.json");
+
+    if (!writeReport(options.output, options, context, results, software, raytrace, bake))
+        return 1;
+    cout << "Benchmark: resultados gravados em " << options.output << endl;
+
+    bool allOk = all_of(results.begin(), results.end(), [](const SceneResult& r) { return r.ok; }) &&
+        all_of(software.begin(), software.end(), [](const SoftwareResult& r) { return r.matches; }) &&
+        all_of(raytrace.begin(), raytrace.end(), [](const RaytraceResult& r) { return r.matches; }) &&
+        (!options.bake || bake.ok);
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include "AssetLoader.h"
+
+#include <iostream>
+
+#include "Profiler.h"
+
+void AssetLoader::loadGeometryAsync(const std::string& objPath, const std::string& texturePath, bool flipTexture,
+    GeometryCallback onLoaded)
+{
+    auto pending = std::make_shared<PendingGeometry>();
+    pending->objPath = objPath;
+    pending->texturePath = texturePath;
+    pending->flipTexture = flipTexture;
+    pending->onLoaded = std::move(onLoaded);
+
+    m_inFlight++;
+    m_jobs.submit([this, pending]()
+        {
+            {
+                PROFILE_SCOPE("LoadObj");
+                pending->ok = parseObj(pending->objPath, pending->mesh);
+            }
+            if (pending->ok)
+            {
+                if (pending->texturePath.empty())
+                    pending->texturePath = pending->mesh.texturePath;
+                if (!pending->texturePath.empty())
+                {
+                    PROFILE_SCOPE("DecodeImage");
+                    pending->hasImage = decodeImage(pending->texturePath, pending->flipTexture, pending->image);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready.push_back(pending);
+        });
+}
+
+bool AssetLoader::update()
+{
+    PROFILE_SCOPE("UploadAssets");
+    std::vector<std::shared_ptr<PendingGeometry>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ready.swap(m_ready);
+    }
+
+    bool loaded = false;
+    for (const std::shared_ptr<PendingGeometry>& pending : ready)
+    {
+        m_inFlight--;
+        if (!pending->ok)
+        {
+            std::cerr << "AssetLoader: falha ao carregar " << pending->objPath << std::endl;
+            continue;
+        }
+
+        Geometry geometry = uploadGeometry(pending->mesh, pending->hasImage ? &pending->image : nullptr);
+        if (pending->hasImage)
+            geometry.textureFilePath = pending->texturePath;
+        if (pending->onLoaded)
+            pending->onLoaded(geometry);
+        loaded = true;
+    }
+    return loaded;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Geometry.h"
+#include "JobSystem.h"
+
+// Carregamento assíncrono de assets.
+//
+// A leitura do .obj e a decodificação do .png rodam no JobSystem; o envio
+// para a GPU e o callback acontecem em update(), chamado pela thread do
+// contexto GL entre um frame e outro. Se o arquivo não puder ser lido o
+// callback não é chamado, e quem pediu continua com a versão antiga.
+class AssetLoader
+{
+public:
+    typedef std::function<void(Geometry&)> GeometryCallback;
+
+    explicit AssetLoader(JobSystem& jobs) : m_jobs(jobs) {}
+    ~AssetLoader() { m_jobs.wait(); }
+
+    // texturePath vazio = usa a textura indicada no .mtl
+    void loadGeometryAsync(const std::string& objPath, const std::string& texturePath, bool flipTexture,
+        GeometryCallback onLoaded);
+
+    // Envia para a GPU o que ficou pronto e chama os callbacks; true se
+    // algum asset foi trocado
+    bool update();
+
+    int getInFlight() const { return m_inFlight.load(); }
+
+private:
+    struct PendingGeometry
+    {
+        std::string objPath;
+        std::string texturePath;
+        bool flipTexture = true;
+        MeshData mesh;
+        ImageData image;
+        bool ok = false;
+        bool hasImage = false;
+        GeometryCallback onLoaded;
+    };
+
+    JobSystem& m_jobs;
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<PendingGeometry>> m_ready;
+    std::atomic<int> m_inFlight{ 0 };
+};
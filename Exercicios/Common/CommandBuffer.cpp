@@ -0,0 +1,369 @@
+#include "CommandBuffer.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "Profiler.h"
+
+static const char* drawDataSource = R"glsl(
+layout(std430, binding = 7) readonly buffer CommandDrawData
+{
+    vec4 commandDrawData[];
+};
+
+uniform uint drawDataOffset;
+
+vec4 drawData(uint index)
+{
+    return commandDrawData[drawDataOffset + index];
+}
+)glsl";
+
+LinearAllocator::LinearAllocator(size_t blockSize)
+    : m_blockSize(blockSize)
+{
+}
+
+void* LinearAllocator::allocate(size_t size, size_t alignment, size_t* offset)
+{
+    if (size > m_blockSize)
+        return nullptr;
+    if (m_blocks.empty())
+    {
+        m_blocks.emplace_back();
+        m_blocks.back().data.reset(new uint8_t[m_blockSize]);
+    }
+
+    size_t start = (m_blocks[m_current].used + alignment - 1) & ~(alignment - 1);
+    if (start + size > m_blockSize)
+    {
+        // Próximo bloco (já existe se um frame anterior chegou até ele)
+        if (++m_current == m_blocks.size())
+        {
+            m_blocks.emplace_back();
+            m_blocks.back().data.reset(new uint8_t[m_blockSize]);
+        }
+        start = 0;
+    }
+    m_blocks[m_current].used = start + size;
+    if (offset)
+        *offset = m_current * m_blockSize + start;
+    return m_blocks[m_current].data.get() + start;
+}
+
+void LinearAllocator::reset()
+{
+    for (Block& block : m_blocks)
+        block.used = 0;
+    m_current = 0;
+}
+
+size_t LinearAllocator::getBlockCount() const
+{
+    return m_blocks.empty() ? 0 : m_current + 1;
+}
+
+size_t LinearAllocator::getBytesUsed() const
+{
+    size_t used = 0;
+    for (size_t i = 0; i < getBlockCount(); ++i)
+        used += m_blocks[i].used;
+    return used;
+}
+
+void CommandBuffer::reset()
+{
+    m_commands.reset();
+    m_drawData.reset();
+    m_commandCount = 0;
+    m_dropDraws = false;
+}
+
+template <typename T>
+void CommandBuffer::push(CommandType type, const T& command)
+{
+    static_assert(sizeof(CommandHeader) == 4 && sizeof(T) % 4 == 0, "comandos alinhados em 4 bytes");
+    uint8_t* destination = (uint8_t*)m_commands.allocate(sizeof(CommandHeader) + sizeof(T), 4);
+    CommandHeader header = { type, (uint16_t)(sizeof(CommandHeader) + sizeof(T)) };
+    std::memcpy(destination, &header, sizeof(header));
+    std::memcpy(destination + sizeof(header), &command, sizeof(T));
+    m_commandCount++;
+}
+
+void CommandBuffer::bindPipeline(uint32_t pipeline)
+{
+    push(CommandType::BindPipeline, BindPipelineCommand{ pipeline });
+}
+
+void CommandBuffer::bindGeometry(uint32_t geometry)
+{
+    push(CommandType::BindGeometry, BindGeometryCommand{ geometry });
+}
+
+void CommandBuffer::bindTexture(uint32_t slot, uint32_t texture)
+{
+    push(CommandType::BindTexture, BindTextureCommand{ slot, texture });
+}
+
+void CommandBuffer::setDrawData(const void* data, size_t size)
+{
+    size_t offset;
+    void* destination = m_drawData.allocate(size, 16, &offset);
+
+    // Dados maiores que um bloco não cabem no SSBO: os draws seguintes leriam
+    // os dados do draw anterior, então são descartados até o próximo setDrawData
+    m_dropDraws = destination == nullptr;
+    if (m_dropDraws)
+    {
+        std::cerr << "CommandBuffer: " << size << " bytes de dados de draw (maximo " << m_drawData.getBlockSize()
+            << "), draws descartados" << std::endl;
+        return;
+    }
+    std::memcpy(destination, data, size);
+    push(CommandType::SetDrawData, SetDrawDataCommand{ (uint32_t)(offset / 16) });
+}
+
+void CommandBuffer::draw(uint32_t count, uint32_t first, uint32_t instances)
+{
+    if (m_dropDraws)
+        return;
+    push(CommandType::Draw, DrawCommand{ count, first, instances });
+}
+
+void CommandBuffer::drawIndexed(uint32_t count, uint32_t firstIndex, int32_t baseVertex, uint32_t instances)
+{
+    if (m_dropDraws)
+        return;
+    push(CommandType::DrawIndexed, DrawIndexedCommand{ count, firstIndex, baseVertex, instances });
+}
+
+CommandReplayer::CommandReplayer()
+{
+    m_supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+    if (m_supported)
+        glGenBuffers(1, &m_drawDataBuffer);
+}
+
+uint32_t CommandReplayer::addPipeline(const PipelineDesc& pipeline)
+{
+    m_pipelines.push_back({ pipeline, glGetUniformLocation(pipeline.program, "drawDataOffset") });
+    return (uint32_t)m_pipelines.size() - 1;
+}
+
+uint32_t CommandReplayer::addGeometry(GLuint VAO)
+{
+    m_geometries.push_back(VAO);
+    return (uint32_t)m_geometries.size() - 1;
+}
+
+uint32_t CommandReplayer::addTexture(GLuint texture, GLenum target)
+{
+    m_textures.push_back({ texture, target });
+    return (uint32_t)m_textures.size() - 1;
+}
+
+size_t CommandReplayer::upload(const CommandBuffer* buffers, size_t count, std::vector<uint32_t>& bases)
+{
+    // Cada buffer ocupa os seus blocos inteiros, então os offsets gravados valem sem ajuste
+    size_t total = 0;
+    bases.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LinearAllocator& data = buffers[i].getDrawData();
+        bases[i] = (uint32_t)(total / 16);
+        total += data.getBlockCount() * data.getBlockSize();
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer);
+    if (total > m_drawDataCapacity)
+        m_drawDataCapacity = total + total / 2;
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_drawDataCapacity, nullptr, GL_STREAM_DRAW);
+
+    size_t uploaded = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LinearAllocator& data = buffers[i].getDrawData();
+        for (size_t block = 0; block < data.getBlockCount(); ++block)
+        {
+            size_t used = data.getBlockUsed(block);
+            if (used == 0)
+                continue;
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr)bases[i] * 16 + block * data.getBlockSize(),
+                (GLsizeiptr)used, data.getBlock(block));
+            uploaded += used;
+        }
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawDataBuffer);
+    return uploaded;
+}
+
+void CommandReplayer::replay(const CommandBuffer* buffers, size_t count)
+{
+    if (!m_supported)
+        return;
+    PROFILE_SCOPE("CommandReplay");
+    auto start = std::chrono::steady_clock::now();
+    m_stats.replays++;
+    m_stats.drawDataBytes += upload(buffers, count, m_bases);
+    auto uploaded = std::chrono::steady_clock::now();
+
+    // Estado sombreado; ~0u = desconhecido, o primeiro bind sempre chega ao GL
+    const uint32_t UNKNOWN = ~0u;
+    uint32_t pipeline = UNKNOWN;
+    uint32_t geometry = UNKNOWN;
+    uint32_t textures[MAX_TEXTURE_SLOTS];
+    for (uint32_t& texture : textures)
+        texture = UNKNOWN;
+    uint32_t activeSlot = UNKNOWN;
+    int depthTest = -1, cullFace = -1;
+    GLint drawDataLoc = -1;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LinearAllocator& commands = buffers[i].getCommands();
+        uint32_t base = m_bases[i];
+        for (size_t block = 0; block < commands.getBlockCount(); ++block)
+        {
+            const uint8_t* cursor = commands.getBlock(block);
+            const uint8_t* end = cursor + commands.getBlockUsed(block);
+            while (cursor < end)
+            {
+                CommandHeader header;
+                std::memcpy(&header, cursor, sizeof(header));
+                const uint8_t* payload = cursor + sizeof(header);
+                cursor += header.size;
+                m_stats.commands++;
+
+                switch (header.type)
+                {
+                case CommandType::BindPipeline:
+                {
+                    BindPipelineCommand command;
+                    std::memcpy(&command, payload, sizeof(command));
+                    if (command.pipeline == pipeline)
+                    {
+                        m_stats.skippedBinds++;
+                        break;
+                    }
+                    pipeline = command.pipeline;
+                    const Pipeline& p = m_pipelines[pipeline];
+                    glUseProgram(p.desc.program);
+                    drawDataLoc = p.drawDataLoc;
+                    if ((int)p.desc.depthTest != depthTest)
+                    {
+                        depthTest = p.desc.depthTest;
+                        p.desc.depthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+                    }
+                    if ((int)p.desc.cullFace != cullFace)
+                    {
+                        cullFace = p.desc.cullFace;
+                        p.desc.cullFace ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+                    }
+                    m_stats.stateCalls++;
+                    break;
+                }
+                case CommandType::BindGeometry:
+                {
+                    BindGeometryCommand command;
+                    std::memcpy(&command, payload, sizeof(command));
+                    if (command.geometry == geometry)
+                    {
+                        m_stats.skippedBinds++;
+                        break;
+                    }
+                    geometry = command.geometry;
+                    glBindVertexArray(m_geometries[geometry]);
+                    m_stats.stateCalls++;
+                    break;
+                }
+                case CommandType::BindTexture:
+                {
+                    BindTextureCommand command;
+                    std::memcpy(&command, payload, sizeof(command));
+                    if (command.slot >= MAX_TEXTURE_SLOTS || textures[command.slot] == command.texture)
+                    {
+                        m_stats.skippedBinds++;
+                        break;
+                    }
+                    textures[command.slot] = command.texture;
+                    if (activeSlot != command.slot)
+                    {
+                        activeSlot = command.slot;
+                        glActiveTexture(GL_TEXTURE0 + command.slot);
+                    }
+                    glBindTexture(m_textures[command.texture].target, m_textures[command.texture].name);
+                    m_stats.stateCalls++;
+                    break;
+                }
+                case CommandType::SetDrawData:
+                {
+                    SetDrawDataCommand command;
+                    std::memcpy(&command, payload, sizeof(command));
+                    glUniform1ui(drawDataLoc, base + command.offset);
+                    break;
+                }
+                case CommandType::Draw:
+                {
+                    DrawCommand command;
+                    std::memcpy(&command, payload, sizeof(command));
+                    glDrawArraysInstanced(GL_TRIANGLES, (GLint)command.first, (GLsizei)command.count,
+                        (GLsizei)command.instances);
+                    m_stats.draws++;
+                    break;
+                }
+                case CommandType::DrawIndexed:
+                {
+                    DrawIndexedCommand command;
+                    std::memcpy(&command, payload, sizeof(command));
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)command.count, GL_UNSIGNED_INT,
+                        (void*)((size_t)command.firstIndex * sizeof(GLuint)), (GLsizei)command.instances,
+                        command.baseVertex);
+                    m_stats.draws++;
+                    break;
+                }
+                }
+            }
+        }
+    }
+
+    glBindVertexArray(0);
+    for (uint32_t slot = 0; slot < MAX_TEXTURE_SLOTS; ++slot)
+        if (textures[slot] != UNKNOWN)
+        {
+            glActiveTexture(GL_TEXTURE0 + slot);
+            glBindTexture(m_textures[textures[slot]].target, 0);
+        }
+    glActiveTexture(GL_TEXTURE0);
+
+    auto end = std::chrono::steady_clock::now();
+    m_stats.uploadMs += std::chrono::duration<double, std::milli>(uploaded - start).count();
+    m_stats.replayMs += std::chrono::duration<double, std::milli>(end - uploaded).count();
+}
+
+void CommandReplayer::printStats() const
+{
+    if (m_stats.replays == 0)
+        return;
+
+    double replays = (double)m_stats.replays;
+    std::cout << "CommandReplayer: media de " << m_stats.commands / replays << " comandos, "
+        << m_stats.draws / replays << " draws e " << m_stats.stateCalls / replays << " binds no GL ("
+        << m_stats.skippedBinds / replays << " repetidos ignorados) por replay, "
+        << m_stats.drawDataBytes / replays / 1024.0 << " KB de dados de draw; upload "
+        << m_stats.uploadMs / replays << " ms, replay " << m_stats.replayMs / replays << " ms" << std::endl;
+}
+
+void CommandReplayer::destroy()
+{
+    if (m_drawDataBuffer)
+        glDeleteBuffers(1, &m_drawDataBuffer);
+    m_drawDataBuffer = 0;
+    m_drawDataCapacity = 0;
+}
+
+const char* CommandReplayer::getShaderSource()
+{
+    return drawDataSource;
+}
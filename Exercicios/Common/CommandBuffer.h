@@ -0,0 +1,207 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+
+// Command buffers: threads de trabalho gravam os draws do frame em paralelo,
+// cada uma no seu CommandBuffer (sem GL nem lock), e a thread do contexto
+// reproduz os buffers em ordem com o CommandReplayer.
+//
+//   CommandReplayer replayer;               // GL 4.3 (dados por draw num SSBO)
+//   uint32_t phong = replayer.addPipeline({ program });
+//   uint32_t cube = replayer.addGeometry(cubeVAO);
+//   uint32_t wall = replayer.addTexture(wallTexture);
+//   std::vector<CommandBuffer> buffers(threads);
+//   jobs.parallelFor(threads, 1, [&](size_t begin, size_t end) {
+//       CommandBuffer& commands = buffers[begin];
+//       commands.reset();
+//       for (...objetos da thread...)
+//       {
+//           commands.bindPipeline(phong);
+//           commands.bindGeometry(cube);
+//           commands.bindTexture(0, wall);
+//           commands.setDrawData(&model, sizeof(model));
+//           commands.drawIndexed(indexCount, 0, 0);
+//       }
+//   });
+//   replayer.replay(buffers.data(), buffers.size());
+//
+// O formato não depende da API: pipeline, geometria e textura são índices
+// das tabelas do replayer, e os comandos (cabeçalho de 4 bytes + campos)
+// ficam em blocos de um LinearAllocator que o reset() reaproveita de um frame
+// para o outro. setDrawData copia os dados do draw (múltiplos de 16 bytes)
+// para um segundo alocador e grava só o offset. No replay os dados de todos os
+// buffers sobem num SSBO (DRAW_DATA_BINDING) e cada setDrawData vira o uniform
+// "drawDataOffset", lido pelo drawData() de getShaderSource(). O replayer
+// sombreia o estado: pipeline, VAO e textura iguais aos atuais não viram
+// chamada GL, então gravar sem se preocupar com repetições sai de graça.
+// Uniforms do frame (view, projection) vão direto nos programas antes do
+// replay.
+
+// Blocos de tamanho fixo, alocação por incremento; reset() mantém os blocos
+class LinearAllocator
+{
+public:
+    explicit LinearAllocator(size_t blockSize = 64 * 1024);
+
+    // nullptr se size for maior que o bloco; offset = bloco * blockSize + posição
+    void* allocate(size_t size, size_t alignment, size_t* offset = nullptr);
+    void reset();
+
+    size_t getBlockSize() const { return m_blockSize; }
+    size_t getBlockCount() const;
+    const uint8_t* getBlock(size_t index) const { return m_blocks[index].data.get(); }
+    size_t getBlockUsed(size_t index) const { return m_blocks[index].used; }
+
+    size_t getBytesUsed() const;
+    size_t getBytesReserved() const { return m_blocks.size() * m_blockSize; }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t used = 0;
+    };
+
+    size_t m_blockSize;
+    std::vector<Block> m_blocks;
+    size_t m_current = 0;
+};
+
+enum class CommandType : uint16_t
+{
+    BindPipeline,
+    BindGeometry,
+    BindTexture,
+    SetDrawData,
+    Draw,
+    DrawIndexed,
+};
+
+struct CommandHeader
+{
+    CommandType type;
+    uint16_t size;                  // bytes, com o cabeçalho
+};
+
+struct BindPipelineCommand { uint32_t pipeline; };
+struct BindGeometryCommand { uint32_t geometry; };
+struct BindTextureCommand { uint32_t slot; uint32_t texture; };
+struct SetDrawDataCommand { uint32_t offset; };     // em vec4, dentro dos dados do buffer
+struct DrawCommand { uint32_t count; uint32_t first; uint32_t instances; };
+struct DrawIndexedCommand { uint32_t count; uint32_t firstIndex; int32_t baseVertex; uint32_t instances; };
+
+class CommandBuffer
+{
+public:
+    CommandBuffer() = default;
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+    CommandBuffer(CommandBuffer&&) = default;
+    CommandBuffer& operator=(CommandBuffer&&) = default;
+
+    // Esvazia para o próximo frame, mantendo a memória
+    void reset();
+
+    void bindPipeline(uint32_t pipeline);
+    void bindGeometry(uint32_t geometry);
+    void bindTexture(uint32_t slot, uint32_t texture);
+
+    // size múltiplo de 16 (layout de vec4/mat4 no std430) e até o tamanho do
+    // bloco; acima disso avisa e descarta os draws até o próximo setDrawData
+    void setDrawData(const void* data, size_t size);
+
+    void draw(uint32_t count, uint32_t first, uint32_t instances = 1);
+    void drawIndexed(uint32_t count, uint32_t firstIndex, int32_t baseVertex, uint32_t instances = 1);
+
+    uint32_t getCommandCount() const { return m_commandCount; }
+    const LinearAllocator& getCommands() const { return m_commands; }
+    const LinearAllocator& getDrawData() const { return m_drawData; }
+
+private:
+    template <typename T>
+    void push(CommandType type, const T& command);
+
+    LinearAllocator m_commands;
+    LinearAllocator m_drawData;
+    uint32_t m_commandCount = 0;
+    bool m_dropDraws = false;
+};
+
+struct PipelineDesc
+{
+    GLuint program = 0;
+    bool depthTest = true;
+    bool cullFace = false;
+};
+
+// Acumulado desde a criação
+struct CommandReplayStats
+{
+    uint64_t replays = 0;
+    uint64_t commands = 0;
+    uint64_t draws = 0;
+    uint64_t stateCalls = 0;        // binds que chegaram ao GL
+    uint64_t skippedBinds = 0;      // binds iguais ao estado atual
+    uint64_t drawDataBytes = 0;
+    double uploadMs = 0.0;
+    double replayMs = 0.0;
+};
+
+class CommandReplayer
+{
+public:
+    CommandReplayer();
+
+    CommandReplayer(const CommandReplayer&) = delete;
+    CommandReplayer& operator=(const CommandReplayer&) = delete;
+
+    bool isSupported() const { return m_supported; }
+
+    uint32_t addPipeline(const PipelineDesc& pipeline);
+    uint32_t addGeometry(GLuint VAO);
+    uint32_t addTexture(GLuint texture, GLenum target = GL_TEXTURE_2D);
+
+    // Sobe os dados por draw e reproduz os buffers na ordem; o estado
+    // sombreado vale só dentro de um replay
+    void replay(const CommandBuffer* buffers, size_t count);
+
+    const CommandReplayStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+    // Apaga o SSBO; chamar antes de destruir o contexto GL
+    void destroy();
+
+    // drawData(i): i-ésimo vec4 dos dados do draw atual (depois do #version 430)
+    static const char* getShaderSource();
+
+    static const GLuint DRAW_DATA_BINDING = 7;      // acima dos bindings do VertexPullingPool
+    static const uint32_t MAX_TEXTURE_SLOTS = 8;
+
+private:
+    struct Pipeline
+    {
+        PipelineDesc desc;
+        GLint drawDataLoc;
+    };
+
+    struct Texture
+    {
+        GLuint name;
+        GLenum target;
+    };
+
+    size_t upload(const CommandBuffer* buffers, size_t count, std::vector<uint32_t>& bases);
+
+    bool m_supported = false;
+    std::vector<Pipeline> m_pipelines;
+    std::vector<GLuint> m_geometries;
+    std::vector<Texture> m_textures;
+    GLuint m_drawDataBuffer = 0;
+    size_t m_drawDataCapacity = 0;
+    std::vector<uint32_t> m_bases;
+    CommandReplayStats m_stats;
+};
@@ -0,0 +1,220 @@
+#include "CpuScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#include "DiskCache.h"
+
+TextureMips::TextureMips(const ImageData& image)
+    : m_image(&image)
+{
+    Level base;
+    base.width = std::max(image.width, 1);
+    base.height = std::max(image.height, 1);
+    base.texels.resize((size_t)base.width * base.height, glm::vec3(1.0f));
+    for (size_t t = 0; t < base.texels.size() && image.channels > 0; ++t)
+    {
+        const unsigned char* p = &image.pixels[t * image.channels];
+        base.texels[t] = image.channels >= 3 ? glm::vec3(p[0], p[1], p[2]) / 255.0f : glm::vec3(p[0] / 255.0f);
+    }
+    m_levels.push_back(std::move(base));
+
+    while (m_levels.back().width > 1 || m_levels.back().height > 1)
+    {
+        const Level& src = m_levels.back();
+        Level level;
+        level.width = std::max(src.width / 2, 1);
+        level.height = std::max(src.height / 2, 1);
+        level.texels.resize((size_t)level.width * level.height);
+        for (int y = 0; y < level.height; ++y)
+        {
+            int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < level.width; ++x)
+            {
+                int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+                level.texels[(size_t)y * level.width + x] = 0.25f *
+                    (src.texels[(size_t)y0 * src.width + x0] + src.texels[(size_t)y0 * src.width + x1] +
+                     src.texels[(size_t)y1 * src.width + x0] + src.texels[(size_t)y1 * src.width + x1]);
+            }
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+glm::vec3 TextureMips::bilinear(const Level& level, glm::vec2 uv) const
+{
+    float fx = uv.x * level.width - 0.5f;
+    float fy = uv.y * level.height - 0.5f;
+    float x0f = std::floor(fx), y0f = std::floor(fy);
+    float tx = fx - x0f, ty = fy - y0f;
+
+    auto texel = [&](int x, int y)
+        {
+            x = ((x % level.width) + level.width) % level.width;
+            y = ((y % level.height) + level.height) % level.height;
+            return level.texels[(size_t)y * level.width + x];
+        };
+
+    int x0 = (int)x0f, y0 = (int)y0f;
+    glm::vec3 top = glm::mix(texel(x0, y0), texel(x0 + 1, y0), tx);
+    glm::vec3 bottom = glm::mix(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), tx);
+    return glm::mix(top, bottom, ty);
+}
+
+glm::vec3 TextureMips::sample(glm::vec2 uv, float lod) const
+{
+    int maxLevel = (int)m_levels.size() - 1;
+    lod = glm::clamp(lod, 0.0f, (float)maxLevel);
+    int level0 = (int)lod;
+    int level1 = std::min(level0 + 1, maxLevel);
+    glm::vec3 color = bilinear(m_levels[level0], uv);
+    if (level1 == level0 || lod == (float)level0)
+        return color;
+    return glm::mix(color, bilinear(m_levels[level1], uv), lod - level0);
+}
+
+glm::vec3 shadePhong(const SceneMaterial& material, const std::vector<SceneLight>& lights, const glm::vec3& baseColor,
+    const glm::vec3& position, const glm::vec3& normal, const glm::vec3& eye, const float* visibility, bool ambient)
+{
+    glm::vec3 V = glm::normalize(eye - position);
+
+    glm::vec3 ambientTerm(0.0f);
+    if (ambient)
+        ambientTerm = material.ka * (lights.empty() ? glm::vec3(1.0f) : lights[0].color);
+
+    glm::vec3 diffuse(0.0f), specular(0.0f);
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        const SceneLight& light = lights[i];
+        float visible = visibility ? visibility[i] : 1.0f;
+        if (visible <= 0.0f)
+            continue;
+
+        glm::vec3 toLight = light.position - position;
+        glm::vec3 L = glm::normalize(toLight);
+        float attenuation = light.attenuate ? 1.0f / glm::dot(toLight, toLight) : 1.0f;
+        diffuse += material.kd * std::max(glm::dot(normal, L), 0.0f) * light.color * attenuation * visible;
+
+        glm::vec3 R = glm::reflect(-L, normal);
+        specular += material.ks * std::pow(std::max(glm::dot(R, V), 0.0f), material.q) * light.color * visible;
+    }
+
+    return (ambientTerm + diffuse) * baseColor + specular;
+}
+
+uint32_t packColor(const glm::vec3& color)
+{
+    glm::vec3 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return (uint32_t)c.r | ((uint32_t)c.g << 8) | ((uint32_t)c.b << 16) | 0xFF000000u;
+}
+
+bool writePpm(const std::string& path, const std::vector<uint32_t>& pixels, int width, int height)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "CpuScene: nao foi possivel gravar " << path << std::endl;
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> row((size_t)width * 3);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            uint32_t c = pixels[(size_t)y * width + x];
+            row[x * 3 + 0] = c & 0xFF;
+            row[x * 3 + 1] = (c >> 8) & 0xFF;
+            row[x * 3 + 2] = (c >> 16) & 0xFF;
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    return true;
+}
+
+bool writePfm(const std::string& path, const std::vector<glm::vec3>& pixels, int width, int height)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "CpuScene: nao foi possivel gravar " << path << std::endl;
+        return false;
+    }
+
+    // Escala negativa = little-endian; o PFM guarda as linhas de baixo para cima
+    fprintf(file, "PF\n%d %d\n-1.0\n", width, height);
+    for (int y = height - 1; y >= 0; --y)
+        fwrite(&pixels[(size_t)y * width], sizeof(glm::vec3), width, file);
+    fclose(file);
+    return true;
+}
+
+bool writeHdr(const std::string& path, const std::vector<glm::vec3>& pixels, int width, int height)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "CpuScene: nao foi possivel gravar " << path << std::endl;
+        return false;
+    }
+
+    // Mantissa de 8 bits por canal com o expoente do maior canal em comum
+    fprintf(file, "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %d +X %d\n", height, width);
+    std::vector<unsigned char> row((size_t)width * 4);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            glm::vec3 c = glm::max(pixels[(size_t)y * width + x], glm::vec3(0.0f));
+            float largest = std::max(c.r, std::max(c.g, c.b));
+            unsigned char* rgbe = &row[(size_t)x * 4];
+            if (largest < 1e-32f)
+            {
+                rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+                continue;
+            }
+            int exponent;
+            float scale = std::frexp(largest, &exponent) * 256.0f / largest;
+            rgbe[0] = (unsigned char)(c.r * scale);
+            rgbe[1] = (unsigned char)(c.g * scale);
+            rgbe[2] = (unsigned char)(c.b * scale);
+            rgbe[3] = (unsigned char)(exponent + 128);
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    return true;
+}
+
+uint64_t hashLighting(const CpuScene& scene, size_t meshIndex, uint64_t seed)
+{
+    const SceneMesh& sceneMesh = scene.meshes[meshIndex];
+    const MeshData& mesh = *sceneMesh.mesh;
+    uint64_t key = seed;
+    key = DiskCache::hash(mesh.positions.data(), mesh.positions.size() * sizeof(glm::vec3), key);
+    key = DiskCache::hash(mesh.uvs.data(), mesh.uvs.size() * sizeof(glm::vec2), key);
+    key = DiskCache::hash(mesh.normals.data(), mesh.normals.size() * sizeof(glm::vec3), key);
+    key = DiskCache::hash(&sceneMesh.model, sizeof(sceneMesh.model), key);
+    key = DiskCache::hash(&sceneMesh.material.ka, sizeof(glm::vec3), key);
+    key = DiskCache::hash(&sceneMesh.material.kd, sizeof(glm::vec3), key);
+    key = DiskCache::hash(&scene.background, sizeof(glm::vec3), key);
+    for (const SceneLight& light : scene.lights)
+    {
+        key = DiskCache::hash(&light.position, sizeof(glm::vec3), key);
+        key = DiskCache::hash(&light.color, sizeof(glm::vec3), key);
+        key = DiskCache::hash(&light.attenuate, sizeof(bool), key);
+    }
+    for (size_t i = 0; i < scene.meshes.size(); ++i)
+    {
+        if (i == meshIndex)
+            continue;
+        const SceneMesh& other = scene.meshes[i];
+        key = DiskCache::hash(other.mesh->positions.data(), other.mesh->positions.size() * sizeof(glm::vec3), key);
+        key = DiskCache::hash(&other.model, sizeof(other.model), key);
+    }
+    return key;
+}
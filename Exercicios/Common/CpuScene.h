@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Geometry.h"
+
+// Cena e sombreamento compartilhados pelos renderizadores em CPU
+// (SoftwareRasterizer e RayTracer). O Phong e a amostragem de textura seguem
+// os shaders dos módulos, então as imagens batem com as do GL.
+//
+//   CpuScene scene;
+//   scene.view = view; scene.projection = projection; scene.cameraPos = camPos;
+//   scene.lights.push_back({ lightPos, lightColor });
+//   scene.meshes.push_back({ &mesh, model, material });
+//   rasterizer.drawScene(scene);    // ou tracer.setScene(scene)
+
+struct SceneLight
+{
+    glm::vec3 position;
+    glm::vec3 color = glm::vec3(1.0f);
+    bool attenuate = false;     // 1/d² no difuso, como no modulo_4_vivencial
+};
+
+struct SceneMaterial
+{
+    glm::vec3 ka = glm::vec3(0.1f);
+    glm::vec3 kd = glm::vec3(0.7f);
+    glm::vec3 ks = glm::vec3(1.0f);
+    float q = 32.0f;
+    bool lit = true;                        // false: só a textura/cor base (Modulo3)
+    glm::vec3 baseColor = glm::vec3(1.0f, 0.0f, 0.0f); // cor do vértice quando não há textura
+    const ImageData* texture = nullptr;     // não pode mudar enquanto o renderizador existir (mipmaps ficam em cache)
+    bool flipV = true;                      // texCoord = (u, 1 - v) como nos shaders dos módulos
+};
+
+struct SceneMesh
+{
+    const MeshData* mesh;       // idem: os renderizadores guardam estruturas por ponteiro
+    glm::mat4 model;
+    SceneMaterial material;
+};
+
+struct CpuScene
+{
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    glm::vec3 background = glm::vec3(0.1f, 0.1f, 0.12f); // glClearColor dos módulos
+    std::vector<SceneLight> lights;
+    std::vector<SceneMesh> meshes;
+};
+
+// Níveis RGB float gerados como o glGenerateMipmap (média 2x2) e amostrados
+// como GL_LINEAR_MIPMAP_LINEAR com GL_REPEAT (a textura de uploadTexture)
+class TextureMips
+{
+public:
+    explicit TextureMips(const ImageData& image);
+
+    // A linha 0 da imagem é t = 0 como no glTexImage2D; lod em níveis
+    glm::vec3 sample(glm::vec2 uv, float lod) const;
+
+    const ImageData* getImage() const { return m_image; }
+    int getWidth() const { return m_levels[0].width; }
+    int getHeight() const { return m_levels[0].height; }
+
+private:
+    struct Level
+    {
+        int width;
+        int height;
+        std::vector<glm::vec3> texels;
+    };
+
+    glm::vec3 bilinear(const Level& level, glm::vec2 uv) const;
+
+    const ImageData* m_image;
+    std::vector<Level> m_levels;
+};
+
+// Phong de phong.fs: ambiente ka * cor da primeira luz, difuso e especular
+// por luz. "visibility" (opcional) multiplica difuso e especular de cada luz
+// (sombras do RayTracer); sem ambiente quando a luz indireta vem de fora.
+glm::vec3 shadePhong(const SceneMaterial& material, const std::vector<SceneLight>& lights, const glm::vec3& baseColor,
+    const glm::vec3& position, const glm::vec3& normal, const glm::vec3& eye, const float* visibility = nullptr,
+    bool ambient = true);
+
+// RGBA8 como o glReadPixels (0xAABBGGRR), com clamp em [0, 1]
+uint32_t packColor(const glm::vec3& color);
+
+// Imagens em disco; linha 0 = topo. PPM binário de 8 bits e PFM em float
+// linear (para comparar renderizações sem perder a faixa dinâmica).
+bool writePpm(const std::string& path, const std::vector<uint32_t>& pixels, int width, int height);
+bool writePfm(const std::string& path, const std::vector<glm::vec3>& pixels, int width, int height);
+
+// Radiance .hdr (RGBE sem RLE), também com a linha 0 no topo
+bool writeHdr(const std::string& path, const std::vector<glm::vec3>& pixels, int width, int height);
+
+// Hash de tudo que muda a iluminação assada de scene.meshes[meshIndex]: a
+// malha, a pose, ka/kd, as luzes, o fundo e as outras malhas (sombras e luz
+// indireta). Chave de cache dos bakers, encadeada com os ajustes de cada um.
+uint64_t hashLighting(const CpuScene& scene, size_t meshIndex, uint64_t seed);
@@ -0,0 +1,72 @@
+#include "DiskCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+DiskCache::DiskCache(const std::string& directory) : m_directory(directory)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+}
+
+std::string DiskCache::pathFor(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return m_directory + "/" + name;
+}
+
+bool DiskCache::read(uint64_t key, std::vector<char>& data) const
+{
+    std::ifstream file(pathFor(key), std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::streamsize size = file.tellg();
+    if (size <= 0)
+        return false;
+
+    data.resize((size_t)size);
+    file.seekg(0);
+    return (bool)file.read(data.data(), size);
+}
+
+bool DiskCache::write(uint64_t key, const void* data, size_t size) const
+{
+    // Escreve num temporário e renomeia, para que uma execução interrompida
+    // nunca deixe uma entrada pela metade no cache
+    std::string path = pathFor(key);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write((const char*)data, (std::streamsize)size);
+        if (!file)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+void DiskCache::remove(uint64_t key) const
+{
+    std::error_code ec;
+    std::filesystem::remove(pathFor(key), ec);
+}
+
+uint64_t DiskCache::hash(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
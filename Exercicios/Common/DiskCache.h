@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Cache simples em disco: cada entrada é um arquivo binário <dir>/<chave>.bin
+// identificado por um hash de 64 bits do conteúdo que a gerou.
+class DiskCache
+{
+public:
+    explicit DiskCache(const std::string& directory);
+
+    bool read(uint64_t key, std::vector<char>& data) const;
+    bool write(uint64_t key, const void* data, size_t size) const;
+    void remove(uint64_t key) const;
+
+    std::string pathFor(uint64_t key) const;
+    const std::string& getDirectory() const { return m_directory; }
+
+    // FNV-1a 64 bits; "seed" permite encadear várias partes numa chave só
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+    static uint64_t hash(const std::string& text, uint64_t seed = 14695981039346656037ull)
+    {
+        return hash(text.data(), text.size(), seed);
+    }
+
+private:
+    std::string m_directory;
+};
@@ -0,0 +1,154 @@
+#include "FileWatcher.h"
+
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace fs = std::filesystem;
+
+static std::string normalizePath(const fs::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(const std::string& directory) : m_directory(normalizePath(directory))
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+    {
+        std::cerr << "FileWatcher: inotify_init1 falhou" << std::endl;
+        return;
+    }
+
+    addWatchRecursive(m_directory);
+    m_valid = !m_watchPaths.empty();
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+void FileWatcher::addWatchRecursive(const std::string& path)
+{
+    // inotify não é recursivo: cada subdiretório precisa do seu próprio watch.
+    // IN_CLOSE_WRITE pega a gravação normal; IN_MOVED_TO pega os editores que
+    // salvam num temporário e renomeiam por cima do arquivo original.
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    int wd = inotify_add_watch(m_fd, path.c_str(), mask);
+    if (wd < 0)
+    {
+        std::cerr << "FileWatcher: nao foi possivel observar " << path << std::endl;
+        return;
+    }
+    m_watchPaths[wd] = path;
+
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(path, ec))
+    {
+        if (entry.is_directory(ec))
+            addWatchRecursive(normalizePath(entry.path()));
+    }
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    std::set<std::string> changed;
+    if (m_fd < 0)
+        return {};
+
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (char* ptr = buffer; ptr < buffer + length; )
+        {
+            const inotify_event* event = (const inotify_event*)ptr;
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto it = m_watchPaths.find(event->wd);
+            if (it == m_watchPaths.end() || event->len == 0)
+                continue;
+
+            std::string path = normalizePath(fs::path(it->second) / event->name);
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    addWatchRecursive(path);
+                continue;
+            }
+
+            // IN_CREATE sozinho ainda é um arquivo vazio; espera o IN_CLOSE_WRITE
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                changed.insert(path);
+        }
+    }
+
+    return std::vector<std::string>(changed.begin(), changed.end());
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string& directory) : m_directory(normalizePath(directory))
+{
+    std::error_code ec;
+    m_valid = fs::is_directory(m_directory, ec);
+    if (m_valid)
+        scan(nullptr);
+    m_lastScan = std::chrono::steady_clock::now();
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::scan(std::vector<std::string>* changed)
+{
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(m_directory, ec), end; it != end; it.increment(ec))
+    {
+        if (ec || !it->is_regular_file(ec))
+            continue;
+
+        std::string path = normalizePath(it->path());
+        fs::file_time_type time = it->last_write_time(ec);
+        auto found = m_times.find(path);
+        if (found == m_times.end() || found->second != time)
+        {
+            if (changed)
+                changed->push_back(path);
+            m_times[path] = time;
+        }
+    }
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    std::vector<std::string> changed;
+    if (!m_valid)
+        return changed;
+
+    // Varre no máximo 4 vezes por segundo para não pesar no frame
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastScan < std::chrono::milliseconds(250))
+        return changed;
+    m_lastScan = now;
+
+    scan(&changed);
+    return changed;
+}
+
+#endif
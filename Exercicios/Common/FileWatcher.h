@@ -0,0 +1,44 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef __linux__
+#include <chrono>
+#include <filesystem>
+#endif
+
+// Observa um diretório (e subdiretórios) e informa quais arquivos mudaram.
+// No Linux usa inotify; nas outras plataformas compara a data de modificação
+// dos arquivos de tempos em tempos.
+class FileWatcher
+{
+public:
+    explicit FileWatcher(const std::string& directory);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Caminhos (diretório + relativo, normalizados) alterados desde a última chamada
+    std::vector<std::string> poll();
+
+    bool isValid() const { return m_valid; }
+    const std::string& getDirectory() const { return m_directory; }
+
+private:
+    std::string m_directory;
+    bool m_valid = false;
+
+#ifdef __linux__
+    void addWatchRecursive(const std::string& path);
+
+    int m_fd = -1;
+    std::map<int, std::string> m_watchPaths;
+#else
+    void scan(std::vector<std::string>* changed);
+
+    std::map<std::string, std::filesystem::file_time_type> m_times;
+    std::chrono::steady_clock::time_point m_lastScan;
+#endif
+};
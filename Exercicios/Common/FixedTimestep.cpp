@@ -0,0 +1,63 @@
+#include "FixedTimestep.h"
+
+#include <algorithm>
+#include <iostream>
+
+FixedTimestep::FixedTimestep(double step, double maxElapsed)
+    : m_step(step), m_maxElapsed(maxElapsed)
+{
+}
+
+int FixedTimestep::advance(double now)
+{
+    if (m_lastTime < 0.0)
+    {
+        m_lastTime = now;
+        return 0;
+    }
+
+    double elapsed = now - m_lastTime;
+    m_lastTime = now;
+    m_advances++;
+    if (elapsed > m_maxElapsed)
+    {
+        m_droppedTime += elapsed - m_maxElapsed;
+        elapsed = m_maxElapsed;
+    }
+
+    m_accumulator += std::max(elapsed, 0.0);
+    int steps = 0;
+    while (m_accumulator >= m_step)
+    {
+        m_accumulator -= m_step;
+        steps++;
+    }
+    m_steps += steps;
+    return steps;
+}
+
+void FixedTimestep::resync(double now)
+{
+    if (m_lastTime >= 0.0)
+        m_idleTime += std::max(now - m_lastTime, 0.0);
+    m_lastTime = now;
+    m_accumulator = 0.0;
+}
+
+double FixedTimestep::getTimeToNextStep(double now) const
+{
+    return std::max(getStepTime() + m_step - now, 0.0);
+}
+
+void FixedTimestep::printStats() const
+{
+    if (m_advances == 0)
+        return;
+
+    std::cout << "FixedTimestep: " << m_steps << " passos de " << m_step * 1000.0 << " ms em " << m_advances
+        << " frames (media de " << (double)m_steps / m_advances << " passos por frame), " << m_droppedTime
+        << " s descartados em travadas";
+    if (m_idleTime > 0.0)
+        std::cout << ", " << m_idleTime << " s parados sem simular";
+    std::cout << std::endl;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+
+// Simulação em passo fixo com acumulador: o tempo real de cada frame entra no
+// acumulador e sai em passos de "step" segundos, então a velocidade de tudo o
+// que anda por passo não depende da taxa de frames nem do vsync. O desenho
+// mostra o estado interpolado entre os dois últimos passos (alpha).
+//
+//   FixedTimestep timestep(1.0 / 60.0);
+//   while (...)
+//   {
+//       int steps = timestep.advance(glfwGetTime());
+//       for (int i = 0; i < steps; ++i)
+//       {
+//           previous = current;
+//           simulate(current, (float)timestep.getStep());
+//       }
+//       draw(mix(previous, current, timestep.getAlpha()));
+//   }
+//
+// Um frame travado (janela arrastada, breakpoint) soma no máximo maxElapsed
+// ao acumulador; o resto é descartado em vez de virar uma rajada de passos.
+
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep(double step = 1.0 / 60.0, double maxElapsed = 0.25);
+
+    // now em segundos (glfwGetTime); devolve quantos passos simular agora.
+    // A primeira chamada só marca o início
+    int advance(double now);
+
+    double getStep() const { return m_step; }
+
+    // Fração do próximo passo já decorrida, entre 0 e 1
+    float getAlpha() const { return (float)(m_accumulator / m_step); }
+
+    // Instante (no relógio de advance) em que o último passo terminou
+    double getStepTime() const { return m_lastTime - m_accumulator; }
+
+    // Depois de uma espera ociosa (nada se mexendo): o tempo parado não vira
+    // passos, a simulação recomeça de now
+    void resync(double now);
+
+    // Quanto falta, a partir de now, para o próximo passo
+    double getTimeToNextStep(double now) const;
+
+    double getSimulationTime() const { return m_steps * m_step; }
+    uint64_t getSteps() const { return m_steps; }
+
+    void printStats() const;
+
+private:
+    double m_step;
+    double m_maxElapsed;
+    double m_accumulator = 0.0;
+    double m_lastTime = -1.0;
+    uint64_t m_steps = 0;
+    uint64_t m_advances = 0;
+    double m_droppedTime = 0.0;
+    double m_idleTime = 0.0;
+};
@@ -0,0 +1,22 @@
+#include "GLUtil.h"
+
+#include <cstring>
+
+bool hasGLExtension(const char* name)
+{
+    if (glGetStringi)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (ext && strcmp(ext, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    const char* all = (const char*)glGetString(GL_EXTENSIONS);
+    return all && strstr(all, name) != nullptr;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <glad/glad.h>
+
+// Procura uma extensão na lista do contexto atual (glGetStringi no core profile,
+// string única nos contextos antigos)
+bool hasGLExtension(const char* name);
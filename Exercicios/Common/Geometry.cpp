@@ -0,0 +1,317 @@
+#include "Geometry.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "stb_image.h"
+
+#include "DiskCache.h"
+#include "Profiler.h"
+
+using namespace std;
+
+// Procura o map_Kd no .mtl de mesmo nome que o .obj
+static string findMtlTexture(const string& filepath)
+{
+    string basePath = filepath.substr(0, filepath.find_last_of("/"));
+    string filenameNoExt = filepath.substr(filepath.find_last_of("/") + 1);
+    filenameNoExt = filenameNoExt.substr(0, filenameNoExt.find_last_of("."));
+
+    string mtlPath = basePath + "/" + filenameNoExt + ".mtl";
+    ifstream mtlFile(mtlPath);
+    if (!mtlFile)
+        return "";
+
+    string line;
+    while (getline(mtlFile, line))
+    {
+        istringstream iss(line);
+        string keyword;
+        iss >> keyword;
+
+        if (keyword == "map_Kd")
+        {
+            string texturePath;
+            iss >> texturePath;
+            return basePath + "/" + texturePath;
+        }
+    }
+    return "";
+}
+
+bool parseObj(const string& filepath, MeshData& mesh)
+{
+    ifstream file(filepath);
+    if (!file)
+    {
+        cerr << "Failed to open file: " << filepath << endl;
+        return false;
+    }
+
+    vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+    vector<glm::vec3> temp_vertices;
+    vector<glm::vec2> temp_uvs;
+    vector<glm::vec3> temp_normals;
+
+    string line;
+    while (getline(file, line))
+    {
+        istringstream iss(line);
+        string type;
+        iss >> type;
+
+        if (type == "v")
+        {
+            glm::vec3 vertex;
+            iss >> vertex.x >> vertex.y >> vertex.z;
+            temp_vertices.push_back(vertex);
+        }
+        else if (type == "vt")
+        {
+            glm::vec2 uv;
+            iss >> uv.x >> uv.y;
+            temp_uvs.push_back(uv);
+        }
+        else if (type == "vn")
+        {
+            glm::vec3 normal;
+            iss >> normal.x >> normal.y >> normal.z;
+            temp_normals.push_back(normal);
+        }
+        else if (type == "f")
+        {
+            unsigned int vertexIndex, uvIndex, normalIndex;
+            char slash;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                iss >> vertexIndex >> slash >> uvIndex >> slash >> normalIndex;
+                vertexIndices.push_back(vertexIndex);
+                uvIndices.push_back(uvIndex);
+                normalIndices.push_back(normalIndex);
+            }
+        }
+    }
+
+    mesh.positions.clear();
+    mesh.uvs.clear();
+    mesh.normals.clear();
+    mesh.positions.reserve(vertexIndices.size());
+    mesh.uvs.reserve(vertexIndices.size());
+    mesh.normals.reserve(vertexIndices.size());
+
+    for (size_t i = 0; i < vertexIndices.size(); ++i)
+    {
+        unsigned int vi = vertexIndices[i];
+        unsigned int ui = uvIndices[i];
+        unsigned int ni = normalIndices[i];
+
+        if (vi == 0 || vi > temp_vertices.size() || ui == 0 || ui > temp_uvs.size() ||
+            ni == 0 || ni > temp_normals.size())
+        {
+            cerr << "Invalid face index in: " << filepath << endl;
+            return false;
+        }
+
+        mesh.positions.push_back(temp_vertices[vi - 1]);
+        mesh.uvs.push_back(temp_uvs[ui - 1]);
+        mesh.normals.push_back(temp_normals[ni - 1]);
+    }
+
+    mesh.texturePath = findMtlTexture(filepath);
+    return !mesh.positions.empty();
+}
+
+bool decodeImage(const string& filepath, bool flipVertically, ImageData& image)
+{
+    // A versão _thread do flip não mexe no estado global do stb_image,
+    // então várias threads de trabalho podem decodificar ao mesmo tempo
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+
+    unsigned char* data = stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0);
+    if (!data)
+    {
+        cerr << "Failed to load texture: " << filepath << endl;
+        return false;
+    }
+
+    image.pixels.assign(data, data + (size_t)image.width * image.height * image.channels);
+    stbi_image_free(data);
+    return true;
+}
+
+GLuint uploadTexture(const ImageData& image)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    GLenum format = (image.channels == 3) ? GL_RGB : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texID;
+}
+
+namespace
+{
+    // Chave da solda: posição, uv, normal e cor
+    struct WeldKey
+    {
+        float data[11];
+
+        bool operator==(const WeldKey& other) const { return memcmp(data, other.data, sizeof(data)) == 0; }
+    };
+
+    struct WeldKeyHash
+    {
+        size_t operator()(const WeldKey& key) const { return (size_t)DiskCache::hash(key.data, sizeof(key.data)); }
+    };
+
+    struct PositionKey
+    {
+        float data[3];
+
+        bool operator==(const PositionKey& other) const { return memcmp(data, other.data, sizeof(data)) == 0; }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const { return (size_t)DiskCache::hash(key.data, sizeof(key.data)); }
+    };
+}
+
+bool indexMesh(const MeshData& mesh, MeshData& vertices, vector<uint32_t>& indices)
+{
+    PROFILE_SCOPE("IndexMesh");
+    size_t count = mesh.positions.size();
+    if (count < 3 || mesh.uvs.size() != count || mesh.normals.size() != count)
+        return false;
+    bool hasColors = mesh.colors.size() == count;
+
+    vertices = MeshData();
+    vertices.texturePath = mesh.texturePath;
+    indices.resize(count - count % 3);
+    unordered_map<WeldKey, uint32_t, WeldKeyHash> ids;
+    ids.reserve(count);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const glm::vec3& p = mesh.positions[i];
+        const glm::vec2& t = mesh.uvs[i];
+        const glm::vec3& n = mesh.normals[i];
+        glm::vec3 c = hasColors ? mesh.colors[i] : glm::vec3(0.0f);
+        WeldKey key = { { p.x, p.y, p.z, t.x, t.y, n.x, n.y, n.z, c.r, c.g, c.b } };
+        auto it = ids.emplace(key, (uint32_t)ids.size());
+        if (it.second)
+        {
+            vertices.positions.push_back(p);
+            vertices.uvs.push_back(t);
+            vertices.normals.push_back(n);
+            if (hasColors)
+                vertices.colors.push_back(c);
+        }
+        indices[i] = it.first->second;
+    }
+    return true;
+}
+
+uint32_t groupPositions(const vector<glm::vec3>& positions, vector<uint32_t>& groups)
+{
+    groups.resize(positions.size());
+    unordered_map<PositionKey, uint32_t, PositionKeyHash> ids;
+    ids.reserve(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const glm::vec3& p = positions[i];
+        PositionKey key = { { p.x, p.y, p.z } };
+        groups[i] = ids.emplace(key, (uint32_t)ids.size()).first->second;
+    }
+    return (uint32_t)ids.size();
+}
+
+Geometry uploadGeometry(const MeshData& mesh, const ImageData* image)
+{
+    // 11 floats por vértice: pos(3), cor(3), uv(2), normal(3)
+    vector<GLfloat> vertices;
+    vertices.reserve(mesh.positions.size() * 11);
+    for (size_t i = 0; i < mesh.positions.size(); ++i)
+    {
+        const glm::vec3& p = mesh.positions[i];
+        const glm::vec2& t = mesh.uvs[i];
+        const glm::vec3& n = mesh.normals[i];
+        glm::vec3 c = mesh.colors.empty() ? glm::vec3(1.0f, 0.0f, 0.0f) : mesh.colors[i];
+        vertices.insert(vertices.end(), {
+            p.x, p.y, p.z,
+            c.r, c.g, c.b,
+            t.x, t.y,
+            n.x, n.y, n.z
+            });
+    }
+
+    Geometry geometry;
+    glGenVertexArrays(1, &geometry.VAO);
+    glGenBuffers(1, &geometry.VBO);
+
+    glBindVertexArray(geometry.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, geometry.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)(8 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+
+    geometry.vertexCount = (GLuint)mesh.positions.size();
+    if (image && !image->pixels.empty())
+        geometry.textureID = uploadTexture(*image);
+
+    return geometry;
+}
+
+void destroyGeometry(Geometry& geometry)
+{
+    if (geometry.VAO)
+        glDeleteVertexArrays(1, &geometry.VAO);
+    if (geometry.VBO)
+        glDeleteBuffers(1, &geometry.VBO);
+    if (geometry.textureID)
+        glDeleteTextures(1, &geometry.textureID);
+    geometry = Geometry();
+}
+
+Geometry loadGeometry(const string& filepath, const string& texturePath, bool flipTexture)
+{
+    PROFILE_SCOPE("LoadGeometry");
+    MeshData mesh;
+    if (!parseObj(filepath, mesh))
+        return {};
+
+    string texPath = texturePath.empty() ? mesh.texturePath : texturePath;
+    ImageData image;
+    bool hasImage = !texPath.empty() && decodeImage(texPath, flipTexture, image);
+
+    Geometry geometry = uploadGeometry(mesh, hasImage ? &image : nullptr);
+    if (hasImage)
+        geometry.textureFilePath = texPath;
+    return geometry;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Malha carregada de um .obj, já "desindexada" (3 vértices por triângulo),
+// pronta para ser enviada à GPU. Fica só na CPU, então pode ser montada numa
+// thread de trabalho.
+struct MeshData
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> colors; // opcional (ex.: luz assada); vazio = vermelho constante
+    std::string texturePath; // map_Kd do .mtl (vazio se não houver)
+};
+
+// Imagem decodificada pelo stb_image, também só na CPU
+struct ImageData
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Objeto pronto para desenhar: VAO com layout pos(3) cor(3) uv(2) normal(3)
+struct Geometry
+{
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint vertexCount = 0;
+    GLuint textureID = 0;
+    std::string textureFilePath;
+};
+
+// Etapas de CPU (seguras fora da thread do contexto GL)
+bool parseObj(const std::string& filepath, MeshData& mesh);
+bool decodeImage(const std::string& filepath, bool flipVertically, ImageData& image);
+
+// Solda os vértices iguais (posição, uv, normal e cor) de uma malha desindexada:
+// vertices fica com um de cada, na ordem em que aparecem, e indices com 3 por triângulo
+bool indexMesh(const MeshData& mesh, MeshData& vertices, std::vector<uint32_t>& indices);
+
+// Junta os vértices de mesma posição (as cópias de uma costura de uv ou normal):
+// groups recebe o grupo de cada vértice, numerados na ordem em que aparecem;
+// devolve quantos grupos há
+uint32_t groupPositions(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& groups);
+
+// Etapas de GPU (só na thread que tem o contexto GL)
+Geometry uploadGeometry(const MeshData& mesh, const ImageData* image);
+GLuint uploadTexture(const ImageData& image);
+void destroyGeometry(Geometry& geometry);
+
+// Carregamento síncrono. Se texturePath for vazio usa a textura do .mtl.
+Geometry loadGeometry(const std::string& filepath, const std::string& texturePath = "", bool flipTexture = true);
@@ -0,0 +1,385 @@
+#include "GeometryPool.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Profiler.h"
+
+namespace
+{
+    int highestBit(uint32_t value)
+    {
+        int bit = -1;
+        while (value)
+        {
+            value >>= 1;
+            ++bit;
+        }
+        return bit;
+    }
+
+    int lowestBit(uint32_t value)
+    {
+        int bit = 0;
+        while (!(value & 1u))
+        {
+            value >>= 1;
+            ++bit;
+        }
+        return bit;
+    }
+
+    // Layout do uploadGeometry: pos(3), cor(3), uv(2), normal(3)
+    void appendVertex(std::vector<GLfloat>& vertices, const glm::vec3& p, const glm::vec3& c, const glm::vec2& t,
+        const glm::vec3& n)
+    {
+        vertices.insert(vertices.end(), { p.x, p.y, p.z, c.r, c.g, c.b, t.x, t.y, n.x, n.y, n.z });
+    }
+}
+
+RangeAllocator::RangeAllocator(uint32_t capacity)
+    : m_capacity(capacity)
+{
+    for (auto& row : m_heads)
+        for (uint32_t& head : row)
+            head = NONE;
+
+    if (capacity == 0)
+        return;
+    uint32_t block = newBlock();
+    m_blocks[block].size = capacity;
+    insertFree(block);
+}
+
+void RangeAllocator::mapping(uint32_t size, int& fl, int& sl)
+{
+    // Abaixo de SL_COUNT cada tamanho tem a sua lista; acima, 16 faixas por potência de 2
+    if (size < (uint32_t)SL_COUNT)
+    {
+        fl = 0;
+        sl = (int)size;
+        return;
+    }
+    int bit = highestBit(size);
+    fl = bit - SL_LOG2 + 1;
+    sl = (int)((size >> (bit - SL_LOG2)) ^ (uint32_t)SL_COUNT);
+}
+
+uint32_t RangeAllocator::newBlock()
+{
+    if (!m_unusedBlocks.empty())
+    {
+        uint32_t block = m_unusedBlocks.back();
+        m_unusedBlocks.pop_back();
+        m_blocks[block] = Block();
+        return block;
+    }
+    m_blocks.push_back(Block());
+    return (uint32_t)m_blocks.size() - 1;
+}
+
+void RangeAllocator::insertFree(uint32_t block)
+{
+    int fl, sl;
+    mapping(m_blocks[block].size, fl, sl);
+    Block& b = m_blocks[block];
+    b.free = true;
+    b.prevFree = NONE;
+    b.nextFree = m_heads[fl][sl];
+    if (b.nextFree != NONE)
+        m_blocks[b.nextFree].prevFree = block;
+    m_heads[fl][sl] = block;
+    m_flBitmap |= 1u << fl;
+    m_slBitmap[fl] |= 1u << sl;
+}
+
+void RangeAllocator::removeFree(uint32_t block)
+{
+    int fl, sl;
+    mapping(m_blocks[block].size, fl, sl);
+    Block& b = m_blocks[block];
+    if (b.prevFree != NONE)
+        m_blocks[b.prevFree].nextFree = b.nextFree;
+    else
+        m_heads[fl][sl] = b.nextFree;
+    if (b.nextFree != NONE)
+        m_blocks[b.nextFree].prevFree = b.prevFree;
+    b.free = false;
+    b.prevFree = b.nextFree = NONE;
+
+    if (m_heads[fl][sl] == NONE)
+    {
+        m_slBitmap[fl] &= ~(1u << sl);
+        if (!m_slBitmap[fl])
+            m_flBitmap &= ~(1u << fl);
+    }
+}
+
+void RangeAllocator::merge(uint32_t left, uint32_t right)
+{
+    // Os dois já fora das listas livres; "right" vira registro reaproveitável
+    Block& l = m_blocks[left];
+    const Block& r = m_blocks[right];
+    l.size += r.size;
+    l.nextPhysical = r.nextPhysical;
+    if (l.nextPhysical != NONE)
+        m_blocks[l.nextPhysical].prevPhysical = left;
+    m_blocks[right] = Block();
+    m_unusedBlocks.push_back(right);
+}
+
+uint32_t RangeAllocator::allocate(uint32_t size, uint32_t& offset)
+{
+    if (size == 0 || size > m_capacity)
+        return NONE;
+
+    // Arredonda para cima até o começo da próxima faixa: qualquer bloco da lista achada serve
+    uint32_t rounded = size;
+    if (size >= (uint32_t)SL_COUNT)
+        rounded += (1u << (highestBit(size) - SL_LOG2)) - 1;
+    int fl, sl;
+    mapping(rounded, fl, sl);
+    if (fl >= FL_COUNT)
+        return NONE;
+
+    uint32_t slMap = m_slBitmap[fl] & (~0u << sl);
+    if (!slMap)
+    {
+        uint32_t flMap = fl + 1 < FL_COUNT ? m_flBitmap & (~0u << (fl + 1)) : 0;
+        if (!flMap)
+            return NONE;
+        fl = lowestBit(flMap);
+        slMap = m_slBitmap[fl];
+    }
+    sl = lowestBit(slMap);
+
+    uint32_t block = m_heads[fl][sl];
+    removeFree(block);
+
+    // Sobra vira um bloco livre logo depois
+    if (m_blocks[block].size > size)
+    {
+        uint32_t rest = newBlock();
+        Block& b = m_blocks[block];
+        Block& r = m_blocks[rest];
+        r.offset = b.offset + size;
+        r.size = b.size - size;
+        r.prevPhysical = block;
+        r.nextPhysical = b.nextPhysical;
+        if (r.nextPhysical != NONE)
+            m_blocks[r.nextPhysical].prevPhysical = rest;
+        b.nextPhysical = rest;
+        b.size = size;
+        insertFree(rest);
+    }
+
+    offset = m_blocks[block].offset;
+    return block;
+}
+
+void RangeAllocator::free(uint32_t block)
+{
+    if (block >= m_blocks.size() || m_blocks[block].free || m_blocks[block].size == 0)
+        return;
+
+    uint32_t prev = m_blocks[block].prevPhysical;
+    if (prev != NONE && m_blocks[prev].free)
+    {
+        removeFree(prev);
+        merge(prev, block);
+        block = prev;
+    }
+    uint32_t next = m_blocks[block].nextPhysical;
+    if (next != NONE && m_blocks[next].free)
+    {
+        removeFree(next);
+        merge(block, next);
+    }
+    insertFree(block);
+}
+
+RangeStats RangeAllocator::getStats() const
+{
+    RangeStats stats;
+    stats.capacity = m_capacity;
+    for (const Block& b : m_blocks)
+    {
+        if (b.size == 0)
+            continue;
+        if (b.free)
+        {
+            ++stats.freeBlocks;
+            stats.largestFree = std::max(stats.largestFree, b.size);
+        }
+        else
+        {
+            ++stats.allocations;
+            stats.used += b.size;
+        }
+    }
+    return stats;
+}
+
+GeometryPool::GeometryPool(uint32_t vertexCapacity, uint32_t indexCapacity)
+    : m_vertices(vertexCapacity), m_indices(indexCapacity)
+{
+    m_immutable = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+
+    GLsizeiptr vertexBytes = (GLsizeiptr)vertexCapacity * VERTEX_STRIDE;
+    GLsizeiptr indexBytes = (GLsizeiptr)indexCapacity * sizeof(uint32_t);
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    if (m_immutable)
+    {
+        glBufferStorage(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
+    }
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)(6 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*)(8 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool GeometryPool::add(const MeshData& mesh, PoolMesh& out)
+{
+    PROFILE_SCOPE("GeometryPool::add");
+    MeshData vertices;
+    std::vector<uint32_t> indices;
+    return indexMesh(mesh, vertices, indices) && add(vertices, indices, out);
+}
+
+bool GeometryPool::add(const PrimitiveMesh& mesh, PoolMesh& out)
+{
+    std::vector<GLfloat> vertices;
+    vertices.reserve(mesh.positions.size() * 11);
+    for (size_t i = 0; i < mesh.positions.size(); ++i)
+        appendVertex(vertices, mesh.positions[i], mesh.colors[i], mesh.uvs[i], mesh.normals[i]);
+    return upload(vertices, mesh.indices, mesh.bounds, out);
+}
+
+bool GeometryPool::add(const MeshData& vertices, const std::vector<uint32_t>& indices, PoolMesh& out)
+{
+    size_t count = vertices.positions.size();
+    if (vertices.uvs.size() != count || vertices.normals.size() != count)
+        return false;
+    bool hasColors = vertices.colors.size() == count;
+
+    std::vector<GLfloat> packed;
+    packed.reserve(count * 11);
+    Aabb bounds;
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec3 c = hasColors ? vertices.colors[i] : glm::vec3(1.0f, 0.0f, 0.0f);
+        appendVertex(packed, vertices.positions[i], c, vertices.uvs[i], vertices.normals[i]);
+        bounds.grow(vertices.positions[i]);
+    }
+    return upload(packed, indices, bounds, out);
+}
+
+bool GeometryPool::upload(const std::vector<GLfloat>& vertices, const std::vector<uint32_t>& indices,
+    const Aabb& bounds, PoolMesh& out)
+{
+    uint32_t vertexCount = (uint32_t)(vertices.size() / 11);
+    if (vertexCount == 0 || indices.empty())
+        return false;
+
+    uint32_t vertexOffset = 0, indexOffset = 0;
+    uint32_t vertexBlock = m_vertices.allocate(vertexCount, vertexOffset);
+    uint32_t indexBlock = vertexBlock != RangeAllocator::NONE ?
+        m_indices.allocate((uint32_t)indices.size(), indexOffset) : RangeAllocator::NONE;
+    if (indexBlock == RangeAllocator::NONE)
+    {
+        m_vertices.free(vertexBlock);
+        ++m_failedAdds;
+        std::cerr << "GeometryPool: sem espaco para " << vertexCount << " vertices e " << indices.size()
+            << " indices" << std::endl;
+        return false;
+    }
+
+    // Índices ficam relativos à malha; baseVertex aponta o trecho no VBO
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexOffset * VERTEX_STRIDE, vertices.size() * sizeof(GLfloat),
+        vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(m_VAO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)indexOffset * sizeof(uint32_t),
+        indices.size() * sizeof(uint32_t), indices.data());
+    glBindVertexArray(0);
+
+    out.baseVertex = (GLint)vertexOffset;
+    out.firstIndex = indexOffset;
+    out.indexCount = (GLsizei)indices.size();
+    out.vertexCount = vertexCount;
+    out.bounds = bounds;
+    out.vertexBlock = vertexBlock;
+    out.indexBlock = indexBlock;
+
+    ++m_meshes;
+    m_uploadedBytes += vertices.size() * sizeof(GLfloat) + indices.size() * sizeof(uint32_t);
+    return true;
+}
+
+void GeometryPool::remove(PoolMesh& mesh)
+{
+    if (!mesh.isValid())
+        return;
+    m_vertices.free(mesh.vertexBlock);
+    m_indices.free(mesh.indexBlock);
+    --m_meshes;
+    mesh = PoolMesh();
+}
+
+void GeometryPool::draw(const PoolMesh& mesh) const
+{
+    glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+        (void*)((size_t)mesh.firstIndex * sizeof(uint32_t)), mesh.baseVertex);
+}
+
+void printRangeStats(const char* label, const RangeStats& stats)
+{
+    double occupancy = stats.capacity ? 100.0 * stats.used / stats.capacity : 0.0;
+    std::cout << "  " << label << ": " << stats.used << "/" << stats.capacity << " (" << occupancy << "%), "
+        << stats.freeBlocks << " blocos livres, maior " << stats.largestFree << ", fragmentacao "
+        << stats.fragmentation() * 100.0f << "%" << std::endl;
+}
+
+void GeometryPool::printStats() const
+{
+    std::cout << "GeometryPool: " << m_meshes << " malhas (" << (m_immutable ? "glBufferStorage" : "glBufferData")
+        << "), " << m_uploadedBytes / 1024 << " KB enviados";
+    if (m_failedAdds)
+        std::cout << ", " << m_failedAdds << " sem espaco";
+    std::cout << std::endl;
+    printRangeStats("vertices", m_vertices.getStats());
+    printRangeStats("indices", m_indices.getStats());
+}
+
+void GeometryPool::destroy()
+{
+    if (m_VAO)
+        glDeleteVertexArrays(1, &m_VAO);
+    if (m_VBO)
+        glDeleteBuffers(1, &m_VBO);
+    if (m_EBO)
+        glDeleteBuffers(1, &m_EBO);
+    m_VAO = m_VBO = m_EBO = 0;
+}
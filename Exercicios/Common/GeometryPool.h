@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Geometry.h"
+#include "InstanceBvh.h"
+#include "Primitives.h"
+
+// Pool de geometria: todas as malhas de um formato de vértice num VBO e num
+// EBO grandes, de tamanho fixo, com um único VAO. Cada malha é só um trecho
+// (baseVertex, firstIndex, indexCount), então desenhar malhas diferentes não
+// troca VAO nem buffer, e uma lista de DrawElementsIndirectCommand (GpuCuller)
+// desenha todas num draw só.
+//
+//   GeometryPool pool(1 << 18, 1 << 20);    // capacidade em vértices e índices (11 MB + 4 MB)
+//   PoolMesh suzanne, sphere;
+//   pool.add(mesh, suzanne);                // MeshData do parseObj (soldada aqui)
+//   pool.add(primitives.getMesh(PrimitiveShape::uvSphere(0.5f, 16, 16)), sphere);
+//   glBindVertexArray(pool.getVAO());
+//   pool.draw(suzanne);                     // glDrawElementsBaseVertex
+//   pool.remove(sphere);                    // o trecho volta para o alocador
+//
+// O formato é o do uploadGeometry (posição, cor, uv, normal nas locations 0 a
+// 3). Com OpenGL 4.4 os buffers são imutáveis (glBufferStorage); antes disso
+// são alocados uma vez com glBufferData. Os trechos de vértices e de índices
+// vêm de dois RangeAllocator (TLSF: listas livres por classe de tamanho, com
+// busca e junção de vizinhos em tempo constante).
+
+// Estado de um RangeAllocator (em unidades: vértices ou índices)
+struct RangeStats
+{
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    uint32_t allocations = 0;       // trechos em uso
+    uint32_t freeBlocks = 0;
+    uint32_t largestFree = 0;
+
+    // 0 = todo o espaço livre num bloco só; perto de 1 = livre picado em blocos pequenos
+    float fragmentation() const
+    {
+        uint32_t free = capacity - used;
+        return free > 0 ? 1.0f - (float)largestFree / (float)free : 0.0f;
+    }
+};
+
+// Uma linha com ocupação e fragmentação, recuada, para os printStats dos pools
+void printRangeStats(const char* label, const RangeStats& stats);
+
+// Two-Level Segregated Fit sobre [0, capacity): o primeiro nível é a potência
+// de 2 do tamanho e o segundo divide cada potência em 16 faixas. Um bitmap por
+// nível acha a menor lista livre que serve sem percorrer blocos.
+class RangeAllocator
+{
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    // Devolve o identificador do trecho (NONE se não couber) e o início dele em "offset"
+    uint32_t allocate(uint32_t size, uint32_t& offset);
+    void free(uint32_t block);
+
+    RangeStats getStats() const;
+
+private:
+    static const int SL_LOG2 = 4;
+    static const int SL_COUNT = 1 << SL_LOG2;
+    static const int FL_COUNT = 32;
+
+    struct Block
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        uint32_t prevPhysical = NONE;   // vizinhos no espaço de endereços
+        uint32_t nextPhysical = NONE;
+        uint32_t prevFree = NONE;       // lista livre da classe
+        uint32_t nextFree = NONE;
+        bool free = false;
+    };
+
+    static void mapping(uint32_t size, int& fl, int& sl);
+    uint32_t newBlock();
+    void insertFree(uint32_t block);
+    void removeFree(uint32_t block);
+    void merge(uint32_t left, uint32_t right);
+
+    uint32_t m_capacity;
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_unusedBlocks;   // registros reaproveitáveis
+    uint32_t m_flBitmap = 0;
+    uint32_t m_slBitmap[FL_COUNT] = {};
+    uint32_t m_heads[FL_COUNT][SL_COUNT];
+};
+
+// Trecho de uma malha no pool
+struct PoolMesh
+{
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;
+    GLsizei indexCount = 0;
+    GLuint vertexCount = 0;
+    Aabb bounds;
+    uint32_t vertexBlock = RangeAllocator::NONE;
+    uint32_t indexBlock = RangeAllocator::NONE;
+
+    bool isValid() const { return vertexBlock != RangeAllocator::NONE; }
+};
+
+class GeometryPool
+{
+public:
+    GeometryPool(uint32_t vertexCapacity = 1 << 18, uint32_t indexCapacity = 1 << 20);
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // false se não couber; a malha desindexada é soldada antes de subir
+    bool add(const MeshData& mesh, PoolMesh& out);
+    bool add(const PrimitiveMesh& mesh, PoolMesh& out);
+    bool add(const MeshData& vertices, const std::vector<uint32_t>& indices, PoolMesh& out);
+
+    void remove(PoolMesh& mesh);
+
+    GLuint getVAO() const { return m_VAO; }
+
+    // VAO do pool já ligado
+    void draw(const PoolMesh& mesh) const;
+
+    RangeStats getVertexStats() const { return m_vertices.getStats(); }
+    RangeStats getIndexStats() const { return m_indices.getStats(); }
+    void printStats() const;
+
+    // Apaga o VAO e os buffers; chamar antes de destruir o contexto GL
+    void destroy();
+
+    static const GLsizei VERTEX_STRIDE = 11 * sizeof(GLfloat);
+
+private:
+    // 11 floats por vértice, no layout do uploadGeometry
+    bool upload(const std::vector<GLfloat>& vertices, const std::vector<uint32_t>& indices, const Aabb& bounds,
+        PoolMesh& out);
+
+    RangeAllocator m_vertices;
+    RangeAllocator m_indices;
+    GLuint m_VAO = 0;
+    GLuint m_VBO = 0;
+    GLuint m_EBO = 0;
+    bool m_immutable = false;
+    uint32_t m_meshes = 0;
+    uint64_t m_uploadedBytes = 0;
+    uint32_t m_failedAdds = 0;
+};
@@ -0,0 +1,522 @@
+#include "GpuCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Profiler.h"
+
+static const char* instanceSource = R"glsl(
+struct GpuInstance
+{
+    mat4 model;
+    uint mesh;
+    float data[3];
+};
+
+layout(std430, binding = 0) readonly buffer GpuInstances
+{
+    GpuInstance instances[];
+};
+)glsl";
+
+static const char* cullSource = R"glsl(
+layout(local_size_x = 64) in;
+
+// 2 vec4 por malha: mínimo e máximo da caixa local
+layout(std430, binding = 1) readonly buffer Meshes
+{
+    vec4 meshBounds[];
+};
+
+// DrawElementsIndirectCommand: count, instanceCount, firstIndex, baseVertex, baseInstance
+layout(std430, binding = 2) buffer Commands
+{
+    uint commands[];
+};
+
+layout(std430, binding = 3) writeonly buffer Visible
+{
+    uint visibleIds[];
+};
+
+layout(std430, binding = 4) buffer Counters
+{
+    uint frustumCulled;
+    uint occlusionCulled;
+};
+
+uniform mat4 viewProjection;
+uniform mat4 hiZViewProjection;
+uniform uint instanceCount;
+uniform bool useHiZ;
+uniform sampler2D hiZ;
+uniform vec2 screenSize;
+uniform int hiZLevels;
+
+bool occluded(mat4 model, vec3 boxMin, vec3 boxMax)
+{
+    // Caixa na tela do frame em que a Hi-Z foi feita
+    mat4 mvp = hiZViewProjection * model;
+    vec3 ndcMin = vec3(1.0), ndcMax = vec3(-1.0);
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? boxMax.x : boxMin.x, (i & 2) != 0 ? boxMax.y : boxMin.y,
+            (i & 4) != 0 ? boxMax.z : boxMin.z);
+        vec4 clip = mvp * vec4(corner, 1.0);
+        if (clip.w <= 1e-5)
+            return false;
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc);
+        ndcMax = max(ndcMax, ndc);
+    }
+
+    vec2 pixelMin = clamp((ndcMin.xy * 0.5 + 0.5) * screenSize, vec2(0.0), screenSize - 1.0);
+    vec2 pixelMax = clamp((ndcMax.xy * 0.5 + 0.5) * screenSize, vec2(0.0), screenSize - 1.0);
+    float depth = ndcMin.z * 0.5 + 0.5;
+
+    // Texel do nível n cobre 2^(n+1) pixels: escolhe o nível em que a caixa pega até 2x2 texels
+    float extent = max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y);
+    int level = clamp(int(ceil(log2(max(extent, 1.0)))) - 1, 0, hiZLevels - 1);
+    ivec2 lo, hi;
+    for (;;)
+    {
+        ivec2 last = textureSize(hiZ, level) - 1;
+        lo = min(ivec2(pixelMin) >> (level + 1), last);
+        hi = min(ivec2(pixelMax) >> (level + 1), last);
+        if (all(lessThanEqual(hi - lo, ivec2(1))) || level == hiZLevels - 1)
+            break;
+        level++;
+    }
+
+    float farthest = 0.0;
+    for (int y = lo.y; y <= hi.y; ++y)
+        for (int x = lo.x; x <= hi.x; ++x)
+            farthest = max(farthest, texelFetch(hiZ, ivec2(x, y), level).r);
+    return depth > farthest;
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= instanceCount)
+        return;
+
+    mat4 model = instances[id].model;
+    uint mesh = instances[id].mesh;
+    vec3 boxMin = meshBounds[mesh * 2u].xyz;
+    vec3 boxMax = meshBounds[mesh * 2u + 1u].xyz;
+
+    // Fora se os 8 cantos estão do lado de fora de um mesmo plano
+    mat4 mvp = viewProjection * model;
+    uint outside = 63u;
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? boxMax.x : boxMin.x, (i & 2) != 0 ? boxMax.y : boxMin.y,
+            (i & 4) != 0 ? boxMax.z : boxMin.z);
+        vec4 clip = mvp * vec4(corner, 1.0);
+        uint code = (clip.x < -clip.w ? 1u : 0u) | (clip.x > clip.w ? 2u : 0u) |
+            (clip.y < -clip.w ? 4u : 0u) | (clip.y > clip.w ? 8u : 0u) |
+            (clip.z < -clip.w ? 16u : 0u) | (clip.z > clip.w ? 32u : 0u);
+        outside &= code;
+    }
+    if (outside != 0u)
+    {
+        atomicAdd(frustumCulled, 1u);
+        return;
+    }
+
+    if (useHiZ && occluded(model, boxMin, boxMax))
+    {
+        atomicAdd(occlusionCulled, 1u);
+        return;
+    }
+
+    uint slot = atomicAdd(commands[mesh * 5u + 1u], 1u);
+    visibleIds[commands[mesh * 5u + 4u] + slot] = id;
+}
+)glsl";
+
+static const char* reduceSource = R"glsl(
+layout(local_size_x = 8, local_size_y = 8) in;
+
+#ifdef FROM_DEPTH
+uniform sampler2D source;
+float load(ivec2 p) { return texelFetch(source, p, 0).r; }
+#else
+layout(r32f, binding = 0) readonly uniform image2D source;
+float load(ivec2 p) { return imageLoad(source, p).r; }
+#endif
+
+layout(r32f, binding = 1) writeonly uniform image2D destination;
+uniform ivec2 sourceSize;
+
+void main()
+{
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(destination);
+    if (p.x >= size.x || p.y >= size.y)
+        return;
+
+    // Maior profundidade do bloco 2x2; com tamanho ímpar a última coluna/linha
+    // leva também a sobra, então nenhum pixel fica de fora
+    ivec2 first = p * 2;
+    ivec2 last = min(first + 1 + ivec2(equal(p, size - 1)) * (sourceSize & 1), sourceSize - 1);
+    float depth = 0.0;
+    for (int y = first.y; y <= last.y; ++y)
+        for (int x = first.x; x <= last.x; ++x)
+            depth = max(depth, load(ivec2(x, y)));
+    imageStore(destination, p, vec4(depth));
+}
+)glsl";
+
+GpuCuller::GpuCuller(ShaderCache& shaders)
+{
+    m_supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+    if (!m_supported)
+    {
+        std::cout << "GpuCuller: requer OpenGL 4.3 (compute shader), culling na GPU desligado" << std::endl;
+        return;
+    }
+
+    std::string header = "#version 430 core\n";
+    size_t cull = shaders.request("gpu_cull", { { GL_COMPUTE_SHADER, header + instanceSource + cullSource } });
+    size_t copy = shaders.request("hiz_copy", { { GL_COMPUTE_SHADER, header + "#define FROM_DEPTH\n" + reduceSource } });
+    size_t reduce = shaders.request("hiz_reduce", { { GL_COMPUTE_SHADER, header + reduceSource } });
+    shaders.build();
+    m_cullProgram = shaders.program(cull);
+    m_copyProgram = shaders.program(copy);
+    m_reduceProgram = shaders.program(reduce);
+    if (m_cullProgram == 0 || m_copyProgram == 0 || m_reduceProgram == 0)
+    {
+        m_supported = false;
+        return;
+    }
+
+    GLuint buffers[7];
+    glGenBuffers(7, buffers);
+    m_instanceBuffer = buffers[0];
+    m_meshBuffer = buffers[1];
+    m_commandBuffer = buffers[2];
+    m_visibleBuffer = buffers[3];
+    m_counterBuffer = buffers[4];
+    m_readbackBuffer = buffers[5];
+    m_templateBuffer = buffers[6];
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_counterBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_readbackBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, READBACK_FRAMES * 2 * sizeof(GLuint), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glGenQueries(READBACK_FRAMES * 4, m_queries);
+}
+
+int GpuCuller::addMesh(GLsizei indexCount, GLuint firstIndex, GLint baseVertex, const Aabb& localBounds)
+{
+    m_meshes.push_back({ indexCount, firstIndex, baseVertex, localBounds });
+    return (int)m_meshes.size() - 1;
+}
+
+void GpuCuller::setInstances(const std::vector<GpuInstance>& instances)
+{
+    static_assert(sizeof(GpuInstance) == 80, "GpuInstance precisa do layout std430");
+    if (!m_supported)
+        return;
+
+    // Cada malha fica com um trecho da lista de visíveis do tamanho das suas instâncias
+    std::vector<GLuint> perMesh(m_meshes.size(), 0);
+    for (const GpuInstance& instance : instances)
+        perMesh[instance.mesh]++;
+
+    std::vector<GLuint> commands;
+    std::vector<glm::vec4> bounds;
+    GLuint baseInstance = 0;
+    for (size_t m = 0; m < m_meshes.size(); ++m)
+    {
+        const Mesh& mesh = m_meshes[m];
+        commands.insert(commands.end(),
+            { (GLuint)mesh.indexCount, 0u, mesh.firstIndex, (GLuint)mesh.baseVertex, baseInstance });
+        baseInstance += perMesh[m];
+        bounds.push_back(glm::vec4(mesh.bounds.min, 0.0f));
+        bounds.push_back(glm::vec4(mesh.bounds.max, 0.0f));
+    }
+    m_instanceCount = (uint32_t)instances.size();
+    m_commandBytes = commands.size() * sizeof(GLuint);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_instanceBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, instances.size() * sizeof(GpuInstance), instances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_meshBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, bounds.size() * sizeof(glm::vec4), bounds.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_templateBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, m_commandBytes, commands.data(), GL_STATIC_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_commandBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, m_commandBytes, commands.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_visibleBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, std::max<size_t>(instances.size(), 1) * sizeof(GLuint), nullptr,
+        GL_DYNAMIC_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuCuller::updateInstances(uint32_t first, const GpuInstance* instances, uint32_t count)
+{
+    if (!m_supported || count == 0)
+        return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_instanceBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, first * sizeof(GpuInstance), count * sizeof(GpuInstance), instances);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuCuller::attachInstanceIds(GLuint VAO, GLuint location) const
+{
+    if (!m_supported)
+        return;
+
+    // O baseInstance de cada comando desloca a leitura: a instância i da malha
+    // m lê visibleIds[baseInstance(m) + i]
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_visibleBuffer);
+    glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GpuCuller::readBack()
+{
+    for (int slot = 0; slot < READBACK_FRAMES; ++slot)
+    {
+        if (!m_fences[slot])
+            continue;
+        GLenum status = glClientWaitSync(m_fences[slot], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            continue;
+        glDeleteSync(m_fences[slot]);
+        m_fences[slot] = nullptr;
+
+        GLuint counters[2];
+        glBindBuffer(GL_COPY_READ_BUFFER, m_readbackBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, slot * sizeof(counters), sizeof(counters), counters);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        m_stats.samples++;
+        m_stats.frustumCulled += counters[0];
+        m_stats.occlusionCulled += counters[1];
+
+        // A cerca vem depois dos timestamps do cull; os do Hi-Z podem atrasar mais um pouco
+        const GLuint* queries = m_queries + slot * 4;
+        GLint available = 1;
+        if (m_hiZTimed[slot])
+            glGetQueryObjectiv(queries[3], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 times[4] = {};
+        for (int q = 0; q < (m_hiZTimed[slot] ? 4 : 2); ++q)
+            glGetQueryObjectui64v(queries[q], GL_QUERY_RESULT, &times[q]);
+        m_stats.gpuMs += ((times[1] - times[0]) + (times[3] - times[2])) / 1.0e6;
+        m_stats.gpuSamples++;
+    }
+}
+
+void GpuCuller::cull(const glm::mat4& viewProjection, bool occlusion)
+{
+    if (!m_supported || m_instanceCount == 0)
+        return;
+    PROFILE_SCOPE("GpuCull");
+    auto start = std::chrono::steady_clock::now();
+
+    readBack();
+    m_slot = m_frame++ % READBACK_FRAMES;
+    if (m_fences[m_slot])
+    {
+        // A GPU ainda não chegou neste frame: perde a amostra em vez de esperar
+        glDeleteSync(m_fences[m_slot]);
+        m_fences[m_slot] = nullptr;
+    }
+    m_hiZTimed[m_slot] = false;
+    glQueryCounter(m_queries[m_slot * 4], GL_TIMESTAMP);
+
+    // Zera os instanceCount e os contadores sem subir nada da CPU: os comandos
+    // vêm do buffer modelo e os contadores são limpos na GPU
+    glBindBuffer(GL_COPY_READ_BUFFER, m_templateBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_commandBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_commandBytes);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_counterBuffer);
+    glClearBufferSubData(GL_COPY_WRITE_BUFFER, GL_R32UI, 0, 2 * sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    bool useHiZ = occlusion && m_hiZValid;
+    glUseProgram(m_cullProgram);
+    glUniformMatrix4fv(glGetUniformLocation(m_cullProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniformMatrix4fv(glGetUniformLocation(m_cullProgram, "hiZViewProjection"), 1, GL_FALSE,
+        glm::value_ptr(m_hiZViewProjection));
+    glUniform1ui(glGetUniformLocation(m_cullProgram, "instanceCount"), m_instanceCount);
+    glUniform1i(glGetUniformLocation(m_cullProgram, "useHiZ"), useHiZ ? 1 : 0);
+    glUniform1i(glGetUniformLocation(m_cullProgram, "hiZ"), 0);
+    glUniform2f(glGetUniformLocation(m_cullProgram, "screenSize"), (float)m_hiZWidth, (float)m_hiZHeight);
+    glUniform1i(glGetUniformLocation(m_cullProgram, "hiZLevels"), m_hiZLevels);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_meshBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_visibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_counterBuffer);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, useHiZ ? m_hiZTexture : 0);
+
+    glDispatchCompute((m_instanceCount + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT |
+        GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glQueryCounter(m_queries[m_slot * 4 + 1], GL_TIMESTAMP);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_counterBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_readbackBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, m_slot * 2 * sizeof(GLuint), 2 * sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_fences[m_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_viewProjection = viewProjection;
+    m_stats.frames++;
+    m_stats.instances += m_instanceCount;
+    m_stats.cullCpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void GpuCuller::draw() const
+{
+    if (!m_supported || m_instanceCount == 0)
+        return;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_instanceBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)m_meshes.size(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuCuller::updateHiZ(int width, int height)
+{
+    if (!m_supported || m_frame == 0 || width <= 1 || height <= 1)
+        return;
+    PROFILE_SCOPE("HiZ");
+    auto start = std::chrono::steady_clock::now();
+
+    if (width != m_hiZWidth || height != m_hiZHeight)
+    {
+        if (m_depthTexture)
+            glDeleteTextures(1, &m_depthTexture);
+        if (m_hiZTexture)
+            glDeleteTextures(1, &m_hiZTexture);
+        m_hiZWidth = width;
+        m_hiZHeight = height;
+        int levelWidth = std::max(width / 2, 1), levelHeight = std::max(height / 2, 1);
+        m_hiZLevels = 1 + (int)std::floor(std::log2((float)std::max(levelWidth, levelHeight)));
+
+        glGenTextures(1, &m_depthTexture);
+        glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glGenTextures(1, &m_hiZTexture);
+        glBindTexture(GL_TEXTURE_2D, m_hiZTexture);
+        glTexStorage2D(GL_TEXTURE_2D, m_hiZLevels, GL_R32F, levelWidth, levelHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    m_hiZTimed[m_slot] = true;
+    glQueryCounter(m_queries[m_slot * 4 + 2], GL_TIMESTAMP);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+    // Nível 0 direto da profundidade, depois cada nível a partir do anterior
+    int sourceWidth = width, sourceHeight = height;
+    for (int level = 0; level < m_hiZLevels; ++level)
+    {
+        int levelWidth = std::max(sourceWidth / 2, 1), levelHeight = std::max(sourceHeight / 2, 1);
+        GLuint program = level == 0 ? m_copyProgram : m_reduceProgram;
+        glUseProgram(program);
+        glUniform2i(glGetUniformLocation(program, "sourceSize"), sourceWidth, sourceHeight);
+        if (level == 0)
+            glUniform1i(glGetUniformLocation(program, "source"), 0);
+        else
+            glBindImageTexture(0, m_hiZTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, m_hiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+        sourceWidth = levelWidth;
+        sourceHeight = levelHeight;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glQueryCounter(m_queries[m_slot * 4 + 3], GL_TIMESTAMP);
+
+    m_hiZViewProjection = m_viewProjection;
+    m_hiZValid = true;
+    m_stats.hiZCpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* GpuCuller::getShaderSource()
+{
+    return instanceSource;
+}
+
+void GpuCuller::printStats() const
+{
+    if (m_stats.frames == 0)
+        return;
+
+    double frames = (double)m_stats.frames;
+    std::cout << "GpuCuller: " << m_stats.frames << " frames, " << m_stats.instances / frames << " instancias";
+    if (m_stats.samples > 0)
+    {
+        double samples = (double)m_stats.samples;
+        std::cout << ", media de " << m_stats.frustumCulled / samples << " fora do frustum e "
+            << m_stats.occlusionCulled / samples << " ocultas pela Hi-Z";
+    }
+    std::cout << ", CPU " << m_stats.cullCpuMs / frames << " ms no cull e " << m_stats.hiZCpuMs / frames << " ms na Hi-Z";
+    if (m_stats.gpuSamples > 0)
+        std::cout << ", GPU " << m_stats.gpuMs / m_stats.gpuSamples << " ms";
+    std::cout << " por frame" << std::endl;
+}
+
+void GpuCuller::destroy()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_queries[0])
+        glDeleteQueries(READBACK_FRAMES * 4, m_queries);
+    std::fill(m_queries, m_queries + READBACK_FRAMES * 4, 0);
+
+    GLuint buffers[7] = { m_instanceBuffer, m_meshBuffer, m_commandBuffer, m_visibleBuffer, m_counterBuffer,
+        m_readbackBuffer, m_templateBuffer };
+    glDeleteBuffers(7, buffers);
+    m_instanceBuffer = m_meshBuffer = m_commandBuffer = m_visibleBuffer = m_counterBuffer = m_readbackBuffer = 0;
+    m_templateBuffer = 0;
+
+    if (m_depthTexture)
+        glDeleteTextures(1, &m_depthTexture);
+    if (m_hiZTexture)
+        glDeleteTextures(1, &m_hiZTexture);
+    m_depthTexture = m_hiZTexture = 0;
+    m_hiZWidth = m_hiZHeight = m_hiZLevels = 0;
+    m_hiZValid = false;
+
+    glDeleteProgram(m_cullProgram);
+    glDeleteProgram(m_copyProgram);
+    glDeleteProgram(m_reduceProgram);
+    m_cullProgram = m_copyProgram = m_reduceProgram = 0;
+    m_instanceCount = 0;
+    m_supported = false;
+}
@@ -0,0 +1,200 @@
+#include "GpuProfiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Frames entre duas recalibrações do relógio da GPU com o da CPU
+static const uint64_t CALIBRATION_INTERVAL = 120;
+
+// Índices fixos das queries de início e fim do frame dentro de cada slot
+static const unsigned FRAME_BEGIN_QUERY = 0;
+static const unsigned FRAME_END_QUERY = 1;
+static const unsigned NO_QUERY = ~0u;
+
+GpuProfiler::GpuProfiler(unsigned latencyFrames, unsigned maxScopesPerFrame)
+    : m_frames(std::max(latencyFrames, 2u))
+{
+    for (Frame& frame : m_frames)
+    {
+        frame.queries.resize(2 + 2 * (size_t)maxScopesPerFrame);
+        glGenQueries((GLsizei)frame.queries.size(), frame.queries.data());
+    }
+    calibrate();
+}
+
+void GpuProfiler::destroy()
+{
+    for (Frame& frame : m_frames)
+    {
+        if (!frame.queries.empty())
+            glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+        frame.queries.clear();
+        frame.pending = false;
+    }
+    m_inFrame = false;
+}
+
+void GpuProfiler::calibrate()
+{
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    m_gpuToCpuNs = (int64_t)Profiler::instance().nowNs() - gpuNow;
+}
+
+unsigned GpuProfiler::allocQuery(Frame& frame)
+{
+    if (frame.used >= frame.queries.size())
+        return NO_QUERY;
+    return frame.used++;
+}
+
+void GpuProfiler::beginFrame()
+{
+    if (m_frames[0].queries.empty())
+        return;
+
+    m_current = (m_current + 1) % m_frames.size();
+    Frame& frame = m_frames[m_current];
+
+    // O slot foi usado há m_frames.size() frames; se a GPU ainda não chegou
+    // lá, o frame é descartado em vez de esperar
+    if (frame.pending)
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.queries[FRAME_END_QUERY], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+            collect(frame);
+        else
+            m_dropped++;
+    }
+
+    if (Profiler::instance().getFrameIndex() % CALIBRATION_INTERVAL == 0)
+        calibrate();
+
+    frame.used = 2;
+    frame.scopes.clear();
+    frame.pending = false;
+    m_stack.clear();
+    m_inFrame = true;
+    glQueryCounter(frame.queries[FRAME_BEGIN_QUERY], GL_TIMESTAMP);
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!m_inFrame)
+        return;
+
+    Frame& frame = m_frames[m_current];
+    glQueryCounter(frame.queries[FRAME_END_QUERY], GL_TIMESTAMP);
+    frame.pending = true;
+    m_inFrame = false;
+}
+
+void GpuProfiler::begin(const char* name)
+{
+    if (!m_inFrame)
+        return;
+
+    Frame& frame = m_frames[m_current];
+    unsigned beginQuery = allocQuery(frame);
+    unsigned endQuery = allocQuery(frame);
+    if (endQuery == NO_QUERY)
+    {
+        // Sem queries livres neste frame: o escopo é ignorado
+        m_stack.push_back(SIZE_MAX);
+        return;
+    }
+
+    glQueryCounter(frame.queries[beginQuery], GL_TIMESTAMP);
+    frame.scopes.push_back({ name, beginQuery, endQuery, (uint32_t)m_stack.size() });
+    m_stack.push_back(frame.scopes.size() - 1);
+}
+
+void GpuProfiler::end()
+{
+    if (!m_inFrame || m_stack.empty())
+        return;
+
+    size_t scope = m_stack.back();
+    m_stack.pop_back();
+    if (scope == SIZE_MAX)
+        return;
+
+    Frame& frame = m_frames[m_current];
+    glQueryCounter(frame.queries[frame.scopes[scope].endQuery], GL_TIMESTAMP);
+}
+
+void GpuProfiler::collect(Frame& frame)
+{
+    // A query de fim de frame é a última emitida; se ela está pronta,
+    // todas as anteriores também estão e GL_QUERY_RESULT não bloqueia
+    std::vector<GLuint64> timestamps(frame.used);
+    for (unsigned i = 0; i < frame.used; ++i)
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+
+    auto toCpu = [this](GLuint64 gpuNs) { return (uint64_t)((int64_t)gpuNs + m_gpuToCpuNs); };
+
+    GLuint64 frameBegin = timestamps[FRAME_BEGIN_QUERY];
+    GLuint64 frameEnd = timestamps[FRAME_END_QUERY];
+    m_frameMs.push_back((float)((frameEnd - frameBegin) / 1e6));
+    Profiler::instance().pushExternal("GPU", { "GPU Frame", toCpu(frameBegin), toCpu(frameEnd), 0, 1 });
+
+    for (const Scope& scope : frame.scopes)
+    {
+        GLuint64 begin = timestamps[scope.beginQuery];
+        GLuint64 end = std::max(timestamps[scope.endQuery], begin);
+        Profiler::instance().pushExternal("GPU", { scope.name, toCpu(begin), toCpu(end), scope.depth + 1, 1 });
+
+        auto stats = std::find_if(m_scopeMs.begin(), m_scopeMs.end(),
+            [&](const std::pair<const char*, std::vector<float>>& entry) { return strcmp(entry.first, scope.name) == 0; });
+        if (stats == m_scopeMs.end())
+        {
+            m_scopeMs.push_back({ scope.name, {} });
+            stats = m_scopeMs.end() - 1;
+        }
+        stats->second.push_back((float)((end - begin) / 1e6));
+    }
+}
+
+static void computeStats(std::vector<float> samples, float& minMs, float& avgMs, float& p99Ms)
+{
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (float ms : samples)
+        sum += ms;
+
+    size_t p99Index = (size_t)std::ceil(samples.size() * 0.99) - 1;
+    minMs = samples.front();
+    avgMs = (float)(sum / samples.size());
+    p99Ms = samples[std::min(p99Index, samples.size() - 1)];
+}
+
+void GpuProfiler::printStats() const
+{
+    if (m_frameMs.empty())
+    {
+        std::cout << "GpuProfiler: nenhum frame medido" << std::endl;
+        return;
+    }
+
+    float minMs, avgMs, p99Ms;
+    computeStats(m_frameMs, minMs, avgMs, p99Ms);
+    std::cout << "GpuProfiler: " << m_frameMs.size() << " frames, min " << minMs
+        << " ms, media " << avgMs << " ms, p99 " << p99Ms << " ms";
+    if (m_dropped > 0)
+        std::cout << " (" << m_dropped << " frame(s) descartado(s))";
+    std::cout << std::endl;
+
+    for (const auto& entry : m_scopeMs)
+    {
+        computeStats(entry.second, minMs, avgMs, p99Ms);
+        std::cout << "  " << entry.first << ": min " << minMs << " ms, media " << avgMs
+            << " ms, p99 " << p99Ms << " ms" << std::endl;
+    }
+}
+
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Profiler.h"
+
+// Profiler de GPU com queries GL_TIMESTAMP.
+//
+// Cada frame marca o início e o fim e cada escopo (passe ou grupo de draws)
+// grava dois timestamps. As queries ficam num anel de vários frames: o
+// resultado de um frame só é lido alguns frames depois, quando a GPU já
+// terminou, então a leitura nunca trava a CPU. Os tempos são convertidos para
+// o relógio do Profiler e aparecem na trilha "GPU" do mesmo trace da CPU.
+//
+//   gpu.beginFrame();
+//   { GPU_PROFILE_SCOPE(gpu, "Phong"); glDrawArrays(...); }
+//   gpu.endFrame();
+//
+// Sem ENABLE_PROFILER a classe vira um stub vazio.
+
+#ifdef ENABLE_PROFILER
+
+class GpuProfiler
+{
+public:
+    explicit GpuProfiler(unsigned latencyFrames = 4, unsigned maxScopesPerFrame = 64);
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    void begin(const char* name);
+    void end();
+
+    // Apaga as queries; chamar antes de destruir o contexto GL
+    void destroy();
+
+    // min/média/p99 do tempo de GPU por frame e média de cada escopo
+    void printStats() const;
+
+private:
+    struct Scope
+    {
+        const char* name;
+        unsigned beginQuery;
+        unsigned endQuery;
+        uint32_t depth;
+    };
+
+    struct Frame
+    {
+        std::vector<GLuint> queries;
+        std::vector<Scope> scopes;
+        unsigned used = 0;
+        bool pending = false;
+    };
+
+    unsigned allocQuery(Frame& frame);
+    void collect(Frame& frame);
+    void calibrate();
+
+    std::vector<Frame> m_frames;
+    unsigned m_current = 0;
+    std::vector<size_t> m_stack;
+    bool m_inFrame = false;
+
+    int64_t m_gpuToCpuNs = 0;
+    std::vector<float> m_frameMs;
+    std::vector<std::pair<const char*, std::vector<float>>> m_scopeMs;
+    unsigned m_dropped = 0;
+};
+
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler& profiler, const char* name) : m_profiler(profiler) { m_profiler.begin(name); }
+    ~GpuProfileScope() { m_profiler.end(); }
+
+private:
+    GpuProfiler& m_profiler;
+};
+
+#define GPU_PROFILE_SCOPE(profiler, name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope_, __LINE__)(profiler, name)
+
+#else
+
+class GpuProfiler
+{
+public:
+    explicit GpuProfiler(unsigned = 4, unsigned = 64) {}
+    void beginFrame() {}
+    void endFrame() {}
+    void begin(const char*) {}
+    void end() {}
+    void destroy() {}
+    void printStats() const {}
+};
+
+#define GPU_PROFILE_SCOPE(profiler, name) ((void)0)
+
+#endif
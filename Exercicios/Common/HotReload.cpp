@@ -0,0 +1,129 @@
+#include "HotReload.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Profiler.h"
+
+namespace fs = std::filesystem;
+
+static std::string normalizePath(const std::string& path)
+{
+    return fs::path(path).lexically_normal().generic_string();
+}
+
+HotReload::HotReload(const std::string& assetsDir, AssetLoader& loader, GLADloadproc loadProc)
+    : m_assetsDir(normalizePath(assetsDir)), m_loader(loader), m_watcher(m_assetsDir),
+    m_shaderCache("shader_cache", loadProc)
+{
+    if (m_watcher.isValid())
+        std::cout << "HotReload: observando " << m_assetsDir << std::endl;
+}
+
+std::string HotReload::resolveAssetsDir(const std::string& sourceDir, const std::string& fallbackDir)
+{
+    std::error_code ec;
+    if (!sourceDir.empty() && fs::is_directory(sourceDir, ec))
+        return sourceDir;
+    return fallbackDir;
+}
+
+bool HotReload::readTextFile(const std::string& path, std::string& text)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+std::string HotReload::path(const std::string& relative) const
+{
+    return normalizePath(m_assetsDir + "/" + relative);
+}
+
+void HotReload::watchProgram(GLuint* program, const std::string& name,
+    const std::string& vertexFile, const std::string& fragmentFile, ProgramCallback onSwap)
+{
+    m_programs.push_back({ program, name, path(vertexFile), path(fragmentFile), onSwap });
+}
+
+void HotReload::watchGeometry(Geometry* geometry, const std::string& objFile,
+    const std::string& textureFile, bool flipTexture)
+{
+    m_geometries.push_back({ geometry, path(objFile), textureFile.empty() ? "" : path(textureFile), flipTexture });
+}
+
+bool HotReload::update()
+{
+    PROFILE_SCOPE("HotReload");
+    std::vector<std::string> changedFiles = m_watcher.poll();
+    for (const std::string& changed : changedFiles)
+    {
+        for (WatchedProgram& watched : m_programs)
+        {
+            if (changed == watched.vertexPath || changed == watched.fragmentPath)
+                reloadProgram(watched);
+        }
+
+        for (WatchedGeometry& watched : m_geometries)
+        {
+            std::string texturePath = watched.texturePath.empty()
+                ? normalizePath(watched.geometry->textureFilePath) : watched.texturePath;
+            std::string mtlPath = fs::path(watched.objPath).replace_extension(".mtl").generic_string();
+            if (changed == watched.objPath || changed == texturePath || changed == mtlPath)
+                reloadGeometry(watched);
+        }
+    }
+
+    // Assets que terminaram de carregar são trocados aqui, entre dois frames
+    bool loaded = m_loader.update();
+    return loaded || !changedFiles.empty();
+}
+
+void HotReload::reloadProgram(WatchedProgram& watched)
+{
+    std::string vertexSource, fragmentSource;
+    if (!readTextFile(watched.vertexPath, vertexSource) || !readTextFile(watched.fragmentPath, fragmentSource))
+        return;
+
+    size_t index = m_shaderCache.request(watched.name, {
+        { GL_VERTEX_SHADER, vertexSource },
+        { GL_FRAGMENT_SHADER, fragmentSource }
+        });
+    m_shaderCache.build();
+
+    GLuint program = m_shaderCache.program(index);
+    if (program == 0)
+    {
+        std::cerr << "HotReload: " << watched.name << " nao compilou, mantendo a versao atual" << std::endl;
+        return;
+    }
+
+    if (watched.onSwap)
+        watched.onSwap(program);
+    if (*watched.program)
+        glDeleteProgram(*watched.program);
+    *watched.program = program;
+    std::cout << "HotReload: programa " << watched.name << " recarregado" << std::endl;
+}
+
+void HotReload::reloadGeometry(WatchedGeometry& watched)
+{
+    Geometry* target = watched.geometry;
+    std::string objPath = watched.objPath;
+    m_loader.loadGeometryAsync(watched.objPath, watched.texturePath, watched.flipTexture,
+        [target, objPath](Geometry& geometry)
+        {
+            destroyGeometry(*target);
+            *target = geometry;
+            std::cout << "HotReload: " << objPath << " recarregado" << std::endl;
+        });
+}
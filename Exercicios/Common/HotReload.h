@@ -0,0 +1,70 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "AssetLoader.h"
+#include "FileWatcher.h"
+#include "Geometry.h"
+#include "ShaderCache.h"
+
+// Recarrega shaders e assets quando os arquivos mudam, sem reiniciar o programa.
+//
+// update() deve ser chamado uma vez por frame, antes de desenhar: é ali que as
+// versões novas são trocadas pelas antigas, então um frame nunca mistura as
+// duas. Se um shader novo não compilar (ou um .obj não puder ser lido) a
+// versão atual continua em uso.
+class HotReload
+{
+public:
+    typedef std::function<void(GLuint)> ProgramCallback;
+
+    HotReload(const std::string& assetsDir, AssetLoader& loader, GLADloadproc loadProc);
+
+    // Diretório de assets preferido: o da árvore de código (para editar e ver
+    // o resultado sem rebuild), ou a cópia ao lado do executável
+    static std::string resolveAssetsDir(const std::string& sourceDir, const std::string& fallbackDir);
+    static bool readTextFile(const std::string& path, std::string& text);
+
+    // Caminhos relativos ao diretório de assets. onSwap recebe o programa novo
+    // para reconfigurar uniforms antes de ele entrar em uso.
+    void watchProgram(GLuint* program, const std::string& name,
+        const std::string& vertexFile, const std::string& fragmentFile, ProgramCallback onSwap);
+    void watchGeometry(Geometry* geometry, const std::string& objFile,
+        const std::string& textureFile, bool flipTexture);
+
+    // true se algum arquivo observado mudou ou um asset foi trocado (o
+    // frame atual não é mais o que está na tela)
+    bool update();
+
+    std::string path(const std::string& relative) const;
+
+private:
+    struct WatchedProgram
+    {
+        GLuint* program;
+        std::string name;
+        std::string vertexPath;
+        std::string fragmentPath;
+        ProgramCallback onSwap;
+    };
+
+    struct WatchedGeometry
+    {
+        Geometry* geometry;
+        std::string objPath;
+        std::string texturePath;
+        bool flipTexture;
+    };
+
+    void reloadProgram(WatchedProgram& watched);
+    void reloadGeometry(WatchedGeometry& watched);
+
+    std::string m_assetsDir;
+    AssetLoader& m_loader;
+    FileWatcher m_watcher;
+    ShaderCache m_shaderCache;
+    std::vector<WatchedProgram> m_programs;
+    std::vector<WatchedGeometry> m_geometries;
+};
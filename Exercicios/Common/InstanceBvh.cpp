@@ -0,0 +1,646 @@
+#include "InstanceBvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "Profiler.h"
+
+static const uint32_t NO_PARENT = 0xFFFFFFFFu;
+static const int SAH_BINS = 16;
+static const int STACK_SIZE = 128;
+
+namespace
+{
+    // Pilha das travessias: STACK_SIZE entradas fixas cobrem qualquer árvore
+    // razoável; uma árvore degenerada mais funda continua no heap em vez de
+    // perder nós
+    template <typename T>
+    class TraversalStack
+    {
+    public:
+        bool empty() const { return m_top == 0; }
+
+        void push(const T& value)
+        {
+            if (m_top < STACK_SIZE)
+                m_fixed[m_top] = value;
+            else
+                m_overflow.push_back(value);
+            m_top++;
+        }
+
+        T pop()
+        {
+            m_top--;
+            if (m_top < STACK_SIZE)
+                return m_fixed[m_top];
+            T value = m_overflow.back();
+            m_overflow.pop_back();
+            return value;
+        }
+
+    private:
+        T m_fixed[STACK_SIZE];
+        std::vector<T> m_overflow;
+        int m_top = 0;
+    };
+}
+
+float Aabb::surfaceArea() const
+{
+    if (isEmpty())
+        return 0.0f;
+    glm::vec3 e = max - min;
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+Aabb transformAabb(const glm::mat4& model, const Aabb& local)
+{
+    // Centro transformado + meia extensão pelos valores absolutos da parte 3x3
+    glm::vec3 center = glm::vec3(model * glm::vec4((local.min + local.max) * 0.5f, 1.0f));
+    glm::vec3 half = (local.max - local.min) * 0.5f;
+    glm::vec3 extent(0.0f);
+    for (int axis = 0; axis < 3; ++axis)
+        extent += glm::abs(glm::vec3(model[axis])) * half[axis];
+
+    Aabb box;
+    box.min = center - extent;
+    box.max = center + extent;
+    return box;
+}
+
+InstanceBvh::InstanceBvh(JobSystem* jobs, float rebuildThreshold)
+    : m_jobs(jobs), m_rebuildThreshold(rebuildThreshold)
+{
+}
+
+int32_t InstanceBvh::buildRecursive(std::vector<BuildNode>& nodes, uint32_t first, uint32_t count,
+    uint32_t taskCutoff, std::vector<BuildTask>* tasks)
+{
+    BuildNode node;
+    node.first = first;
+    node.count = count;
+    Aabb centroidBounds;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        node.bounds.grow(m_bounds[m_indices[i]]);
+        centroidBounds.grow(m_centroids[m_indices[i]]);
+    }
+
+    int32_t index = (int32_t)nodes.size();
+    nodes.push_back(node);
+
+    if (tasks && count <= taskCutoff && count > (uint32_t)MAX_LEAF_SIZE)
+    {
+        nodes[index].task = (int32_t)tasks->size();
+        tasks->push_back({ first, count, {} });
+        return index;
+    }
+    if (count == 1)
+        return index;
+
+    // SAH com caixas agrupadas em bins ao longo de cada eixo:
+    // custo = 1 (travessia) + (área_esq * n_esq + área_dir * n_dir) / área_pai
+    float parentArea = node.bounds.surfaceArea();
+    float bestCost = 1e30f;
+    int bestAxis = -1, bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.0f)
+            continue;
+
+        Aabb binBounds[SAH_BINS];
+        uint32_t binCount[SAH_BINS] = {};
+        float scale = SAH_BINS / extent;
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            uint32_t instance = m_indices[i];
+            int bin = std::min(SAH_BINS - 1, (int)((m_centroids[instance][axis] - centroidBounds.min[axis]) * scale));
+            binBounds[bin].grow(m_bounds[instance]);
+            binCount[bin]++;
+        }
+
+        float leftArea[SAH_BINS - 1];
+        uint32_t leftCount[SAH_BINS - 1];
+        Aabb accum;
+        uint32_t n = 0;
+        for (int split = 0; split < SAH_BINS - 1; ++split)
+        {
+            accum.grow(binBounds[split]);
+            n += binCount[split];
+            leftArea[split] = accum.surfaceArea();
+            leftCount[split] = n;
+        }
+
+        accum = Aabb();
+        n = 0;
+        for (int split = SAH_BINS - 2; split >= 0; --split)
+        {
+            accum.grow(binBounds[split + 1]);
+            n += binCount[split + 1];
+            if (leftCount[split] == 0 || n == 0)
+                continue;
+            float cost = 1.0f + (leftArea[split] * leftCount[split] + accum.surfaceArea() * n) / parentArea;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    // Folha se a divisão não compensa; acima de MAX_LEAF_SIZE divide de qualquer jeito
+    if (count <= (uint32_t)MAX_LEAF_SIZE && bestCost >= (float)count)
+        return index;
+
+    uint32_t mid = first + count / 2;
+    if (bestAxis >= 0)
+    {
+        float minCentroid = centroidBounds.min[bestAxis];
+        float scale = SAH_BINS / (centroidBounds.max[bestAxis] - minCentroid);
+        auto middle = std::partition(m_indices.begin() + first, m_indices.begin() + first + count,
+            [&](uint32_t instance)
+            {
+                int bin = std::min(SAH_BINS - 1, (int)((m_centroids[instance][bestAxis] - minCentroid) * scale));
+                return bin <= bestSplit;
+            });
+        uint32_t split = (uint32_t)(middle - m_indices.begin());
+        if (split > first && split < first + count)
+            mid = split;
+    }
+    else if (count <= (uint32_t)MAX_LEAF_SIZE)
+    {
+        return index;   // centróides iguais: nada a separar
+    }
+
+    int32_t left = buildRecursive(nodes, first, mid - first, taskCutoff, tasks);
+    int32_t right = buildRecursive(nodes, mid, first + count - mid, taskCutoff, tasks);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+uint32_t InstanceBvh::flatten(const std::vector<BuildNode>& nodes, int32_t index, const std::vector<BuildTask>& tasks,
+    uint32_t nodeIndex, uint32_t depth)
+{
+    const BuildNode& source = nodes[index];
+    if (source.task >= 0)
+        return flatten(tasks[source.task].nodes, 0, tasks, nodeIndex, depth);
+
+    m_nodes[nodeIndex].boundsMin = source.bounds.min;
+    m_nodes[nodeIndex].boundsMax = source.bounds.max;
+    m_stats.maxDepth = std::max(m_stats.maxDepth, depth);
+
+    if (source.left < 0)
+    {
+        m_nodes[nodeIndex].leftOrFirst = source.first;
+        m_nodes[nodeIndex].count = source.count;
+        for (uint32_t i = source.first; i < source.first + source.count; ++i)
+            m_leafOf[m_indices[i]] = nodeIndex;
+        m_stats.leaves++;
+        return nodeIndex;
+    }
+
+    // Irmãos sempre adjacentes e depois do pai: o refit pode andar de trás para frente
+    uint32_t left = (uint32_t)m_nodes.size();
+    m_nodes.resize(m_nodes.size() + 2);
+    m_parents[left] = m_parents[left + 1] = nodeIndex;
+    m_nodes[nodeIndex].leftOrFirst = left;
+    m_nodes[nodeIndex].count = 0;
+    flatten(nodes, source.left, tasks, left, depth + 1);
+    flatten(nodes, source.right, tasks, left + 1, depth + 1);
+    return nodeIndex;
+}
+
+void InstanceBvh::build(const std::vector<Aabb>& bounds)
+{
+    PROFILE_SCOPE("BvhBuild");
+    auto start = std::chrono::steady_clock::now();
+
+    m_bounds = bounds;
+    uint32_t count = (uint32_t)bounds.size();
+    m_centroids.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+        m_centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+    m_indices.resize(count);
+    std::iota(m_indices.begin(), m_indices.end(), 0u);
+    m_leafOf.assign(count, 0);
+    m_nodes.clear();
+    m_stats = BvhStats();
+
+    if (count > 0)
+    {
+        // Topo da árvore em série até as subárvores ficarem pequenas o bastante
+        // para dividir entre os workers; cada uma mexe só no seu trecho de m_indices
+        std::vector<BuildNode> top;
+        std::vector<BuildTask> tasks;
+        uint32_t cutoff = 0;
+        if (m_jobs && count >= 2048)
+            cutoff = std::max(512u, count / (m_jobs->getThreadCount() * 4));
+        int32_t root = buildRecursive(top, 0, count, cutoff, cutoff ? &tasks : nullptr);
+
+        auto buildTasks = [&](size_t begin, size_t end)
+            {
+                for (size_t t = begin; t < end; ++t)
+                    buildRecursive(tasks[t].nodes, tasks[t].first, tasks[t].count, 0, nullptr);
+            };
+        if (!tasks.empty())
+            m_jobs->parallelFor(tasks.size(), 1, buildTasks);
+
+        m_nodes.reserve((size_t)count * 2);
+        m_nodes.resize(1);
+        m_parents.assign((size_t)count * 2, NO_PARENT);
+        flatten(top, root, tasks, 0, 1);
+    }
+
+    m_stats.nodes = (uint32_t)m_nodes.size();
+    m_buildCost = m_currentCost = computeSahCost();
+    m_costDirty = false;
+    m_stats.sahCost = m_buildCost;
+    m_stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void InstanceBvh::refitNode(uint32_t index)
+{
+    Node& node = m_nodes[index];
+    Aabb box;
+    if (node.count > 0)
+    {
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            box.grow(m_bounds[m_indices[i]]);
+    }
+    else
+    {
+        const Node& left = m_nodes[node.leftOrFirst];
+        const Node& right = m_nodes[node.leftOrFirst + 1];
+        box.min = glm::min(left.boundsMin, right.boundsMin);
+        box.max = glm::max(left.boundsMax, right.boundsMax);
+    }
+    node.boundsMin = box.min;
+    node.boundsMax = box.max;
+}
+
+void InstanceBvh::update(uint32_t instance, const Aabb& bounds)
+{
+    if (instance >= m_bounds.size() || m_nodes.empty())
+        return;
+    if (bounds.min == m_bounds[instance].min && bounds.max == m_bounds[instance].max)
+        return;
+
+    m_bounds[instance] = bounds;
+    for (uint32_t node = m_leafOf[instance]; node != NO_PARENT; node = m_parents[node])
+    {
+        glm::vec3 oldMin = m_nodes[node].boundsMin, oldMax = m_nodes[node].boundsMax;
+        refitNode(node);
+        if (m_nodes[node].boundsMin == oldMin && m_nodes[node].boundsMax == oldMax)
+            break;
+    }
+    m_costDirty = true;
+}
+
+void InstanceBvh::refit(const std::vector<Aabb>& bounds)
+{
+    PROFILE_SCOPE("BvhRefit");
+    if (bounds.size() != m_bounds.size())
+    {
+        build(bounds);
+        return;
+    }
+
+    m_bounds = bounds;
+    for (size_t i = m_nodes.size(); i-- > 0;)
+        refitNode((uint32_t)i);
+    m_costDirty = true;
+}
+
+float InstanceBvh::computeSahCost() const
+{
+    if (m_nodes.empty())
+        return 0.0f;
+
+    auto area = [](const Node& node)
+        {
+            Aabb box;
+            box.min = node.boundsMin;
+            box.max = node.boundsMax;
+            return box.surfaceArea();
+        };
+
+    float rootArea = std::max(area(m_nodes[0]), 1e-12f);
+    float cost = 0.0f;
+    for (const Node& node : m_nodes)
+        cost += area(node) * (node.count > 0 ? (float)node.count : 1.0f);
+    return cost / rootArea;
+}
+
+bool InstanceBvh::needsRebuild() const
+{
+    if (m_costDirty)
+    {
+        m_currentCost = computeSahCost();
+        m_costDirty = false;
+    }
+    return m_currentCost > m_buildCost * m_rebuildThreshold;
+}
+
+// Entrada do raio na caixa, ou 1e30 se não acerta antes de tMax
+static float slab(const glm::vec3& origin, const glm::vec3& invDir, const glm::vec3& boxMin, const glm::vec3& boxMax,
+    float tMax)
+{
+    glm::vec3 t0 = (boxMin - origin) * invDir;
+    glm::vec3 t1 = (boxMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit ? enter : 1e30f;
+}
+
+BvhHit InstanceBvh::intersectRay(const BvhRay& ray, const std::function<float(uint32_t, const BvhRay&)>& exact) const
+{
+    BvhHit hit;
+    hit.t = ray.tMax;
+    if (m_nodes.empty())
+    {
+        hit.t = 1e30f;
+        return hit;
+    }
+
+    glm::vec3 invDir = 1.0f / ray.direction;
+    TraversalStack<uint32_t> stack;
+    if (slab(ray.origin, invDir, m_nodes[0].boundsMin, m_nodes[0].boundsMax, hit.t) < 1e30f)
+        stack.push(0);
+
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.pop()];
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                uint32_t instance = m_indices[i];
+                float t = slab(ray.origin, invDir, m_bounds[instance].min, m_bounds[instance].max, hit.t);
+                if (t >= hit.t)
+                    continue;
+                if (exact)
+                    t = exact(instance, ray);
+                if (t >= 0.0f && t < hit.t)
+                {
+                    hit.t = t;
+                    hit.instance = instance;
+                }
+            }
+            continue;
+        }
+
+        // O filho mais próximo sai primeiro da pilha
+        uint32_t left = node.leftOrFirst, right = left + 1;
+        float tLeft = slab(ray.origin, invDir, m_nodes[left].boundsMin, m_nodes[left].boundsMax, hit.t);
+        float tRight = slab(ray.origin, invDir, m_nodes[right].boundsMin, m_nodes[right].boundsMax, hit.t);
+        if (tLeft > tRight)
+        {
+            std::swap(left, right);
+            std::swap(tLeft, tRight);
+        }
+        if (tRight < hit.t)
+            stack.push(right);
+        if (tLeft < hit.t)
+            stack.push(left);
+    }
+
+    if (hit.instance == BvhHit::NONE)
+        hit.t = 1e30f;
+    return hit;
+}
+
+void InstanceBvh::intersectPacket(const BvhRay* rays, BvhHit* hits, int count) const
+{
+    // Raios em SoA; as pistas sem raio ficam com closest negativo e nunca acertam
+    alignas(32) float ox[PACKET_SIZE], oy[PACKET_SIZE], oz[PACKET_SIZE];
+    alignas(32) float ix[PACKET_SIZE], iy[PACKET_SIZE], iz[PACKET_SIZE];
+    alignas(32) float closest[PACKET_SIZE];
+    uint32_t instanceHit[PACKET_SIZE];
+    for (int lane = 0; lane < PACKET_SIZE; ++lane)
+    {
+        const BvhRay& ray = rays[lane < count ? lane : 0];
+        ox[lane] = ray.origin.x;
+        oy[lane] = ray.origin.y;
+        oz[lane] = ray.origin.z;
+        ix[lane] = 1.0f / ray.direction.x;
+        iy[lane] = 1.0f / ray.direction.y;
+        iz[lane] = 1.0f / ray.direction.z;
+        closest[lane] = lane < count ? ray.tMax : -1.0f;
+        instanceHit[lane] = BvhHit::NONE;
+    }
+
+    // Os 8 raios contra uma caixa, sem desvios (vetoriza); devolve a máscara de acertos
+    auto testBox = [&](const glm::vec3& boxMin, const glm::vec3& boxMax, float* enter)
+        {
+            unsigned mask = 0;
+            for (int lane = 0; lane < PACKET_SIZE; ++lane)
+            {
+                float tx0 = (boxMin.x - ox[lane]) * ix[lane], tx1 = (boxMax.x - ox[lane]) * ix[lane];
+                float ty0 = (boxMin.y - oy[lane]) * iy[lane], ty1 = (boxMax.y - oy[lane]) * iy[lane];
+                float tz0 = (boxMin.z - oz[lane]) * iz[lane], tz1 = (boxMax.z - oz[lane]) * iz[lane];
+                float tNear = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+                float tFar = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), closest[lane]));
+                enter[lane] = tNear;
+                mask |= (unsigned)(tNear <= tFar && tNear < closest[lane]) << lane;
+            }
+            return mask;
+        };
+
+    alignas(32) float enter[PACKET_SIZE], enterRight[PACKET_SIZE];
+    auto nearest = [](unsigned mask, const float* t)
+        {
+            float best = 1e30f;
+            for (int lane = 0; lane < PACKET_SIZE; ++lane)
+                if (mask & (1u << lane))
+                    best = std::min(best, t[lane]);
+            return best;
+        };
+
+    TraversalStack<uint32_t> stack;
+    if (testBox(m_nodes[0].boundsMin, m_nodes[0].boundsMax, enter))
+        stack.push(0);
+
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.pop()];
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                uint32_t instance = m_indices[i];
+                unsigned mask = testBox(m_bounds[instance].min, m_bounds[instance].max, enter);
+                for (int lane = 0; lane < PACKET_SIZE; ++lane)
+                    if (mask & (1u << lane))
+                    {
+                        closest[lane] = enter[lane];
+                        instanceHit[lane] = instance;
+                    }
+            }
+            continue;
+        }
+
+        // Filhos testados aqui; o mais próximo para o pacote sai primeiro da pilha
+        uint32_t left = node.leftOrFirst, right = left + 1;
+        unsigned maskLeft = testBox(m_nodes[left].boundsMin, m_nodes[left].boundsMax, enter);
+        unsigned maskRight = testBox(m_nodes[right].boundsMin, m_nodes[right].boundsMax, enterRight);
+        bool leftFirst = nearest(maskLeft, enter) <= nearest(maskRight, enterRight);
+        if (maskRight && leftFirst)
+            stack.push(right);
+        if (maskLeft)
+            stack.push(left);
+        if (maskRight && !leftFirst)
+            stack.push(right);
+    }
+
+    for (int lane = 0; lane < count; ++lane)
+    {
+        hits[lane].instance = instanceHit[lane];
+        hits[lane].t = instanceHit[lane] == BvhHit::NONE ? 1e30f : closest[lane];
+    }
+}
+
+void InstanceBvh::intersectRays(const std::vector<BvhRay>& rays, std::vector<BvhHit>& hits) const
+{
+    PROFILE_SCOPE("BvhRays");
+    hits.assign(rays.size(), BvhHit());
+    if (m_nodes.empty())
+        return;
+
+    size_t packets = (rays.size() + PACKET_SIZE - 1) / PACKET_SIZE;
+    auto trace = [&](size_t begin, size_t end)
+        {
+            for (size_t p = begin; p < end; ++p)
+            {
+                size_t first = p * PACKET_SIZE;
+                intersectPacket(&rays[first], &hits[first], (int)std::min<size_t>(PACKET_SIZE, rays.size() - first));
+            }
+        };
+
+    if (m_jobs)
+        m_jobs->parallelFor(packets, 64, trace);
+    else
+        trace(0, packets);
+}
+
+void InstanceBvh::queryFrustum(const glm::mat4& viewProjection, std::vector<uint32_t>& instances) const
+{
+    queryFrustums(&viewProjection, 1, &instances);
+}
+
+void InstanceBvh::queryFrustums(const glm::mat4* viewProjections, size_t count, std::vector<uint32_t>* instances) const
+{
+    PROFILE_SCOPE("BvhFrustum");
+    count = std::min<size_t>(count, MAX_FRUSTUMS);
+    for (size_t f = 0; f < count; ++f)
+        instances[f].clear();
+    if (m_nodes.empty() || count == 0)
+        return;
+
+    // Planos (Gribb/Hartmann) em SoA: [frustum * 6 + plano]; dentro = n.p + d >= 0
+    alignas(32) float nx[MAX_FRUSTUMS * 6], ny[MAX_FRUSTUMS * 6], nz[MAX_FRUSTUMS * 6], nd[MAX_FRUSTUMS * 6];
+    for (size_t f = 0; f < count; ++f)
+    {
+        const glm::mat4& m = viewProjections[f];
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+        glm::vec4 planes[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+        for (int p = 0; p < 6; ++p)
+        {
+            float length = glm::length(glm::vec3(planes[p]));
+            glm::vec4 plane = planes[p] / (length > 0.0f ? length : 1.0f);
+            nx[f * 6 + p] = plane.x;
+            ny[f * 6 + p] = plane.y;
+            nz[f * 6 + p] = plane.z;
+            nd[f * 6 + p] = plane.w;
+        }
+    }
+
+    // Para cada frustum ativo: 0 = fora, 1 = cruza, 2 = inteiro dentro
+    auto classify = [&](const glm::vec3& boxMin, const glm::vec3& boxMax, unsigned active, int* result)
+        {
+            glm::vec3 center = (boxMin + boxMax) * 0.5f, half = (boxMax - boxMin) * 0.5f;
+            for (size_t f = 0; f < count; ++f)
+            {
+                if (!(active & (1u << f)))
+                    continue;
+                bool outside = false, inside = true;
+                for (int p = 0; p < 6; ++p)
+                {
+                    size_t k = f * 6 + p;
+                    float distance = nx[k] * center.x + ny[k] * center.y + nz[k] * center.z + nd[k];
+                    float radius = std::fabs(nx[k]) * half.x + std::fabs(ny[k]) * half.y + std::fabs(nz[k]) * half.z;
+                    // Folga proporcional ao d do plano: caixa encostada no plano far não some por arredondamento
+                    outside |= distance < -radius - 1e-4f * (std::fabs(nd[k]) + 1.0f);
+                    inside &= distance >= radius;
+                }
+                result[f] = outside ? 0 : (inside ? 2 : 1);
+            }
+        };
+
+    // Subárvore inteira dentro: as instâncias são um trecho contínuo de m_indices
+    auto appendSubtree = [&](uint32_t index, size_t f)
+        {
+            uint32_t first = index, last = index;
+            while (m_nodes[first].count == 0)
+                first = m_nodes[first].leftOrFirst;
+            while (m_nodes[last].count == 0)
+                last = m_nodes[last].leftOrFirst + 1;
+            uint32_t begin = m_nodes[first].leftOrFirst, end = m_nodes[last].leftOrFirst + m_nodes[last].count;
+            instances[f].insert(instances[f].end(), m_indices.begin() + begin, m_indices.begin() + end);
+        };
+
+    struct Entry { uint32_t node; unsigned active; };
+    TraversalStack<Entry> stack;
+    stack.push({ 0, (1u << count) - 1 });
+
+    int result[MAX_FRUSTUMS];
+    while (!stack.empty())
+    {
+        Entry entry = stack.pop();
+        const Node& node = m_nodes[entry.node];
+        classify(node.boundsMin, node.boundsMax, entry.active, result);
+
+        unsigned partial = 0;
+        for (size_t f = 0; f < count; ++f)
+        {
+            if (!(entry.active & (1u << f)) || result[f] == 0)
+                continue;
+            if (result[f] == 2)
+                appendSubtree(entry.node, f);
+            else
+                partial |= 1u << f;
+        }
+        if (!partial)
+            continue;
+
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                uint32_t instance = m_indices[i];
+                classify(m_bounds[instance].min, m_bounds[instance].max, partial, result);
+                for (size_t f = 0; f < count; ++f)
+                    if ((partial & (1u << f)) && result[f] != 0)
+                        instances[f].push_back(instance);
+            }
+        }
+        else
+        {
+            stack.push({ node.leftOrFirst + 1, partial });
+            stack.push({ node.leftOrFirst, partial });
+        }
+    }
+
+    for (size_t f = 0; f < count; ++f)
+        std::sort(instances[f].begin(), instances[f].end());
+}
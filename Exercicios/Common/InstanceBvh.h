@@ -0,0 +1,158 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+
+// BVH sobre as caixas das instâncias de uma cena (cubos do Modulo2, objetos
+// do Modulo5...) para picking, culling e consultas de raio.
+//
+//   bvh.build(bounds);                      // SAH, subárvores em paralelo
+//   bvh.update(i, newBounds);               // instância mexeu: refit só do caminho até a raiz
+//   if (bvh.needsRebuild()) bvh.build(bounds);
+//   BvhHit hit = bvh.intersectRay(ray);
+//   bvh.queryFrustum(projection * view, visible);
+//
+// Os nós ficam num vetor plano de 32 bytes alinhados, com os dois filhos de um
+// nó lado a lado (o mesmo cache line de 64 bytes). O refit mantém a topologia e
+// só aumenta/diminui as caixas; quando o custo SAH da árvore refeita passa de
+// rebuildThreshold vezes o custo logo após o build, needsRebuild() avisa.
+
+struct Aabb
+{
+    glm::vec3 min = glm::vec3(1e30f);
+    glm::vec3 max = glm::vec3(-1e30f);
+
+    void grow(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); }
+    void grow(const Aabb& box) { min = glm::min(min, box.min); max = glm::max(max, box.max); }
+    bool isEmpty() const { return min.x > max.x; }
+    float surfaceArea() const;
+};
+
+// Caixa alinhada aos eixos que contém "local" transformada por model
+Aabb transformAabb(const glm::mat4& model, const Aabb& local);
+
+struct BvhRay
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float tMax = 1e30f;
+};
+
+struct BvhHit
+{
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    uint32_t instance = NONE;
+    float t = 1e30f;
+};
+
+struct BvhStats
+{
+    uint32_t nodes = 0;
+    uint32_t leaves = 0;
+    uint32_t maxDepth = 0;
+    float sahCost = 0.0f;
+    double buildMs = 0.0;
+};
+
+class InstanceBvh
+{
+public:
+    // Sem JobSystem o build e os lotes de raios rodam na thread que chama
+    explicit InstanceBvh(JobSystem* jobs = nullptr, float rebuildThreshold = 1.5f);
+
+    void build(const std::vector<Aabb>& bounds);
+
+    // Troca a caixa de uma instância e corrige os pais até a raiz (para no
+    // primeiro nó que não mudou)
+    void update(uint32_t instance, const Aabb& bounds);
+
+    // Troca todas as caixas e corrige a árvore inteira de baixo para cima
+    void refit(const std::vector<Aabb>& bounds);
+
+    bool needsRebuild() const;
+
+    // Instância mais próxima atingida. Sem "exact" vale a interseção com a
+    // caixa; com ele a caixa só filtra e exact(instância, raio) devolve o t do
+    // acerto de verdade (negativo = errou).
+    BvhHit intersectRay(const BvhRay& ray,
+        const std::function<float(uint32_t, const BvhRay&)>& exact = nullptr) const;
+
+    // Lote de raios contra as caixas: pacotes de 8 raios descem juntos pela
+    // árvore, cada pacote num job
+    void intersectRays(const std::vector<BvhRay>& rays, std::vector<BvhHit>& hits) const;
+
+    // Instâncias cuja caixa toca o frustum de viewProjection (em ordem crescente)
+    void queryFrustum(const glm::mat4& viewProjection, std::vector<uint32_t>& instances) const;
+
+    // Vários frustums (cascatas, faces de cubemap...) numa única descida;
+    // até MAX_FRUSTUMS por chamada
+    void queryFrustums(const glm::mat4* viewProjections, size_t count, std::vector<uint32_t>* instances) const;
+
+    uint32_t getInstanceCount() const { return (uint32_t)m_bounds.size(); }
+    const Aabb& getBounds(uint32_t instance) const { return m_bounds[instance]; }
+    const BvhStats& getStats() const { return m_stats; }
+
+    // Árvore achatada, para quem monta outra estrutura em cima dela (TriangleBvh).
+    // Raiz em 0; folhas apontam para trechos de getLeafOrder().
+    struct alignas(32) Node
+    {
+        glm::vec3 boundsMin;
+        uint32_t leftOrFirst;   // interno: filho esquerdo (o direito é +1); folha: início em getLeafOrder()
+        glm::vec3 boundsMax;
+        uint32_t count;         // instâncias da folha; 0 = nó interno
+    };
+
+    const std::vector<Node>& getNodes() const { return m_nodes; }
+    const std::vector<uint32_t>& getLeafOrder() const { return m_indices; }
+
+    static const int MAX_LEAF_SIZE = 4;
+    static const int PACKET_SIZE = 8;
+    static const int MAX_FRUSTUMS = 8;
+
+private:
+    // Nó durante o build; as subárvores grandes são montadas em paralelo em
+    // vetores próprios e depois copiadas para m_nodes em profundidade
+    struct BuildNode
+    {
+        Aabb bounds;
+        uint32_t first;
+        uint32_t count;
+        int32_t left = -1;
+        int32_t right = -1;
+        int32_t task = -1;      // >= 0: subárvore montada pelo job "task"
+    };
+
+    struct BuildTask
+    {
+        uint32_t first;
+        uint32_t count;
+        std::vector<BuildNode> nodes;
+    };
+
+    int32_t buildRecursive(std::vector<BuildNode>& nodes, uint32_t first, uint32_t count, uint32_t taskCutoff,
+        std::vector<BuildTask>* tasks);
+    uint32_t flatten(const std::vector<BuildNode>& nodes, int32_t index, const std::vector<BuildTask>& tasks,
+        uint32_t nodeIndex, uint32_t depth);
+    void refitNode(uint32_t node);
+    float computeSahCost() const;
+    void intersectPacket(const BvhRay* rays, BvhHit* hits, int count) const;
+
+    JobSystem* m_jobs;
+    float m_rebuildThreshold;
+
+    std::vector<Aabb> m_bounds;
+    std::vector<glm::vec3> m_centroids;
+    std::vector<uint32_t> m_indices;        // instâncias na ordem das folhas
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_leafOf;         // folha de cada instância
+
+    float m_buildCost = 0.0f;
+    mutable float m_currentCost = 0.0f;
+    mutable bool m_costDirty = false;
+    BvhStats m_stats;
+};
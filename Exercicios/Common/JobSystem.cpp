@@ -0,0 +1,118 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <memory>
+
+JobSystem::JobSystem(unsigned threadCount)
+{
+    if (threadCount == 0)
+    {
+        unsigned cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores - 1 : 1;
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_workers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void JobSystem::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(job));
+        m_pending++;
+    }
+    m_wake.notify_one();
+}
+
+void JobSystem::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+void JobSystem::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_stop && m_queue.empty())
+                return;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending--;
+            if (m_pending == 0)
+                m_idle.notify_all();
+        }
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+    if (count == 0)
+        return;
+    grain = std::max<size_t>(grain, 1);
+
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1)
+    {
+        fn(0, count);
+        return;
+    }
+
+    // Os blocos são distribuídos por um contador atômico; cada participante
+    // pega o próximo bloco livre até acabarem
+    struct Shared
+    {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto shared = std::make_shared<Shared>();
+
+    auto run = [shared, &fn, count, grain, chunks]()
+        {
+            size_t chunk;
+            while ((chunk = shared->next.fetch_add(1)) < chunks)
+            {
+                size_t begin = chunk * grain;
+                size_t end = std::min(begin + grain, count);
+                fn(begin, end);
+                if (shared->done.fetch_add(1) + 1 == chunks)
+                {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    shared->finished.notify_all();
+                }
+            }
+        };
+
+    size_t helpers = std::min<size_t>(m_workers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        submit(run);
+
+    run();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&] { return shared->done.load() == chunks; });
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads de trabalho. Usado para carregar assets em segundo plano e
+// para dividir laços pesados (parallelFor) entre os núcleos.
+class JobSystem
+{
+public:
+    // threadCount = 0 usa (núcleos - 1) workers, no mínimo 1
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Enfileira um job assíncrono
+    void submit(std::function<void()> job);
+
+    // Espera todos os jobs enfileirados com submit() terminarem
+    void wait();
+
+    // Divide [0, count) em blocos de "grain" itens e executa fn(begin, end) em
+    // paralelo. A thread que chama também trabalha e só retorna no fim.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+    // Workers + a thread que chama parallelFor
+    unsigned getThreadCount() const { return (unsigned)m_workers.size() + 1; }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    size_t m_pending = 0;
+    bool m_stop = false;
+};
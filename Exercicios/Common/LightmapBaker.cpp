@@ -0,0 +1,262 @@
+#include "LightmapBaker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "Profiler.h"
+
+LightmapBaker::LightmapBaker(JobSystem* jobs, const DiskCache* cache) : m_jobs(jobs), m_cache(cache)
+{
+}
+
+void LightmapBaker::setScene(const CpuScene& scene)
+{
+    m_scene = &scene;
+    m_tracer.reset();
+}
+
+uint64_t LightmapBaker::cacheKey(size_t meshIndex, const LightmapSettings& settings) const
+{
+    uint64_t key = hashLighting(*m_scene, meshIndex, DiskCache::hash("lightmap1"));
+    key = DiskCache::hash(&settings.size, sizeof(settings.size), key);
+    key = DiskCache::hash(&settings.aoSamples, sizeof(settings.aoSamples), key);
+    key = DiskCache::hash(&settings.aoDistance, sizeof(settings.aoDistance), key);
+    key = DiskCache::hash(&settings.indirectSamples, sizeof(settings.indirectSamples), key);
+    key = DiskCache::hash(&settings.maxBounces, sizeof(settings.maxBounces), key);
+    key = DiskCache::hash(&settings.dilation, sizeof(settings.dilation), key);
+    key = DiskCache::hash(&settings.seed, sizeof(settings.seed), key);
+    return key;
+}
+
+void LightmapBaker::rasterize(const SceneMesh& sceneMesh, int size, std::vector<Texel>& texels,
+    std::vector<uint8_t>& coverage)
+{
+    PROFILE_SCOPE("LightmapRaster");
+    const MeshData& mesh = *sceneMesh.mesh;
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(sceneMesh.model)));
+
+    // Texel -> posição em "texels" (o último triângulo que cobriu o centro)
+    std::vector<uint32_t> slot((size_t)size * size, 0xFFFFFFFFu);
+    for (size_t t = 0; t + 2 < mesh.positions.size(); t += 3)
+    {
+        glm::vec2 a = mesh.uvs[t] * (float)size;
+        glm::vec2 b = mesh.uvs[t + 1] * (float)size;
+        glm::vec2 c = mesh.uvs[t + 2] * (float)size;
+        float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+        if (std::fabs(area) < 1e-12f)
+            continue;
+
+        int minX = std::max((int)std::floor(std::min({ a.x, b.x, c.x })), 0);
+        int minY = std::max((int)std::floor(std::min({ a.y, b.y, c.y })), 0);
+        int maxX = std::min((int)std::ceil(std::max({ a.x, b.x, c.x })), size - 1);
+        int maxY = std::min((int)std::ceil(std::max({ a.y, b.y, c.y })), size - 1);
+
+        for (int y = minY; y <= maxY; ++y)
+            for (int x = minX; x <= maxX; ++x)
+            {
+                // Baricêntricas do centro do texel; o sinal da área aceita os dois sentidos
+                glm::vec2 p(x + 0.5f, y + 0.5f);
+                float w1 = ((p.x - a.x) * (c.y - a.y) - (c.x - a.x) * (p.y - a.y)) / area;
+                float w2 = ((b.x - a.x) * (p.y - a.y) - (p.x - a.x) * (b.y - a.y)) / area;
+                float w0 = 1.0f - w1 - w2;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                    continue;
+
+                glm::vec3 local = w0 * mesh.positions[t] + w1 * mesh.positions[t + 1] + w2 * mesh.positions[t + 2];
+                glm::vec3 normal = w0 * mesh.normals[t] + w1 * mesh.normals[t + 1] + w2 * mesh.normals[t + 2];
+
+                Texel texel;
+                texel.index = (uint32_t)(y * size + x);
+                texel.position = glm::vec3(sceneMesh.model * glm::vec4(local, 1.0f));
+                texel.normal = normalMatrix * normal;
+                float length = glm::length(texel.normal);
+                texel.normal = length > 0.0f ? texel.normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+                uint32_t& s = slot[texel.index];
+                if (s == 0xFFFFFFFFu)
+                {
+                    s = (uint32_t)texels.size();
+                    texels.push_back(texel);
+                }
+                else
+                {
+                    texels[s] = texel;
+                }
+                coverage[texel.index] = (uint8_t)std::min(coverage[texel.index] + 1, 255);
+            }
+    }
+}
+
+void LightmapBaker::dilate(Lightmap& lightmap, std::vector<uint8_t>& coverage, int passes)
+{
+    int width = lightmap.width, height = lightmap.height;
+    std::vector<uint8_t> next;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        next = coverage;
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+            {
+                size_t index = (size_t)y * width + x;
+                if (coverage[index])
+                    continue;
+
+                // Média dos vizinhos (8) já preenchidos
+                glm::vec3 sum(0.0f);
+                int count = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        int nx = x + dx, ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+                            continue;
+                        size_t neighbor = (size_t)ny * width + nx;
+                        if (coverage[neighbor])
+                        {
+                            sum += lightmap.texels[neighbor];
+                            count++;
+                        }
+                    }
+                if (count == 0)
+                    continue;
+                lightmap.texels[index] = sum / (float)count;
+                next[index] = 1;
+                m_stats.dilated++;
+            }
+        coverage.swap(next);
+    }
+}
+
+bool LightmapBaker::bake(size_t meshIndex, const LightmapSettings& settings, Lightmap& lightmap)
+{
+    PROFILE_SCOPE("LightmapBake");
+    auto start = std::chrono::high_resolution_clock::now();
+    auto elapsedMs = [&]()
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+    m_stats = LightmapStats();
+    m_stats.threads = m_jobs ? m_jobs->getThreadCount() : 1;
+    if (!m_scene || meshIndex >= m_scene->meshes.size() || settings.size <= 0)
+        return false;
+
+    const SceneMesh& sceneMesh = m_scene->meshes[meshIndex];
+    if (sceneMesh.mesh->uvs.size() != sceneMesh.mesh->positions.size() ||
+        sceneMesh.mesh->normals.size() != sceneMesh.mesh->positions.size())
+        return false;
+
+    int size = settings.size;
+    lightmap.width = lightmap.height = size;
+    lightmap.texels.assign((size_t)size * size, glm::vec3(0.0f));
+
+    uint64_t key = 0;
+    if (m_cache)
+    {
+        key = cacheKey(meshIndex, settings);
+        std::vector<char> data;
+        if (m_cache->read(key, data) && data.size() == lightmap.texels.size() * sizeof(glm::vec3))
+        {
+            memcpy(lightmap.texels.data(), data.data(), data.size());
+            m_stats.cached = true;
+            m_stats.bakeMs = elapsedMs();
+            return true;
+        }
+    }
+
+    std::vector<Texel> texels;
+    std::vector<uint8_t> coverage((size_t)size * size, 0);
+    rasterize(sceneMesh, size, texels, coverage);
+    m_stats.texels = (uint32_t)texels.size();
+    m_stats.overlapping = (uint32_t)std::count_if(coverage.begin(), coverage.end(), [](uint8_t c) { return c > 1; });
+    m_stats.rasterMs = elapsedMs();
+
+    if (!m_tracer)
+    {
+        m_tracer = std::make_unique<RayTracer>(m_jobs);
+        m_tracer->setScene(*m_scene);
+    }
+
+    const SceneMaterial& material = sceneMesh.material;
+    glm::vec3 ambient = material.ka * (m_scene->lights.empty() ? glm::vec3(1.0f) : m_scene->lights[0].color);
+    const RayTracer& tracer = *m_tracer;
+
+    auto run = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Texel& texel = texels[i];
+
+                // Semente pelo texel: o mesmo bake sempre dá o mesmo lightmap
+                uint32_t seed = settings.seed * 0x9E3779B9u + texel.index * 0x85EBCA6Bu;
+                float occlusion = settings.aoSamples > 0
+                    ? tracer.ambientOcclusion(texel.position, texel.normal, settings.aoSamples, settings.aoDistance, seed)
+                    : 1.0f;
+                glm::vec3 irradiance = tracer.directLight(texel.position, texel.normal);
+                if (settings.indirectSamples > 0)
+                    irradiance += tracer.indirectLight(texel.position, texel.normal, settings.indirectSamples,
+                        settings.maxBounces, seed ^ 0x5bd1e995u);
+
+                lightmap.texels[texel.index] = ambient * occlusion + material.kd * irradiance;
+            }
+        };
+
+    if (m_jobs)
+        m_jobs->parallelFor(texels.size(), 64, run);
+    else
+        run(0, texels.size());
+
+    coverage.assign(coverage.size(), 0);
+    for (const Texel& texel : texels)
+        coverage[texel.index] = 1;
+    dilate(lightmap, coverage, settings.dilation);
+
+    if (m_cache)
+        m_cache->write(key, lightmap.texels.data(), lightmap.texels.size() * sizeof(glm::vec3));
+
+    m_stats.rays = (uint64_t)texels.size() * (m_scene->lights.size() + settings.aoSamples + settings.indirectSamples);
+    m_stats.bakeMs = elapsedMs();
+    return true;
+}
+
+void LightmapBaker::printStats() const
+{
+    if (m_stats.cached)
+    {
+        std::cout << "Lightmap: lido do cache em " << m_stats.bakeMs << " ms" << std::endl;
+        return;
+    }
+
+    std::cout << "Lightmap: " << m_stats.texels << " texels (" << m_stats.overlapping << " com UV sobreposta, "
+        << m_stats.dilated << " dilatados), " << m_stats.rays << " raios em " << m_stats.bakeMs << " ms com "
+        << m_stats.threads << " threads (rasterizacao " << m_stats.rasterMs << " ms)" << std::endl;
+}
+
+bool writeHdr(const std::string& path, const Lightmap& lightmap)
+{
+    std::vector<glm::vec3> flipped(lightmap.texels.size());
+    for (int y = 0; y < lightmap.height; ++y)
+        std::copy_n(&lightmap.texels[(size_t)(lightmap.height - 1 - y) * lightmap.width], lightmap.width,
+            &flipped[(size_t)y * lightmap.width]);
+    return writeHdr(path, flipped, lightmap.width, lightmap.height);
+}
+
+GLuint uploadLightmap(const Lightmap& lightmap)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, lightmap.width, lightmap.height, 0, GL_RGB, GL_FLOAT,
+        lightmap.texels.data());
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texID;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "CpuScene.h"
+#include "DiskCache.h"
+#include "JobSystem.h"
+#include "RayTracer.h"
+
+// Lightmap HDR assado no espaço de UV da própria malha (o .obj já traz as UVs).
+//
+//   LightmapBaker baker(&jobs, &cache);     // cache opcional (DiskCache)
+//   baker.setScene(scene);                  // mesma CpuScene do RayTracer
+//   Lightmap lightmap;
+//   baker.bake(0, settings, lightmap);      // scene.meshes[0] na pose do bake
+//   GLuint texture = uploadLightmap(lightmap);
+//   writeHdr("lightmap.hdr", lightmap);
+//
+// Cada triângulo é rasterizado nas suas UVs: o centro de cada texel coberto
+// vira um ponto de mundo (posição e normal interpoladas), onde o RayTracer
+// soma a luz direta com sombras, a indireta difusa (path tracing) e a
+// oclusão ambiente do termo ka, no mesmo formato do VertexBaker:
+//   ka * luz * AO + kd * (direta + indireta).
+// O shader lightmap.fs só multiplica pelo albedo da textura. Os texels são
+// divididos entre os workers do JobSystem, então o tempo cai com o número de
+// núcleos. Depois, "dilation" passadas espalham a borda de cada ilha de UV
+// para os texels vazios em volta, para o filtro bilinear não puxar o fundo
+// preto nas costuras.
+//
+// UVs sobrepostas (partes espelhadas que dividem a mesma área da textura)
+// ficam com a luz do último triângulo; getStats().overlapping conta esses texels.
+
+struct LightmapSettings
+{
+    int size = 256;             // size x size texels
+    int aoSamples = 32;
+    float aoDistance = 0.5f;    // em unidades de mundo
+    int indirectSamples = 32;   // 0: só luz direta
+    int maxBounces = 2;
+    int dilation = 4;
+    uint32_t seed = 1;
+};
+
+// Linha 0 = v = 0, como o glTexImage2D (t = v)
+struct Lightmap
+{
+    int width = 0;
+    int height = 0;
+    std::vector<glm::vec3> texels;
+};
+
+struct LightmapStats
+{
+    uint32_t texels = 0;        // cobertos por algum triângulo
+    uint32_t overlapping = 0;   // cobertos por mais de um
+    uint32_t dilated = 0;
+    uint64_t rays = 0;          // raios saindo dos texels (sem contar os saltos)
+    unsigned threads = 1;
+    double rasterMs = 0.0;
+    double bakeMs = 0.0;        // total, com rasterização e dilatação
+    bool cached = false;
+};
+
+class LightmapBaker
+{
+public:
+    // Sem JobSystem tudo roda na thread que chama
+    explicit LightmapBaker(JobSystem* jobs = nullptr, const DiskCache* cache = nullptr);
+
+    // As malhas, texturas e a cena precisam continuar vivas até o último bake
+    void setScene(const CpuScene& scene);
+
+    bool bake(size_t meshIndex, const LightmapSettings& settings, Lightmap& lightmap);
+
+    const LightmapStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+private:
+    // Ponto de mundo de um texel coberto
+    struct Texel
+    {
+        uint32_t index;         // em Lightmap::texels
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    uint64_t cacheKey(size_t meshIndex, const LightmapSettings& settings) const;
+    void rasterize(const SceneMesh& sceneMesh, int size, std::vector<Texel>& texels, std::vector<uint8_t>& coverage);
+    void dilate(Lightmap& lightmap, std::vector<uint8_t>& coverage, int passes);
+
+    JobSystem* m_jobs;
+    const DiskCache* m_cache;
+    const CpuScene* m_scene = nullptr;
+    std::unique_ptr<RayTracer> m_tracer;    // criado no primeiro bake fora do cache
+    LightmapStats m_stats;
+};
+
+// .hdr com v = 1 na linha de cima (a imagem fica como o layout de UV)
+bool writeHdr(const std::string& path, const Lightmap& lightmap);
+
+// Etapa de GPU: textura RGB16F com filtro linear e clamp nas bordas
+GLuint uploadLightmap(const Lightmap& lightmap);
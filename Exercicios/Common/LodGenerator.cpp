@@ -0,0 +1,634 @@
+#include "LodGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+
+#include "Profiler.h"
+
+namespace
+{
+    // Forma quadrática simétrica 4x4 (10 termos) e a soma dos pesos, para o
+    // erro sair como distância média quadrática aos planos
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+        double weight = 0;
+
+        void addPlane(const glm::dvec3& n, double d, double w)
+        {
+            a2 += w * n.x * n.x; ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+            b2 += w * n.y * n.y; bc += w * n.y * n.z; bd += w * n.y * d;
+            c2 += w * n.z * n.z; cd += w * n.z * d;
+            d2 += w * d * d;
+            weight += w;
+        }
+
+        void add(const Quadric& q)
+        {
+            a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2; bc += q.bc; bd += q.bd;
+            c2 += q.c2; cd += q.cd; d2 += q.d2; weight += q.weight;
+        }
+
+        double eval(const glm::vec3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                + c2 * z * z + 2 * cd * z + d2;
+            return std::max(e, 0.0);
+        }
+    };
+
+    // Malha indexada em simplificação. "Vértice" é o soldado (com atributos);
+    // "grupo" junta os vértices de mesma posição (as cópias de uma costura).
+    class Simplifier
+    {
+    public:
+        Simplifier(const MeshData& mesh, float borderWeight)
+        {
+            // A solda é a do indexMesh; generate() já validou a malha
+            MeshData vertices;
+            indexMesh(mesh, vertices, m_indices);
+            m_hasColors = !vertices.colors.empty();
+            m_positions = std::move(vertices.positions);
+            m_uvs = std::move(vertices.uvs);
+            m_normals = std::move(vertices.normals);
+            m_colors = std::move(vertices.colors);
+
+            m_groupPositions.resize(groupPositions(m_positions, m_group));
+            for (size_t v = 0; v < m_positions.size(); ++v)
+                m_groupPositions[m_group[v]] = m_positions[v];
+
+            // Triângulos que já nascem degenerados (dois cantos na mesma posição) saem
+            size_t kept = 0;
+            for (size_t t = 0; t + 2 < m_indices.size(); t += 3)
+            {
+                uint32_t g0 = m_group[m_indices[t]], g1 = m_group[m_indices[t + 1]], g2 = m_group[m_indices[t + 2]];
+                if (g0 == g1 || g1 == g2 || g0 == g2)
+                    continue;
+                std::copy_n(&m_indices[t], 3, &m_indices[kept]);
+                kept += 3;
+            }
+            m_indices.resize(kept);
+
+            // Plano de cada triângulo, com peso pela área
+            m_quadrics.resize(m_groupPositions.size());
+            for (size_t t = 0; t < m_indices.size(); t += 3)
+            {
+                glm::dvec3 p0 = m_positions[m_indices[t]], p1 = m_positions[m_indices[t + 1]], p2 = m_positions[m_indices[t + 2]];
+                glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+                double length = glm::length(n);
+                if (length <= 0.0)
+                    continue;
+                n /= length;
+                for (int k = 0; k < 3; ++k)
+                    m_quadrics[m_group[m_indices[t + k]]].addPlane(n, -glm::dot(n, p0), length * 0.5);
+            }
+
+            // Bordas abertas: plano perpendicular ao triângulo passando pela aresta
+            buildTopology();
+            for (size_t t = 0; t < m_indices.size(); t += 3)
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t a = m_group[m_indices[t + k]], b = m_group[m_indices[t + (k + 1) % 3]];
+                    if (edgeCount(a, b) != 1)
+                        continue;
+                    glm::dvec3 p0 = m_positions[m_indices[t]], p1 = m_positions[m_indices[t + 1]], p2 = m_positions[m_indices[t + 2]];
+                    glm::dvec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+                    glm::dvec3 pa = m_groupPositions[a], pb = m_groupPositions[b];
+                    glm::dvec3 n = glm::cross(pb - pa, faceNormal);
+                    double length = glm::length(n);
+                    if (length <= 0.0)
+                        continue;
+                    n /= length;
+                    double w = borderWeight * glm::dot(pb - pa, pb - pa);
+                    m_quadrics[a].addPlane(n, -glm::dot(n, pa), w);
+                    m_quadrics[b].addPlane(n, -glm::dot(n, pa), w);
+                }
+        }
+
+        size_t triangleCount() const { return m_indices.size() / 3; }
+        size_t vertexCount() const { return m_positions.size(); }
+        float error() const { return m_error; }
+        uint32_t collapses() const { return m_collapses; }
+
+        // Uma passada de colapsos; false se nenhum foi possível
+        bool pass(size_t targetTriangles)
+        {
+            buildTopology();
+
+            // Melhor sentido de cada aresta
+            struct Collapse
+            {
+                uint32_t from, to;
+                float cost;
+            };
+            std::vector<Collapse> collapses;
+            collapses.reserve(m_edges.size());
+            for (const Edge& edge : m_edges)
+            {
+                if (edge.count > 2)
+                    continue;
+                Collapse best = { 0, 0, -1.0f };
+                for (int direction = 0; direction < 2; ++direction)
+                {
+                    uint32_t from = direction ? edge.b : edge.a, to = direction ? edge.a : edge.b;
+                    if (m_nonManifold[from] || (m_border[from] && edge.count != 1))
+                        continue;
+                    Quadric q = m_quadrics[from];
+                    q.add(m_quadrics[to]);
+                    float cost = (float)std::sqrt(q.eval(m_groupPositions[to]) / std::max(q.weight, 1e-30));
+                    if (best.cost < 0.0f || cost < best.cost)
+                        best = { from, to, cost };
+                }
+                if (best.cost >= 0.0f)
+                    collapses.push_back(best);
+            }
+            std::sort(collapses.begin(), collapses.end(),
+                [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            std::vector<uint8_t> locked(m_groupPositions.size(), 0);
+            std::vector<uint32_t> remap(m_positions.size());
+            for (size_t i = 0; i < remap.size(); ++i)
+                remap[i] = (uint32_t)i;
+
+            size_t triangles = triangleCount();
+            if (collapses.empty() || triangles <= targetTriangles)
+                return false;
+
+            // Cada colapso tira ~2 triângulos; com os vizinhos travados, os colapsos
+            // bem mais caros que os necessários esperam a próxima passada, quando os
+            // baratos que ficaram travados nesta já puderem entrar
+            size_t goal = std::min((triangles - targetTriangles + 1) / 2, collapses.size()) - 1;
+            float costLimit = collapses[goal].cost * 1.5f;
+
+            bool collapsed = false;
+            for (const Collapse& collapse : collapses)
+            {
+                if (triangles <= targetTriangles || collapse.cost > costLimit)
+                    break;
+                if (locked[collapse.from] || locked[collapse.to])
+                    continue;
+
+                int removed = tryCollapse(collapse.from, collapse.to, remap);
+                if (removed < 0)
+                    continue;
+
+                // Os triângulos em volta de "from" mudaram: os vizinhos esperam a próxima passada
+                for (uint32_t t : trianglesOf(collapse.from))
+                    for (int k = 0; k < 3; ++k)
+                        locked[m_group[m_indices[t * 3 + k]]] = 1;
+                locked[collapse.to] = 1;
+
+                m_quadrics[collapse.to].add(m_quadrics[collapse.from]);
+                m_error = std::max(m_error, collapse.cost);
+                m_collapses++;
+                triangles -= removed;
+                collapsed = true;
+            }
+
+            if (collapsed)
+            {
+                size_t kept = 0;
+                for (size_t t = 0; t < m_indices.size(); t += 3)
+                {
+                    uint32_t i0 = remap[m_indices[t]], i1 = remap[m_indices[t + 1]], i2 = remap[m_indices[t + 2]];
+                    if (m_group[i0] == m_group[i1] || m_group[i1] == m_group[i2] || m_group[i0] == m_group[i2])
+                        continue;
+                    m_indices[kept++] = i0;
+                    m_indices[kept++] = i1;
+                    m_indices[kept++] = i2;
+                }
+                m_indices.resize(kept);
+            }
+            return collapsed;
+        }
+
+        // Malha desindexada do estado atual, só com os vértices usados
+        MeshData extract(const std::string& texturePath) const
+        {
+            MeshData mesh;
+            mesh.positions.reserve(m_indices.size());
+            mesh.uvs.reserve(m_indices.size());
+            mesh.normals.reserve(m_indices.size());
+            for (uint32_t index : m_indices)
+            {
+                mesh.positions.push_back(m_positions[index]);
+                mesh.uvs.push_back(m_uvs[index]);
+                mesh.normals.push_back(m_normals[index]);
+                if (m_hasColors)
+                    mesh.colors.push_back(m_colors[index]);
+            }
+            mesh.texturePath = texturePath;
+            return mesh;
+        }
+
+    private:
+        struct Edge
+        {
+            uint32_t a, b;      // grupos, a < b
+            uint32_t count;     // triângulos que usam a aresta
+        };
+
+        // Triângulos por grupo (CSR), arestas e a classificação dos grupos
+        void buildTopology()
+        {
+            size_t groups = m_groupPositions.size();
+            m_firstTriangle.assign(groups + 1, 0);
+            for (uint32_t index : m_indices)
+                m_firstTriangle[m_group[index] + 1]++;
+            for (size_t g = 0; g < groups; ++g)
+                m_firstTriangle[g + 1] += m_firstTriangle[g];
+            m_groupTriangles.resize(m_indices.size());
+            std::vector<uint32_t> cursor(m_firstTriangle.begin(), m_firstTriangle.end() - 1);
+            for (size_t i = 0; i < m_indices.size(); ++i)
+                m_groupTriangles[cursor[m_group[m_indices[i]]]++] = (uint32_t)(i / 3);
+
+            std::vector<uint64_t> keys;
+            keys.reserve(m_indices.size());
+            for (size_t t = 0; t < m_indices.size(); t += 3)
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t a = m_group[m_indices[t + k]], b = m_group[m_indices[t + (k + 1) % 3]];
+                    keys.push_back(((uint64_t)std::min(a, b) << 32) | std::max(a, b));
+                }
+            std::sort(keys.begin(), keys.end());
+
+            m_edges.clear();
+            for (size_t i = 0; i < keys.size();)
+            {
+                size_t j = i;
+                while (j < keys.size() && keys[j] == keys[i])
+                    ++j;
+                m_edges.push_back({ (uint32_t)(keys[i] >> 32), (uint32_t)keys[i], (uint32_t)(j - i) });
+                i = j;
+            }
+
+            m_border.assign(groups, 0);
+            m_nonManifold.assign(groups, 0);
+            for (const Edge& edge : m_edges)
+            {
+                if (edge.count == 1)
+                    m_border[edge.a] = m_border[edge.b] = 1;
+                else if (edge.count > 2)
+                    m_nonManifold[edge.a] = m_nonManifold[edge.b] = 1;
+            }
+        }
+
+        uint32_t edgeCount(uint32_t a, uint32_t b) const
+        {
+            Edge key = { std::min(a, b), std::max(a, b), 0 };
+            auto it = std::lower_bound(m_edges.begin(), m_edges.end(), key,
+                [](const Edge& x, const Edge& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+            return it != m_edges.end() && it->a == key.a && it->b == key.b ? it->count : 0;
+        }
+
+        std::vector<uint32_t> trianglesOf(uint32_t group) const
+        {
+            return std::vector<uint32_t>(m_groupTriangles.begin() + m_firstTriangle[group],
+                m_groupTriangles.begin() + m_firstTriangle[group + 1]);
+        }
+
+        // Triângulos removidos, ou -1 se o colapso from -> to não vale
+        int tryCollapse(uint32_t from, uint32_t to, std::vector<uint32_t>& remap)
+        {
+            std::vector<uint32_t> fromTriangles = trianglesOf(from);
+            std::vector<uint32_t> fromRing, toRing, opposite;
+            std::vector<std::pair<uint32_t, uint32_t>> copies;  // vértice de "from" -> vértice de "to"
+            int removed = 0;
+
+            for (uint32_t t : fromTriangles)
+            {
+                const uint32_t* tri = &m_indices[t * 3];
+                int fromCorner = -1, toCorner = -1;
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t g = m_group[tri[k]];
+                    if (g == from)
+                        fromCorner = k;
+                    else if (g == to)
+                        toCorner = k;
+                    else
+                        fromRing.push_back(g);
+                }
+                if (toCorner < 0)
+                    continue;
+
+                // Triângulo da aresta: some, e liga a cópia de "from" à de "to" no mesmo lado da costura
+                removed++;
+                opposite.push_back(m_group[tri[3 - fromCorner - toCorner]]);
+                copies.push_back({ tri[fromCorner], tri[toCorner] });
+            }
+
+            // Cada cópia de "from" precisa de um destino único
+            std::sort(copies.begin(), copies.end());
+            copies.erase(std::unique(copies.begin(), copies.end()), copies.end());
+            for (size_t i = 1; i < copies.size(); ++i)
+                if (copies[i].first == copies[i - 1].first)
+                    return -1;
+            auto target = [&](uint32_t vertex) -> int64_t
+                {
+                    auto it = std::lower_bound(copies.begin(), copies.end(), std::make_pair(vertex, 0u));
+                    return it != copies.end() && it->first == vertex ? (int64_t)it->second : -1;
+                };
+
+            // Condição de link: os vizinhos em comum são só os opostos da aresta
+            for (uint32_t t : trianglesOf(to))
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t g = m_group[m_indices[t * 3 + k]];
+                    if (g != to && g != from)
+                        toRing.push_back(g);
+                }
+            for (std::vector<uint32_t>* ring : { &fromRing, &toRing, &opposite })
+            {
+                std::sort(ring->begin(), ring->end());
+                ring->erase(std::unique(ring->begin(), ring->end()), ring->end());
+            }
+            std::vector<uint32_t> common;
+            std::set_intersection(fromRing.begin(), fromRing.end(), toRing.begin(), toRing.end(), std::back_inserter(common));
+            if (common != opposite)
+                return -1;
+
+            // Os triângulos que ficam não podem virar, e todas as cópias precisam de destino
+            const glm::vec3& newPosition = m_groupPositions[to];
+            for (uint32_t t : fromTriangles)
+            {
+                const uint32_t* tri = &m_indices[t * 3];
+                int fromCorner = -1;
+                bool hasTo = false;
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (m_group[tri[k]] == from)
+                        fromCorner = k;
+                    hasTo |= m_group[tri[k]] == to;
+                }
+                if (target(tri[fromCorner]) < 0)
+                    return -1;
+                if (hasTo)
+                    continue;
+
+                glm::vec3 p[3] = { m_positions[tri[0]], m_positions[tri[1]], m_positions[tri[2]] };
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                p[fromCorner] = newPosition;
+                glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                if (glm::dot(before, after) <= 0.0f)
+                    return -1;
+            }
+
+            for (const auto& copy : copies)
+                remap[copy.first] = copy.second;
+            return removed;
+        }
+
+        bool m_hasColors = false;
+        std::vector<glm::vec3> m_positions;
+        std::vector<glm::vec2> m_uvs;
+        std::vector<glm::vec3> m_normals;
+        std::vector<glm::vec3> m_colors;
+        std::vector<uint32_t> m_group;          // vértice -> grupo
+        std::vector<uint32_t> m_indices;
+
+        std::vector<glm::vec3> m_groupPositions;
+        std::vector<Quadric> m_quadrics;        // por grupo
+
+        std::vector<uint32_t> m_firstTriangle;
+        std::vector<uint32_t> m_groupTriangles;
+        std::vector<Edge> m_edges;
+        std::vector<uint8_t> m_border;
+        std::vector<uint8_t> m_nonManifold;
+
+        float m_error = 0.0f;
+        uint32_t m_collapses = 0;
+    };
+
+    template <typename T>
+    void appendData(std::vector<char>& data, const T* values, size_t count)
+    {
+        const char* bytes = reinterpret_cast<const char*>(values);
+        data.insert(data.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    template <typename T>
+    bool readData(const std::vector<char>& data, size_t& offset, T* values, size_t count)
+    {
+        if (offset + count * sizeof(T) > data.size())
+            return false;
+        memcpy(values, data.data() + offset, count * sizeof(T));
+        offset += count * sizeof(T);
+        return true;
+    }
+
+    // [níveis] e, por nível, [vértices][tem cor][erro] + posições, uvs, normais e cores
+    std::vector<char> serialize(const LodChain& chain)
+    {
+        std::vector<char> data;
+        uint32_t levels = (uint32_t)chain.levels.size();
+        appendData(data, &levels, 1);
+        for (const LodLevel& level : chain.levels)
+        {
+            uint32_t header[2] = { (uint32_t)level.mesh.positions.size(), level.mesh.colors.empty() ? 0u : 1u };
+            appendData(data, header, 2);
+            appendData(data, &level.error, 1);
+            appendData(data, level.mesh.positions.data(), level.mesh.positions.size());
+            appendData(data, level.mesh.uvs.data(), level.mesh.uvs.size());
+            appendData(data, level.mesh.normals.data(), level.mesh.normals.size());
+            appendData(data, level.mesh.colors.data(), level.mesh.colors.size());
+        }
+        return data;
+    }
+
+    bool deserialize(const std::vector<char>& data, const std::string& texturePath, LodChain& chain)
+    {
+        size_t offset = 0;
+        uint32_t levels = 0;
+        if (!readData(data, offset, &levels, 1))
+            return false;
+        chain.levels.resize(levels);
+        for (LodLevel& level : chain.levels)
+        {
+            uint32_t header[2];
+            if (!readData(data, offset, header, 2) || !readData(data, offset, &level.error, 1))
+                return false;
+            level.mesh.positions.resize(header[0]);
+            level.mesh.uvs.resize(header[0]);
+            level.mesh.normals.resize(header[0]);
+            level.mesh.colors.resize(header[1] ? header[0] : 0);
+            level.mesh.texturePath = texturePath;
+            if (!readData(data, offset, level.mesh.positions.data(), header[0]) ||
+                !readData(data, offset, level.mesh.uvs.data(), header[0]) ||
+                !readData(data, offset, level.mesh.normals.data(), header[0]) ||
+                !readData(data, offset, level.mesh.colors.data(), level.mesh.colors.size()))
+                return false;
+        }
+        return offset == data.size() && levels > 0;
+    }
+
+    void computeBounds(LodChain& chain)
+    {
+        const std::vector<glm::vec3>& positions = chain.levels[0].mesh.positions;
+        glm::vec3 minimum(1e30f), maximum(-1e30f);
+        for (const glm::vec3& p : positions)
+        {
+            minimum = glm::min(minimum, p);
+            maximum = glm::max(maximum, p);
+        }
+        chain.center = (minimum + maximum) * 0.5f;
+        chain.radius = 0.0f;
+        for (const glm::vec3& p : positions)
+            chain.radius = std::max(chain.radius, glm::length(p - chain.center));
+    }
+}
+
+LodGenerator::LodGenerator(const DiskCache* cache) : m_cache(cache)
+{
+}
+
+bool LodGenerator::generate(const MeshData& mesh, const LodSettings& settings, LodChain& chain)
+{
+    PROFILE_SCOPE("LodGenerate");
+    auto start = std::chrono::high_resolution_clock::now();
+    auto elapsedMs = [&]()
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+    m_stats = LodStats();
+    chain = LodChain();
+    size_t count = mesh.positions.size();
+    if (count < 3 || count % 3 != 0 || mesh.uvs.size() != count || mesh.normals.size() != count ||
+        (!mesh.colors.empty() && mesh.colors.size() != count))
+        return false;
+    m_stats.sourceTriangles = (uint32_t)(count / 3);
+
+    uint64_t key = 0;
+    if (m_cache)
+    {
+        key = DiskCache::hash("lod1");
+        key = DiskCache::hash(mesh.positions.data(), count * sizeof(glm::vec3), key);
+        key = DiskCache::hash(mesh.uvs.data(), count * sizeof(glm::vec2), key);
+        key = DiskCache::hash(mesh.normals.data(), count * sizeof(glm::vec3), key);
+        key = DiskCache::hash(mesh.colors.data(), mesh.colors.size() * sizeof(glm::vec3), key);
+        key = DiskCache::hash(settings.ratios.data(), settings.ratios.size() * sizeof(float), key);
+        key = DiskCache::hash(&settings.borderWeight, sizeof(settings.borderWeight), key);
+
+        std::vector<char> data;
+        if (m_cache->read(key, data) && deserialize(data, mesh.texturePath, chain))
+        {
+            computeBounds(chain);
+            m_stats.cached = true;
+            m_stats.generateMs = elapsedMs();
+            return true;
+        }
+        chain = LodChain();
+    }
+
+    std::vector<float> ratios = settings.ratios;
+    std::sort(ratios.begin(), ratios.end(), std::greater<float>());
+
+    // O nível 0 é sempre a malha original, sem passar pela solda
+    chain.levels.push_back({ mesh, 0.0f });
+    Simplifier simplifier(mesh, settings.borderWeight);
+    m_stats.uniqueVertices = (uint32_t)simplifier.vertexCount();
+    size_t previous = m_stats.sourceTriangles;
+    for (float ratio : ratios)
+    {
+        if (ratio >= 1.0f)
+            continue;
+        size_t target = (size_t)(std::max(ratio, 0.0f) * m_stats.sourceTriangles);
+        while (simplifier.triangleCount() > target && simplifier.pass(target))
+            m_stats.passes++;
+
+        if (simplifier.triangleCount() >= previous)
+            continue;
+        previous = simplifier.triangleCount();
+        chain.levels.push_back({ simplifier.extract(mesh.texturePath), simplifier.error() });
+    }
+    m_stats.collapses = simplifier.collapses();
+    computeBounds(chain);
+
+    if (m_cache)
+    {
+        std::vector<char> data = serialize(chain);
+        m_cache->write(key, data.data(), data.size());
+    }
+
+    m_stats.generateMs = elapsedMs();
+    return true;
+}
+
+void LodGenerator::printStats(const LodChain& chain) const
+{
+    std::cout << "LOD: " << chain.levels.size() << " niveis (";
+    for (size_t i = 0; i < chain.levels.size(); ++i)
+        std::cout << (i ? ", " : "") << chain.levels[i].mesh.positions.size() / 3 << " tri erro "
+            << chain.levels[i].error;
+    std::cout << ")";
+    if (m_stats.cached)
+        std::cout << " lidos do cache em " << m_stats.generateMs << " ms" << std::endl;
+    else
+        std::cout << " gerados em " << m_stats.generateMs << " ms (" << m_stats.uniqueVertices << " vertices soldados, "
+            << m_stats.collapses << " colapsos em " << m_stats.passes << " passadas)" << std::endl;
+}
+
+LodGeometry uploadLodChain(const LodChain& chain, const ImageData* image)
+{
+    LodGeometry lod;
+    lod.center = chain.center;
+    lod.radius = chain.radius;
+
+    // Níveis um depois do outro no mesmo VBO
+    MeshData all;
+    for (const LodLevel& level : chain.levels)
+    {
+        LodRange range;
+        range.first = (GLint)all.positions.size();
+        range.count = (GLsizei)level.mesh.positions.size();
+        range.error = level.error;
+        lod.levels.push_back(range);
+
+        all.positions.insert(all.positions.end(), level.mesh.positions.begin(), level.mesh.positions.end());
+        all.uvs.insert(all.uvs.end(), level.mesh.uvs.begin(), level.mesh.uvs.end());
+        all.normals.insert(all.normals.end(), level.mesh.normals.begin(), level.mesh.normals.end());
+        all.colors.insert(all.colors.end(), level.mesh.colors.begin(), level.mesh.colors.end());
+    }
+    if (all.colors.size() != all.positions.size())
+        all.colors.clear();
+
+    lod.geometry = uploadGeometry(all, image);
+    return lod;
+}
+
+void destroyLodGeometry(LodGeometry& lod)
+{
+    destroyGeometry(lod.geometry);
+    lod = LodGeometry();
+}
+
+float lodProjectionScale(const glm::mat4& projection, int viewportHeight)
+{
+    return projection[1][1] * viewportHeight * 0.5f;
+}
+
+int selectLod(const LodGeometry& lod, const glm::mat4& model, const glm::vec3& cameraPos, float projectionScale,
+    float maxPixelError)
+{
+    // Maior escala do model: o erro e o raio crescem com ela
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+        glm::length(glm::vec3(model[2])) });
+    glm::vec3 center = glm::vec3(model * glm::vec4(lod.center, 1.0f));
+    float distance = glm::length(center - cameraPos) - lod.radius * scale;
+    if (distance <= 1e-4f)
+        return 0;
+
+    int selected = 0;
+    for (size_t i = 1; i < lod.levels.size(); ++i)
+        if (lod.levels[i].error * scale * projectionScale / distance <= maxPixelError)
+            selected = (int)i;
+    return selected;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "DiskCache.h"
+#include "Geometry.h"
+
+// Níveis de detalhe gerados por simplificação com quádricas (Garland-Heckbert)
+// e escolhidos em tempo de execução pelo erro projetado na tela.
+//
+//   LodGenerator generator(&cache);         // cache opcional (DiskCache)
+//   LodChain chain;
+//   generator.generate(mesh, LodSettings(), chain);
+//   LodGeometry lod = uploadLodChain(chain, &image);
+//   ...
+//   float pixels = lodProjectionScale(projection, viewportHeight);
+//   const LodRange& range = lod.levels[selectLod(lod, model, camPos, pixels, 1.0f)];
+//   glDrawArrays(GL_TRIANGLES, range.first, range.count);
+//
+// A malha é soldada (vértices com a mesma posição, UV, normal e cor viram um
+// só) e simplificada por colapsos de aresta em que um vértice cai em cima do
+// outro: nenhum atributo é interpolado, então UVs e normais dos vértices que
+// ficam são os do .obj. Cada colapso custa o erro da soma das quádricas dos
+// dois vértices na posição que fica; as arestas mais baratas são colapsadas
+// primeiro, em passadas com os vizinhos de cada colapso travados até a próxima.
+//
+// Um colapso só é aceito se cada cópia de UV/normal do vértice que some tiver
+// uma cópia do destino num triângulo em comum: vértices de costura de UV só
+// andam ao longo da costura e as quinas da costura ficam paradas. Bordas
+// abertas só andam ao longo da borda (e têm quádricas extras que seguram a
+// silhueta); colapsos que viram algum triângulo ou que dobrariam a malha
+// (condição de link) são recusados.
+//
+// Os níveis saem de uma simplificação só, parada em cada proporção de
+// triângulos pedida; o erro de cada nível (distância em unidades do objeto)
+// é o maior erro dos colapsos feitos até ali. Se a malha travar antes da meta
+// o nível sai com mais triângulos, e níveis que não reduziram nada são omitidos.
+
+struct LodSettings
+{
+    std::vector<float> ratios = { 1.0f, 0.5f, 0.25f, 0.125f };  // triângulos de cada nível / originais
+    float borderWeight = 10.0f;     // peso das quádricas que seguram as bordas abertas
+};
+
+struct LodLevel
+{
+    MeshData mesh;                  // desindexada, como a do parseObj
+    float error = 0.0f;             // em unidades do objeto; 0 no nível original
+};
+
+struct LodChain
+{
+    std::vector<LodLevel> levels;   // do mais detalhado ao mais simples
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;            // esfera envolvente, em unidades do objeto
+};
+
+struct LodStats
+{
+    uint32_t sourceTriangles = 0;
+    uint32_t uniqueVertices = 0;    // depois de soldar
+    uint32_t collapses = 0;
+    uint32_t passes = 0;
+    double generateMs = 0.0;
+    bool cached = false;
+};
+
+class LodGenerator
+{
+public:
+    explicit LodGenerator(const DiskCache* cache = nullptr);
+
+    // mesh com positions, uvs e normals do mesmo tamanho (colors opcional)
+    bool generate(const MeshData& mesh, const LodSettings& settings, LodChain& chain);
+
+    const LodStats& getStats() const { return m_stats; }
+    void printStats(const LodChain& chain) const;
+
+private:
+    const DiskCache* m_cache;
+    LodStats m_stats;
+};
+
+// Faixa de um nível no VBO compartilhado
+struct LodRange
+{
+    GLint first = 0;
+    GLsizei count = 0;
+    float error = 0.0f;
+};
+
+// Todos os níveis num VBO só (mesmo layout do uploadGeometry)
+struct LodGeometry
+{
+    Geometry geometry;
+    std::vector<LodRange> levels;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+LodGeometry uploadLodChain(const LodChain& chain, const ImageData* image);
+void destroyLodGeometry(LodGeometry& lod);
+
+// Pixels por unidade de mundo a 1 unidade de distância (perspectiva)
+float lodProjectionScale(const glm::mat4& projection, int viewportHeight);
+
+// Nível mais simples cujo erro, projetado na distância da câmera até a
+// esfera envolvente, fica abaixo de maxPixelError
+int selectLod(const LodGeometry& lod, const glm::mat4& model, const glm::vec3& cameraPos, float projectionScale,
+    float maxPixelError);
@@ -0,0 +1,472 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "Profiler.h"
+
+namespace
+{
+    // Esfera da caixa dos pontos: centro da caixa, raio até o ponto mais longe
+    void boundingSphere(const std::vector<glm::vec3>& positions, const uint32_t* indices, size_t count,
+        glm::vec3& center, float& radius)
+    {
+        glm::vec3 lo(1e30f), hi(-1e30f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            lo = glm::min(lo, positions[indices[i]]);
+            hi = glm::max(hi, positions[indices[i]]);
+        }
+        center = (lo + hi) * 0.5f;
+        float radius2 = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            glm::vec3 d = positions[indices[i]] - center;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+        radius = std::sqrt(radius2);
+    }
+
+    // Cone de normais: eixo = média das normais das faces, abertura = a normal
+    // mais longe do eixo. O ápice fica atrás do plano de todos os triângulos,
+    // então a câmera dentro do cone (com a ponta no ápice, aberto para trás)
+    // vê todos de costas.
+    void computeCone(const std::vector<glm::vec3>& positions, const uint32_t* indices, uint32_t triangles,
+        Meshlet& meshlet)
+    {
+        std::vector<glm::vec3> normals;
+        normals.reserve(triangles);
+        glm::vec3 axis(0.0f);
+        for (uint32_t t = 0; t < triangles; ++t)
+        {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            glm::vec3 n = glm::cross(positions[indices[t * 3 + 1]] - p0, positions[indices[t * 3 + 2]] - p0);
+            float length = glm::length(n);
+            if (length <= 1e-12f)
+                continue;
+            normals.push_back(n / length);
+            axis += normals.back();
+        }
+
+        float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength <= 1e-6f)
+            return;
+        axis /= axisLength;
+
+        float minDot = 1.0f;
+        for (const glm::vec3& n : normals)
+            minDot = std::min(minDot, glm::dot(n, axis));
+        // Mais de ~84 graus de abertura: o teste quase nunca descartaria
+        if (minDot <= 0.1f)
+            return;
+
+        float maxT = 0.0f;
+        size_t k = 0;
+        for (uint32_t t = 0; t < triangles; ++t)
+        {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            glm::vec3 n = glm::cross(positions[indices[t * 3 + 1]] - p0, positions[indices[t * 3 + 2]] - p0);
+            if (glm::length(n) <= 1e-12f)
+                continue;
+            const glm::vec3& normal = normals[k++];
+            // Quanto o centro precisa recuar ao longo do eixo para ficar atrás deste plano
+            maxT = std::max(maxT, glm::dot(meshlet.center - p0, normal) / glm::dot(axis, normal));
+        }
+
+        meshlet.coneAxis = axis;
+        meshlet.coneApex = meshlet.center - axis * maxT;
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+bool buildMeshlets(const MeshData& mesh, const MeshletSettings& settings, MeshletMesh& clusters)
+{
+    PROFILE_SCOPE("BuildMeshlets");
+    auto start = std::chrono::steady_clock::now();
+
+    if (settings.maxVertices < 3 || settings.maxTriangles < 1)
+        return false;
+
+    // Solda os vértices (indexMesh também recusa a malha inválida) e, à parte,
+    // agrupa as posições (vizinhança entre triângulos)
+    MeshData welded;
+    std::vector<uint32_t> indices;
+    if (!indexMesh(mesh, welded, indices))
+        return false;
+    std::vector<uint32_t> groupOf;
+    uint32_t groupCount = groupPositions(welded.positions, groupOf);
+
+    uint32_t vertexCount = (uint32_t)welded.positions.size();
+    uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        const glm::vec3& p0 = welded.positions[indices[t * 3]];
+        const glm::vec3& p1 = welded.positions[indices[t * 3 + 1]];
+        const glm::vec3& p2 = welded.positions[indices[t * 3 + 2]];
+        centroids[t] = (p0 + p1 + p2) / 3.0f;
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(n);
+        faceNormals[t] = length > 1e-12f ? n / length : glm::vec3(0.0f);
+    }
+
+    // Triângulos de cada posição (CSR)
+    std::vector<uint32_t> groupStart(groupCount + 1, 0);
+    for (uint32_t index : indices)
+        groupStart[groupOf[index] + 1]++;
+    for (uint32_t g = 0; g < groupCount; ++g)
+        groupStart[g + 1] += groupStart[g];
+    std::vector<uint32_t> groupTriangles(indices.size());
+    {
+        std::vector<uint32_t> cursor(groupStart.begin(), groupStart.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            groupTriangles[cursor[groupOf[indices[i]]]++] = (uint32_t)(i / 3);
+    }
+
+    std::vector<uint32_t> ordered;          // índices soldados, agrupados por meshlet
+    ordered.reserve(indices.size());
+    std::vector<Meshlet> meshlets;
+    std::vector<uint8_t> used(triangleCount, 0);
+    std::vector<uint32_t> vertexStamp(vertexCount, 0);     // meshlet + 1 que já tem o vértice
+    std::vector<uint32_t> candidateStamp(triangleCount, 0);
+    std::vector<uint32_t> candidates;
+    glm::vec3 lastCenter(0.0f);
+    uint32_t nextSeed = 0;
+    uint32_t emitted = 0;
+
+    while (emitted < triangleCount)
+    {
+        uint32_t stamp = (uint32_t)meshlets.size() + 1;
+        Meshlet meshlet;
+        meshlet.firstIndex = (uint32_t)ordered.size();
+        glm::vec3 centroidSum(0.0f), normalSum(0.0f);
+
+        // Semente: o vizinho livre do meshlet anterior mais perto do centro
+        // dele (continua a varredura pela superfície); sem vizinho, o primeiro livre
+        uint32_t seed = UINT32_MAX;
+        if (!meshlets.empty())
+        {
+            float best = 1e30f;
+            for (uint32_t t : candidates)
+            {
+                float d = glm::length(centroids[t] - lastCenter);
+                if (!used[t] && d < best)
+                {
+                    best = d;
+                    seed = t;
+                }
+            }
+        }
+        if (seed == UINT32_MAX)
+        {
+            while (used[nextSeed])
+                nextSeed++;
+            seed = nextSeed;
+        }
+        candidates.clear();
+
+        uint32_t triangle = seed;
+        while (triangle != UINT32_MAX)
+        {
+            used[triangle] = 1;
+            emitted++;
+            meshlet.triangleCount++;
+            centroidSum += centroids[triangle];
+            normalSum += faceNormals[triangle];
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[triangle * 3 + k];
+                ordered.push_back(v);
+                if (vertexStamp[v] != stamp)
+                {
+                    vertexStamp[v] = stamp;
+                    meshlet.vertexCount++;
+                }
+                uint32_t g = groupOf[v];
+                for (uint32_t j = groupStart[g]; j < groupStart[g + 1]; ++j)
+                {
+                    uint32_t neighbor = groupTriangles[j];
+                    if (!used[neighbor] && candidateStamp[neighbor] != stamp)
+                    {
+                        candidateStamp[neighbor] = stamp;
+                        candidates.push_back(neighbor);
+                    }
+                }
+            }
+            if (meshlet.triangleCount >= settings.maxTriangles)
+                break;
+
+            glm::vec3 center = centroidSum / (float)meshlet.triangleCount;
+            float normalLength = glm::length(normalSum);
+            glm::vec3 axis = normalLength > 1e-6f ? normalSum / normalLength : glm::vec3(0.0f);
+            float spread = 1e-12f;
+            for (size_t i = meshlet.firstIndex; i < ordered.size(); ++i)
+                spread = std::max(spread, glm::length(welded.positions[ordered[i]] - center));
+
+            // Menos vértices novos primeiro; no empate, perto do centro e alinhado com a normal média
+            triangle = UINT32_MAX;
+            uint32_t bestExtra = 4;
+            float bestScore = 1e30f;
+            size_t kept = 0;
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                uint32_t t = candidates[i];
+                if (used[t])
+                    continue;
+                candidates[kept++] = t;
+
+                uint32_t extra = 0;
+                for (int k = 0; k < 3; ++k)
+                    extra += vertexStamp[indices[t * 3 + k]] != stamp ? 1 : 0;
+                if (meshlet.vertexCount + extra > settings.maxVertices || extra > bestExtra)
+                    continue;
+
+                float score = glm::length(centroids[t] - center) / spread +
+                    settings.coneWeight * (1.0f - glm::dot(faceNormals[t], axis));
+                if (extra < bestExtra || score < bestScore)
+                {
+                    bestExtra = extra;
+                    bestScore = score;
+                    triangle = t;
+                }
+            }
+            candidates.resize(kept);
+        }
+
+        lastCenter = centroidSum / (float)meshlet.triangleCount;
+        meshlets.push_back(meshlet);
+    }
+
+    // Reordena os vértices na ordem de uso: os de um meshlet ficam juntos no VBO
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    clusters = MeshletMesh();
+    MeshData& vertices = clusters.vertices;
+    vertices.texturePath = mesh.texturePath;
+    for (uint32_t& index : ordered)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = (uint32_t)vertices.positions.size();
+            vertices.positions.push_back(welded.positions[index]);
+            vertices.uvs.push_back(welded.uvs[index]);
+            vertices.normals.push_back(welded.normals[index]);
+            if (!welded.colors.empty())
+                vertices.colors.push_back(welded.colors[index]);
+        }
+        index = remap[index];
+    }
+    clusters.indices = std::move(ordered);
+
+    for (Meshlet& meshlet : meshlets)
+    {
+        const uint32_t* meshletIndices = clusters.indices.data() + meshlet.firstIndex;
+        boundingSphere(vertices.positions, meshletIndices, meshlet.triangleCount * 3, meshlet.center, meshlet.radius);
+        computeCone(vertices.positions, meshletIndices, meshlet.triangleCount, meshlet);
+    }
+    clusters.meshlets = std::move(meshlets);
+    boundingSphere(vertices.positions, clusters.indices.data(), clusters.indices.size(), clusters.center, clusters.radius);
+
+    clusters.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void printMeshletStats(const MeshletMesh& clusters)
+{
+    if (clusters.meshlets.empty())
+        return;
+
+    uint64_t vertices = 0;
+    size_t cones = 0;
+    for (const Meshlet& meshlet : clusters.meshlets)
+    {
+        vertices += meshlet.vertexCount;
+        cones += meshlet.coneCutoff < 1.0f ? 1 : 0;
+    }
+    double count = (double)clusters.meshlets.size();
+    std::cout << "Meshlets: " << clusters.meshlets.size() << " de " << clusters.indices.size() / 3
+        << " triangulos (media de " << clusters.indices.size() / 3 / count << " triangulos e " << vertices / count
+        << " vertices), " << cones << " com cone, gerados em " << clusters.buildMs << " ms" << std::endl;
+}
+
+MeshletGeometry uploadMeshlets(const MeshletMesh& clusters, const ImageData* image)
+{
+    MeshletGeometry geometry;
+    geometry.meshlets = clusters.meshlets;
+    geometry.center = clusters.center;
+    geometry.radius = clusters.radius;
+    geometry.indexCount = (GLsizei)clusters.indices.size();
+    geometry.geometry = uploadGeometry(clusters.vertices, image);
+
+    // O EBO fica gravado no VAO
+    glBindVertexArray(geometry.geometry.VAO);
+    glGenBuffers(1, &geometry.EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, clusters.indices.size() * sizeof(uint32_t), clusters.indices.data(),
+        GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    return geometry;
+}
+
+void destroyMeshletGeometry(MeshletGeometry& geometry)
+{
+    if (geometry.EBO)
+        glDeleteBuffers(1, &geometry.EBO);
+    destroyGeometry(geometry.geometry);
+    geometry = MeshletGeometry();
+}
+
+MeshletCuller::MeshletCuller(JobSystem* jobs)
+    : m_jobs(jobs)
+{
+}
+
+void MeshletCuller::beginFrame(const MeshletGeometry& geometry, const glm::mat4& viewProjection,
+    const glm::vec3& cameraPos)
+{
+    m_geometry = &geometry;
+    m_viewProjection = viewProjection;
+    m_cameraPos = cameraPos;
+    m_models.clear();
+}
+
+uint32_t MeshletCuller::addInstance(const glm::mat4& model)
+{
+    m_models.push_back(model);
+    return (uint32_t)m_models.size() - 1;
+}
+
+void MeshletCuller::cull()
+{
+    PROFILE_SCOPE("MeshletCulling");
+    auto start = std::chrono::steady_clock::now();
+
+    size_t count = m_models.size();
+    size_t meshletCount = m_geometry->meshlets.size();
+    m_results.resize(count);
+    m_counts.resize(count * meshletCount);
+    m_offsets.resize(count * meshletCount);
+
+    auto work = [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                cullInstance((uint32_t)i);
+        };
+    if (m_jobs)
+        m_jobs->parallelFor(count, 16, work);
+    else
+        work(0, count);
+
+    m_stats.frames++;
+    m_stats.instances += count;
+    m_stats.meshletsTested += count * meshletCount;
+    m_stats.trianglesTested += (uint64_t)count * (m_geometry->indexCount / 3);
+    for (const Result& result : m_results)
+    {
+        m_stats.trianglesFrustumCulled += result.frustumCulled;
+        m_stats.trianglesConeCulled += result.coneCulled;
+        m_stats.draws += result.drawCount;
+    }
+    m_stats.cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void MeshletCuller::cullInstance(uint32_t instance)
+{
+    const glm::mat4& model = m_models[instance];
+    const std::vector<Meshlet>& meshlets = m_geometry->meshlets;
+
+    Result& result = m_results[instance];
+    result.firstDraw = instance * (uint32_t)meshlets.size();
+    result.drawCount = 0;
+    result.triangles = 0;
+    result.frustumCulled = 0;
+    result.coneCulled = 0;
+
+    // Planos de viewProjection * model já estão no espaço do objeto (Gribb-Hartmann)
+    glm::mat4 m = glm::transpose(m_viewProjection * model);
+    glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+    for (glm::vec4& plane : planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        plane /= length > 0.0f ? length : 1.0f;
+    }
+    glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(m_cameraPos, 1.0f));
+
+    // A esfera da malha inteira decide se ainda falta testar os planos por meshlet
+    bool outside = false, inside = true;
+    for (const glm::vec4& plane : planes)
+    {
+        float distance = glm::dot(glm::vec3(plane), m_geometry->center) + plane.w;
+        outside |= distance < -m_geometry->radius;
+        inside &= distance > m_geometry->radius;
+    }
+    if (outside)
+    {
+        result.frustumCulled = (uint32_t)(m_geometry->indexCount / 3);
+        return;
+    }
+
+    GLsizei* counts = m_counts.data() + result.firstDraw;
+    const void** offsets = m_offsets.data() + result.firstDraw;
+    uint32_t nextIndex = UINT32_MAX;    // fim do último draw, para emendar meshlets vizinhos
+    for (const Meshlet& meshlet : meshlets)
+    {
+        bool visible = true;
+        if (!inside)
+            for (const glm::vec4& plane : planes)
+                if (glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius)
+                {
+                    visible = false;
+                    result.frustumCulled += meshlet.triangleCount;
+                    break;
+                }
+        if (visible && meshlet.coneCutoff < 1.0f &&
+            glm::dot(glm::normalize(meshlet.coneApex - camera), meshlet.coneAxis) >= meshlet.coneCutoff)
+        {
+            visible = false;
+            result.coneCulled += meshlet.triangleCount;
+        }
+        if (!visible)
+            continue;
+
+        if (meshlet.firstIndex == nextIndex)
+            counts[result.drawCount - 1] += (GLsizei)meshlet.triangleCount * 3;
+        else
+        {
+            counts[result.drawCount] = (GLsizei)meshlet.triangleCount * 3;
+            offsets[result.drawCount] = (const void*)(meshlet.firstIndex * sizeof(uint32_t));
+            result.drawCount++;
+        }
+        nextIndex = meshlet.firstIndex + meshlet.triangleCount * 3;
+        result.triangles += meshlet.triangleCount;
+    }
+}
+
+void MeshletCuller::draw(uint32_t instance) const
+{
+    const Result& result = m_results[instance];
+    if (result.drawCount == 1)
+        glDrawElements(GL_TRIANGLES, m_counts[result.firstDraw], GL_UNSIGNED_INT, m_offsets[result.firstDraw]);
+    else if (result.drawCount > 1)
+        glMultiDrawElements(GL_TRIANGLES, m_counts.data() + result.firstDraw, GL_UNSIGNED_INT,
+            m_offsets.data() + result.firstDraw, (GLsizei)result.drawCount);
+}
+
+void MeshletCuller::printStats() const
+{
+    if (m_stats.frames == 0)
+        return;
+
+    double frames = (double)m_stats.frames;
+    double tested = (double)std::max<uint64_t>(m_stats.trianglesTested, 1);
+    uint64_t culled = m_stats.trianglesFrustumCulled + m_stats.trianglesConeCulled;
+    std::cout << "Meshlets: " << m_stats.frames << " frames, media de " << culled / frames << " de "
+        << m_stats.trianglesTested / frames << " triangulos descartados (" << 100.0 * culled / tested << "%: frustum "
+        << 100.0 * m_stats.trianglesFrustumCulled / tested << "%, cone " << 100.0 * m_stats.trianglesConeCulled / tested
+        << "%), " << m_stats.draws / frames << " draws em " << m_stats.instances / frames << " instancias, teste "
+        << m_stats.cullMs / frames << " ms" << std::endl;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Geometry.h"
+#include "JobSystem.h"
+
+// Meshlets: a malha dividida em grupos pequenos de triângulos vizinhos (até
+// 64 vértices e 124 triângulos), cada um com esfera envolvente e cone de
+// normais, descartados um a um na CPU antes do draw.
+//
+//   MeshletMesh clusters;
+//   buildMeshlets(mesh, MeshletSettings(), clusters);
+//   MeshletGeometry geometry = uploadMeshlets(clusters, &image);
+//   ...
+//   culler.beginFrame(geometry, projection * view, cameraPos);
+//   for (...) culler.addInstance(model);
+//   culler.cull();                          // em paralelo no JobSystem
+//   glBindVertexArray(geometry.geometry.VAO);
+//   for (...) { glUniformMatrix4fv(modelLoc, ...); culler.draw(i); }
+//
+// O builder solda os vértices e cresce cada meshlet a partir de uma semente,
+// sempre pelo triângulo vizinho que acrescenta menos vértices novos e, no
+// empate, pelo mais perto do centro e mais alinhado com a normal média (os
+// vizinhos contam pela posição, então o meshlet atravessa costuras de UV). Os
+// vértices saem reordenados na ordem em que os meshlets os usam.
+//
+// O culler leva a câmera e os planos do frustum para o espaço do objeto de
+// cada instância e testa cada meshlet contra os planos (esfera) e contra o
+// cone: se a câmera está no cone de costas, todos os triângulos do meshlet
+// estão de costas para ela. Isso só vale com GL_CULL_FACE ligado (ou malhas
+// fechadas). Os meshlets que sobram viram uma lista de glMultiDrawElements,
+// com os vizinhos no índice emendados num draw só.
+
+struct MeshletSettings
+{
+    uint32_t maxVertices = 64;
+    uint32_t maxTriangles = 124;
+    float coneWeight = 1.0f;        // peso do desvio da normal média na escolha do próximo triângulo
+};
+
+struct Meshlet
+{
+    uint32_t firstIndex = 0;        // no índice global, 3 por triângulo
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;       // vértices distintos
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    glm::vec3 coneApex = glm::vec3(0.0f);
+    float coneCutoff = 1.0f;        // seno da abertura do cone; 1 = normais espalhadas demais, nunca descarta
+    glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+};
+
+struct MeshletMesh
+{
+    MeshData vertices;              // soldados, na ordem de uso dos meshlets
+    std::vector<uint32_t> indices;  // triângulos agrupados por meshlet
+    std::vector<Meshlet> meshlets;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    double buildMs = 0.0;
+};
+
+// mesh com positions, uvs e normals do mesmo tamanho (colors opcional)
+bool buildMeshlets(const MeshData& mesh, const MeshletSettings& settings, MeshletMesh& clusters);
+void printMeshletStats(const MeshletMesh& clusters);
+
+// VAO do uploadGeometry com um EBO dos índices dos meshlets
+struct MeshletGeometry
+{
+    Geometry geometry;
+    GLuint EBO = 0;
+    GLsizei indexCount = 0;
+    std::vector<Meshlet> meshlets;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+MeshletGeometry uploadMeshlets(const MeshletMesh& clusters, const ImageData* image);
+void destroyMeshletGeometry(MeshletGeometry& geometry);
+
+struct MeshletCullStats
+{
+    uint64_t frames = 0;
+    uint64_t instances = 0;
+    uint64_t meshletsTested = 0;
+    uint64_t trianglesTested = 0;
+    uint64_t trianglesFrustumCulled = 0;
+    uint64_t trianglesConeCulled = 0;
+    uint64_t draws = 0;
+    double cullMs = 0.0;
+};
+
+class MeshletCuller
+{
+public:
+    // Sem JobSystem o teste roda na thread que chama
+    explicit MeshletCuller(JobSystem* jobs = nullptr);
+
+    // A geometria precisa continuar viva até o último draw() do frame
+    void beginFrame(const MeshletGeometry& geometry, const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+
+    // Retorna o índice da instância
+    uint32_t addInstance(const glm::mat4& model);
+
+    void cull();
+
+    // Meshlets visíveis da instância; o VAO da geometria já deve estar ligado
+    void draw(uint32_t instance) const;
+    uint32_t getTriangleCount(uint32_t instance) const { return m_results[instance].triangles; }
+
+    const MeshletCullStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+private:
+    struct Result
+    {
+        uint32_t firstDraw;
+        uint32_t drawCount;
+        uint32_t triangles;
+        uint32_t frustumCulled;     // triângulos
+        uint32_t coneCulled;
+    };
+
+    void cullInstance(uint32_t instance);
+
+    JobSystem* m_jobs;
+    const MeshletGeometry* m_geometry = nullptr;
+    glm::mat4 m_viewProjection = glm::mat4(1.0f);
+    glm::vec3 m_cameraPos = glm::vec3(0.0f);
+
+    std::vector<glm::mat4> m_models;
+    std::vector<Result> m_results;
+    std::vector<GLsizei> m_counts;          // meshlets.size() posições por instância
+    std::vector<const void*> m_offsets;
+
+    MeshletCullStats m_stats;
+};
@@ -0,0 +1,309 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+#include "Profiler.h"
+
+static const uint64_t FULL_MASK = ~0ull;
+
+OcclusionCuller::OcclusionCuller(int width, int height, JobSystem* jobs, unsigned maxOccluders)
+    : m_jobs(jobs), m_maxOccluders(maxOccluders)
+{
+    m_tilesX = std::max(1, (width + TILE_SIZE - 1) / TILE_SIZE);
+    m_tilesY = std::max(1, (height + TILE_SIZE - 1) / TILE_SIZE);
+    m_width = m_tilesX * TILE_SIZE;
+    m_height = m_tilesY * TILE_SIZE;
+    m_tiles.resize((size_t)m_tilesX * m_tilesY);
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    m_instances.clear();
+}
+
+uint32_t OcclusionCuller::addInstance(const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax,
+    const std::vector<glm::vec3>* occluder)
+{
+    m_instances.push_back({ model, boxMin, boxMax, occluder });
+    return (uint32_t)m_instances.size() - 1;
+}
+
+OcclusionCuller::ScreenRect OcclusionCuller::projectBox(const Instance& instance) const
+{
+    ScreenRect rect = { 0, 0, 0, 0, 1.0f, false, false };
+    glm::mat4 mvp = m_viewProjection * instance.model;
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        glm::vec3 p((corner & 1) ? instance.boxMax.x : instance.boxMin.x,
+            (corner & 2) ? instance.boxMax.y : instance.boxMin.y, (corner & 4) ? instance.boxMax.z : instance.boxMin.z);
+        glm::vec4 clip = mvp * glm::vec4(p, 1.0f);
+        if (clip.w <= 1e-5f || clip.z < -clip.w)
+        {
+            rect.crossesNear = true;
+            return rect;
+        }
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        lo = glm::min(lo, ndc);
+        hi = glm::max(hi, ndc);
+    }
+
+    // Pixels que a caixa toca, mesmo que parcialmente
+    float x0 = (lo.x * 0.5f + 0.5f) * m_width, x1 = (hi.x * 0.5f + 0.5f) * m_width;
+    float y0 = (lo.y * 0.5f + 0.5f) * m_height, y1 = (hi.y * 0.5f + 0.5f) * m_height;
+    rect.offscreen = x1 <= 0.0f || y1 <= 0.0f || x0 >= m_width || y0 >= m_height || lo.z > 1.0f;
+    rect.minX = std::max(0, (int)std::floor(x0));
+    rect.minY = std::max(0, (int)std::floor(y0));
+    rect.maxX = std::min(m_width - 1, (int)std::ceil(x1) - 1);
+    rect.maxY = std::min(m_height - 1, (int)std::ceil(y1) - 1);
+    rect.zMin = lo.z * 0.5f + 0.5f;
+    return rect;
+}
+
+void OcclusionCuller::setupOccluders()
+{
+    // Maiores na tela primeiro; depois da frente para trás, o que deixa a
+    // camada em construção de cada tile mais próxima
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < m_instances.size(); ++i)
+    {
+        const ScreenRect& rect = m_rects[i];
+        if (m_instances[i].occluder && !rect.crossesNear && !rect.offscreen)
+            candidates.push_back(i);
+    }
+
+    auto area = [this](uint32_t i)
+        {
+            const ScreenRect& rect = m_rects[i];
+            return (rect.maxX - rect.minX + 1) * (rect.maxY - rect.minY + 1);
+        };
+    size_t count = std::min<size_t>(candidates.size(), m_maxOccluders);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+        [&](uint32_t a, uint32_t b) { return area(a) > area(b); });
+    candidates.resize(count);
+    std::sort(candidates.begin(), candidates.end(),
+        [this](uint32_t a, uint32_t b) { return m_rects[a].zMin < m_rects[b].zMin; });
+
+    m_triangles.clear();
+    for (uint32_t i : candidates)
+    {
+        const Instance& instance = m_instances[i];
+        glm::mat4 mvp = m_viewProjection * instance.model;
+        const std::vector<glm::vec3>& positions = *instance.occluder;
+
+        for (size_t v = 0; v + 2 < positions.size(); v += 3)
+        {
+            glm::vec3 s[3];
+            bool behindNear = false;
+            for (int k = 0; k < 3; ++k)
+            {
+                glm::vec4 clip = mvp * glm::vec4(positions[v + k], 1.0f);
+                behindNear |= clip.w <= 1e-5f || clip.z < -clip.w;
+                glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                s[k] = glm::vec3((ndc.x * 0.5f + 0.5f) * m_width, (ndc.y * 0.5f + 0.5f) * m_height, ndc.z * 0.5f + 0.5f);
+            }
+            // Sem recorte: triângulo que atravessa o near simplesmente não oclui
+            if (behindNear)
+                continue;
+
+            // Anti-horário na tela com y para cima = frente; trás é encoberto pela frente
+            float area2 = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[1].y - s[0].y) * (s[2].x - s[0].x);
+            if (area2 <= 1e-8f)
+                continue;
+
+            Triangle tri;
+            float zPlaneA = 0.0f, zPlaneB = 0.0f, zPlaneC = 0.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                // Aresta oposta ao vértice k; positiva do lado de dentro
+                const glm::vec3& a = s[(k + 1) % 3];
+                const glm::vec3& b = s[(k + 2) % 3];
+                float A = a.y - b.y, B = b.x - a.x, C = -(A * a.x + B * a.y);
+                zPlaneA += A * s[k].z;
+                zPlaneB += B * s[k].z;
+                zPlaneC += C * s[k].z;
+                tri.edgeA[k] = A;
+                tri.edgeB[k] = B;
+                tri.edgeC[k] = C;
+            }
+            tri.zA = zPlaneA / area2;
+            tri.zB = zPlaneB / area2;
+            tri.zC = zPlaneC / area2;
+            tri.zMax = std::min(1.0f, std::max(s[0].z, std::max(s[1].z, s[2].z)));
+
+            float minX = std::min(s[0].x, std::min(s[1].x, s[2].x)), maxX = std::max(s[0].x, std::max(s[1].x, s[2].x));
+            float minY = std::min(s[0].y, std::min(s[1].y, s[2].y)), maxY = std::max(s[0].y, std::max(s[1].y, s[2].y));
+            tri.minX = std::max(0, (int)std::floor(minX));
+            tri.minY = std::max(0, (int)std::floor(minY));
+            tri.maxX = std::min(m_width - 1, (int)std::ceil(maxX) - 1);
+            tri.maxY = std::min(m_height - 1, (int)std::ceil(maxY) - 1);
+            if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+                continue;
+            m_triangles.push_back(tri);
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const Triangle& tri, int tileY0, int tileY1)
+{
+    int tx0 = tri.minX / TILE_SIZE, tx1 = tri.maxX / TILE_SIZE;
+    int ty0 = std::max(tileY0, tri.minY / TILE_SIZE), ty1 = std::min(tileY1 - 1, tri.maxY / TILE_SIZE);
+
+    for (int ty = ty0; ty <= ty1; ++ty)
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            Tile& tile = m_tiles[(size_t)ty * m_tilesX + tx];
+            float px0 = (float)(tx * TILE_SIZE), py0 = (float)(ty * TILE_SIZE);
+
+            // Maior profundidade do triângulo no tile: o plano no pior canto,
+            // limitado pelo vértice mais distante
+            float zTri = tri.zC + std::max(tri.zA * px0, tri.zA * (px0 + TILE_SIZE)) +
+                std::max(tri.zB * py0, tri.zB * (py0 + TILE_SIZE));
+            zTri = std::min(zTri, tri.zMax);
+            if (zTri >= tile.zMax0)
+                continue;
+
+            // Cobertura dos 64 pixels, uma linha de 8 por vez sem desvios (o
+            // compilador vetoriza o laço interno)
+            uint64_t covered = 0;
+            for (int row = 0; row < TILE_SIZE; ++row)
+            {
+                float py = py0 + row + 0.5f;
+                float e0 = tri.edgeB[0] * py + tri.edgeC[0];
+                float e1 = tri.edgeB[1] * py + tri.edgeC[1];
+                float e2 = tri.edgeB[2] * py + tri.edgeC[2];
+                unsigned bits = 0;
+                for (int col = 0; col < TILE_SIZE; ++col)
+                {
+                    float px = px0 + col + 0.5f;
+                    bool inside = (tri.edgeA[0] * px + e0 >= 0.0f) & (tri.edgeA[1] * px + e1 >= 0.0f) &
+                        (tri.edgeA[2] * px + e2 >= 0.0f);
+                    bits |= (unsigned)inside << col;
+                }
+                covered |= (uint64_t)bits << (row * TILE_SIZE);
+            }
+            if (covered == 0)
+                continue;
+
+            tile.zMax1 = tile.mask ? std::max(tile.zMax1, zTri) : zTri;
+            tile.mask |= covered;
+
+            // Camada em construção cobriu o tile: vira a camada completa
+            if (tile.mask == FULL_MASK)
+            {
+                tile.zMax0 = tile.zMax1;
+                tile.zMax1 = 0.0f;
+                tile.mask = 0;
+            }
+        }
+}
+
+void OcclusionCuller::rasterizeTileRows(int tileY0, int tileY1)
+{
+    for (int ty = tileY0; ty < tileY1; ++ty)
+        std::fill(m_tiles.begin() + (size_t)ty * m_tilesX, m_tiles.begin() + (size_t)(ty + 1) * m_tilesX,
+            Tile{ 0, 1.0f, 0.0f });
+
+    int pixelY0 = tileY0 * TILE_SIZE, pixelY1 = tileY1 * TILE_SIZE - 1;
+    for (const Triangle& tri : m_triangles)
+        if (tri.maxY >= pixelY0 && tri.minY <= pixelY1)
+            rasterizeTriangle(tri, tileY0, tileY1);
+}
+
+bool OcclusionCuller::testRect(const ScreenRect& rect) const
+{
+    for (int ty = rect.minY / TILE_SIZE; ty <= rect.maxY / TILE_SIZE; ++ty)
+    {
+        int row0 = std::max(rect.minY - ty * TILE_SIZE, 0), row1 = std::min(rect.maxY - ty * TILE_SIZE, TILE_SIZE - 1);
+        for (int tx = rect.minX / TILE_SIZE; tx <= rect.maxX / TILE_SIZE; ++tx)
+        {
+            const Tile& tile = m_tiles[(size_t)ty * m_tilesX + tx];
+            if (rect.zMin > tile.zMax0)
+                continue;
+
+            // Só a camada em construção está na frente: vale se a caixa cair
+            // inteira nos pixels da máscara
+            int col0 = std::max(rect.minX - tx * TILE_SIZE, 0), col1 = std::min(rect.maxX - tx * TILE_SIZE, TILE_SIZE - 1);
+            uint64_t rowBits = ((1ull << (col1 + 1)) - 1) & ~((1ull << col0) - 1);
+            uint64_t rectMask = 0;
+            for (int row = row0; row <= row1; ++row)
+                rectMask |= rowBits << (row * TILE_SIZE);
+
+            if ((rectMask & ~tile.mask) != 0 || rect.zMin <= tile.zMax1)
+                return true;
+        }
+    }
+    return false;
+}
+
+void OcclusionCuller::cull()
+{
+    PROFILE_SCOPE("Culling");
+    auto start = std::chrono::steady_clock::now();
+
+    size_t count = m_instances.size();
+    m_rects.resize(count);
+    m_visible.assign(count, 1);
+
+    auto run = [this](size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+        {
+            if (m_jobs)
+                m_jobs->parallelFor(count, grain, fn);
+            else
+                fn(0, count);
+        };
+
+    run(count, 256, [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                m_rects[i] = projectBox(m_instances[i]);
+        });
+
+    {
+        PROFILE_SCOPE("OccluderRaster");
+        setupOccluders();
+        // Cada job fica com uma faixa de linhas de tiles: nenhum tile é escrito por duas threads
+        run((size_t)m_tilesY, 1, [this](size_t begin, size_t end) { rasterizeTileRows((int)begin, (int)end); });
+    }
+    auto rasterized = std::chrono::steady_clock::now();
+
+    {
+        PROFILE_SCOPE("OcclusionTest");
+        run(count, 256, [this](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const ScreenRect& rect = m_rects[i];
+                    if (!rect.crossesNear && !rect.offscreen)
+                        m_visible[i] = testRect(rect) ? 1 : 0;
+                }
+            });
+    }
+    auto tested = std::chrono::steady_clock::now();
+
+    m_lastOccluded = (uint32_t)std::count(m_visible.begin(), m_visible.end(), 0);
+    m_stats.frames++;
+    m_stats.instancesTested += count;
+    m_stats.instancesOccluded += m_lastOccluded;
+    m_stats.occluderTriangles += m_triangles.size();
+    m_stats.rasterizeMs += std::chrono::duration<double, std::milli>(rasterized - start).count();
+    m_stats.testMs += std::chrono::duration<double, std::milli>(tested - rasterized).count();
+}
+
+void OcclusionCuller::printStats() const
+{
+    if (m_stats.frames == 0)
+        return;
+
+    double frames = (double)m_stats.frames;
+    std::cout << "Oclusao: " << m_stats.frames << " frames, media de " << m_stats.instancesOccluded / frames
+        << " de " << m_stats.instancesTested / frames << " instancias descartadas, "
+        << m_stats.occluderTriangles / frames << " triangulos de oclusores, rasterizacao "
+        << m_stats.rasterizeMs / frames << " ms, teste " << m_stats.testMs / frames << " ms ("
+        << m_tilesX * TILE_SIZE << "x" << m_tilesY * TILE_SIZE << ")" << std::endl;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+
+// Oclusão em CPU (masked occlusion culling) para cenas com muitas instâncias
+// que se escondem umas atrás das outras.
+//
+//   culler.beginFrame(projection * view);
+//   for (...) culler.addInstance(model, boxMin, boxMax, &cubePositions);
+//   culler.cull();                          // em paralelo no JobSystem
+//   for (...) if (culler.isVisible(i)) glDraw...;
+//
+// Os maiores oclusores na tela (até maxOccluders) são rasterizados num buffer
+// de baixa resolução dividido em tiles de 8x8. Cada tile guarda só uma máscara
+// de 64 bits dos pixels cobertos e duas profundidades máximas: a da camada
+// completa e a da camada em construção. Depois a caixa de cada instância é
+// projetada e comparada com os tiles que ela toca; se estiver atrás em todos
+// a instância não é enviada para a GPU.
+//
+// A cobertura usa o centro do pixel, como o rasterizador da GPU, mas a
+// profundidade do oclusor é sempre a maior do triângulo no tile e a caixa
+// testada cobre todo pixel que toca; só uma fresta menor que um pixel do
+// buffer entre dois oclusores pode esconder algo visível. Roda antes dos draws
+// do frame, nos workers, enquanto a GPU ainda processa o frame anterior.
+
+struct OcclusionStats
+{
+    uint64_t frames = 0;
+    uint64_t instancesTested = 0;
+    uint64_t instancesOccluded = 0;
+    uint64_t occluderTriangles = 0;
+    double rasterizeMs = 0.0;
+    double testMs = 0.0;
+};
+
+class OcclusionCuller
+{
+public:
+    // Largura e altura são arredondadas para múltiplos de 8. Sem JobSystem tudo
+    // roda na thread que chama.
+    OcclusionCuller(int width = 256, int height = 192, JobSystem* jobs = nullptr, unsigned maxOccluders = 128);
+
+    void beginFrame(const glm::mat4& viewProjection);
+
+    // Caixa em espaço local, levada para a tela com model. "occluder" é a malha
+    // (lista de triângulos em espaço local) usada se a instância for escolhida
+    // como oclusor; nullptr para instâncias que só são testadas. Retorna o
+    // índice da instância.
+    uint32_t addInstance(const glm::mat4& model, const glm::vec3& boxMin, const glm::vec3& boxMax,
+        const std::vector<glm::vec3>* occluder = nullptr);
+
+    void cull();
+
+    bool isVisible(uint32_t instance) const { return m_visible[instance] != 0; }
+
+    // Resultado do último cull() e acumulado desde a criação
+    uint32_t getOccludedCount() const { return m_lastOccluded; }
+    const OcclusionStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+    static const int TILE_SIZE = 8;
+
+private:
+    struct Instance
+    {
+        glm::mat4 model;
+        glm::vec3 boxMin;
+        glm::vec3 boxMax;
+        const std::vector<glm::vec3>* occluder;
+    };
+
+    // Retângulo da caixa projetada em pixels (inclusivo) e menor profundidade
+    struct ScreenRect
+    {
+        int minX, minY, maxX, maxY;
+        float zMin;
+        bool crossesNear;   // algum canto atrás do plano near: sempre visível
+        bool offscreen;
+    };
+
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float zA, zB, zC;
+        float zMax;
+        int minX, minY, maxX, maxY;
+    };
+
+    struct Tile
+    {
+        uint64_t mask;  // pixels cobertos pela camada em construção
+        float zMax0;    // camada completa: todo pixel do tile está na frente disto
+        float zMax1;    // camada em construção: pixels da máscara estão na frente disto
+    };
+
+    ScreenRect projectBox(const Instance& instance) const;
+    void setupOccluders();
+    void rasterizeTileRows(int tileY0, int tileY1);
+    void rasterizeTriangle(const Triangle& tri, int tileY0, int tileY1);
+    bool testRect(const ScreenRect& rect) const;
+
+    int m_width;
+    int m_height;
+    int m_tilesX;
+    int m_tilesY;
+    JobSystem* m_jobs;
+    unsigned m_maxOccluders;
+
+    glm::mat4 m_viewProjection = glm::mat4(1.0f);
+    std::vector<Instance> m_instances;
+    std::vector<ScreenRect> m_rects;
+    std::vector<uint8_t> m_visible;
+    std::vector<Triangle> m_triangles;
+    std::vector<Tile> m_tiles;
+
+    uint32_t m_lastOccluded = 0;
+    OcclusionStats m_stats;
+};
@@ -0,0 +1,45 @@
+#include "Overdraw.h"
+
+static const char* overdrawVertexSource = R"glsl(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)glsl";
+
+static const char* overdrawFragmentSource = R"glsl(
+#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0 / 8.0, 1.0 / 16.0, 1.0 / 32.0, 1.0);
+}
+)glsl";
+
+GLuint createOverdrawProgram(ShaderCache& cache)
+{
+    return cache.getProgram("overdraw", overdrawVertexSource, overdrawFragmentSource);
+}
+
+void beginOverdraw()
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+}
+
+void endOverdraw()
+{
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
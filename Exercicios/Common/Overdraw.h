@@ -0,0 +1,17 @@
+#pragma once
+#include <glad/glad.h>
+
+#include "ShaderCache.h"
+
+// Visualização de overdraw: cada fragmento rasterizado soma uma cor fixa com
+// blend aditivo e sem teste de profundidade, então o brilho do pixel mostra
+// quantas vezes ele foi pintado (vermelho satura em 8 camadas, verde em 16,
+// azul em 32).
+//
+// O programa usa só a posição (location 0) e os uniforms model/view/projection,
+// então substitui o programa normal de qualquer módulo no modo de diagnóstico.
+GLuint createOverdrawProgram(ShaderCache& cache);
+
+// Liga/desliga o estado de blend aditivo usado no modo overdraw
+void beginOverdraw();
+void endOverdraw();
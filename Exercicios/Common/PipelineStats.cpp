@@ -0,0 +1,202 @@
+#include "PipelineStats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "GLUtil.h"
+
+// Alvos das queries na ordem do enum Counter (mesmos valores da extensão ARB)
+static const GLenum COUNTER_TARGETS[PipelineStats::COUNTER_COUNT] = {
+    GL_VERTICES_SUBMITTED,
+    GL_PRIMITIVES_SUBMITTED,
+    GL_VERTEX_SHADER_INVOCATIONS,
+    GL_CLIPPING_INPUT_PRIMITIVES,
+    GL_CLIPPING_OUTPUT_PRIMITIVES,
+    GL_FRAGMENT_SHADER_INVOCATIONS
+};
+
+static const char* COUNTER_NAMES[PipelineStats::COUNTER_COUNT] = {
+    "vertices", "primitives", "vs_invocations", "clipping_in", "clipping_out", "fs_invocations"
+};
+
+PipelineStats::PipelineStats(const std::string& csvPath, unsigned latencyFrames, unsigned maxPassesPerFrame)
+    : m_csvPath(csvPath), m_frames(std::max(latencyFrames, 2u)), m_maxPasses(maxPassesPerFrame)
+{
+    m_supported = GLAD_GL_VERSION_4_6 || hasGLExtension("GL_ARB_pipeline_statistics_query");
+    if (!m_supported)
+        return;
+
+    for (Frame& frame : m_frames)
+    {
+        frame.queries.resize((size_t)m_maxPasses * COUNTER_COUNT);
+        glGenQueries((GLsizei)frame.queries.size(), frame.queries.data());
+    }
+}
+
+bool PipelineStats::setEnabled(bool enabled)
+{
+    if (enabled && !m_supported)
+    {
+        std::cerr << "PipelineStats: contexto sem ARB_pipeline_statistics_query" << std::endl;
+        return false;
+    }
+
+    if (enabled && !m_csv.is_open())
+    {
+        m_csv.open(m_csvPath);
+        if (!m_csv)
+        {
+            std::cerr << "PipelineStats: nao foi possivel criar " << m_csvPath << std::endl;
+            return false;
+        }
+        m_csv << "frame,pass";
+        for (const char* name : COUNTER_NAMES)
+            m_csv << "," << name;
+        m_csv << "\n";
+    }
+
+    m_enabled = enabled;
+    std::cout << "PipelineStats: " << (enabled ? "ligado, gravando em " + m_csvPath : "desligado") << std::endl;
+    return true;
+}
+
+bool PipelineStats::isReady(const Frame& frame) const
+{
+    if (frame.passes.empty())
+        return true;
+
+    // A última query emitida é a de fragmentos do último passe
+    GLuint available = GL_FALSE;
+    unsigned last = frame.passes.back().firstQuery + COUNTER_COUNT - 1;
+    glGetQueryObjectuiv(frame.queries[last], GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+}
+
+void PipelineStats::beginFrame()
+{
+    m_frameIndex++;
+    if (!m_supported || m_frames[0].queries.empty())
+        return;
+
+    m_current = (m_current + 1) % m_frames.size();
+    Frame& frame = m_frames[m_current];
+
+    if (frame.pending)
+    {
+        if (isReady(frame))
+            collect(frame);
+        else
+            m_dropped++;
+    }
+
+    frame.passes.clear();
+    frame.pending = false;
+    frame.frameIndex = m_frameIndex;
+    m_passDepth = 0;
+    m_passActive = false;
+    m_inFrame = m_enabled;
+}
+
+void PipelineStats::endFrame()
+{
+    if (!m_inFrame)
+        return;
+
+    m_frames[m_current].pending = true;
+    m_inFrame = false;
+}
+
+void PipelineStats::begin(const char* pass)
+{
+    if (!m_inFrame || m_passDepth++ > 0)
+        return;
+
+    Frame& frame = m_frames[m_current];
+    if (frame.passes.size() >= m_maxPasses)
+        return;
+
+    unsigned first = (unsigned)frame.passes.size() * COUNTER_COUNT;
+    frame.passes.push_back({ pass, first });
+    for (int i = 0; i < COUNTER_COUNT; ++i)
+        glBeginQuery(COUNTER_TARGETS[i], frame.queries[first + i]);
+    m_passActive = true;
+}
+
+void PipelineStats::end()
+{
+    if (!m_inFrame || m_passDepth == 0 || --m_passDepth > 0 || !m_passActive)
+        return;
+
+    for (int i = 0; i < COUNTER_COUNT; ++i)
+        glEndQuery(COUNTER_TARGETS[i]);
+    m_passActive = false;
+}
+
+void PipelineStats::collect(Frame& frame)
+{
+    for (const Pass& pass : frame.passes)
+    {
+        auto totals = std::find_if(m_totals.begin(), m_totals.end(),
+            [&](const PassTotals& entry) { return strcmp(entry.name, pass.name) == 0; });
+        if (totals == m_totals.end())
+        {
+            m_totals.push_back({ pass.name });
+            totals = m_totals.end() - 1;
+        }
+        totals->frames++;
+
+        m_csv << frame.frameIndex << "," << pass.name;
+        for (int i = 0; i < COUNTER_COUNT; ++i)
+        {
+            GLuint64 value = 0;
+            glGetQueryObjectui64v(frame.queries[pass.firstQuery + i], GL_QUERY_RESULT, &value);
+            totals->counters[i] += value;
+            m_csv << "," << value;
+        }
+        m_csv << "\n";
+    }
+
+    if (!frame.passes.empty())
+        m_framesWritten++;
+    frame.pending = false;
+}
+
+void PipelineStats::destroy()
+{
+    // No encerramento pode esperar a GPU: grava os frames que ainda estavam no anel
+    for (unsigned i = 1; i <= m_frames.size(); ++i)
+    {
+        Frame& frame = m_frames[(m_current + i) % m_frames.size()];
+        if (frame.pending)
+            collect(frame);
+    }
+
+    for (Frame& frame : m_frames)
+    {
+        if (!frame.queries.empty())
+            glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+        frame.queries.clear();
+    }
+    m_inFrame = false;
+    m_csv.flush();
+}
+
+void PipelineStats::printReport() const
+{
+    if (m_framesWritten == 0)
+        return;
+
+    std::cout << "PipelineStats: " << m_framesWritten << " frames em " << m_csvPath;
+    if (m_dropped > 0)
+        std::cout << " (" << m_dropped << " frame(s) descartado(s))";
+    std::cout << std::endl;
+
+    for (const PassTotals& totals : m_totals)
+    {
+        std::cout << "  " << totals.name << " (media/frame):";
+        for (int i = 0; i < COUNTER_COUNT; ++i)
+            std::cout << " " << COUNTER_NAMES[i] << "=" << totals.counters[i] / totals.frames;
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Profiler.h"
+
+// Contadores de pipeline por passe (GL 4.6 / ARB_pipeline_statistics_query).
+//
+// Mede quantos vértices, primitivas e invocações de fragment shader cada
+// passe custa e grava uma linha por passe e por frame num CSV. Como no
+// GpuProfiler, as queries ficam num anel de vários frames e só são lidas
+// quando já estão prontas.
+//
+//   stats.beginFrame();
+//   { PIPELINE_STATS_SCOPE(stats, "Cubos"); glDrawArrays(...); }
+//   stats.endFrame();
+//
+// Passes não podem ser aninhados (uma query ativa por alvo); um begin() dentro
+// de outro passe é ignorado e conta para o passe de fora.
+
+class PipelineStats
+{
+public:
+    enum Counter
+    {
+        VERTICES_SUBMITTED,
+        PRIMITIVES_SUBMITTED,
+        VERTEX_SHADER_INVOCATIONS,
+        CLIPPING_INPUT_PRIMITIVES,
+        CLIPPING_OUTPUT_PRIMITIVES,
+        FRAGMENT_SHADER_INVOCATIONS,
+        COUNTER_COUNT
+    };
+
+    explicit PipelineStats(const std::string& csvPath, unsigned latencyFrames = 4, unsigned maxPassesPerFrame = 16);
+
+    PipelineStats(const PipelineStats&) = delete;
+    PipelineStats& operator=(const PipelineStats&) = delete;
+
+    bool isSupported() const { return m_supported; }
+
+    // Desligado por padrão; ligar abre o CSV (na primeira vez). false se não
+    // deu para ligar (sem a extensão ou sem o CSV); aí continua desligado
+    bool setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    void beginFrame();
+    void endFrame();
+
+    void begin(const char* pass);
+    void end();
+
+    // Lê os frames pendentes (esperando a GPU) e apaga as queries;
+    // chamar antes de destruir o contexto GL
+    void destroy();
+
+    void printReport() const;
+
+private:
+    struct Pass
+    {
+        const char* name;
+        unsigned firstQuery;
+    };
+
+    struct Frame
+    {
+        std::vector<GLuint> queries;
+        std::vector<Pass> passes;
+        uint64_t frameIndex = 0;
+        bool pending = false;
+    };
+
+    struct PassTotals
+    {
+        const char* name;
+        uint64_t frames = 0;
+        uint64_t counters[COUNTER_COUNT] = {};
+    };
+
+    bool isReady(const Frame& frame) const;
+    void collect(Frame& frame);
+
+    std::string m_csvPath;
+    std::ofstream m_csv;
+    bool m_supported = false;
+    bool m_enabled = false;
+
+    std::vector<Frame> m_frames;
+    unsigned m_maxPasses;
+    unsigned m_current = 0;
+    bool m_inFrame = false;
+    int m_passDepth = 0;
+    bool m_passActive = false;
+
+    uint64_t m_frameIndex = 0;
+    uint64_t m_framesWritten = 0;
+    unsigned m_dropped = 0;
+    std::vector<PassTotals> m_totals;
+};
+
+class PipelineStatsScope
+{
+public:
+    PipelineStatsScope(PipelineStats& stats, const char* pass) : m_stats(stats) { m_stats.begin(pass); }
+    ~PipelineStatsScope() { m_stats.end(); }
+
+private:
+    PipelineStats& m_stats;
+};
+
+#define PIPELINE_STATS_SCOPE(stats, pass) PipelineStatsScope PROFILE_CONCAT(pipelineStatsScope_, __LINE__)(stats, pass)
@@ -0,0 +1,465 @@
+#include "Primitives.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+    const float PI = 3.14159265358979f;
+
+    void addVertex(PrimitiveMesh& mesh, const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv,
+        const glm::vec3& color)
+    {
+        mesh.positions.push_back(position);
+        mesh.normals.push_back(normal);
+        mesh.uvs.push_back(uv);
+        mesh.colors.push_back(color);
+    }
+
+    void addTriangle(PrimitiveMesh& mesh, uint32_t a, uint32_t b, uint32_t c)
+    {
+        mesh.indices.push_back(a);
+        mesh.indices.push_back(b);
+        mesh.indices.push_back(c);
+    }
+
+    // Mesmo mapeamento do antigo generateSphere: theta a partir de +y, phi no plano XZ
+    glm::vec3 sphereDirection(float theta, float phi)
+    {
+        return glm::vec3(std::cos(phi) * std::sin(theta), std::cos(theta), std::sin(phi) * std::sin(theta));
+    }
+
+    void buildUvSphere(PrimitiveMesh& mesh, float radius, int rings, int sectors, const glm::vec3& color)
+    {
+        rings = std::max(rings, 2);
+        sectors = std::max(sectors, 3);
+
+        // Anéis 1..rings-1 com sectors+1 vértices (a costura u = 0/1 duplicada)
+        uint32_t columns = (uint32_t)sectors + 1;
+        for (int i = 1; i < rings; ++i)
+        {
+            float theta = PI * i / rings;
+            for (int j = 0; j <= sectors; ++j)
+            {
+                float phi = 2.0f * PI * j / sectors;
+                glm::vec3 normal = sphereDirection(theta, phi);
+                addVertex(mesh, normal * radius, normal, glm::vec2((float)j / sectors, (float)i / rings), color);
+            }
+        }
+        auto ring = [&](int i, int j) { return (uint32_t)(i - 1) * columns + (uint32_t)j; };
+
+        // Um vértice de polo por setor, com u no meio do setor
+        uint32_t top = (uint32_t)mesh.positions.size();
+        for (int j = 0; j < sectors; ++j)
+            addVertex(mesh, glm::vec3(0.0f, radius, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+                glm::vec2((j + 0.5f) / sectors, 0.0f), color);
+        uint32_t bottom = (uint32_t)mesh.positions.size();
+        for (int j = 0; j < sectors; ++j)
+            addVertex(mesh, glm::vec3(0.0f, -radius, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+                glm::vec2((j + 0.5f) / sectors, 1.0f), color);
+
+        for (int j = 0; j < sectors; ++j)
+        {
+            addTriangle(mesh, top + j, ring(1, j + 1), ring(1, j));
+            for (int i = 1; i < rings - 1; ++i)
+            {
+                addTriangle(mesh, ring(i, j), ring(i, j + 1), ring(i + 1, j));
+                addTriangle(mesh, ring(i, j + 1), ring(i + 1, j + 1), ring(i + 1, j));
+            }
+            addTriangle(mesh, ring(rings - 1, j), ring(rings - 1, j + 1), bottom + j);
+        }
+    }
+
+    void buildIcosphere(PrimitiveMesh& mesh, float radius, int subdivisions, const glm::vec3& color)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+        std::vector<glm::vec3> points = {
+            { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+            { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+            { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 },
+        };
+        std::vector<uint32_t> faces = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+        };
+        for (glm::vec3& p : points)
+            p = glm::normalize(p);
+
+        // Cada aresta ganha um ponto médio, compartilhado pelos dois triângulos vizinhos
+        for (int level = 0; level < std::clamp(subdivisions, 0, 7); ++level)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+            auto midpoint = [&](uint32_t a, uint32_t b)
+                {
+                    auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                    auto it = midpoints.find(key);
+                    if (it != midpoints.end())
+                        return it->second;
+                    points.push_back(glm::normalize(points[a] + points[b]));
+                    uint32_t index = (uint32_t)points.size() - 1;
+                    midpoints.emplace(key, index);
+                    return index;
+                };
+
+            std::vector<uint32_t> next;
+            next.reserve(faces.size() * 4);
+            for (size_t f = 0; f < faces.size(); f += 3)
+            {
+                uint32_t a = faces[f], b = faces[f + 1], c = faces[f + 2];
+                uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+                next.insert(next.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+            faces.swap(next);
+        }
+
+        for (const glm::vec3& p : points)
+        {
+            float u = std::atan2(p.z, p.x) / (2.0f * PI);
+            addVertex(mesh, p * radius, p, glm::vec2(u < 0.0f ? u + 1.0f : u, std::acos(std::clamp(p.y, -1.0f, 1.0f)) / PI),
+                color);
+        }
+
+        // Triângulos que cruzam a costura u = 0/1 usam cópias com u + 1
+        std::map<uint32_t, uint32_t> wrapped;
+        for (size_t f = 0; f < faces.size(); f += 3)
+        {
+            float minU = 1.0f, maxU = 0.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                minU = std::min(minU, mesh.uvs[faces[f + k]].x);
+                maxU = std::max(maxU, mesh.uvs[faces[f + k]].x);
+            }
+            if (maxU - minU > 0.5f)
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t index = faces[f + k];
+                    if (mesh.uvs[index].x >= 0.5f)
+                        continue;
+                    auto it = wrapped.find(index);
+                    if (it == wrapped.end())
+                    {
+                        addVertex(mesh, mesh.positions[index], mesh.normals[index],
+                            mesh.uvs[index] + glm::vec2(1.0f, 0.0f), color);
+                        it = wrapped.emplace(index, (uint32_t)mesh.positions.size() - 1).first;
+                    }
+                    faces[f + k] = it->second;
+                }
+        }
+        mesh.indices = std::move(faces);
+    }
+
+    void buildCube(PrimitiveMesh& mesh, float size)
+    {
+        // Normal, eixos u e v da face (u x v = normal) e a cor da face no Modulo2
+        struct Face { glm::vec3 normal, u, v, color; };
+        const Face faces[] = {
+            { {  0,  0,  1 }, {  1, 0,  0 }, { 0, 1,  0 }, { 1, 0, 0 } },
+            { {  0,  0, -1 }, { -1, 0,  0 }, { 0, 1,  0 }, { 0, 1, 0 } },
+            { { -1,  0,  0 }, {  0, 0,  1 }, { 0, 1,  0 }, { 0, 0, 1 } },
+            { {  1,  0,  0 }, {  0, 0, -1 }, { 0, 1,  0 }, { 1, 1, 0 } },
+            { {  0,  1,  0 }, {  1, 0,  0 }, { 0, 0, -1 }, { 0, 1, 1 } },
+            { {  0, -1,  0 }, {  1, 0,  0 }, { 0, 0,  1 }, { 1, 0, 1 } },
+        };
+        const glm::vec2 corners[] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+
+        float half = size * 0.5f;
+        for (const Face& face : faces)
+        {
+            uint32_t base = (uint32_t)mesh.positions.size();
+            for (const glm::vec2& corner : corners)
+            {
+                glm::vec3 position = (face.normal + face.u * (corner.x * 2.0f - 1.0f) + face.v * (corner.y * 2.0f - 1.0f)) * half;
+                addVertex(mesh, position, face.normal, corner, face.color);
+            }
+            addTriangle(mesh, base, base + 1, base + 2);
+            addTriangle(mesh, base, base + 2, base + 3);
+        }
+    }
+
+    void buildPlane(PrimitiveMesh& mesh, float width, float depth, int divisions, const glm::vec3& color)
+    {
+        divisions = std::max(divisions, 1);
+        uint32_t columns = (uint32_t)divisions + 1;
+        for (int j = 0; j <= divisions; ++j)
+            for (int i = 0; i <= divisions; ++i)
+            {
+                glm::vec2 uv((float)i / divisions, (float)j / divisions);
+                addVertex(mesh, glm::vec3((uv.x - 0.5f) * width, 0.0f, (uv.y - 0.5f) * depth),
+                    glm::vec3(0.0f, 1.0f, 0.0f), uv, color);
+            }
+
+        for (uint32_t j = 0; j < (uint32_t)divisions; ++j)
+            for (uint32_t i = 0; i < (uint32_t)divisions; ++i)
+            {
+                uint32_t a = j * columns + i;
+                addTriangle(mesh, a, a + columns, a + 1);
+                addTriangle(mesh, a + 1, a + columns, a + columns + 1);
+            }
+    }
+
+    void buildCylinder(PrimitiveMesh& mesh, float radius, float height, int sectors, const glm::vec3& color)
+    {
+        sectors = std::max(sectors, 3);
+        float half = height * 0.5f;
+
+        // Lateral: linha de cima e de baixo, com a costura duplicada
+        for (int j = 0; j <= sectors; ++j)
+        {
+            float phi = 2.0f * PI * j / sectors;
+            glm::vec3 normal(std::cos(phi), 0.0f, std::sin(phi));
+            float u = (float)j / sectors;
+            addVertex(mesh, normal * radius + glm::vec3(0.0f, half, 0.0f), normal, glm::vec2(u, 0.0f), color);
+            addVertex(mesh, normal * radius - glm::vec3(0.0f, half, 0.0f), normal, glm::vec2(u, 1.0f), color);
+        }
+        for (uint32_t j = 0; j < (uint32_t)sectors; ++j)
+        {
+            uint32_t top = j * 2, next = top + 2;
+            addTriangle(mesh, top, next, top + 1);
+            addTriangle(mesh, next, next + 1, top + 1);
+        }
+
+        // Tampas: centro + anel próprio (a normal é outra)
+        for (float side : { 1.0f, -1.0f })
+        {
+            glm::vec3 normal(0.0f, side, 0.0f);
+            uint32_t center = (uint32_t)mesh.positions.size();
+            addVertex(mesh, normal * half, normal, glm::vec2(0.5f), color);
+            for (int j = 0; j < sectors; ++j)
+            {
+                float phi = 2.0f * PI * j / sectors;
+                glm::vec2 direction(std::cos(phi), std::sin(phi));
+                addVertex(mesh, glm::vec3(direction.x * radius, side * half, direction.y * radius), normal,
+                    glm::vec2(0.5f) + direction * 0.5f, color);
+            }
+            for (uint32_t j = 0; j < (uint32_t)sectors; ++j)
+            {
+                uint32_t a = center + 1 + j, b = center + 1 + (j + 1) % sectors;
+                if (side > 0.0f)
+                    addTriangle(mesh, center, b, a);
+                else
+                    addTriangle(mesh, center, a, b);
+            }
+        }
+    }
+}
+
+// A chave do cache é comparada byte a byte: sem padding entre os campos
+static_assert(sizeof(PrimitiveShape) == 36, "PrimitiveShape com padding");
+
+PrimitiveShape PrimitiveShape::uvSphere(float radius, int rings, int sectors, const glm::vec3& color)
+{
+    PrimitiveShape shape;
+    shape.type = UV_SPHERE;
+    shape.size = glm::vec3(radius);
+    shape.segments[0] = rings;
+    shape.segments[1] = sectors;
+    shape.color = color;
+    return shape;
+}
+
+PrimitiveShape PrimitiveShape::icosphere(float radius, int subdivisions, const glm::vec3& color)
+{
+    PrimitiveShape shape;
+    shape.type = ICOSPHERE;
+    shape.size = glm::vec3(radius);
+    shape.segments[0] = subdivisions;
+    shape.color = color;
+    return shape;
+}
+
+PrimitiveShape PrimitiveShape::cube(float size)
+{
+    PrimitiveShape shape;
+    shape.type = CUBE;
+    shape.size = glm::vec3(size);
+    shape.color = glm::vec3(0.0f);
+    return shape;
+}
+
+PrimitiveShape PrimitiveShape::plane(float width, float depth, int divisions, const glm::vec3& color)
+{
+    PrimitiveShape shape;
+    shape.type = PLANE;
+    shape.size = glm::vec3(width, 0.0f, depth);
+    shape.segments[0] = divisions;
+    shape.color = color;
+    return shape;
+}
+
+PrimitiveShape PrimitiveShape::cylinder(float radius, float height, int sectors, const glm::vec3& color)
+{
+    PrimitiveShape shape;
+    shape.type = CYLINDER;
+    shape.size = glm::vec3(radius, height, radius);
+    shape.segments[0] = sectors;
+    shape.color = color;
+    return shape;
+}
+
+PrimitiveMesh buildPrimitive(const PrimitiveShape& shape)
+{
+    PrimitiveMesh mesh;
+    switch (shape.type)
+    {
+    case PrimitiveShape::UV_SPHERE:
+        buildUvSphere(mesh, shape.size.x, shape.segments[0], shape.segments[1], shape.color);
+        break;
+    case PrimitiveShape::ICOSPHERE:
+        buildIcosphere(mesh, shape.size.x, shape.segments[0], shape.color);
+        break;
+    case PrimitiveShape::CUBE:
+        buildCube(mesh, shape.size.x);
+        break;
+    case PrimitiveShape::PLANE:
+        buildPlane(mesh, shape.size.x, shape.size.z, shape.segments[0], shape.color);
+        break;
+    case PrimitiveShape::CYLINDER:
+        buildCylinder(mesh, shape.size.x, shape.size.y, shape.segments[0], shape.color);
+        break;
+    }
+
+    for (const glm::vec3& p : mesh.positions)
+        mesh.bounds.grow(p);
+    return mesh;
+}
+
+std::vector<glm::vec3> expandTriangles(const PrimitiveMesh& mesh)
+{
+    std::vector<glm::vec3> triangles;
+    triangles.reserve(mesh.indices.size());
+    for (uint32_t index : mesh.indices)
+        triangles.push_back(mesh.positions[index]);
+    return triangles;
+}
+
+MeshData expandMesh(const PrimitiveMesh& mesh)
+{
+    MeshData data;
+    data.positions.reserve(mesh.indices.size());
+    data.normals.reserve(mesh.indices.size());
+    data.uvs.reserve(mesh.indices.size());
+    data.colors.reserve(mesh.indices.size());
+    for (uint32_t index : mesh.indices)
+    {
+        data.positions.push_back(mesh.positions[index]);
+        data.normals.push_back(mesh.normals[index]);
+        data.uvs.push_back(mesh.uvs[index]);
+        data.colors.push_back(mesh.colors[index]);
+    }
+    return data;
+}
+
+PrimitiveLibrary::Entry& PrimitiveLibrary::entry(const PrimitiveShape& shape)
+{
+    m_requests++;
+    std::unique_ptr<Entry>& slot = m_entries[shape];
+    if (!slot)
+    {
+        slot = std::make_unique<Entry>();
+        slot->mesh = buildPrimitive(shape);
+        m_builds++;
+    }
+    return *slot;
+}
+
+const PrimitiveMesh& PrimitiveLibrary::getMesh(const PrimitiveShape& shape)
+{
+    return entry(shape).mesh;
+}
+
+const Primitive& PrimitiveLibrary::get(const PrimitiveShape& shape, const PrimitiveLayout& layout)
+{
+    Entry& e = entry(shape);
+    for (const auto& primitive : e.primitives)
+        if (primitive.first == layout)
+            return *primitive.second;
+
+    const PrimitiveMesh& mesh = e.mesh;
+    auto primitive = std::make_unique<Primitive>();
+    primitive->indexCount = (GLsizei)mesh.indices.size();
+    primitive->vertexCount = (GLsizei)mesh.positions.size();
+    primitive->bounds = mesh.bounds;
+    primitive->mesh = &mesh;
+
+    // O VAO vem antes dos buffers para o GL_ELEMENT_ARRAY_BUFFER não cair no VAO de quem chamou
+    glGenVertexArrays(1, &primitive->VAO);
+    glBindVertexArray(primitive->VAO);
+
+    if (!e.VBO)
+    {
+        // posição, cor, normal, uv
+        std::vector<float> vertices;
+        vertices.reserve(mesh.positions.size() * 11);
+        for (size_t i = 0; i < mesh.positions.size(); ++i)
+        {
+            const float* attributes[] = { &mesh.positions[i].x, &mesh.colors[i].x, &mesh.normals[i].x, &mesh.uvs[i].x };
+            const int sizes[] = { 3, 3, 3, 2 };
+            for (int a = 0; a < 4; ++a)
+                vertices.insert(vertices.end(), attributes[a], attributes[a] + sizes[a]);
+        }
+
+        glGenBuffers(1, &e.VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, e.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glGenBuffers(1, &e.EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, e.VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e.EBO);
+
+    const GLint locations[] = { layout.position, layout.color, layout.normal, layout.uv };
+    const GLint sizes[] = { 3, 3, 3, 2 };
+    size_t offset = 0;
+    for (int a = 0; a < 4; ++a)
+    {
+        if (locations[a] >= 0)
+        {
+            glVertexAttribPointer(locations[a], sizes[a], GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)offset);
+            glEnableVertexAttribArray(locations[a]);
+        }
+        offset += sizes[a] * sizeof(GLfloat);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    e.primitives.emplace_back(layout, std::move(primitive));
+    return *e.primitives.back().second;
+}
+
+void PrimitiveLibrary::printStats() const
+{
+    size_t vertices = 0, indices = 0, vaos = 0;
+    for (const auto& e : m_entries)
+    {
+        vertices += e.second->mesh.positions.size();
+        indices += e.second->mesh.indices.size();
+        vaos += e.second->primitives.size();
+    }
+
+    std::cout << "Primitivas: " << m_builds << " formas geradas para " << m_requests << " pedidos ("
+        << (m_requests - m_builds) << " reaproveitadas), " << vaos << " VAOs, " << vertices << " vertices e "
+        << indices / 3 << " triangulos, " << (vertices * 11 * sizeof(float) + indices * sizeof(uint32_t)) / 1024
+        << " KB" << std::endl;
+}
+
+void PrimitiveLibrary::destroy()
+{
+    for (auto& e : m_entries)
+    {
+        for (auto& primitive : e.second->primitives)
+            glDeleteVertexArrays(1, &primitive.second->VAO);
+        if (e.second->VBO)
+        {
+            glDeleteBuffers(1, &e.second->VBO);
+            glDeleteBuffers(1, &e.second->EBO);
+        }
+    }
+    m_entries.clear();
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Geometry.h"
+#include "InstanceBvh.h"
+
+// Biblioteca de primitivas paramétricas indexadas (esfera UV, icosfera, cubo,
+// plano e cilindro), com cache por parâmetros.
+//
+//   PrimitiveLibrary primitives;
+//   const Primitive& sphere = primitives.get(PrimitiveShape::uvSphere(0.5f, 16, 16));
+//   glBindVertexArray(sphere.VAO);
+//   glDrawElements(GL_TRIANGLES, sphere.indexCount, GL_UNSIGNED_INT, nullptr);
+//
+// Cada vértice aparece uma vez (as costuras de UV e as quinas do cubo
+// duplicam só o necessário) e os triângulos são anti-horários vistos de fora.
+// Nos polos da esfera UV cada setor tem o seu vértice de polo, com a UV no
+// meio do setor, e um único triângulo: nada de triângulos degenerados.
+//
+// O mesmo PrimitiveShape sempre devolve o mesmo Primitive: a malha é gerada e
+// enviada para a GPU uma vez só. Pedir a mesma forma com outro layout de
+// atributos cria só outro VAO sobre os mesmos buffers.
+
+// Malha indexada, só na CPU
+struct PrimitiveMesh
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> colors;
+    std::vector<uint32_t> indices;
+    Aabb bounds;
+};
+
+// Parâmetros de uma primitiva, usados também como chave do cache
+struct PrimitiveShape
+{
+    enum Type : uint32_t { UV_SPHERE, ICOSPHERE, CUBE, PLANE, CYLINDER };
+
+    Type type = CUBE;
+    glm::vec3 size = glm::vec3(1.0f);
+    int32_t segments[2] = { 1, 1 };
+    glm::vec3 color = glm::vec3(1.0f, 0.0f, 0.0f);
+
+    // Eixo dos polos = y; rings >= 2 faixas de latitude, sectors >= 3 de longitude
+    static PrimitiveShape uvSphere(float radius, int rings, int sectors, const glm::vec3& color = glm::vec3(1, 0, 0));
+
+    // Icosaedro subdividido: triângulos quase iguais, sem polos
+    static PrimitiveShape icosphere(float radius, int subdivisions, const glm::vec3& color = glm::vec3(1, 0, 0));
+
+    // Cores por face do Modulo2: frente vermelha, trás verde, esquerda azul,
+    // direita amarela, cima ciano, baixo magenta
+    static PrimitiveShape cube(float size = 1.0f);
+
+    // No plano XZ, virado para +y
+    static PrimitiveShape plane(float width, float depth, int divisions = 1, const glm::vec3& color = glm::vec3(1, 0, 0));
+
+    // Eixo = y, centrado na origem, com tampas
+    static PrimitiveShape cylinder(float radius, float height, int sectors, const glm::vec3& color = glm::vec3(1, 0, 0));
+
+    bool operator<(const PrimitiveShape& other) const { return memcmp(this, &other, sizeof(*this)) < 0; }
+};
+
+PrimitiveMesh buildPrimitive(const PrimitiveShape& shape);
+
+// Triângulos soltos (3 posições cada), no formato do oclusor do OcclusionCuller
+std::vector<glm::vec3> expandTriangles(const PrimitiveMesh& mesh);
+
+// Desindexada (3 vértices por triângulo), no formato do parseObj, para os
+// renderizadores em CPU (CpuScene)
+MeshData expandMesh(const PrimitiveMesh& mesh);
+
+// Location de cada atributo no VAO (-1 = fora)
+struct PrimitiveLayout
+{
+    GLint position = 0;
+    GLint color = 1;
+    GLint normal = 2;
+    GLint uv = 3;
+
+    bool operator==(const PrimitiveLayout& other) const
+    {
+        return position == other.position && color == other.color && normal == other.normal && uv == other.uv;
+    }
+};
+
+// Layout do uploadGeometry/Geometry (Modulo3 a 5): posição, cor, uv, normal
+const PrimitiveLayout GEOMETRY_LAYOUT = { 0, 1, 3, 2 };
+
+// Pronta para desenhar com glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0)
+struct Primitive
+{
+    GLuint VAO = 0;
+    GLsizei indexCount = 0;
+    GLsizei vertexCount = 0;
+    Aabb bounds;
+    const PrimitiveMesh* mesh = nullptr;    // cópia na CPU, guardada pela biblioteca
+};
+
+class PrimitiveLibrary
+{
+public:
+    PrimitiveLibrary() = default;
+
+    PrimitiveLibrary(const PrimitiveLibrary&) = delete;
+    PrimitiveLibrary& operator=(const PrimitiveLibrary&) = delete;
+
+    // A referência vale até destroy(); precisa do contexto GL
+    const Primitive& get(const PrimitiveShape& shape, const PrimitiveLayout& layout = PrimitiveLayout());
+
+    // Só a malha (memoizada, sem GL)
+    const PrimitiveMesh& getMesh(const PrimitiveShape& shape);
+
+    void printStats() const;
+
+    // Apaga VAOs e buffers; chamar antes de destruir o contexto GL
+    void destroy();
+
+private:
+    struct Entry
+    {
+        PrimitiveMesh mesh;
+        GLuint VBO = 0;     // posição, cor, normal, uv intercalados
+        GLuint EBO = 0;
+        std::vector<std::pair<PrimitiveLayout, std::unique_ptr<Primitive>>> primitives;
+    };
+
+    Entry& entry(const PrimitiveShape& shape);
+
+    std::map<PrimitiveShape, std::unique_ptr<Entry>> m_entries;
+    uint64_t m_requests = 0;
+    uint64_t m_builds = 0;
+};
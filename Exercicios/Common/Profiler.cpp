@@ -0,0 +1,138 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+std::vector<ProfileEvent> ProfileThreadBuffer::snapshot() const
+{
+    uint64_t written = m_written.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>(written, CAPACITY);
+
+    std::vector<ProfileEvent> events;
+    events.reserve((size_t)count);
+    for (uint64_t i = written - count; i < written; ++i)
+        events.push_back(m_events[i & (CAPACITY - 1)]);
+    return events;
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : m_start(std::chrono::steady_clock::now())
+{
+}
+
+uint64_t Profiler::nowNs() const
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start).count();
+}
+
+ProfileThreadBuffer& Profiler::threadBuffer()
+{
+    // Registro acontece uma vez por thread; depois disso gravar não trava nada
+    thread_local ProfileThreadBuffer* buffer = nullptr;
+    if (!buffer)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threads.push_back(std::make_unique<ProfileThreadBuffer>((uint32_t)m_threads.size() + 1));
+        buffer = m_threads.back().get();
+        buffer->name = m_threads.size() == 1 ? "Main" : "Worker " + std::to_string(m_threads.size() - 1);
+    }
+    return *buffer;
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    threadBuffer().name = name;
+}
+
+void Profiler::markFrame()
+{
+    // O frame inteiro vira um evento "Frame" na trilha da thread principal
+    uint64_t now = nowNs();
+    if (m_frameIndex.load() > 0)
+        threadBuffer().push({ "Frame", m_lastFrameNs, now, 0, 0 });
+    m_lastFrameNs = now;
+    m_frameIndex++;
+}
+
+void Profiler::pushExternal(const char* track, const ProfileEvent& event)
+{
+    ProfileThreadBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_external)
+        {
+            if (entry.first == track)
+                buffer = entry.second.get();
+        }
+        if (!buffer)
+        {
+            m_external.emplace_back(track, std::make_unique<ProfileThreadBuffer>((uint32_t)(1000 + m_external.size())));
+            buffer = m_external.back().second.get();
+            buffer->name = track;
+        }
+    }
+    buffer->push(event);
+}
+
+static void writeJsonString(std::ostream& out, const std::string& text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+static void writeEvents(std::ostream& out, const ProfileThreadBuffer& buffer, bool& first)
+{
+    if (!first)
+        out << ",\n";
+    first = false;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.getThreadId()
+        << ",\"args\":{\"name\":";
+    writeJsonString(out, buffer.name);
+    out << "}}";
+
+    for (const ProfileEvent& event : buffer.snapshot())
+    {
+        out << ",\n{\"name\":";
+        writeJsonString(out, event.name);
+        out << ",\"cat\":\"" << (event.category == 0 ? "cpu" : "gpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << buffer.getThreadId() << ",\"ts\":" << event.beginNs / 1000.0
+            << ",\"dur\":" << (event.endNs - event.beginNs) / 1000.0 << "}";
+    }
+}
+
+bool Profiler::writeChromeTrace(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cerr << "Profiler: nao foi possivel gravar " << path << std::endl;
+        return false;
+    }
+
+    out.precision(3);
+    out << std::fixed << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool first = true;
+    for (const auto& buffer : m_threads)
+        writeEvents(out, *buffer, first);
+    for (const auto& entry : m_external)
+        writeEvents(out, *entry.second, first);
+    out << "\n]}\n";
+
+    std::cout << "Profiler: " << m_frameIndex.load() << " frames gravados em " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Profiler de CPU por escopos.
+//
+//   PROFILE_FRAME();              // marca o início de um frame no game loop
+//   { PROFILE_SCOPE("Submit"); }  // mede o tempo do bloco (RAII)
+//   PROFILE_EXPORT("trace.json"); // grava no formato Chrome trace / Perfetto
+//
+// Cada thread escreve num ring buffer próprio, sem locks: só quem grava é a
+// dona do buffer. Com ENABLE_PROFILER desligado (padrão) as macros somem e
+// não custam nada. O arquivo gerado abre em chrome://tracing ou ui.perfetto.dev.
+
+struct ProfileEvent
+{
+    const char* name;   // literal: só o ponteiro é guardado
+    uint64_t beginNs;
+    uint64_t endNs;
+    uint32_t depth;
+    uint32_t category;  // 0 = CPU; outros valores ficam para trilhas externas (GPU)
+};
+
+class ProfileThreadBuffer
+{
+public:
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    explicit ProfileThreadBuffer(uint32_t threadId) : m_threadId(threadId), m_events(CAPACITY) {}
+
+    void push(const ProfileEvent& event)
+    {
+        uint64_t index = m_written.load(std::memory_order_relaxed);
+        m_events[index & (CAPACITY - 1)] = event;
+        m_written.store(index + 1, std::memory_order_release);
+    }
+
+    // Eventos mais antigos são sobrescritos quando o buffer dá a volta
+    std::vector<ProfileEvent> snapshot() const;
+
+    uint32_t getThreadId() const { return m_threadId; }
+    std::string name;
+    uint32_t depth = 0;
+
+private:
+    uint32_t m_threadId;
+    std::vector<ProfileEvent> m_events;
+    std::atomic<uint64_t> m_written{ 0 };
+};
+
+class Profiler
+{
+public:
+    static Profiler& instance();
+
+    uint64_t nowNs() const;
+
+    ProfileThreadBuffer& threadBuffer();
+    void setThreadName(const char* name);
+
+    void markFrame();
+    uint64_t getFrameIndex() const { return m_frameIndex.load(); }
+
+    // Eventos vindos de outra fonte (ex.: GPU) já convertidos para o relógio do profiler
+    void pushExternal(const char* track, const ProfileEvent& event);
+
+    bool writeChromeTrace(const std::string& path);
+
+private:
+    Profiler();
+
+    std::chrono::steady_clock::time_point m_start;
+    std::mutex m_mutex; // só para registrar threads e trilhas externas
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> m_threads;
+    std::vector<std::pair<std::string, std::unique_ptr<ProfileThreadBuffer>>> m_external;
+    std::atomic<uint64_t> m_frameIndex{ 0 };
+    uint64_t m_lastFrameNs = 0;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : m_buffer(Profiler::instance().threadBuffer()), m_name(name)
+    {
+        m_depth = m_buffer.depth++;
+        m_begin = Profiler::instance().nowNs();
+    }
+
+    ~ProfileScope()
+    {
+        uint64_t end = Profiler::instance().nowNs();
+        m_buffer.depth--;
+        m_buffer.push({ m_name, m_begin, end, m_depth, 0 });
+    }
+
+private:
+    ProfileThreadBuffer& m_buffer;
+    const char* m_name;
+    uint64_t m_begin;
+    uint32_t m_depth;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::instance().markFrame()
+#define PROFILE_THREAD(name) Profiler::instance().setThreadName(name)
+#define PROFILE_EXPORT(path) Profiler::instance().writeChromeTrace(path)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_EXPORT(path) ((void)0)
+#endif
@@ -0,0 +1,610 @@
+#include "RayTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+#include "Profiler.h"
+
+static const int MAX_STACK_LIGHTS = 8;
+
+// PCG de 32 bits: barato, sem estado global e reproduzível por pixel
+class RayTracer::Random
+{
+public:
+    explicit Random(uint32_t seed) : m_state(seed) { next(); }
+
+    float next()
+    {
+        m_state = m_state * 747796405u + 2891336453u;
+        uint32_t word = ((m_state >> ((m_state >> 28u) + 4u)) ^ m_state) * 277803737u;
+        word = (word >> 22u) ^ word;
+        return (word >> 8) * (1.0f / 16777216.0f);
+    }
+
+private:
+    uint32_t m_state;
+};
+
+struct RayTracer::TileCounters
+{
+    uint64_t primary = 0;
+    uint64_t shadow = 0;
+    uint64_t bounce = 0;
+};
+
+static uint32_t hashSeed(uint32_t a, uint32_t b)
+{
+    uint32_t h = a * 0x9E3779B9u ^ (b + 0x7F4A7C15u + (a << 6) + (a >> 2));
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+// Direção no hemisfério de n com densidade cos/pi
+static glm::vec3 cosineSample(const glm::vec3& n, float r1, float r2)
+{
+    glm::vec3 helper = std::fabs(n.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 tangent = glm::normalize(glm::cross(helper, n));
+    glm::vec3 bitangent = glm::cross(n, tangent);
+    float phi = glm::two_pi<float>() * r1;
+    float radius = std::sqrt(r2);
+    return glm::normalize(tangent * (radius * std::cos(phi)) + bitangent * (radius * std::sin(phi)) +
+        n * std::sqrt(std::max(0.0f, 1.0f - r2)));
+}
+
+// Afasta a origem de um raio secundário da superfície, na escala da posição
+static glm::vec3 offsetOrigin(const glm::vec3& position, const glm::vec3& normal)
+{
+    float scale = std::max({ 1.0f, std::fabs(position.x), std::fabs(position.y), std::fabs(position.z) });
+    return position + normal * (1e-4f * scale);
+}
+
+// Entrada do raio na caixa, ou 1e30 se não toca antes de tMax
+static float slabEnter(const Aabb& box, const glm::vec3& origin, const glm::vec3& invDir, float tMax)
+{
+    glm::vec3 t0 = (box.min - origin) * invDir;
+    glm::vec3 t1 = (box.max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit ? enter : 1e30f;
+}
+
+static BvhRay toLocal(const glm::mat4& inverseModel, const BvhRay& ray)
+{
+    // Direção sem normalizar: o t do espaço local é o mesmo do mundo
+    BvhRay local;
+    local.origin = glm::vec3(inverseModel * glm::vec4(ray.origin, 1.0f));
+    local.direction = glm::mat3(inverseModel) * ray.direction;
+    local.tMax = ray.tMax;
+    return local;
+}
+
+RayTracer::RayTracer(JobSystem* jobs)
+    : m_jobs(jobs), m_tlas(jobs)
+{
+}
+
+int RayTracer::findMesh(const MeshData& data)
+{
+    for (size_t i = 0; i < m_meshes.size(); ++i)
+        if (m_meshes[i].data == &data)
+            return (int)i;
+
+    Mesh mesh;
+    mesh.data = &data;
+    mesh.bvh = std::make_unique<TriangleBvh>(m_jobs);
+    mesh.bvh->build(data.positions);
+
+    size_t triangles = data.positions.size() / 3;
+    mesh.uvDensity.assign(triangles, 0.0f);
+    if (data.uvs.size() >= triangles * 3)
+    {
+        for (size_t t = 0; t < triangles; ++t)
+        {
+            const glm::vec3* p = &data.positions[t * 3];
+            const glm::vec2* uv = &data.uvs[t * 3];
+            glm::vec2 a = uv[1] - uv[0], b = uv[2] - uv[0];
+            float uvArea = std::fabs(a.x * b.y - a.y * b.x);
+            float area = glm::length(glm::cross(p[1] - p[0], p[2] - p[0]));
+            mesh.uvDensity[t] = 0.5f * std::log2(std::max(uvArea, 1e-20f) / std::max(area, 1e-20f));
+        }
+    }
+
+    m_meshes.push_back(std::move(mesh));
+    return (int)m_meshes.size() - 1;
+}
+
+int RayTracer::findTexture(const ImageData& image)
+{
+    for (size_t i = 0; i < m_textures.size(); ++i)
+        if (m_textures[i].getImage() == &image)
+            return (int)i;
+    m_textures.emplace_back(image);
+    return (int)m_textures.size() - 1;
+}
+
+void RayTracer::setScene(const CpuScene& scene)
+{
+    PROFILE_SCOPE("RayTraceSetup");
+    m_lights = scene.lights;
+    m_background = scene.background;
+    m_cameraPos = scene.cameraPos;
+    m_viewProjection = scene.projection * scene.view;
+    m_inverseViewProjection = glm::inverse(m_viewProjection);
+    m_focalLength = scene.projection[1][1];
+
+    m_instances.clear();
+    std::vector<Aabb> bounds;
+    for (const SceneMesh& sceneMesh : scene.meshes)
+    {
+        int mesh = findMesh(*sceneMesh.mesh);
+        const TriangleBvh& bvh = *m_meshes[mesh].bvh;
+        if (bvh.getTriangleCount() == 0)
+            continue;
+
+        Instance instance;
+        instance.mesh = (uint32_t)mesh;
+        instance.model = sceneMesh.model;
+        instance.inverseModel = glm::inverse(sceneMesh.model);
+        instance.normalMatrix = glm::mat3(glm::transpose(instance.inverseModel));
+        instance.scale = std::cbrt(std::fabs(glm::determinant(glm::mat3(sceneMesh.model))));
+        instance.material = sceneMesh.material;
+        instance.texture = sceneMesh.material.texture ? findTexture(*sceneMesh.material.texture) : -1;
+        instance.bounds = transformAabb(sceneMesh.model, bvh.getBounds());
+        m_instances.push_back(instance);
+        bounds.push_back(instance.bounds);
+    }
+    m_tlas.build(bounds);
+}
+
+void RayTracer::completeHit(const BvhRay& ray, uint32_t instanceIndex, const TriangleHit& triangleHit,
+    SurfaceHit& hit) const
+{
+    const Instance& instance = m_instances[instanceIndex];
+    const MeshData& mesh = *m_meshes[instance.mesh].data;
+    size_t i0 = (size_t)triangleHit.triangle * 3;
+    float w0 = 1.0f - triangleHit.u - triangleHit.v, w1 = triangleHit.u, w2 = triangleHit.v;
+
+    hit.t = triangleHit.t;
+    hit.instance = instanceIndex;
+    hit.triangle = triangleHit.triangle;
+    hit.position = ray.origin + ray.direction * triangleHit.t;
+
+    const glm::vec3* p = &mesh.positions[i0];
+    hit.geometricNormal = glm::normalize(instance.normalMatrix * glm::cross(p[1] - p[0], p[2] - p[0]));
+    if (glm::dot(hit.geometricNormal, ray.direction) > 0.0f)
+        hit.geometricNormal = -hit.geometricNormal;
+
+    if (mesh.normals.size() >= i0 + 3)
+        hit.normal = glm::normalize(instance.normalMatrix *
+            (mesh.normals[i0] * w0 + mesh.normals[i0 + 1] * w1 + mesh.normals[i0 + 2] * w2));
+    else
+        hit.normal = hit.geometricNormal;
+
+    hit.uv = mesh.uvs.size() >= i0 + 3 ? mesh.uvs[i0] * w0 + mesh.uvs[i0 + 1] * w1 + mesh.uvs[i0 + 2] * w2 : glm::vec2(0.0f);
+}
+
+bool RayTracer::traceRay(const BvhRay& ray, SurfaceHit& hit) const
+{
+    if (m_instances.empty())
+        return false;
+
+    // A caixa de cada instância só filtra; o acerto vem da BVH da malha, e
+    // "best" acompanha o hit.t da BVH de topo
+    TriangleHit best;
+    uint32_t bestInstance = BvhHit::NONE;
+    m_tlas.intersectRay(ray, [&](uint32_t i, const BvhRay& r)
+        {
+            const Instance& instance = m_instances[i];
+            if (!m_meshes[instance.mesh].bvh->intersect(toLocal(instance.inverseModel, r), best))
+                return -1.0f;
+            bestInstance = i;
+            return best.t;
+        });
+
+    if (bestInstance == BvhHit::NONE)
+        return false;
+    completeHit(ray, bestInstance, best, hit);
+    return true;
+}
+
+bool RayTracer::anyHit(const BvhRay& ray) const
+{
+    if (m_instances.empty())
+        return false;
+
+    // Devolver t = 0 no primeiro bloqueio zera o limite da BVH de topo e
+    // encerra a descida
+    bool blocked = false;
+    m_tlas.intersectRay(ray, [&](uint32_t i, const BvhRay& r)
+        {
+            const Instance& instance = m_instances[i];
+            if (blocked || !m_meshes[instance.mesh].bvh->occluded(toLocal(instance.inverseModel, r)))
+                return -1.0f;
+            blocked = true;
+            return 0.0f;
+        });
+    return blocked;
+}
+
+bool RayTracer::isOccluded(const glm::vec3& from, const glm::vec3& to) const
+{
+    BvhRay ray;
+    ray.origin = from;
+    ray.direction = to - from;
+    ray.tMax = 1.0f - 1e-4f;
+    return anyHit(ray);
+}
+
+void RayTracer::primaryRay(float px, float py, BvhRay& ray) const
+{
+    // Mesma convenção do GL: y da imagem para baixo, pixel (x + 0.5, y + 0.5)
+    float x = px / m_width * 2.0f - 1.0f;
+    float y = 1.0f - py / m_height * 2.0f;
+    glm::vec4 nearPoint = m_inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+    glm::vec4 farPoint = m_inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 span = glm::vec3(farPoint) / farPoint.w - origin;
+
+    ray.origin = origin;
+    ray.tMax = glm::length(span);
+    ray.direction = span / ray.tMax;
+}
+
+void RayTracer::intersectPrimaryPacket(const BvhRay* rays, SurfaceHit* hits, bool* found, int count,
+    const std::vector<uint32_t>& tileInstances, std::vector<std::pair<float, uint32_t>>& candidates) const
+{
+    const int N = TriangleBvh::PACKET_SIZE;
+    TriangleHit best[N];
+    uint32_t bestInstance[N];
+    glm::vec3 invDir[N];
+    for (int k = 0; k < count; ++k)
+    {
+        bestInstance[k] = BvhHit::NONE;
+        invDir[k] = 1.0f / rays[k].direction;
+    }
+
+    // Instâncias tocadas por algum raio, da mais próxima para a mais distante,
+    // para o closest de cada pista já podar as de trás
+    candidates.clear();
+    for (uint32_t i : tileInstances)
+    {
+        float enter = 1e30f;
+        for (int k = 0; k < count; ++k)
+            enter = std::min(enter, slabEnter(m_instances[i].bounds, rays[k].origin, invDir[k], rays[k].tMax));
+        if (enter < 1e30f)
+            candidates.push_back({ enter, i });
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+        float farthest = 0.0f;
+        for (int k = 0; k < count; ++k)
+            farthest = std::max(farthest, std::min(rays[k].tMax, best[k].t));
+        if (candidates[c].first >= farthest)
+            break;
+
+        uint32_t i = candidates[c].second;
+        const Instance& instance = m_instances[i];
+        BvhRay local[N];
+        for (int k = 0; k < count; ++k)
+            local[k] = toLocal(instance.inverseModel, rays[k]);
+        uint32_t mask = m_meshes[instance.mesh].bvh->intersectPacket(local, best, count);
+        for (int k = 0; k < count; ++k)
+            if (mask & (1u << k))
+                bestInstance[k] = i;
+    }
+
+    for (int k = 0; k < count; ++k)
+    {
+        found[k] = bestInstance[k] != BvhHit::NONE;
+        if (found[k])
+            completeHit(rays[k], bestInstance[k], best[k], hits[k]);
+    }
+}
+
+float RayTracer::textureLod(const SurfaceHit& hit, const glm::vec3& direction, float coneWidth) const
+{
+    // Cone do raio: largura na superfície (corrigida pela inclinação) em
+    // unidades locais, vezes a densidade uv do triângulo e o tamanho da textura
+    const Instance& instance = m_instances[hit.instance];
+    const TextureMips& texture = m_textures[instance.texture];
+    float cosine = std::max(std::fabs(glm::dot(hit.geometricNormal, direction)), 1e-4f);
+    float footprint = coneWidth / (instance.scale * cosine);
+    return m_meshes[instance.mesh].uvDensity[hit.triangle] +
+        0.5f * std::log2((float)texture.getWidth() * texture.getHeight()) + std::log2(std::max(footprint, 1e-20f));
+}
+
+glm::vec3 RayTracer::surfaceAlbedo(const SurfaceHit& hit, float lod) const
+{
+    const Instance& instance = m_instances[hit.instance];
+    if (instance.texture < 0)
+        return instance.material.baseColor;
+    glm::vec2 uv = hit.uv;
+    if (instance.material.flipV)
+        uv.y = 1.0f - uv.y;
+    return m_textures[instance.texture].sample(uv, lod);
+}
+
+float RayTracer::lightVisibility(const SurfaceHit& hit, const SceneLight& light) const
+{
+    glm::vec3 normal = glm::dot(hit.geometricNormal, light.position - hit.position) >= 0.0f ?
+        hit.geometricNormal : -hit.geometricNormal;
+    return isOccluded(offsetOrigin(hit.position, normal), light.position) ? 0.0f : 1.0f;
+}
+
+glm::vec3 RayTracer::shadeDirect(const BvhRay& ray, const SurfaceHit& hit, const RayTracerSettings& settings,
+    TileCounters& counters) const
+{
+    const Instance& instance = m_instances[hit.instance];
+    float lod = instance.texture >= 0 ? textureLod(hit, ray.direction, hit.t * m_pixelSpread) : 0.0f;
+    glm::vec3 base = surfaceAlbedo(hit, lod);
+    if (!instance.material.lit)
+        return base;
+
+    float stackVisibility[MAX_STACK_LIGHTS];
+    std::vector<float> heapVisibility;
+    float* visibility = stackVisibility;
+    if (m_lights.size() > MAX_STACK_LIGHTS)
+    {
+        heapVisibility.resize(m_lights.size());
+        visibility = heapVisibility.data();
+    }
+    for (size_t i = 0; i < m_lights.size(); ++i)
+        visibility[i] = settings.shadows ? lightVisibility(hit, m_lights[i]) : 1.0f;
+    if (settings.shadows)
+        counters.shadow += m_lights.size();
+
+    return shadePhong(instance.material, m_lights, base, hit.position, hit.normal, m_cameraPos, visibility);
+}
+
+glm::vec3 RayTracer::tracePath(BvhRay ray, const RayTracerSettings& settings, Random& random,
+    TileCounters& counters) const
+{
+    glm::vec3 radiance(0.0f), throughput(1.0f);
+    glm::vec3 eye = ray.origin;
+
+    float stackVisibility[MAX_STACK_LIGHTS];
+    std::vector<float> heapVisibility;
+    float* visibility = stackVisibility;
+    if (m_lights.size() > MAX_STACK_LIGHTS)
+    {
+        heapVisibility.resize(m_lights.size());
+        visibility = heapVisibility.data();
+    }
+
+    for (int bounce = 0; ; ++bounce)
+    {
+        SurfaceHit hit;
+        if (!traceRay(ray, hit))
+        {
+            radiance += throughput * m_background;
+            break;
+        }
+
+        const Instance& instance = m_instances[hit.instance];
+        float lod = bounce == 0 && instance.texture >= 0 ? textureLod(hit, ray.direction, hit.t * m_pixelSpread) : 0.0f;
+        glm::vec3 base = surfaceAlbedo(hit, lod);
+        if (!instance.material.lit)
+        {
+            radiance += throughput * base;
+            break;
+        }
+
+        // Normal de sombreamento do lado de quem olha
+        glm::vec3 normal = glm::dot(hit.normal, hit.geometricNormal) < 0.0f ? -hit.normal : hit.normal;
+        for (size_t i = 0; i < m_lights.size(); ++i)
+            visibility[i] = settings.shadows ? lightVisibility(hit, m_lights[i]) : 1.0f;
+        if (settings.shadows)
+            counters.shadow += m_lights.size();
+
+        // O ambiente (ka) do Phong é trocado pela luz indireta de verdade
+        radiance += throughput * shadePhong(instance.material, m_lights, base, hit.position, normal, eye, visibility, false);
+        if (bounce >= settings.maxBounces)
+            break;
+
+        // Lambert com amostragem por cosseno: o pdf cos/pi cancela com o BRDF kd * base / pi
+        throughput *= instance.material.kd * base;
+        if (bounce >= 2)
+        {
+            float survive = glm::clamp(std::max({ throughput.r, throughput.g, throughput.b }), 0.05f, 1.0f);
+            if (random.next() > survive)
+                break;
+            throughput /= survive;
+        }
+
+        eye = hit.position;
+        ray.origin = offsetOrigin(hit.position, hit.geometricNormal);
+        ray.direction = cosineSample(hit.geometricNormal, random.next(), random.next());
+        ray.tMax = 1e30f;
+        counters.bounce++;
+    }
+    return radiance;
+}
+
+void RayTracer::renderTile(int tile, const RayTracerSettings& settings, TileCounters& counters)
+{
+    int tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    int x0 = (tile % tilesX) * TILE_SIZE, y0 = (tile / tilesX) * TILE_SIZE;
+    int x1 = std::min(x0 + TILE_SIZE, m_width), y1 = std::min(y0 + TILE_SIZE, m_height);
+
+    auto store = [&](int x, int y, const glm::vec3& color)
+        {
+            size_t i = (size_t)y * m_width + x;
+            m_image[i] = color;
+            m_color[i] = packColor(color);
+        };
+
+    if (settings.mode == RayTracerSettings::DIRECT && settings.samplesPerPixel <= 1)
+    {
+        // Instâncias no frustum do tile (projeção descentrada que leva o
+        // retângulo do tile para [-1, 1]); os pacotes só olham para essas
+        glm::vec2 ndcMin(2.0f * x0 / m_width - 1.0f, 1.0f - 2.0f * y1 / m_height);
+        glm::vec2 ndcMax(2.0f * x1 / m_width - 1.0f, 1.0f - 2.0f * y0 / m_height);
+        glm::vec2 scale = 2.0f / (ndcMax - ndcMin), center = (ndcMin + ndcMax) * 0.5f;
+        glm::mat4 crop(1.0f);
+        crop[0][0] = scale.x;
+        crop[1][1] = scale.y;
+        crop[3][0] = -center.x * scale.x;
+        crop[3][1] = -center.y * scale.y;
+        std::vector<uint32_t> tileInstances;
+        std::vector<std::pair<float, uint32_t>> candidates;
+        m_tlas.queryFrustum(crop * m_viewProjection, tileInstances);
+
+        // Blocos de 4x2 pixels = um pacote de 8 raios primários
+        for (int by = y0; by < y1; by += 2)
+            for (int bx = x0; bx < x1; bx += 4)
+            {
+                BvhRay rays[TriangleBvh::PACKET_SIZE];
+                SurfaceHit hits[TriangleBvh::PACKET_SIZE];
+                bool found[TriangleBvh::PACKET_SIZE];
+                int px[TriangleBvh::PACKET_SIZE], py[TriangleBvh::PACKET_SIZE];
+                int count = 0;
+                for (int y = by; y < std::min(by + 2, y1); ++y)
+                    for (int x = bx; x < std::min(bx + 4, x1); ++x)
+                    {
+                        px[count] = x;
+                        py[count] = y;
+                        primaryRay(x + 0.5f, y + 0.5f, rays[count++]);
+                    }
+
+                intersectPrimaryPacket(rays, hits, found, count, tileInstances, candidates);
+                counters.primary += count;
+                for (int k = 0; k < count; ++k)
+                    store(px[k], py[k], found[k] ? shadeDirect(rays[k], hits[k], settings, counters) : m_background);
+            }
+        return;
+    }
+
+    int samples = std::max(settings.samplesPerPixel, 1);
+    for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x)
+        {
+            Random random(hashSeed((uint32_t)(y * m_width + x), settings.seed));
+            glm::vec3 color(0.0f);
+            for (int s = 0; s < samples; ++s)
+            {
+                float jx = samples > 1 ? random.next() : 0.5f;
+                float jy = samples > 1 ? random.next() : 0.5f;
+                BvhRay ray;
+                primaryRay(x + jx, y + jy, ray);
+                counters.primary++;
+
+                if (settings.mode == RayTracerSettings::PATH)
+                {
+                    color += tracePath(ray, settings, random, counters);
+                    continue;
+                }
+                SurfaceHit hit;
+                color += traceRay(ray, hit) ? shadeDirect(ray, hit, settings, counters) : m_background;
+            }
+            store(x, y, color / (float)samples);
+        }
+}
+
+void RayTracer::render(int width, int height, const RayTracerSettings& settings)
+{
+    PROFILE_SCOPE("RayTrace");
+    auto start = std::chrono::steady_clock::now();
+
+    m_width = width;
+    m_height = height;
+    m_image.assign((size_t)width * height, glm::vec3(0.0f));
+    m_color.assign((size_t)width * height, 0u);
+    m_pixelSpread = 2.0f / (m_focalLength * height);
+
+    int tiles = ((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    std::vector<TileCounters> counters(tiles);
+    auto run = [&](size_t begin, size_t end)
+        {
+            for (size_t t = begin; t < end; ++t)
+                renderTile((int)t, settings, counters[t]);
+        };
+
+    if (m_jobs)
+        m_jobs->parallelFor(tiles, 1, run);
+    else
+        run(0, tiles);
+
+    m_stats = RayTracerStats();
+    for (const TileCounters& tile : counters)
+    {
+        m_stats.primaryRays += tile.primary;
+        m_stats.shadowRays += tile.shadow;
+        m_stats.bounceRays += tile.bounce;
+    }
+    m_stats.renderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t rays = m_stats.primaryRays + m_stats.shadowRays + m_stats.bounceRays;
+    m_stats.mraysPerSecond = rays / (m_stats.renderMs * 1000.0);
+}
+
+bool RayTracer::writePpm(const std::string& path) const
+{
+    return ::writePpm(path, m_color, m_width, m_height);
+}
+
+bool RayTracer::writePfm(const std::string& path) const
+{
+    return ::writePfm(path, m_image, m_width, m_height);
+}
+
+glm::vec3 RayTracer::directLight(const glm::vec3& position, const glm::vec3& normal) const
+{
+    glm::vec3 irradiance(0.0f);
+    glm::vec3 origin = offsetOrigin(position, normal);
+    for (const SceneLight& light : m_lights)
+    {
+        glm::vec3 toLight = light.position - position;
+        float cosine = glm::dot(normal, glm::normalize(toLight));
+        if (cosine <= 0.0f || isOccluded(origin, light.position))
+            continue;
+        float attenuation = light.attenuate ? 1.0f / glm::dot(toLight, toLight) : 1.0f;
+        irradiance += light.color * cosine * attenuation;
+    }
+    return irradiance;
+}
+
+float RayTracer::ambientOcclusion(const glm::vec3& position, const glm::vec3& normal, int samples, float maxDistance,
+    uint32_t seed) const
+{
+    Random random(seed);
+    glm::vec3 origin = offsetOrigin(position, normal);
+    int open = 0;
+    for (int s = 0; s < samples; ++s)
+    {
+        BvhRay ray;
+        ray.origin = origin;
+        ray.direction = cosineSample(normal, random.next(), random.next());
+        ray.tMax = maxDistance;
+        open += !anyHit(ray);
+    }
+    return samples > 0 ? (float)open / samples : 1.0f;
+}
+
+glm::vec3 RayTracer::indirectLight(const glm::vec3& position, const glm::vec3& normal, int samples, int maxBounces,
+    uint32_t seed) const
+{
+    // Mesma escala de directLight: cor final = kd * albedo * (direta + indireta)
+    RayTracerSettings settings;
+    settings.mode = RayTracerSettings::PATH;
+    settings.maxBounces = std::max(maxBounces - 1, 0);
+
+    Random random(seed);
+    TileCounters counters;
+    glm::vec3 origin = offsetOrigin(position, normal);
+    glm::vec3 sum(0.0f);
+    for (int s = 0; s < samples; ++s)
+    {
+        BvhRay ray;
+        ray.origin = origin;
+        ray.direction = cosineSample(normal, random.next(), random.next());
+        sum += tracePath(ray, settings, random, counters);
+    }
+    return samples > 0 ? sum / (float)samples : glm::vec3(0.0f);
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CpuScene.h"
+#include "InstanceBvh.h"
+#include "JobSystem.h"
+#include "TriangleBvh.h"
+
+// Renderizador de referência por traçado de raios em CPU, sobre a mesma
+// CpuScene do SoftwareRasterizer (malhas, texturas, luzes e Phong dos módulos).
+//
+//   RayTracer tracer(&jobs);
+//   tracer.setScene(scene);                 // BVH por malha (em cache) + BVH das instâncias
+//   tracer.render(1280, 720, settings);     // tiles de 16x16 nos workers
+//   tracer.writePpm("still.ppm"); tracer.writePfm("still.pfm");
+//   tracer.getStats().mraysPerSecond;
+//
+// DIRECT é o Whitted sem reflexões: raio primário + um raio de sombra por luz,
+// com o mesmo Phong do GL (sem sombras a imagem deve bater com a do GL).
+// PATH soma a luz indireta difusa por path tracing (amostragem por cosseno,
+// roleta russa a partir do 3º salto); o fundo ilumina como um céu uniforme.
+//
+// Cada MeshData tem uma TriangleBvh de 4 filhos montada uma vez e reaproveitada
+// por todas as instâncias que usam a malha; os raios vão para o espaço local da
+// instância. Raios primários descem em pacotes de 8 (blocos de 4x2 pixels),
+// só pelas instâncias que a BVH de topo acha no frustum do tile.
+// A textura usa mip por cone de raio (ângulo do pixel x distância).
+//
+// As consultas traceRay/isOccluded/directLight/ambientOcclusion/indirectLight
+// servem de backend para quem assa iluminação em vértices ou lightmaps.
+
+struct RayTracerSettings
+{
+    enum Mode { DIRECT, PATH };
+
+    Mode mode = DIRECT;
+    bool shadows = true;
+    int samplesPerPixel = 1;    // > 1 espalha as amostras dentro do pixel
+    int maxBounces = 3;         // PATH
+    uint32_t seed = 1;
+};
+
+struct RayTracerStats
+{
+    uint64_t primaryRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t bounceRays = 0;
+    double renderMs = 0.0;
+    double mraysPerSecond = 0.0;
+};
+
+// Ponto atingido, já em espaço de mundo
+struct SurfaceHit
+{
+    float t = 1e30f;
+    uint32_t instance = 0;
+    uint32_t triangle = 0;
+    glm::vec3 position;
+    glm::vec3 normal;           // interpolada (como no shader)
+    glm::vec3 geometricNormal;  // do triângulo, virada para o lado de onde o raio veio
+    glm::vec2 uv;
+};
+
+class RayTracer
+{
+public:
+    // Sem JobSystem tudo roda na thread que chama
+    explicit RayTracer(JobSystem* jobs = nullptr);
+
+    void setScene(const CpuScene& scene);
+    void render(int width, int height, const RayTracerSettings& settings = RayTracerSettings());
+
+    // Última imagem: float linear e RGBA8 (como o glReadPixels), linha 0 = topo
+    const std::vector<glm::vec3>& getImage() const { return m_image; }
+    const std::vector<uint32_t>& getColorBuffer() const { return m_color; }
+    bool writePpm(const std::string& path) const;
+    bool writePfm(const std::string& path) const;
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    const RayTracerStats& getStats() const { return m_stats; }
+
+    // Consultas para baking (thread-safe depois do setScene)
+    bool traceRay(const BvhRay& ray, SurfaceHit& hit) const;
+    bool isOccluded(const glm::vec3& from, const glm::vec3& to) const;
+
+    // Irradiância difusa das luzes da cena em p (com sombras), sem kd
+    glm::vec3 directLight(const glm::vec3& position, const glm::vec3& normal) const;
+
+    // Fração do hemisfério livre até maxDistance (1 = nada por perto)
+    float ambientOcclusion(const glm::vec3& position, const glm::vec3& normal, int samples, float maxDistance,
+        uint32_t seed) const;
+
+    // Irradiância indireta difusa (luz que chega depois de pelo menos um salto
+    // ou vinda do fundo), média de "samples" caminhos
+    glm::vec3 indirectLight(const glm::vec3& position, const glm::vec3& normal, int samples, int maxBounces,
+        uint32_t seed) const;
+
+    // Cor base do material no ponto (textura ou cor base), sem sombreamento
+    glm::vec3 surfaceAlbedo(const SurfaceHit& hit, float lod = 0.0f) const;
+    const SceneMaterial& getMaterial(uint32_t instance) const { return m_instances[instance].material; }
+
+    static const int TILE_SIZE = 16;
+
+private:
+    struct Instance
+    {
+        uint32_t mesh;          // índice em m_meshes
+        glm::mat4 model;
+        glm::mat4 inverseModel;
+        glm::mat3 normalMatrix;
+        float scale;            // escala média (para o mip)
+        SceneMaterial material;
+        int texture;            // índice em m_textures, -1 sem textura
+        Aabb bounds;            // em mundo
+    };
+
+    struct Mesh
+    {
+        const MeshData* data;
+        std::unique_ptr<TriangleBvh> bvh;
+        std::vector<float> uvDensity;   // 0.5 * log2(área uv / área local) por triângulo
+    };
+
+    class Random;
+    struct TileCounters;
+
+    int findMesh(const MeshData& mesh);
+    int findTexture(const ImageData& image);
+    void renderTile(int tile, const RayTracerSettings& settings, TileCounters& counters);
+    void primaryRay(float px, float py, BvhRay& ray) const;
+    void intersectPrimaryPacket(const BvhRay* rays, SurfaceHit* hits, bool* found, int count,
+        const std::vector<uint32_t>& tileInstances, std::vector<std::pair<float, uint32_t>>& candidates) const;
+    bool anyHit(const BvhRay& ray) const;
+    void completeHit(const BvhRay& ray, uint32_t instance, const TriangleHit& triangleHit, SurfaceHit& hit) const;
+    glm::vec3 shadeDirect(const BvhRay& ray, const SurfaceHit& hit, const RayTracerSettings& settings,
+        TileCounters& counters) const;
+    glm::vec3 tracePath(BvhRay ray, const RayTracerSettings& settings, Random& random, TileCounters& counters) const;
+    float lightVisibility(const SurfaceHit& hit, const SceneLight& light) const;
+    float textureLod(const SurfaceHit& hit, const glm::vec3& direction, float coneWidth) const;
+
+    JobSystem* m_jobs;
+    InstanceBvh m_tlas;
+
+    std::vector<Mesh> m_meshes;
+    std::vector<TextureMips> m_textures;
+    std::vector<Instance> m_instances;
+    std::vector<SceneLight> m_lights;
+    glm::vec3 m_background = glm::vec3(0.0f);
+    glm::vec3 m_cameraPos = glm::vec3(0.0f);
+    glm::mat4 m_viewProjection = glm::mat4(1.0f);
+    glm::mat4 m_inverseViewProjection = glm::mat4(1.0f);
+    float m_focalLength = 1.0f;         // projection[1][1] = 1 / tan(fovy / 2)
+    float m_pixelSpread = 0.0f;         // ângulo de um pixel (para o cone do raio primário)
+
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<glm::vec3> m_image;
+    std::vector<uint32_t> m_color;
+    RayTracerStats m_stats;
+};
@@ -0,0 +1,105 @@
+#include "RedrawTracker.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+// Tempo de CPU do processo inteiro (todas as threads), em segundos
+static double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+        return 0.0;
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+RedrawTracker::RedrawTracker(double animationInterval, double idleTimeout)
+    : m_animationInterval(animationInterval), m_idleTimeout(idleTimeout)
+{
+    m_start = Clock::now();
+    m_startCpu = processCpuSeconds();
+}
+
+void RedrawTracker::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    m_dirty = true;
+}
+
+bool RedrawTracker::needsRedraw(double now) const
+{
+    return !m_enabled || m_dirty || (m_animating && now >= m_nextAnimationFrame);
+}
+
+double RedrawTracker::getWaitTimeout(double now) const
+{
+    if (needsRedraw(now))
+        return 0.0;
+    if (m_animating)
+        return std::max(m_nextAnimationFrame - now, 0.0);
+    return m_idleTimeout;
+}
+
+void RedrawTracker::frameDrawn(double now)
+{
+    m_dirty = false;
+    m_frames++;
+
+    // O ritmo da animação segue o horário marcado, não o fim do frame; um
+    // frame atrasado remarca a partir de agora
+    if (now >= m_nextAnimationFrame)
+    {
+        m_nextAnimationFrame += m_animationInterval;
+        if (m_nextAnimationFrame <= now)
+            m_nextAnimationFrame = now + m_animationInterval;
+    }
+}
+
+void RedrawTracker::beginWait()
+{
+    m_waitStart = Clock::now();
+    m_waitStartCpu = processCpuSeconds();
+}
+
+void RedrawTracker::endWait()
+{
+    m_waits++;
+    m_waitSeconds += std::chrono::duration<double>(Clock::now() - m_waitStart).count();
+    m_waitCpuSeconds += processCpuSeconds() - m_waitStartCpu;
+}
+
+void RedrawTracker::printStats() const
+{
+    double seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+    if (seconds <= 0.0)
+        return;
+
+    double cpu = processCpuSeconds() - m_startCpu;
+    std::cout << "RedrawTracker: " << m_frames << " frames em " << seconds << " s ("
+        << m_frames / seconds << " por segundo), CPU media de " << cpu / seconds * 100.0 << "% de um nucleo";
+    if (m_waitSeconds > 0.0)
+    {
+        std::cout << "; " << m_waits << " esperas por eventos somando " << m_waitSeconds << " s, com "
+            << m_waitCpuSeconds / m_waitSeconds * 100.0 << "% de CPU";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Desenho sob demanda: só desenha quando a cena ou a câmera mudaram (dirty)
+// ou quando há uma animação contínua rodando; no resto do tempo o laço
+// principal dorme em glfwWaitEventsTimeout em vez de redesenhar o mesmo
+// frame, e a CPU e a GPU ficam livres.
+//
+//   RedrawTracker redraw(1.0 / 60.0);
+//   // callbacks de teclado, mouse e resize: redraw.markDirty();
+//   while (...)
+//   {
+//       redraw.setAnimating(rotateX || rotateY || rotateZ);
+//       redraw.beginWait();
+//       glfwWaitEventsTimeout(redraw.getWaitTimeout(glfwGetTime()));
+//       redraw.endWait();
+//       if (!redraw.needsRedraw(glfwGetTime()))
+//           continue;
+//       desenha; glfwSwapBuffers(window);
+//       redraw.frameDrawn(glfwGetTime());
+//   }
+//   redraw.printStats();
+//
+// Uma animação desenha no seu próprio ritmo (animationInterval; 0 = um frame
+// por volta do laço, limitado pelo vsync ou pela simulação). Sem nada para
+// desenhar a espera é de idleTimeout, para quem ainda precisa olhar algo de
+// tempos em tempos (hot reload). O tempo e a CPU do processo (todas as
+// threads) gastos nas esperas são medidos, para mostrar o custo parado.
+// Desligado (setEnabled(false)) volta ao laço que redesenha sempre.
+
+class RedrawTracker
+{
+public:
+    explicit RedrawTracker(double animationInterval = 1.0 / 60.0, double idleTimeout = 0.5);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // Algo mudou desde o último frame (evento, passo da simulação, asset)
+    void markDirty() { m_dirty = true; }
+
+    // Animação contínua: pede frames no ritmo de animationInterval sem eventos
+    void setAnimating(bool animating) { m_animating = animating; }
+    bool isAnimating() const { return m_animating; }
+
+    // Nada a desenhar até o próximo evento
+    bool isIdle() const { return m_enabled && !m_dirty && !m_animating; }
+
+    // now em segundos (glfwGetTime)
+    bool needsRedraw(double now) const;
+
+    // Quanto esperar por eventos antes da próxima volta do laço (0 = só poll)
+    double getWaitTimeout(double now) const;
+    double getIdleTimeout() const { return m_idleTimeout; }
+
+    // Limpa o dirty e marca a hora do frame para o ritmo da animação
+    void frameDrawn(double now);
+
+    // Em volta da espera por eventos (glfwWaitEventsTimeout)
+    void beginWait();
+    void endWait();
+
+    void printStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double m_animationInterval;
+    double m_idleTimeout;
+    bool m_enabled = true;
+    bool m_dirty = true;
+    bool m_animating = false;
+    double m_nextAnimationFrame = 0.0;
+
+    uint64_t m_frames = 0;
+    uint64_t m_waits = 0;
+    double m_waitSeconds = 0.0;
+    double m_waitCpuSeconds = 0.0;
+    Clock::time_point m_waitStart;
+    double m_waitStartCpu = 0.0;
+    Clock::time_point m_start;
+    double m_startCpu = 0.0;
+};
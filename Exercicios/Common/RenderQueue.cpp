@@ -0,0 +1,195 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Profiler.h"
+
+void RenderQueue::beginFrame(const glm::mat4& view, float farPlane)
+{
+    m_view = view;
+    m_farPlane = farPlane;
+    m_items.clear();
+    m_entries.clear();
+}
+
+void RenderQueue::setBackToFront(uint32_t pass, bool backToFront)
+{
+    uint32_t bit = 1u << (pass & 0xF);
+    m_backToFront = backToFront ? m_backToFront | bit : m_backToFront & ~bit;
+}
+
+uint32_t RenderQueue::compactId(std::unordered_map<GLuint, uint32_t>& ids, GLuint name, uint32_t bits)
+{
+    uint32_t maxId = (1u << bits) - 1;
+    auto it = ids.find(name);
+    if (it != ids.end())
+        return it->second;
+    uint32_t id = std::min((uint32_t)ids.size(), maxId);
+    ids.emplace(name, id);
+    return id;
+}
+
+void RenderQueue::push(const DrawItem& item)
+{
+    // Distância ao longo da câmera, 16 bits entre 0 e o far plane
+    float viewDepth = -(m_view * item.model[3]).z;
+    uint64_t depth = (uint64_t)(glm::clamp(viewDepth / m_farPlane, 0.0f, 1.0f) * 65535.0f);
+
+    // Estado em 44 bits: programa (8), material (12), textura (12), VAO (12)
+    uint64_t state = (uint64_t)compactId(m_programIds, item.program, 8) << 36;
+    state |= (uint64_t)(std::min(item.material, 4095u)) << 24;
+    state |= (uint64_t)compactId(m_textureIds, item.texture, 12) << 12;
+    state |= (uint64_t)compactId(m_vaoIds, item.VAO, 12);
+
+    uint64_t key = (uint64_t)(item.pass & 0xF) << 60;
+    if (m_backToFront & (1u << (item.pass & 0xF)))
+        key |= (65535 - depth) << 44 | state;
+    else
+        key |= state << 16 | depth;
+
+    m_entries.push_back({ key, (uint32_t)m_items.size() });
+    m_items.push_back(item);
+}
+
+void RenderQueue::radixSort()
+{
+    size_t count = m_entries.size();
+    m_scratch.resize(count);
+
+    // LSD, 8 bits por passo; estável, então a ordem de chegada desempata
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const SortEntry& entry : m_entries)
+            histogram[(entry.key >> shift) & 0xFF]++;
+        if (histogram[(m_entries[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            size_t n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (const SortEntry& entry : m_entries)
+            m_scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        m_entries.swap(m_scratch);
+    }
+}
+
+uint64_t RenderQueue::countChanges(const std::vector<SortEntry>& order) const
+{
+    uint64_t changes = 0;
+    const DrawItem* previous = nullptr;
+    for (const SortEntry& entry : order)
+    {
+        const DrawItem& item = m_items[entry.item];
+        if (!previous || item.program != previous->program)
+            changes += 2;       // programa e material
+        else if (item.material != previous->material)
+            changes++;
+        if (!previous || item.texture != previous->texture)
+            changes++;
+        if (!previous || item.VAO != previous->VAO)
+            changes++;
+        previous = &item;
+    }
+    return changes;
+}
+
+void RenderQueue::submit()
+{
+    PROFILE_SCOPE("RenderQueue");
+    m_stats.frames++;
+    if (m_entries.empty())
+        return;
+
+    m_stats.arrivalChanges += countChanges(m_entries);
+
+    auto start = std::chrono::steady_clock::now();
+    if (m_sorting)
+        radixSort();
+    auto sorted = std::chrono::steady_clock::now();
+
+    // Sem suposição sobre o estado anterior: o primeiro draw liga tudo
+    const DrawItem* previous = nullptr;
+    uint64_t previousKey = 0;
+    GLint modelLoc = -1;
+    for (const SortEntry& entry : m_entries)
+    {
+        const DrawItem& item = m_items[entry.item];
+        bool programChanged = !previous || item.program != previous->program;
+        if (programChanged)
+        {
+            glUseProgram(item.program);
+            auto it = m_modelLocations.find(item.program);
+            if (it == m_modelLocations.end())
+                it = m_modelLocations.emplace(item.program, glGetUniformLocation(item.program, "model")).first;
+            modelLoc = it->second;
+            if (m_onProgram)
+                m_onProgram(item.program);
+            m_stats.programChanges++;
+        }
+        if (programChanged || item.material != previous->material)
+        {
+            if (m_onMaterial)
+                m_onMaterial(item.material, item.program);
+            m_stats.materialChanges++;
+        }
+        if (!previous || item.texture != previous->texture)
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, item.texture);
+            m_stats.textureChanges++;
+        }
+        if (!previous || item.VAO != previous->VAO)
+        {
+            glBindVertexArray(item.VAO);
+            m_stats.vaoChanges++;
+        }
+
+        // Nos passes de trás para frente a profundidade invertida está logo abaixo do passe
+        uint32_t pass = (uint32_t)(entry.key >> 60);
+        if (previous && (m_backToFront & (1u << pass)) && pass == (previousKey >> 60) &&
+            ((entry.key >> 44) & 0xFFFF) < ((previousKey >> 44) & 0xFFFF))
+            m_stats.depthInversions++;
+        previousKey = entry.key;
+
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(item.model));
+        if (item.indexed)
+            glDrawElementsBaseVertex(GL_TRIANGLES, item.count, GL_UNSIGNED_INT,
+                (void*)((size_t)item.first * sizeof(GLuint)), item.baseVertex);
+        else
+            glDrawArrays(GL_TRIANGLES, (GLint)item.first, item.count);
+        m_stats.draws++;
+        previous = &item;
+    }
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    auto end = std::chrono::steady_clock::now();
+    m_stats.sortMs += std::chrono::duration<double, std::milli>(sorted - start).count();
+    m_stats.submitMs += std::chrono::duration<double, std::milli>(end - sorted).count();
+}
+
+void RenderQueue::printStats() const
+{
+    if (m_stats.frames == 0)
+        return;
+
+    double frames = (double)m_stats.frames;
+    uint64_t changes = m_stats.programChanges + m_stats.materialChanges + m_stats.textureChanges + m_stats.vaoChanges;
+    std::cout << "RenderQueue: " << m_stats.frames << " frames, media de " << m_stats.draws / frames
+        << " draws e " << changes / frames << " trocas de estado (programa " << m_stats.programChanges / frames
+        << ", material " << m_stats.materialChanges / frames << ", textura " << m_stats.textureChanges / frames
+        << ", VAO " << m_stats.vaoChanges / frames << ") por frame, " << m_stats.arrivalChanges / frames
+        << " na ordem de chegada; " << (m_sorting ? "ordenacao " : "sem ordenacao ") << m_stats.sortMs / frames
+        << " ms, submissao " << m_stats.submitMs / frames << " ms";
+    if (m_backToFront)
+        std::cout << "; " << m_stats.depthInversions / frames << " draws fora da ordem de tras para frente";
+    std::cout << std::endl;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Fila de draws: cada sistema empurra o que quer desenhar no frame, a fila
+// ordena por uma chave de 64 bits e desenha trocando o mínimo de estado.
+//
+//   RenderQueue queue;
+//   queue.setProgramCallback([&](GLuint program) { ...view, projection... });
+//   queue.setMaterialCallback([&](uint32_t material, GLuint program) { ...kd, ks... });
+//   queue.setBackToFront(1, true);           // passe 1: transparentes
+//   queue.beginFrame(view, 100.0f);          // far plane, para a profundidade
+//   DrawItem item;
+//   item.program = phong; item.VAO = geometry.VAO; item.texture = geometry.textureID;
+//   item.indexed = false; item.count = geometry.vertexCount; item.model = model;
+//   queue.push(item);
+//   ...
+//   queue.submit();                          // ordena (radix sort) e desenha
+//
+// Chave, do bit mais alto ao mais baixo: passe (4 bits), programa (8),
+// material (12), textura (12), VAO (12) e profundidade (16, a distância ao
+// longo da câmera até a origem do modelo). Nos passes de trás para frente
+// (transparentes) a ordem é a da tela, não a do estado: a profundidade,
+// invertida, vem logo abaixo do passe e o estado só desempata.
+// Programas, texturas e VAOs ganham ids compactos na primeira vez em
+// que aparecem; ids que não cabem nos bits ficam todos no último valor, o que
+// só piora a ordem, não o resultado. A ordenação é um radix sort LSD de 8 bits
+// que pula os bytes iguais em todas as chaves. Na submissão só o que muda de
+// um draw para o próximo é ligado; o model vai no uniform "model".
+
+struct DrawItem
+{
+    uint32_t pass = 0;              // 0 a 15, desenhados em ordem
+    GLuint program = 0;
+    uint32_t material = 0;          // id do chamador (0 a 4095), passado ao callback
+    GLuint texture = 0;             // GL_TEXTURE_2D na unidade 0 (0 = nenhuma)
+    GLuint VAO = 0;
+    glm::mat4 model = glm::mat4(1.0f);
+    bool indexed = true;            // glDrawElementsBaseVertex ou glDrawArrays
+    GLsizei count = 0;
+    GLuint first = 0;               // primeiro índice ou primeiro vértice
+    GLint baseVertex = 0;
+};
+
+// Acumulado desde a criação
+struct RenderQueueStats
+{
+    uint64_t frames = 0;
+    uint64_t draws = 0;
+    uint64_t programChanges = 0;
+    uint64_t materialChanges = 0;
+    uint64_t textureChanges = 0;
+    uint64_t vaoChanges = 0;
+    uint64_t arrivalChanges = 0;    // trocas (as quatro somadas) se desenhasse na ordem de chegada
+    uint64_t depthInversions = 0;   // nos passes de trás para frente, draws mais longe que o anterior
+    double sortMs = 0.0;
+    double submitMs = 0.0;
+};
+
+class RenderQueue
+{
+public:
+    typedef std::function<void(GLuint)> ProgramCallback;
+    typedef std::function<void(uint32_t, GLuint)> MaterialCallback;
+
+    // Chamado logo depois de ligar um programa (view, projection, luzes...)
+    void setProgramCallback(ProgramCallback callback) { m_onProgram = callback; }
+
+    // Chamado quando o material muda, com o programa já ligado
+    void setMaterialCallback(MaterialCallback callback) { m_onMaterial = callback; }
+
+    // false desenha na ordem de chegada (para comparar)
+    void setSorting(bool sorting) { m_sorting = sorting; }
+
+    // Passe de trás para frente (transparentes): o mais longe primeiro
+    void setBackToFront(uint32_t pass, bool backToFront);
+
+    void beginFrame(const glm::mat4& view, float farPlane);
+    void push(const DrawItem& item);
+    void submit();
+
+    size_t size() const { return m_items.size(); }
+    const RenderQueueStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+private:
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    static uint32_t compactId(std::unordered_map<GLuint, uint32_t>& ids, GLuint name, uint32_t bits);
+    void radixSort();
+    uint64_t countChanges(const std::vector<SortEntry>& order) const;
+
+    ProgramCallback m_onProgram;
+    MaterialCallback m_onMaterial;
+    bool m_sorting = true;
+    uint32_t m_backToFront = 0;     // um bit por passe
+
+    glm::mat4 m_view = glm::mat4(1.0f);
+    float m_farPlane = 100.0f;
+    std::vector<DrawItem> m_items;
+    std::vector<SortEntry> m_entries;
+    std::vector<SortEntry> m_scratch;
+
+    std::unordered_map<GLuint, uint32_t> m_programIds;
+    std::unordered_map<GLuint, uint32_t> m_textureIds;
+    std::unordered_map<GLuint, uint32_t> m_vaoIds;
+    std::unordered_map<GLuint, GLint> m_modelLocations;
+
+    RenderQueueStats m_stats;
+};
@@ -0,0 +1,132 @@
+#include "RenderThread.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Profiler.h"
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::setContinuous(bool continuous, double maxFps)
+{
+    m_continuous = continuous;
+    m_maxFps = maxFps;
+}
+
+void RenderThread::start(const RenderThreadCallbacks& callbacks)
+{
+    if (m_thread.joinable())
+        return;
+    m_callbacks = callbacks;
+    m_pending = false;
+    m_stop = false;
+    m_stats = RenderThreadStats();
+    m_thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::notify()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = true;
+        m_lastNotify = Clock::now();
+        m_stats.notifies++;
+    }
+    m_wake.notify_one();
+}
+
+void RenderThread::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void RenderThread::run()
+{
+    PROFILE_THREAD("Render");
+    if (m_callbacks.begin)
+        m_callbacks.begin();
+
+    // No modo contínuo, um frame sem nada a desenhar faz a thread dormir até
+    // o próximo notify (desenho sob demanda)
+    bool idle = true;
+    Clock::duration period = Clock::duration::zero();
+    if (m_maxFps > 0.0)
+        period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_maxFps));
+    Clock::time_point nextFrame = Clock::now();
+    while (true)
+    {
+        Clock::time_point published;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_continuous || idle)
+                m_wake.wait(lock, [this]() { return m_pending || m_stop; });
+            else if (period > Clock::duration::zero())
+                m_wake.wait_until(lock, nextFrame, [this]() { return m_stop; });
+            if (m_stop)
+                break;
+            m_pending = false;
+            published = m_lastNotify;
+        }
+        nextFrame = std::max(nextFrame + period, Clock::now());
+
+        Clock::time_point start = Clock::now();
+        bool drawn;
+        {
+            PROFILE_SCOPE("RenderFrame");
+            drawn = m_callbacks.frame();
+        }
+        idle = !drawn;
+        if (!drawn)
+            continue;
+        Clock::time_point submitted = Clock::now();
+        {
+            PROFILE_SCOPE("Swap");
+            if (m_callbacks.swap)
+                m_callbacks.swap();
+        }
+        Clock::time_point end = Clock::now();
+
+        double latency = std::chrono::duration<double, std::milli>(end - published).count();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.frames++;
+        m_stats.frameMs += std::chrono::duration<double, std::milli>(submitted - start).count();
+        m_stats.swapMs += std::chrono::duration<double, std::milli>(end - submitted).count();
+        m_stats.latencyMs += latency;
+        m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latency);
+    }
+
+    if (m_callbacks.end)
+        m_callbacks.end();
+}
+
+RenderThreadStats RenderThread::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void RenderThread::printStats() const
+{
+    RenderThreadStats stats = getStats();
+    if (stats.frames == 0)
+        return;
+
+    double frames = (double)stats.frames;
+    std::cout << "RenderThread: " << stats.notifies << " snapshots, " << stats.frames << " frames";
+    if (!m_continuous)
+        std::cout << " (" << stats.notifies - std::min(stats.notifies, stats.frames) << " descartados)";
+    std::cout << "; media de "
+        << stats.frameMs / frames << " ms de submissao e " << stats.swapMs / frames
+        << " ms de swap por frame, latencia snapshot->tela " << stats.latencyMs / frames << " ms (max "
+        << stats.maxLatencyMs << " ms)" << std::endl;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Thread de render separada da thread de eventos e simulação. A thread
+// principal bombeia os eventos do GLFW e simula num ritmo fixo; a cada passo
+// escreve um snapshot imutável do frame (matrizes, modo de luz...) num
+// TripleBuffer e avisa o RenderThread, que é o dono do contexto GL e desenha
+// sempre o snapshot mais recente. Um swap preso no vsync ou na GPU só atrasa
+// a thread de render: a simulação e a leitura do teclado seguem no seu ritmo.
+//
+//   TripleBuffer<FrameSnapshot> frames;
+//   RenderThread renderer;
+//   RenderThreadCallbacks callbacks;
+//   callbacks.begin = [&]() { glfwMakeContextCurrent(window); ...cria recursos GL... };
+//   callbacks.frame = [&]() { if (!frames.acquire()) return false; draw(frames.front()); return true; };
+//   callbacks.swap = [&]() { glfwSwapBuffers(window); };
+//   callbacks.end = [&]() { ...apaga recursos GL...; glfwMakeContextCurrent(nullptr); };
+//   glfwMakeContextCurrent(nullptr);        // o contexto passa para a thread de render
+//   renderer.start(callbacks);
+//   while (...) { glfwPollEvents(); simula; preenche frames.back(); frames.publish(); renderer.notify(); }
+//   renderer.stop();
+//
+// Por padrão a thread de render só desenha quando há snapshot novo. Com
+// setContinuous ela desenha sem parar (depois do primeiro snapshot), para
+// interpolar entre os passos da simulação, limitada pelo vsync ou por maxFps;
+// quando o frame devolve false (nada mudou) ela dorme até o próximo notify.
+//
+// O GLFW só é usado pelos callbacks (o Common não linka com ele). O
+// TripleBuffer não tem lock: produtor e consumidor trocam de slot com um
+// exchange atômico no slot do meio, e o produtor nunca espera; se o render
+// estiver atrasado, o snapshot que não chegou a ser desenhado é substituído
+// (contado como descartado). O aviso de snapshot novo usa uma variável de
+// condição, só para a thread de render dormir enquanto não há o que desenhar.
+
+// Um produtor (back/publish) e um consumidor (acquire/front)
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Slot do produtor; não é lido por ninguém até o publish
+    T& back() { return m_slots[m_back]; }
+
+    // Entrega o back ao consumidor; true se o anterior não tinha sido lido
+    bool publish()
+    {
+        uint32_t previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+        m_back = previous & INDEX;
+        return (previous & FRESH) != 0;
+    }
+
+    // Pega o snapshot mais recente, se houver um novo desde o último acquire
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_acquire) & FRESH) == 0)
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // Slot do consumidor; fica estável até o próximo acquire
+    const T& front() const { return m_slots[m_front]; }
+
+private:
+    static const uint32_t INDEX = 3;
+    static const uint32_t FRESH = 4;
+
+    T m_slots[3];
+    uint32_t m_back = 0;
+    uint32_t m_front = 1;
+    std::atomic<uint32_t> m_middle{ 2 };
+};
+
+struct RenderThreadCallbacks
+{
+    std::function<void()> begin;    // na thread de render: torna o contexto atual, cria recursos
+    std::function<bool()> frame;    // desenha o snapshot mais recente; false = nada a desenhar, sem swap (e espera o notify)
+    std::function<void()> swap;     // glfwSwapBuffers
+    std::function<void()> end;      // apaga recursos e solta o contexto
+};
+
+// Somas desde o start
+struct RenderThreadStats
+{
+    uint64_t notifies = 0;          // snapshots publicados
+    uint64_t frames = 0;            // frames desenhados
+    double frameMs = 0.0;           // callback frame (submissão)
+    double swapMs = 0.0;            // callback swap (espera do vsync/GPU)
+    double latencyMs = 0.0;         // do notify do snapshot ao fim do swap
+    double maxLatencyMs = 0.0;
+};
+
+class RenderThread
+{
+public:
+    RenderThread() = default;
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Antes do start; maxFps = 0 deixa o ritmo só com o vsync
+    void setContinuous(bool continuous, double maxFps = 0.0);
+
+    // O contexto GL já deve estar solto na thread que chama
+    void start(const RenderThreadCallbacks& callbacks);
+
+    // Um snapshot novo foi publicado (chamar depois do publish)
+    void notify();
+
+    // Termina o frame em andamento, roda o end e espera a thread
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+
+    RenderThreadStats getStats() const;
+    void printStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+
+    RenderThreadCallbacks m_callbacks;
+    bool m_continuous = false;
+    double m_maxFps = 0.0;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_pending = false;
+    bool m_stop = false;
+    Clock::time_point m_lastNotify;
+    RenderThreadStats m_stats;
+};
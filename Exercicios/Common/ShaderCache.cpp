@@ -0,0 +1,267 @@
+#include "ShaderCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "GLUtil.h"
+#include "Profiler.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Cabeçalho gravado antes do binário do programa
+struct ProgramBinaryHeader
+{
+    uint32_t magic;
+    uint32_t format;
+};
+
+static const uint32_t PROGRAM_BINARY_MAGIC = 0x43534750; // "PGSC"
+
+static std::string glString(GLenum name)
+{
+    const GLubyte* s = glGetString(name);
+    return s ? (const char*)s : "";
+}
+
+ShaderCache::ShaderCache(const std::string& directory, GLADloadproc loadProc) : m_disk(directory)
+{
+    m_driverId = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+
+    GLint binaryFormats = 0;
+    if (GLAD_GL_VERSION_4_1)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+    m_binarySupported = binaryFormats > 0;
+
+    if (loadProc)
+    {
+        if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+            m_maxShaderCompilerThreads = (PFNMAXSHADERCOMPILERTHREADSPROC)loadProc("glMaxShaderCompilerThreadsKHR");
+        else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+            m_maxShaderCompilerThreads = (PFNMAXSHADERCOMPILERTHREADSPROC)loadProc("glMaxShaderCompilerThreadsARB");
+    }
+    m_parallelSupported = m_maxShaderCompilerThreads != nullptr;
+
+    // 0xFFFFFFFF = deixa o driver escolher quantas threads usar
+    if (m_parallelSupported)
+        m_maxShaderCompilerThreads(0xFFFFFFFFu);
+}
+
+size_t ShaderCache::request(const std::string& name, const std::vector<ShaderStageSource>& stages)
+{
+    Entry entry;
+    entry.name = name;
+    entry.stages = stages;
+
+    uint64_t key = DiskCache::hash(m_driverId);
+    for (const ShaderStageSource& stage : stages)
+    {
+        key = DiskCache::hash(&stage.type, sizeof(stage.type), key);
+        key = DiskCache::hash(stage.source, key);
+    }
+    entry.key = key;
+
+    // Um nome já registrado (hot reload) reaproveita a entrada; o programa
+    // antigo continua com quem o pegou
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries[i].name == name)
+        {
+            m_entries[i] = entry;
+            return i;
+        }
+    }
+
+    m_entries.push_back(entry);
+    return m_entries.size() - 1;
+}
+
+GLuint ShaderCache::getProgram(const std::string& name, const char* vertexSource, const char* fragmentSource)
+{
+    size_t index = request(name, {
+        { GL_VERTEX_SHADER, vertexSource },
+        { GL_FRAGMENT_SHADER, fragmentSource }
+        });
+    build();
+    return program(index);
+}
+
+void ShaderCache::build()
+{
+    PROFILE_SCOPE("ShaderBuild");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 1) Tenta os binários do cache
+    std::vector<Entry*> cold;
+    for (Entry& entry : m_entries)
+    {
+        if (entry.built)
+            continue;
+
+        if (m_binarySupported && loadBinary(entry))
+        {
+            entry.built = true;
+            m_hits++;
+        }
+        else
+        {
+            cold.push_back(&entry);
+        }
+    }
+
+    // 2) Dispara todas as compilações antes de consultar qualquer status,
+    //    para o driver poder compilar em paralelo
+    for (Entry* entry : cold)
+    {
+        for (const ShaderStageSource& stage : entry->stages)
+        {
+            GLuint shader = glCreateShader(stage.type);
+            const GLchar* src = stage.source.c_str();
+            glShaderSource(shader, 1, &src, NULL);
+            glCompileShader(shader);
+            entry->shaders.push_back(shader);
+        }
+    }
+
+    for (Entry* entry : cold)
+    {
+        entry->program = glCreateProgram();
+        for (GLuint shader : entry->shaders)
+            glAttachShader(entry->program, shader);
+        if (m_binarySupported)
+            glProgramParameteri(entry->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(entry->program);
+    }
+
+    // 3) Com a extensão paralela, espera sem bloquear dentro do driver
+    if (m_parallelSupported)
+    {
+        for (Entry* entry : cold)
+        {
+            GLint done = GL_FALSE;
+            while (true)
+            {
+                glGetProgramiv(entry->program, GL_COMPLETION_STATUS_KHR, &done);
+                if (done)
+                    break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    for (Entry* entry : cold)
+    {
+        if (checkProgram(*entry) && m_binarySupported)
+            storeBinary(*entry);
+        entry->built = true;
+        m_misses++;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_buildMs += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool ShaderCache::loadBinary(Entry& entry)
+{
+    std::vector<char> data;
+    if (!m_disk.read(entry.key, data) || data.size() <= sizeof(ProgramBinaryHeader))
+        return false;
+
+    ProgramBinaryHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != PROGRAM_BINARY_MAGIC)
+    {
+        m_disk.remove(entry.key);
+        return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, data.data() + sizeof(header), (GLsizei)(data.size() - sizeof(header)));
+
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // Driver recusou o binário: descarta e recompila a partir do código-fonte
+        glDeleteProgram(program);
+        m_disk.remove(entry.key);
+        m_rejected++;
+        return false;
+    }
+
+    entry.program = program;
+    return true;
+}
+
+void ShaderCache::storeBinary(const Entry& entry)
+{
+    GLint length = 0;
+    glGetProgramiv(entry.program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> data(sizeof(ProgramBinaryHeader) + length);
+    ProgramBinaryHeader header = { PROGRAM_BINARY_MAGIC, 0 };
+    GLenum format = 0;
+    glGetProgramBinary(entry.program, length, NULL, &format, data.data() + sizeof(header));
+    header.format = format;
+    memcpy(data.data(), &header, sizeof(header));
+
+    if (!m_disk.write(entry.key, data.data(), data.size()))
+        std::cerr << "ShaderCache: nao foi possivel gravar " << m_disk.pathFor(entry.key) << std::endl;
+}
+
+bool ShaderCache::checkProgram(Entry& entry)
+{
+    GLint success;
+    GLchar infoLog[512];
+
+    for (size_t i = 0; i < entry.shaders.size(); ++i)
+    {
+        glGetShaderiv(entry.shaders[i], GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(entry.shaders[i], 512, NULL, infoLog);
+            const char* stage = entry.stages[i].type == GL_VERTEX_SHADER ? "VERTEX" :
+                entry.stages[i].type == GL_FRAGMENT_SHADER ? "FRAGMENT" :
+                entry.stages[i].type == GL_COMPUTE_SHADER ? "COMPUTE" : "STAGE";
+            std::cerr << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED (" << entry.name << ")\n" << infoLog << std::endl;
+        }
+    }
+
+    glGetProgramiv(entry.program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(entry.program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED (" << entry.name << ")\n" << infoLog << std::endl;
+    }
+
+    for (GLuint shader : entry.shaders)
+    {
+        glDetachShader(entry.program, shader);
+        glDeleteShader(shader);
+    }
+    entry.shaders.clear();
+
+    if (!success)
+    {
+        glDeleteProgram(entry.program);
+        entry.program = 0;
+    }
+    return success == GL_TRUE;
+}
+
+void ShaderCache::printReport() const
+{
+    std::cout << "ShaderCache: " << m_entries.size() << " programa(s), "
+        << m_hits << " do cache, " << m_misses << " compilado(s)";
+    if (m_rejected > 0)
+        std::cout << " (" << m_rejected << " binario(s) recusado(s) pelo driver)";
+    std::cout << " - " << (m_misses == 0 ? "cache quente" : "cache frio")
+        << ", " << m_buildMs << " ms"
+        << (m_parallelSupported ? ", compilacao paralela" : "")
+        << (m_binarySupported ? "" : ", sem suporte a program binary") << std::endl;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "DiskCache.h"
+
+// Um estágio de shader (GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, ...) e seu código GLSL
+struct ShaderStageSource
+{
+    GLenum type;
+    std::string source;
+};
+
+// Cache de programas de shader.
+//
+// Guarda em disco a saída de glGetProgramBinary, com chave formada pelo hash do
+// código-fonte e pelo vendor/renderer/versão do driver. Se o driver recusar o
+// binário (atualização de driver, troca de GPU) o programa é compilado de novo.
+// Os programas que precisam ser compilados são enviados todos juntos, usando
+// GL_KHR_parallel_shader_compile quando o driver oferece.
+class ShaderCache
+{
+public:
+    ShaderCache(const std::string& directory, GLADloadproc loadProc);
+
+    // Registra um programa para o próximo build() e retorna seu índice; pedir
+    // de novo o mesmo nome substitui a entrada (sem apagar o programa antigo)
+    size_t request(const std::string& name, const std::vector<ShaderStageSource>& stages);
+
+    // Carrega do cache ou compila todos os programas pendentes
+    void build();
+
+    // Programa linkado (0 se a compilação falhou)
+    GLuint program(size_t index) const { return m_entries[index].program; }
+
+    // Atalho para o caso comum de um vertex + fragment shader
+    GLuint getProgram(const std::string& name, const char* vertexSource, const char* fragmentSource);
+
+    void printReport() const;
+
+    int getHits() const { return m_hits; }
+    int getMisses() const { return m_misses; }
+    int getRejected() const { return m_rejected; }
+    double getBuildMs() const { return m_buildMs; }
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::vector<ShaderStageSource> stages;
+        uint64_t key = 0;
+        GLuint program = 0;
+        bool built = false;
+        std::vector<GLuint> shaders;
+    };
+
+    bool loadBinary(Entry& entry);
+    void storeBinary(const Entry& entry);
+    bool checkProgram(Entry& entry);
+
+    DiskCache m_disk;
+    std::vector<Entry> m_entries;
+
+    std::string m_driverId;
+    bool m_binarySupported = false;
+    bool m_parallelSupported = false;
+
+    typedef void (APIENTRYP PFNMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+    PFNMAXSHADERCOMPILERTHREADSPROC m_maxShaderCompilerThreads = nullptr;
+
+    int m_hits = 0;
+    int m_misses = 0;
+    int m_rejected = 0;
+    double m_buildMs = 0.0;
+};
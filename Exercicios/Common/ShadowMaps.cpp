@@ -0,0 +1,744 @@
+#include "ShadowMaps.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GLUtil.h"
+#include "Profiler.h"
+
+// Passe de sombra: o vertex shader leva o vértice para o mundo e escolhe a
+// camada pela instância. Com VERTEX_LAYER ele mesmo projeta e grava gl_Layer;
+// sem a extensão o geometry shader abaixo faz essa parte.
+static const char* shadowVertexSource = R"glsl(
+layout(location = 0) in vec3 position;
+
+uniform mat4 model;
+uniform mat4 layerMatrices[MAX_LAYERS];
+uniform int instanceLayers[MAX_LAYERS];
+
+#ifdef VERTEX_LAYER
+out vec3 worldPos;
+flat out int layer;
+#else
+out vec3 vWorldPos;
+flat out int vLayer;
+#endif
+
+void main()
+{
+    int target = instanceLayers[gl_InstanceID];
+    vec4 world = model * vec4(position, 1.0);
+#ifdef VERTEX_LAYER
+    worldPos = world.xyz;
+    layer = target;
+    gl_Layer = target;
+    gl_Position = layerMatrices[target] * world;
+#else
+    vWorldPos = world.xyz;
+    vLayer = target;
+    gl_Position = world;
+#endif
+}
+)glsl";
+
+static const char* shadowGeometrySource = R"glsl(
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+uniform mat4 layerMatrices[MAX_LAYERS];
+
+in vec3 vWorldPos[];
+flat in int vLayer[];
+
+out vec3 worldPos;
+flat out int layer;
+
+void main()
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        worldPos = vWorldPos[i];
+        layer = vLayer[0];
+        gl_Layer = vLayer[0];
+        gl_Position = layerMatrices[vLayer[0]] * vec4(vWorldPos[i], 1.0);
+        EmitVertex();
+    }
+    EndPrimitive();
+}
+)glsl";
+
+// Cube maps guardam a distância até a luz dividida pelo far (linear, igual
+// em todas as faces); as cascatas usam a profundidade normal da ortográfica
+static const char* pointFragmentSource = R"glsl(
+in vec3 worldPos;
+flat in int layer;
+
+uniform vec4 pointLights[MAX_LAYERS / 6];
+
+void main()
+{
+    vec4 light = pointLights[layer / 6];
+    gl_FragDepth = length(worldPos - light.xyz) / light.w;
+}
+)glsl";
+
+static const char* cascadeFragmentSource = R"glsl(
+void main()
+{
+}
+)glsl";
+
+static const char* receiverSource = R"glsl(
+#define MAX_SHADOW_POINT_LIGHTS 4
+#define MAX_SHADOW_CASCADES 4
+
+uniform samplerCubeArrayShadow shadowCubeMaps;
+uniform sampler2DArrayShadow shadowCascadeMaps;
+uniform vec4 shadowPointLights[MAX_SHADOW_POINT_LIGHTS];    // xyz: posição, w: far
+uniform float shadowCubeTexel;                              // texel a uma unidade da luz
+uniform mat4 shadowCascadeMatrices[MAX_SHADOW_CASCADES];
+uniform vec4 shadowCascadeParams[MAX_SHADOW_CASCADES];      // fim (profundidade de view), texel, bias
+uniform int shadowCascadeCount;
+uniform mat4 shadowCameraView;
+
+// normal em mundo, normalizada; 1 = iluminado, 0 = na sombra
+float pointShadow(int light, vec3 worldPos, vec3 normal)
+{
+    vec4 shadowLight = shadowPointLights[light];
+    float texel = shadowCubeTexel * length(worldPos - shadowLight.xyz);
+    vec3 toFragment = worldPos + normal * 1.5 * texel - shadowLight.xyz;
+    float distance = length(toFragment);
+    if (distance >= shadowLight.w)
+        return 1.0;
+    return texture(shadowCubeMaps, vec4(toFragment, float(light)), (distance - texel) / shadowLight.w);
+}
+
+float directionalShadow(vec3 worldPos, vec3 normal)
+{
+    float depth = -(shadowCameraView * vec4(worldPos, 1.0)).z;
+    for (int i = 0; i < shadowCascadeCount; ++i)
+    {
+        vec4 params = shadowCascadeParams[i];
+        if (depth > params.x)
+            continue;
+        vec4 p = shadowCascadeMatrices[i] * vec4(worldPos + normal * 1.5 * params.y, 1.0);
+        p.xyz = p.xyz * 0.5 + 0.5;
+        return texture(shadowCascadeMaps, vec4(p.xy, float(i), p.z - params.z));
+    }
+    return 1.0;
+}
+)glsl";
+
+// Direção e "up" de cada face do cube map, na ordem das camadas (+X, -X, +Y, -Y, +Z, -Z)
+static const glm::vec3 cubeFaceDirections[6] = {
+    { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+static const glm::vec3 cubeFaceUps[6] = {
+    { 0, -1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, -1, 0 }, { 0, -1, 0 } };
+
+// Caixa dentro ou cruzando o frustum de viewProjection (planos de Gribb/Hartmann)
+static bool boxInFrustum(const glm::mat4& m, const Aabb& box)
+{
+    if (box.isEmpty())
+        return false;
+
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    glm::vec4 planes[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+
+    glm::vec3 center = (box.min + box.max) * 0.5f, half = (box.max - box.min) * 0.5f;
+    for (const glm::vec4& plane : planes)
+    {
+        glm::vec3 n(plane);
+        float radius = std::fabs(n.x) * half.x + std::fabs(n.y) * half.y + std::fabs(n.z) * half.z;
+        if (glm::dot(n, center) + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+static std::string shadowHeader(bool vertexLayer, int maxLayers)
+{
+    std::string header = vertexLayer ? "#version 410 core\n" : "#version 400 core\n";
+    if (vertexLayer)
+        header += hasGLExtension("GL_ARB_shader_viewport_layer_array")
+            ? "#extension GL_ARB_shader_viewport_layer_array : require\n#define VERTEX_LAYER\n"
+            : "#extension GL_AMD_vertex_shader_layer : require\n#define VERTEX_LAYER\n";
+    header += "#define MAX_LAYERS " + std::to_string(maxLayers) + "\n";
+    return header;
+}
+
+ShadowMaps::ShadowMaps(ShaderCache& shaders, const ShadowSettings& settings) : m_settings(settings)
+{
+    m_settings.cascadeCount = std::min(std::max(m_settings.cascadeCount, 1), (int)MAX_CASCADES);
+    m_supported = GLVersion.major >= 4;
+    if (!m_supported)
+    {
+        std::cout << "ShadowMaps: requer OpenGL 4.0 (cube map array), sombras desligadas" << std::endl;
+        return;
+    }
+
+    m_vertexLayer = (GLVersion.major > 4 || GLVersion.minor >= 1) &&
+        (hasGLExtension("GL_ARB_shader_viewport_layer_array") || hasGLExtension("GL_AMD_vertex_shader_layer"));
+
+    size_t programs[2];
+    const char* fragments[2] = { pointFragmentSource, cascadeFragmentSource };
+    const int maxLayers[2] = { MAX_POINT_LIGHTS * 6, MAX_CASCADES };
+    for (int i = 0; i < 2; ++i)
+    {
+        std::string header = shadowHeader(m_vertexLayer, maxLayers[i]);
+        std::vector<ShaderStageSource> stages = {
+            { GL_VERTEX_SHADER, header + shadowVertexSource },
+            { GL_FRAGMENT_SHADER, header + fragments[i] } };
+        if (!m_vertexLayer)
+            stages.push_back({ GL_GEOMETRY_SHADER, header + shadowGeometrySource });
+        programs[i] = shaders.request(i == 0 ? "shadow_point" : "shadow_cascade", stages);
+    }
+    shaders.build();
+    m_pointProgram = shaders.program(programs[0]);
+    m_cascadeProgram = shaders.program(programs[1]);
+    if (m_pointProgram == 0 || m_cascadeProgram == 0)
+    {
+        m_supported = false;
+        return;
+    }
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    glGenQueries(QUERY_COUNT * 2, m_queries);
+}
+
+int ShadowMaps::addPointLight(const glm::vec3& position, float farPlane)
+{
+    if ((int)m_pointLights.size() >= MAX_POINT_LIGHTS)
+        return -1;
+    m_pointLights.push_back({ position, farPlane });
+    return (int)m_pointLights.size() - 1;
+}
+
+void ShadowMaps::setPointLightPosition(int light, const glm::vec3& position)
+{
+    PointLight& pointLight = m_pointLights[light];
+    if (pointLight.position == position)
+        return;
+    pointLight.position = position;
+    for (int face = 0; face < 6 && light * 6 + face < m_cubes.layers; ++face)
+        m_cubes.dirty[light * 6 + face] = 1;
+}
+
+void ShadowMaps::setDirectionalLight(const glm::vec3& direction)
+{
+    glm::vec3 normalized = glm::normalize(direction);
+    if (m_hasDirectional && normalized == m_lightDirection)
+        return;
+    m_lightDirection = normalized;
+    m_hasDirectional = true;
+    std::fill(m_cascadeMaps.dirty.begin(), m_cascadeMaps.dirty.end(), 1);
+}
+
+int ShadowMaps::addCaster(GLuint VAO, GLsizei count, const Aabb& localBounds, bool indexed)
+{
+    Caster caster;
+    caster.VAO = VAO;
+    caster.count = count;
+    caster.indexed = indexed;
+    caster.localBounds = localBounds;
+    caster.bounds = localBounds;
+    m_casters.push_back(caster);
+    return (int)m_casters.size() - 1;
+}
+
+void ShadowMaps::setCasterTransform(int caster, const glm::mat4& model)
+{
+    Caster& c = m_casters[caster];
+    if (c.model == model)
+        return;
+    c.model = model;
+    c.bounds = transformAabb(model, c.localBounds);
+    c.moved = true;
+}
+
+void ShadowMaps::allocate(LayeredTarget& target, GLenum textureTarget, int resolution, int layers)
+{
+    if (!target.texture)
+        glGenTextures(1, &target.texture);
+    glBindTexture(textureTarget, target.texture);
+    glTexImage3D(textureTarget, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, layers, 0, GL_DEPTH_COMPONENT,
+        GL_FLOAT, nullptr);
+
+    // Comparação em hardware: o sampler *Shadow com filtro linear já faz um PCF 2x2
+    glTexParameteri(textureTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(textureTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(textureTarget, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(textureTarget, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    if (textureTarget == GL_TEXTURE_2D_ARRAY)
+    {
+        // Fora da cascata = iluminado
+        const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameterfv(textureTarget, GL_TEXTURE_BORDER_COLOR, border);
+    }
+    else
+    {
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(textureTarget, 0);
+
+    target.resolution = resolution;
+    target.layers = layers;
+    target.matrices.assign(layers, glm::mat4(0.0f));
+    target.dirty.assign(layers, 1);
+}
+
+void ShadowMaps::computeCascades(const glm::mat4& view, const glm::mat4& projection)
+{
+    m_cameraView = view;
+    int count = m_settings.cascadeCount;
+    m_cascades.resize(count);
+
+    // Cantos do frustum da câmera em espaço de view, no near e no far
+    glm::mat4 inverseProjection = glm::inverse(projection);
+    glm::vec3 nearCorners[4], farCorners[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        glm::vec2 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f);
+        glm::vec4 nearPoint = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+        glm::vec4 farPoint = inverseProjection * glm::vec4(ndc, 1.0f, 1.0f);
+        nearCorners[i] = glm::vec3(nearPoint) / nearPoint.w;
+        farCorners[i] = glm::vec3(farPoint) / farPoint.w;
+    }
+    float cameraNear = -nearCorners[0].z, cameraFar = -farCorners[0].z;
+    float shadowFar = std::min(cameraFar, std::max(m_settings.shadowDistance, cameraNear * 2.0f));
+
+    // Caixa de todos os casters: a profundidade da ortográfica precisa pegá-los
+    // mesmo fora da fatia da câmera
+    Aabb scene;
+    for (const Caster& caster : m_casters)
+        scene.grow(caster.bounds);
+
+    glm::vec3 up = std::fabs(m_lightDirection.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+    glm::mat4 rotation = glm::lookAt(glm::vec3(0.0f), m_lightDirection, up);
+    glm::mat4 inverseRotation = glm::inverse(rotation);
+    glm::mat4 inverseView = glm::inverse(view);
+
+    // Divisão "prática": mistura da logarítmica com a linear
+    auto split = [&](int i)
+        {
+            float t = (float)i / count;
+            float logarithmic = cameraNear * std::pow(shadowFar / cameraNear, t);
+            float linear = cameraNear + (shadowFar - cameraNear) * t;
+            return m_settings.cascadeLambda * logarithmic + (1.0f - m_settings.cascadeLambda) * linear;
+        };
+
+    for (int c = 0; c < count; ++c)
+    {
+        float begin = split(c), end = split(c + 1);
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 4; ++i)
+        {
+            glm::vec3 ray = farCorners[i] - nearCorners[i];
+            for (int k = 0; k < 2; ++k)
+            {
+                float depth = k ? end : begin;
+                glm::vec3 point = nearCorners[i] + ray * ((depth - cameraNear) / (cameraFar - cameraNear));
+                corners[i * 2 + k] = glm::vec3(inverseView * glm::vec4(point, 1.0f));
+                center += corners[i * 2 + k];
+            }
+        }
+        center /= 8.0f;
+
+        // Esfera envolvente: o tamanho não muda quando a câmera gira
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // Centro em passos de texel no espaço da luz: a matriz só muda quando
+        // a cascata anda um texel inteiro
+        float texel = 2.0f * radius / m_settings.cascadeResolution;
+        glm::vec3 lightSpace = glm::vec3(rotation * glm::vec4(center, 1.0f));
+        lightSpace = glm::floor(lightSpace / texel) * texel;
+        center = glm::vec3(inverseRotation * glm::vec4(lightSpace, 1.0f));
+
+        glm::mat4 lightView = glm::lookAt(center, center + m_lightDirection, up);
+        float zNear = -radius, zFar = radius;
+        if (!scene.isEmpty())
+            for (int i = 0; i < 8; ++i)
+            {
+                glm::vec3 corner((i & 1) ? scene.max.x : scene.min.x, (i & 2) ? scene.max.y : scene.min.y,
+                    (i & 4) ? scene.max.z : scene.min.z);
+                float depth = -(lightView * glm::vec4(corner, 1.0f)).z;
+                zNear = std::min(zNear, depth);
+                zFar = std::max(zFar, depth);
+            }
+        // Arredondado para fora em passos do raio: casters andando não mudam a matriz
+        zNear = std::floor(zNear / radius) * radius;
+        zFar = std::ceil(zFar / radius) * radius;
+
+        Cascade& cascade = m_cascades[c];
+        cascade.viewProjection = glm::ortho(-radius, radius, -radius, radius, zNear, zFar) * lightView;
+        cascade.splitFar = end;
+        cascade.texel = texel;
+        cascade.depthBias = texel / (zFar - zNear);
+
+        if (memcmp(&cascade.viewProjection, &m_cascadeMaps.matrices[c], sizeof(glm::mat4)) != 0)
+        {
+            m_cascadeMaps.matrices[c] = cascade.viewProjection;
+            m_cascadeMaps.dirty[c] = 1;
+        }
+    }
+}
+
+void ShadowMaps::markMovedCasters()
+{
+    LayeredTarget* targets[2] = { &m_cubes, &m_cascadeMaps };
+    int usedLayers[2] = { (int)m_pointLights.size() * 6, m_hasDirectional ? m_settings.cascadeCount : 0 };
+    for (const Caster& caster : m_casters)
+    {
+        if (!caster.moved)
+            continue;
+        for (int t = 0; t < 2; ++t)
+            for (int layer = 0; layer < usedLayers[t]; ++layer)
+            {
+                LayeredTarget& target = *targets[t];
+                if (target.dirty[layer])
+                    continue;
+                // Sombra antiga some de onde estava, nova aparece onde está
+                if (boxInFrustum(target.matrices[layer], caster.renderedBounds) ||
+                    boxInFrustum(target.matrices[layer], caster.bounds))
+                    target.dirty[layer] = 1;
+            }
+    }
+}
+
+void ShadowMaps::render(LayeredTarget& target, GLuint program, bool cascades)
+{
+    int usedLayers = cascades ? (m_hasDirectional ? m_settings.cascadeCount : 0) : (int)m_pointLights.size() * 6;
+    std::vector<int> dirtyLayers;
+    for (int layer = 0; layer < target.layers; ++layer)
+        if (target.dirty[layer])
+            dirtyLayers.push_back(layer);
+    int rendered = (int)std::count_if(dirtyLayers.begin(), dirtyLayers.end(), [&](int l) { return l < usedLayers; });
+    m_stats.mapsRendered += rendered;
+    m_stats.mapsCached += usedLayers - rendered;
+    if (dirtyLayers.empty())
+        return;
+    if (rendered > 0)
+        m_stats.passes += m_settings.layered ? 1 : rendered;
+
+    // Casters de cada camada suja, até MAX_FRUSTUMS frustums por descida na BVH
+    std::vector<std::vector<uint32_t>> layerCasters(dirtyLayers.size());
+    for (size_t first = 0; first < dirtyLayers.size(); first += InstanceBvh::MAX_FRUSTUMS)
+    {
+        size_t count = std::min<size_t>(InstanceBvh::MAX_FRUSTUMS, dirtyLayers.size() - first);
+        glm::mat4 matrices[InstanceBvh::MAX_FRUSTUMS];
+        for (size_t k = 0; k < count; ++k)
+            matrices[k] = target.matrices[dirtyLayers[first + k]];
+        m_bvh.queryFrustums(matrices, count, m_layerCasters);
+        for (size_t k = 0; k < count; ++k)
+            if (dirtyLayers[first + k] < usedLayers)
+                layerCasters[first + k] = m_layerCasters[k];
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, target.resolution, target.resolution);
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "layerMatrices"), target.layers, GL_FALSE,
+        glm::value_ptr(target.matrices[0]));
+    if (!cascades)
+    {
+        glm::vec4 lights[MAX_POINT_LIGHTS];
+        for (size_t i = 0; i < m_pointLights.size(); ++i)
+            lights[i] = glm::vec4(m_pointLights[i].position, m_pointLights[i].farPlane);
+        glUniform4fv(glGetUniformLocation(program, "pointLights"), (GLsizei)m_pointLights.size(), glm::value_ptr(lights[0]));
+    }
+    GLint modelLoc = glGetUniformLocation(program, "model");
+    GLint layersLoc = glGetUniformLocation(program, "instanceLayers");
+
+    // Casters fora da fatia da câmera ainda projetam sombra nela
+    if (cascades)
+        glEnable(GL_DEPTH_CLAMP);
+
+    auto draw = [&](const Caster& caster, const int* layers, int instances)
+        {
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(caster.model));
+            glUniform1iv(layersLoc, instances, layers);
+            glBindVertexArray(caster.VAO);
+            if (caster.indexed)
+                glDrawElementsInstanced(GL_TRIANGLES, caster.count, GL_UNSIGNED_INT, nullptr, instances);
+            else
+                glDrawArraysInstanced(GL_TRIANGLES, 0, caster.count, instances);
+            m_stats.draws++;
+            m_stats.triangles += (uint64_t)(caster.count / 3) * instances;
+        };
+
+    if (m_settings.layered)
+    {
+        // Limpa só as camadas sujas (todas de uma vez se for o caso) e desenha
+        // cada caster uma vez, instanciado nas camadas que ele toca
+        if ((int)dirtyLayers.size() == target.layers)
+        {
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target.texture, 0);
+            glClear(GL_DEPTH_BUFFER_BIT);
+        }
+        else
+        {
+            for (int layer : dirtyLayers)
+            {
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target.texture, 0, layer);
+                glClear(GL_DEPTH_BUFFER_BIT);
+            }
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target.texture, 0);
+        }
+
+        m_casterLayers.resize(m_casters.size());
+        for (std::vector<int>& layers : m_casterLayers)
+            layers.clear();
+        for (size_t i = 0; i < dirtyLayers.size(); ++i)
+            for (uint32_t caster : layerCasters[i])
+                m_casterLayers[caster].push_back(dirtyLayers[i]);
+
+        for (size_t c = 0; c < m_casters.size(); ++c)
+            if (!m_casterLayers[c].empty())
+                draw(m_casters[c], m_casterLayers[c].data(), (int)m_casterLayers[c].size());
+    }
+    else
+    {
+        // Sem camadas: um render target e um passe por mapa (gl_Layer é ignorado)
+        for (size_t i = 0; i < dirtyLayers.size(); ++i)
+        {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target.texture, 0, dirtyLayers[i]);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            for (uint32_t caster : layerCasters[i])
+                draw(m_casters[caster], &dirtyLayers[i], 1);
+        }
+    }
+
+    if (cascades)
+        glDisable(GL_DEPTH_CLAMP);
+    std::fill(target.dirty.begin(), target.dirty.end(), 0);
+}
+
+void ShadowMaps::update(const glm::mat4& view, const glm::mat4& projection)
+{
+    if (!m_supported)
+        return;
+
+    PROFILE_SCOPE("ShadowMaps");
+    auto start = std::chrono::high_resolution_clock::now();
+    m_stats.updates++;
+
+    // Texturas com pelo menos uma camada: os samplers sempre têm algo válido
+    int cubeLayers = std::max((int)m_pointLights.size(), 1) * 6;
+    if (m_cubes.layers != cubeLayers || m_cubes.resolution != m_settings.pointResolution)
+        allocate(m_cubes, GL_TEXTURE_CUBE_MAP_ARRAY, m_settings.pointResolution, cubeLayers);
+    int cascadeLayers = m_hasDirectional ? m_settings.cascadeCount : 1;
+    if (m_cascadeMaps.layers != cascadeLayers)
+        allocate(m_cascadeMaps, GL_TEXTURE_2D_ARRAY, m_settings.cascadeResolution, cascadeLayers);
+
+    if (m_casters.size() != m_bvhCasters)
+    {
+        std::vector<Aabb> bounds;
+        for (const Caster& caster : m_casters)
+            bounds.push_back(caster.bounds);
+        m_bvh.build(bounds);
+        m_bvhCasters = m_casters.size();
+    }
+    else
+    {
+        for (size_t i = 0; i < m_casters.size(); ++i)
+            if (m_casters[i].moved)
+                m_bvh.update((uint32_t)i, m_casters[i].bounds);
+        if (m_bvh.needsRebuild())
+        {
+            std::vector<Aabb> bounds;
+            for (const Caster& caster : m_casters)
+                bounds.push_back(caster.bounds);
+            m_bvh.build(bounds);
+        }
+    }
+
+    for (size_t light = 0; light < m_pointLights.size(); ++light)
+    {
+        const PointLight& pointLight = m_pointLights[light];
+        glm::mat4 faceProjection = glm::perspective(glm::radians(90.0f), 1.0f, m_settings.pointNear, pointLight.farPlane);
+        for (int face = 0; face < 6; ++face)
+            m_cubes.matrices[light * 6 + face] = faceProjection *
+                glm::lookAt(pointLight.position, pointLight.position + cubeFaceDirections[face], cubeFaceUps[face]);
+    }
+    if (m_hasDirectional)
+        computeCascades(view, projection);
+    else
+        m_cameraView = view;
+
+    markMovedCasters();
+    if (!m_settings.caching)
+    {
+        std::fill(m_cubes.dirty.begin(), m_cubes.dirty.end(), 1);
+        std::fill(m_cascadeMaps.dirty.begin(), m_cascadeMaps.dirty.end(), 1);
+    }
+
+    // Tempo de GPU: par de GL_TIMESTAMP (como no GpuProfiler), lido alguns
+    // updates depois, sem esperar
+    for (int q = 0; q < QUERY_COUNT; ++q)
+    {
+        if (!m_queryPending[q])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[q * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(m_queries[q * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(m_queries[q * 2 + 1], GL_QUERY_RESULT, &end);
+        m_stats.gpuMs += (end - begin) / 1e6;
+        m_stats.gpuSamples++;
+        m_queryPending[q] = false;
+    }
+
+    bool anyDirty = std::find(m_cubes.dirty.begin(), m_cubes.dirty.end(), 1) != m_cubes.dirty.end() ||
+        std::find(m_cascadeMaps.dirty.begin(), m_cascadeMaps.dirty.end(), 1) != m_cascadeMaps.dirty.end();
+    int query = -1;
+    if (!anyDirty)
+    {
+        m_stats.gpuSamples++;
+    }
+    else if (!m_queryPending[m_nextQuery])
+    {
+        query = m_nextQuery;
+        m_nextQuery = (m_nextQuery + 1) % QUERY_COUNT;
+        glQueryCounter(m_queries[query * 2], GL_TIMESTAMP);
+    }
+
+    GLint previousFramebuffer = 0, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST), cullFace = glIsEnabled(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+
+    render(m_cubes, m_pointProgram, false);
+    render(m_cascadeMaps, m_cascadeProgram, true);
+
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    if (!depthTest)
+        glDisable(GL_DEPTH_TEST);
+    if (cullFace)
+        glEnable(GL_CULL_FACE);
+
+    if (query >= 0)
+    {
+        glQueryCounter(m_queries[query * 2 + 1], GL_TIMESTAMP);
+        m_queryPending[query] = true;
+    }
+
+    for (Caster& caster : m_casters)
+    {
+        caster.renderedBounds = caster.bounds;
+        caster.moved = false;
+    }
+    m_stats.cpuMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ShadowMaps::bind(GLuint program, int firstUnit) const
+{
+    if (!m_supported || !m_cubes.texture)
+        return;
+
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_cubes.texture);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_cascadeMaps.texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(glGetUniformLocation(program, "shadowCubeMaps"), firstUnit);
+    glUniform1i(glGetUniformLocation(program, "shadowCascadeMaps"), firstUnit + 1);
+
+    glm::vec4 lights[MAX_POINT_LIGHTS];
+    for (size_t i = 0; i < m_pointLights.size(); ++i)
+        lights[i] = glm::vec4(m_pointLights[i].position, m_pointLights[i].farPlane);
+    if (!m_pointLights.empty())
+        glUniform4fv(glGetUniformLocation(program, "shadowPointLights"), (GLsizei)m_pointLights.size(),
+            glm::value_ptr(lights[0]));
+    glUniform1f(glGetUniformLocation(program, "shadowCubeTexel"), 2.0f / m_cubes.resolution);
+
+    int cascades = m_hasDirectional ? (int)m_cascades.size() : 0;
+    glUniform1i(glGetUniformLocation(program, "shadowCascadeCount"), cascades);
+    glUniformMatrix4fv(glGetUniformLocation(program, "shadowCameraView"), 1, GL_FALSE, glm::value_ptr(m_cameraView));
+    if (cascades > 0)
+    {
+        glm::mat4 matrices[MAX_CASCADES];
+        glm::vec4 params[MAX_CASCADES];
+        for (int i = 0; i < cascades; ++i)
+        {
+            matrices[i] = m_cascades[i].viewProjection;
+            params[i] = glm::vec4(m_cascades[i].splitFar, m_cascades[i].texel, m_cascades[i].depthBias, 0.0f);
+        }
+        glUniformMatrix4fv(glGetUniformLocation(program, "shadowCascadeMatrices"), cascades, GL_FALSE,
+            glm::value_ptr(matrices[0]));
+        glUniform4fv(glGetUniformLocation(program, "shadowCascadeParams"), cascades, glm::value_ptr(params[0]));
+    }
+}
+
+const char* ShadowMaps::getShaderSource()
+{
+    return receiverSource;
+}
+
+void ShadowMaps::printStats() const
+{
+    if (m_stats.updates == 0)
+        return;
+
+    double updates = (double)m_stats.updates;
+    std::cout << "Sombras (" << (m_vertexLayer ? "gl_Layer no vertex shader" : "geometry shader") << ", "
+        << (m_settings.layered ? "um passe por textura" : "um passe por mapa") << ", cache "
+        << (m_settings.caching ? "ligado" : "desligado") << "): " << m_stats.updates << " updates, media de "
+        << m_stats.mapsRendered / updates << " mapas desenhados e " << m_stats.mapsCached / updates
+        << " no cache, " << m_stats.passes / updates << " passes, " << m_stats.draws / updates << " draws, "
+        << m_stats.triangles / updates << " triangulos, CPU " << m_stats.cpuMs / updates << " ms";
+    if (m_stats.gpuSamples > 0)
+        std::cout << ", GPU " << m_stats.gpuMs / m_stats.gpuSamples << " ms";
+    std::cout << " por update" << std::endl;
+}
+
+void ShadowMaps::destroy()
+{
+    if (m_cubes.texture)
+        glDeleteTextures(1, &m_cubes.texture);
+    if (m_cascadeMaps.texture)
+        glDeleteTextures(1, &m_cascadeMaps.texture);
+    m_cubes = LayeredTarget();
+    m_cascadeMaps = LayeredTarget();
+    if (m_framebuffer)
+        glDeleteFramebuffers(1, &m_framebuffer);
+    m_framebuffer = 0;
+    if (m_queries[0])
+        glDeleteQueries(QUERY_COUNT * 2, m_queries);
+    std::fill(m_queries, m_queries + QUERY_COUNT * 2, 0);
+    glDeleteProgram(m_pointProgram);
+    glDeleteProgram(m_cascadeProgram);
+    m_pointProgram = m_cascadeProgram = 0;
+    m_supported = false;
+}
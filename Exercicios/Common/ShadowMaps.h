@@ -0,0 +1,180 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "InstanceBvh.h"
+#include "ShaderCache.h"
+
+// Sombras para as cenas com Phong: cube maps para luzes pontuais e cascatas
+// (CSM) para uma luz direcional, com cache dos mapas que não mudaram.
+//
+//   ShadowMaps shadows(cache);              // GL 4.0 (cube map array)
+//   int light = shadows.addPointLight(lightPos, 5.0f);
+//   shadows.setDirectionalLight(glm::vec3(-1, -2, -1));
+//   int caster = shadows.addCaster(VAO, nVertices, localBounds);
+//   ...
+//   shadows.setCasterTransform(caster, model);  // todo frame; só marca se mudou
+//   shadows.update(view, projection);           // antes do passe principal
+//   glUseProgram(program);
+//   shadows.bind(program, 1);                   // unidades 1 e 2
+//
+// No fragment shader, ShadowMaps::getShaderSource() (colado logo depois do
+// #version 400) traz pointShadow(luz, posMundo, normal) e
+// directionalShadow(posMundo, normal), que devolvem 1 (iluminado) a 0.
+//
+// Todas as faces de todas as luzes pontuais ficam num GL_TEXTURE_CUBE_MAP_ARRAY
+// (camada = luz * 6 + face) com a distância linear até a luz; as cascatas num
+// GL_TEXTURE_2D_ARRAY. Cada textura é desenhada num passe só: cada caster sai
+// num único draw instanciado e gl_InstanceID escolhe a camada de destino, via
+// gl_Layer no vertex shader (ARB_shader_viewport_layer_array) ou num geometry
+// shader quando a extensão falta. Três luzes pontuais custam um passe e um
+// draw por caster, em vez de 18 passes da cena inteira.
+//
+// Uma face ou cascata só é desenhada de novo quando a luz mexeu, a cascata
+// mudou (o centro anda em passos de texel, então a câmera parada ou andando
+// pouco não muda a matriz) ou um caster que se mexeu estava ou está dentro
+// do seu frustum; as outras ficam no cache. Os casters ficam numa InstanceBvh
+// e cada caster só é instanciado nas camadas cujo frustum ele toca.
+
+struct ShadowSettings
+{
+    int pointResolution = 512;
+    float pointNear = 0.05f;
+    int cascadeResolution = 1024;
+    int cascadeCount = 3;
+    float cascadeLambda = 0.75f;    // 0 = divisões lineares, 1 = logarítmicas
+    float shadowDistance = 30.0f;   // fim da última cascata (limitado pelo far da câmera)
+    bool caching = true;            // false: desenha todos os mapas todo frame
+    bool layered = true;            // false: um passe por face/cascata (para comparar)
+};
+
+// Acumulado desde a criação
+struct ShadowStats
+{
+    uint64_t updates = 0;
+    uint64_t mapsRendered = 0;      // faces de cube map + cascatas desenhadas
+    uint64_t mapsCached = 0;        // reaproveitadas do frame anterior
+    uint64_t passes = 0;            // render targets com mapas desenhados
+    uint64_t draws = 0;
+    uint64_t triangles = 0;         // enviados, contando cada instância
+    double cpuMs = 0.0;
+    double gpuMs = 0.0;             // soma dos updates medidos (par de GL_TIMESTAMP)
+    uint64_t gpuSamples = 0;        // updates com tempo de GPU conhecido (0 ms se nada foi desenhado)
+};
+
+class ShadowMaps
+{
+public:
+    static const int MAX_POINT_LIGHTS = 4;
+    static const int MAX_CASCADES = 4;
+
+    // Compila os programas do passe de sombra (precisa do contexto GL atual)
+    explicit ShadowMaps(ShaderCache& shaders, const ShadowSettings& settings = ShadowSettings());
+
+    ShadowMaps(const ShadowMaps&) = delete;
+    ShadowMaps& operator=(const ShadowMaps&) = delete;
+
+    // false sem GL 4.0 (cube map array); update() e bind() não fazem nada
+    bool isSupported() const { return m_supported; }
+    bool usesVertexShaderLayer() const { return m_vertexLayer; }
+
+    // Retorna o índice da luz (-1 depois de MAX_POINT_LIGHTS)
+    int addPointLight(const glm::vec3& position, float farPlane);
+    void setPointLightPosition(int light, const glm::vec3& position);
+
+    // Direção em que a luz anda (da luz para a cena)
+    void setDirectionalLight(const glm::vec3& direction);
+
+    // VAO com a posição na location 0; count = vértices (ou índices se indexed)
+    int addCaster(GLuint VAO, GLsizei count, const Aabb& localBounds, bool indexed = false);
+    void setCasterTransform(int caster, const glm::mat4& model);
+
+    // Redesenha só os mapas sujos. Muda o programa, o VAO e o framebuffer
+    // (restaura framebuffer e viewport no fim).
+    void update(const glm::mat4& view, const glm::mat4& projection);
+
+    // Texturas em firstUnit (cubos) e firstUnit + 1 (cascatas) e os uniforms
+    // do getShaderSource(), no programa que está em uso
+    void bind(GLuint program, int firstUnit) const;
+
+    static const char* getShaderSource();
+
+    const ShadowStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+    // Apaga texturas, framebuffer e queries; chamar antes de destruir o contexto GL
+    void destroy();
+
+private:
+    struct Caster
+    {
+        GLuint VAO;
+        GLsizei count;
+        bool indexed;
+        Aabb localBounds;
+        glm::mat4 model = glm::mat4(1.0f);
+        Aabb bounds;            // em mundo, com model
+        Aabb renderedBounds;    // como estava no último update (o que os mapas mostram)
+        bool moved = true;
+    };
+
+    struct PointLight
+    {
+        glm::vec3 position;
+        float farPlane;
+    };
+
+    struct Cascade
+    {
+        glm::mat4 viewProjection = glm::mat4(0.0f);
+        float splitFar = 0.0f;  // profundidade de view onde a cascata termina
+        float texel = 0.0f;     // tamanho do texel em mundo
+        float depthBias = 0.0f; // um texel em profundidade normalizada
+    };
+
+    // Um GL_TEXTURE_*_ARRAY e o que cada camada mostra
+    struct LayeredTarget
+    {
+        GLuint texture = 0;
+        int resolution = 0;
+        int layers = 0;
+        std::vector<glm::mat4> matrices;
+        std::vector<uint8_t> dirty;
+    };
+
+    void allocate(LayeredTarget& target, GLenum textureTarget, int resolution, int layers);
+    void computeCascades(const glm::mat4& view, const glm::mat4& projection);
+    void markMovedCasters();
+    void render(LayeredTarget& target, GLuint program, bool cascades);
+
+    ShadowSettings m_settings;
+    bool m_supported = false;
+    bool m_vertexLayer = false;
+
+    GLuint m_pointProgram = 0;
+    GLuint m_cascadeProgram = 0;
+    GLuint m_framebuffer = 0;
+
+    std::vector<PointLight> m_pointLights;
+    LayeredTarget m_cubes;
+    glm::vec3 m_lightDirection = glm::vec3(0.0f);
+    bool m_hasDirectional = false;
+    std::vector<Cascade> m_cascades;
+    LayeredTarget m_cascadeMaps;
+    glm::mat4 m_cameraView = glm::mat4(1.0f);
+
+    std::vector<Caster> m_casters;
+    InstanceBvh m_bvh;
+    size_t m_bvhCasters = 0;    // casters quando a BVH foi montada
+    std::vector<uint32_t> m_layerCasters[InstanceBvh::MAX_FRUSTUMS];
+    std::vector<std::vector<int>> m_casterLayers;
+
+    static const int QUERY_COUNT = 4;
+    GLuint m_queries[QUERY_COUNT * 2] = {};    // início e fim de cada update medido
+    bool m_queryPending[QUERY_COUNT] = {};
+    int m_nextQuery = 0;
+
+    ShadowStats m_stats;
+};
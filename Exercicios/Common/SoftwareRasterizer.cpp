@@ -0,0 +1,433 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(SOFTRAST_HAS_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "Profiler.h"
+#include "SoftwareRasterizerKernels.h"
+
+static const uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+
+static bool cpuHasAvx2()
+{
+#if defined(SOFTRAST_HAS_AVX2) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(SOFTRAST_HAS_AVX2)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool rasterizeBlockScalar(const SoftwareRasterizer::Triangle& tri, int x0, int y0, int x1, int y1,
+    const SoftwareRasterizer::Target& target)
+{
+    bool written = false;
+    for (int y = y0; y < y1; ++y)
+    {
+        float py = y + 0.5f;
+        for (int x = x0; x < x1; ++x)
+        {
+            float px = x + 0.5f;
+            float l0 = tri.edgeA[0] * px + tri.edgeB[0] * py + tri.edgeC[0];
+            float l1 = tri.edgeA[1] * px + tri.edgeB[1] * py + tri.edgeC[1];
+            float l2 = tri.edgeA[2] * px + tri.edgeB[2] * py + tri.edgeC[2];
+            if (l0 < 0.0f || l1 < 0.0f || l2 < 0.0f)
+                continue;
+
+            float z = tri.zA * px + tri.zB * py + tri.zC;
+            size_t i = (size_t)y * target.width + x;
+            if (z > 1.0f || z >= target.depth[i])
+                continue;
+
+            target.depth[i] = z;
+            target.lambda1[i] = l1;
+            target.lambda2[i] = l2;
+            target.triangleId[i] = tri.id;
+            written = true;
+        }
+    }
+    return written;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, JobSystem* jobs)
+    : m_width(width), m_height(height), m_jobs(jobs), m_kernel(rasterizeBlockScalar)
+{
+    m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    size_t pixels = (size_t)width * height;
+    m_color.resize(pixels);
+    m_depth.resize(pixels);
+    m_triangleId.resize(pixels);
+    m_lambda1.resize(pixels);
+    m_lambda2.resize(pixels);
+    m_hiZ.resize((size_t)m_blocksX * blocksY);
+    m_bins.resize((size_t)m_tilesX * m_tilesY);
+    m_tileStats.resize(m_bins.size());
+
+    setSimdEnabled(true);
+}
+
+void SoftwareRasterizer::setSimdEnabled(bool enabled)
+{
+    m_kernel = rasterizeBlockScalar;
+#ifdef SOFTRAST_HAS_AVX2
+    if (enabled && cpuHasAvx2())
+        m_kernel = rasterizeBlockAvx2;
+#else
+    (void)enabled;
+#endif
+}
+
+const char* SoftwareRasterizer::getKernelName() const
+{
+    return m_kernel == rasterizeBlockScalar ? "scalar" : "avx2";
+}
+
+void SoftwareRasterizer::beginFrame(const glm::vec3& clearColor)
+{
+    // Os buffers de cada tile são limpos pelo próprio job do tile no endFrame()
+    m_clearColor = packColor(clearColor);
+    m_vertices.clear();
+    m_triangles.clear();
+    m_draws.clear();
+    for (std::vector<uint32_t>& bin : m_bins)
+        bin.clear();
+    m_stats = RasterStats();
+}
+
+void SoftwareRasterizer::setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos)
+{
+    m_viewProjection = projection * view;
+    m_cameraPos = cameraPos;
+}
+
+void SoftwareRasterizer::drawScene(const CpuScene& scene)
+{
+    setCamera(scene.view, scene.projection, scene.cameraPos);
+    setLights(scene.lights);
+    for (const SceneMesh& mesh : scene.meshes)
+        drawMesh(*mesh.mesh, mesh.model, mesh.material);
+}
+
+void SoftwareRasterizer::drawMesh(const MeshData& mesh, const glm::mat4& model, const SceneMaterial& material)
+{
+    PROFILE_SCOPE("RasterSetup");
+    size_t count = mesh.positions.size() - mesh.positions.size() % 3;
+    uint32_t draw = (uint32_t)m_draws.size();
+    m_draws.push_back({ material, material.texture ? findTexture(*material.texture) : -1 });
+    m_stats.trianglesSubmitted += count / 3;
+
+    size_t base = m_vertices.size();
+    m_vertices.resize(base + count);
+
+    glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+    auto transform = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                Vertex& v = m_vertices[base + i];
+                glm::vec4 world = model * glm::vec4(mesh.positions[i], 1.0f);
+                v.world = glm::vec3(world);
+                v.clip = m_viewProjection * world;
+                v.normal = i < mesh.normals.size() ? normalMatrix * mesh.normals[i] : glm::vec3(0.0f, 0.0f, 1.0f);
+                v.uv = i < mesh.uvs.size() ? mesh.uvs[i] : glm::vec2(0.0f);
+            }
+        };
+
+    if (m_jobs)
+        m_jobs->parallelFor(count, 4096, transform);
+    else
+        transform(0, count);
+
+    // Recorte e binning ficam na thread que chama para manter a ordem de submissão
+    for (size_t i = 0; i < count; i += 3)
+        clipTriangle((uint32_t)(base + i), (uint32_t)(base + i + 1), (uint32_t)(base + i + 2), draw);
+}
+
+void SoftwareRasterizer::clipTriangle(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t draw)
+{
+    // Só o plano near precisa de recorte (w > 0 depois dele); os outros planos
+    // viram limites da caixa em pixels e o teste z <= 1 no kernel
+    uint32_t in[3] = { v0, v1, v2 };
+    float d[3];
+    int inside = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        const glm::vec4& c = m_vertices[in[k]].clip;
+        d[k] = c.z + c.w;
+        inside += d[k] >= 0.0f;
+    }
+
+    if (inside == 3)
+    {
+        setupTriangle(v0, v1, v2, draw);
+        return;
+    }
+    if (inside == 0)
+        return;
+
+    uint32_t polygon[4];
+    int count = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        int next = (k + 1) % 3;
+        if (d[k] >= 0.0f)
+            polygon[count++] = in[k];
+        if ((d[k] >= 0.0f) != (d[next] >= 0.0f))
+        {
+            float t = d[k] / (d[k] - d[next]);
+            Vertex a = m_vertices[in[k]];
+            const Vertex& b = m_vertices[in[next]];
+            a.clip += (b.clip - a.clip) * t;
+            a.world += (b.world - a.world) * t;
+            a.normal += (b.normal - a.normal) * t;
+            a.uv += (b.uv - a.uv) * t;
+            m_vertices.push_back(a);
+            polygon[count++] = (uint32_t)m_vertices.size() - 1;
+        }
+    }
+
+    for (int k = 1; k + 1 < count; ++k)
+        setupTriangle(polygon[0], polygon[k], polygon[k + 1], draw);
+}
+
+void SoftwareRasterizer::setupTriangle(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t draw)
+{
+    // Mesma convenção do GL: centro do pixel em +0.5 e y da tela para baixo
+    uint32_t index[3] = { v0, v1, v2 };
+    double sx[3], sy[3], sz[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        const glm::vec4& c = m_vertices[index[k]].clip;
+        double invW = 1.0 / c.w;
+        sx[k] = (c.x * invW * 0.5 + 0.5) * m_width;
+        sy[k] = (0.5 - c.y * invW * 0.5) * m_height;
+        sz[k] = c.z * invW * 0.5 + 0.5;
+    }
+
+    double area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+    if (std::fabs(area) < 1e-10)
+        return;
+
+    Triangle tri;
+    tri.minX = std::max(0, (int)std::floor(std::min({ sx[0], sx[1], sx[2] })));
+    tri.minY = std::max(0, (int)std::floor(std::min({ sy[0], sy[1], sy[2] })));
+    tri.maxX = std::min(m_width - 1, (int)std::ceil(std::max({ sx[0], sx[1], sx[2] })));
+    tri.maxY = std::min(m_height - 1, (int)std::ceil(std::max({ sy[0], sy[1], sy[2] })));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+        return;
+
+    double zMin = std::min({ sz[0], sz[1], sz[2] });
+    if (zMin > 1.0)
+        return;
+
+    // lambda_k é a função de aresta oposta ao vértice k dividida pela área,
+    // então vale 1 no vértice k e 0 na aresta oposta, em qualquer orientação
+    double zA = 0.0, zB = 0.0, zC = 0.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        int j = (k + 1) % 3, l = (k + 2) % 3;
+        double A = -(sy[l] - sy[j]) / area;
+        double B = (sx[l] - sx[j]) / area;
+        double C = ((sy[l] - sy[j]) * sx[j] - (sx[l] - sx[j]) * sy[j]) / area;
+        tri.edgeA[k] = (float)A;
+        tri.edgeB[k] = (float)B;
+        tri.edgeC[k] = (float)C;
+        zA += A * sz[k];
+        zB += B * sz[k];
+        zC += C * sz[k];
+        tri.vertex[k] = index[k];
+    }
+    tri.zA = (float)zA;
+    tri.zB = (float)zB;
+    tri.zC = (float)zC;
+    tri.zMin = (float)std::max(zMin, 0.0);
+    tri.draw = draw;
+    tri.id = (uint32_t)m_triangles.size();
+    m_triangles.push_back(tri);
+    m_stats.trianglesBinned++;
+
+    for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ++ty)
+        for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; ++tx)
+        {
+            m_bins[(size_t)ty * m_tilesX + tx].push_back(tri.id);
+            m_stats.binEntries++;
+        }
+}
+
+void SoftwareRasterizer::endFrame()
+{
+    PROFILE_SCOPE("RasterTiles");
+    auto tiles = [this](size_t begin, size_t end)
+        {
+            for (size_t t = begin; t < end; ++t)
+                processTile((int)t);
+        };
+
+    if (m_jobs)
+        m_jobs->parallelFor(m_bins.size(), 1, tiles);
+    else
+        tiles(0, m_bins.size());
+
+    for (const RasterStats& tile : m_tileStats)
+    {
+        m_stats.blocksRasterized += tile.blocksRasterized;
+        m_stats.blocksHiZCulled += tile.blocksHiZCulled;
+        m_stats.pixelsShaded += tile.pixelsShaded;
+    }
+}
+
+void SoftwareRasterizer::processTile(int tileIndex)
+{
+    int x0 = (tileIndex % m_tilesX) * TILE_SIZE;
+    int y0 = (tileIndex / m_tilesX) * TILE_SIZE;
+    int x1 = std::min(x0 + TILE_SIZE, m_width);
+    int y1 = std::min(y0 + TILE_SIZE, m_height);
+
+    RasterStats& stats = m_tileStats[tileIndex];
+    stats = RasterStats();
+
+    for (int y = y0; y < y1; ++y)
+    {
+        size_t row = (size_t)y * m_width;
+        std::fill(m_depth.begin() + row + x0, m_depth.begin() + row + x1, 1.0f);
+        std::fill(m_triangleId.begin() + row + x0, m_triangleId.begin() + row + x1, NO_TRIANGLE);
+    }
+    for (int by = y0 / BLOCK_SIZE; by * BLOCK_SIZE < y1; ++by)
+        for (int bx = x0 / BLOCK_SIZE; bx * BLOCK_SIZE < x1; ++bx)
+            m_hiZ[(size_t)by * m_blocksX + bx] = 1.0f;
+
+    Target target = { m_width, m_depth.data(), m_triangleId.data(), m_lambda1.data(), m_lambda2.data() };
+
+    // 1) Visibilidade: cada triângulo do bin, bloco a bloco
+    for (uint32_t id : m_bins[tileIndex])
+    {
+        const Triangle& tri = m_triangles[id];
+        int bx0 = std::max(x0, tri.minX) / BLOCK_SIZE, bx1 = std::min(x1 - 1, tri.maxX) / BLOCK_SIZE;
+        int by0 = std::max(y0, tri.minY) / BLOCK_SIZE, by1 = std::min(y1 - 1, tri.maxY) / BLOCK_SIZE;
+
+        for (int by = by0; by <= by1; ++by)
+            for (int bx = bx0; bx <= bx1; ++bx)
+            {
+                float& hiZ = m_hiZ[(size_t)by * m_blocksX + bx];
+                if (tri.zMin >= hiZ)
+                {
+                    stats.blocksHiZCulled++;
+                    continue;
+                }
+
+                int px0 = bx * BLOCK_SIZE, px1 = std::min(px0 + BLOCK_SIZE, m_width);
+                int py0 = by * BLOCK_SIZE, py1 = std::min(py0 + BLOCK_SIZE, m_height);
+
+                // Bloco inteiro do lado de fora de alguma aresta
+                bool outside = false;
+                for (int k = 0; k < 3 && !outside; ++k)
+                {
+                    float ex0 = tri.edgeA[k] * (px0 + 0.5f), ex1 = tri.edgeA[k] * (px1 - 0.5f);
+                    float ey0 = tri.edgeB[k] * (py0 + 0.5f), ey1 = tri.edgeB[k] * (py1 - 0.5f);
+                    float best = std::max(ex0, ex1) + std::max(ey0, ey1) + tri.edgeC[k];
+                    outside = best < 0.0f;
+                }
+                if (outside)
+                    continue;
+
+                stats.blocksRasterized++;
+                if (!m_kernel(tri, px0, std::max(py0, tri.minY), px1, std::min(py1, tri.maxY + 1), target))
+                    continue;
+
+                float blockMax = 0.0f;
+                for (int y = py0; y < py1; ++y)
+                    for (int x = px0; x < px1; ++x)
+                        blockMax = std::max(blockMax, m_depth[(size_t)y * m_width + x]);
+                hiZ = blockMax;
+            }
+    }
+
+    // 2) Sombreamento: um Phong por pixel visível
+    for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x)
+        {
+            size_t i = (size_t)y * m_width + x;
+            if (m_triangleId[i] == NO_TRIANGLE)
+            {
+                m_color[i] = m_clearColor;
+                continue;
+            }
+            shadePixel(x, y);
+            stats.pixelsShaded++;
+        }
+}
+
+int SoftwareRasterizer::findTexture(const ImageData& image)
+{
+    for (size_t i = 0; i < m_textures.size(); ++i)
+        if (m_textures[i].getImage() == &image)
+            return (int)i;
+    m_textures.emplace_back(image);
+    return (int)m_textures.size() - 1;
+}
+
+void SoftwareRasterizer::shadePixel(int x, int y)
+{
+    size_t i = (size_t)y * m_width + x;
+    const Triangle& tri = m_triangles[m_triangleId[i]];
+    const Vertex& a = m_vertices[tri.vertex[0]];
+    const Vertex& b = m_vertices[tri.vertex[1]];
+    const Vertex& c = m_vertices[tri.vertex[2]];
+    const SceneMaterial& material = m_draws[tri.draw].material;
+
+    // Baricêntricas da tela -> perspectiva correta (divide por w e normaliza)
+    auto perspective = [&](float l1, float l2)
+        {
+            glm::vec3 w((1.0f - l1 - l2) / a.clip.w, l1 / b.clip.w, l2 / c.clip.w);
+            return w / (w.x + w.y + w.z);
+        };
+    float l1 = m_lambda1[i], l2 = m_lambda2[i];
+    glm::vec3 weights = perspective(l1, l2);
+    float w0 = weights.x, w1 = weights.y, w2 = weights.z;
+
+    glm::vec3 base = material.baseColor;
+    if (m_draws[tri.draw].texture >= 0)
+    {
+        // As baricêntricas são lineares na tela: o vizinho à direita e o de baixo
+        // saem dos coeficientes das arestas e dão as derivadas do uv para o mip
+        auto uvAt = [&](const glm::vec3& w) { return a.uv * w.x + b.uv * w.y + c.uv * w.z; };
+        glm::vec2 uv = uvAt(weights);
+        glm::vec2 dx = uvAt(perspective(l1 + tri.edgeA[1], l2 + tri.edgeA[2])) - uv;
+        glm::vec2 dy = uvAt(perspective(l1 + tri.edgeB[1], l2 + tri.edgeB[2])) - uv;
+
+        const TextureMips& texture = m_textures[m_draws[tri.draw].texture];
+        glm::vec2 size((float)texture.getWidth(), (float)texture.getHeight());
+        float rho = std::max(glm::length(dx * size), glm::length(dy * size));
+        float lod = rho > 0.0f ? std::log2(rho) : 0.0f;
+
+        if (material.flipV)
+            uv.y = 1.0f - uv.y;
+        base = texture.sample(uv, lod);
+    }
+
+    if (!material.lit)
+    {
+        m_color[i] = packColor(base);
+        return;
+    }
+
+    glm::vec3 fragPos = a.world * w0 + b.world * w1 + c.world * w2;
+    glm::vec3 N = glm::normalize(a.normal * w0 + b.normal * w1 + c.normal * w2);
+    m_color[i] = packColor(shadePhong(material, m_lights, base, fragPos, N, m_cameraPos));
+}
+
+bool SoftwareRasterizer::writePpm(const std::string& path) const
+{
+    return ::writePpm(path, m_color, m_width, m_height);
+}
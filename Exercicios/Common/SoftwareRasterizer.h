@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CpuScene.h"
+#include "Geometry.h"
+#include "JobSystem.h"
+
+// Rasterizador em CPU para máquinas sem GPU. Desenha as mesmas malhas
+// (MeshData) com o mesmo Phong dos shaders dos módulos.
+//
+//   rast.beginFrame(clearColor);
+//   rast.setCamera(view, projection, camPos);
+//   rast.drawMesh(mesh, model, material);   // transforma e distribui em tiles
+//   rast.endFrame();                         // rasteriza e sombreia os tiles
+//
+// ou rast.drawScene(scene) com a mesma CpuScene entregue ao RayTracer.
+//
+// Os triângulos são distribuídos (binning) em tiles de 64x64 pixels e cada
+// tile é processado por um job: primeiro a visibilidade (funções de aresta em
+// blocos de 8x8, 8 pixels por vez com AVX2 quando a CPU suporta) e depois o
+// sombreamento de cada pixel visível uma vez só. Um Hi-Z por bloco de 8x8
+// (maior profundidade do bloco) descarta blocos inteiros já encobertos.
+
+struct RasterStats
+{
+    uint64_t trianglesSubmitted = 0;
+    uint64_t trianglesBinned = 0;   // após recorte, descarte de degenerados e fora da tela
+    uint64_t binEntries = 0;        // pares tile x triângulo
+    uint64_t blocksRasterized = 0;
+    uint64_t blocksHiZCulled = 0;
+    uint64_t pixelsShaded = 0;
+};
+
+class SoftwareRasterizer
+{
+public:
+    // Sem JobSystem tudo roda na thread que chama
+    SoftwareRasterizer(int width, int height, JobSystem* jobs = nullptr);
+
+    void beginFrame(const glm::vec3& clearColor);
+    void setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos);
+    void setLights(const std::vector<SceneLight>& lights) { m_lights = lights; }
+    void drawMesh(const MeshData& mesh, const glm::mat4& model, const SceneMaterial& material);
+
+    // Câmera, luzes e todas as malhas da cena (entre beginFrame e endFrame)
+    void drawScene(const CpuScene& scene);
+    void endFrame();
+
+    // RGBA8, linha 0 = topo da imagem
+    const std::vector<uint32_t>& getColorBuffer() const { return m_color; }
+    bool writePpm(const std::string& path) const;
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    const RasterStats& getStats() const { return m_stats; }
+
+    // Kernel AVX2 só é usado se foi compilado e a CPU suporta; desligar força o escalar
+    void setSimdEnabled(bool enabled);
+    const char* getKernelName() const; // "avx2" ou "scalar"
+
+    static const int TILE_SIZE = 64;
+    static const int BLOCK_SIZE = 8;
+
+    // Visibilidade de um triângulo já preparado para a tela (ver SoftwareRasterizer.cpp)
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3]; // lambda_k(x, y) = A*x + B*y + C, já normalizado pela área
+        float zA, zB, zC;                   // profundidade [0, 1] como plano na tela
+        float zMin;
+        int minX, minY, maxX, maxY;         // caixa em pixels (inclusiva)
+        uint32_t vertex[3];
+        uint32_t draw;
+        uint32_t id;                        // índice em m_triangles, gravado no buffer de visibilidade
+    };
+
+    // Buffers de visibilidade compartilhados com os kernels
+    struct Target
+    {
+        int width;
+        float* depth;
+        uint32_t* triangleId;
+        float* lambda1;
+        float* lambda2;
+    };
+
+    typedef bool (*BlockKernel)(const Triangle& tri, int x0, int y0, int x1, int y1, const Target& target);
+
+private:
+    struct Vertex
+    {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec3 normal;
+        glm::vec2 uv;
+    };
+
+    struct Draw
+    {
+        SceneMaterial material;
+        int texture;                // índice em m_textures, -1 sem textura
+    };
+
+    void clipTriangle(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t draw);
+    void setupTriangle(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t draw);
+    void processTile(int tileIndex);
+    void shadePixel(int x, int y);
+    int findTexture(const ImageData& image);
+
+    int m_width;
+    int m_height;
+    int m_tilesX;
+    int m_tilesY;
+    int m_blocksX;
+    JobSystem* m_jobs;
+    BlockKernel m_kernel;
+
+    glm::mat4 m_viewProjection = glm::mat4(1.0f);
+    glm::vec3 m_cameraPos = glm::vec3(0.0f);
+    std::vector<SceneLight> m_lights;
+    uint32_t m_clearColor = 0;
+
+    std::vector<Vertex> m_vertices;
+    std::vector<Triangle> m_triangles;
+    std::vector<Draw> m_draws;
+    std::vector<TextureMips> m_textures;
+    std::vector<std::vector<uint32_t>> m_bins;
+
+    std::vector<uint32_t> m_color;
+    std::vector<float> m_depth;
+    std::vector<uint32_t> m_triangleId;
+    std::vector<float> m_lambda1;
+    std::vector<float> m_lambda2;
+    std::vector<float> m_hiZ;
+
+    RasterStats m_stats;
+    std::vector<RasterStats> m_tileStats;
+};
@@ -0,0 +1,58 @@
+#include "SoftwareRasterizerKernels.h"
+
+#if defined(SOFTRAST_HAS_AVX2) && defined(__AVX2__)
+
+#include <immintrin.h>
+
+// 8 pixels de uma linha por iteração: as três funções de aresta, a
+// profundidade e o teste de profundidade são feitos em registradores de 256
+// bits, e a escrita usa máscara para não tocar pixels fora do triângulo.
+bool rasterizeBlockAvx2(const SoftwareRasterizer::Triangle& tri, int x0, int y0, int x1, int y1,
+    const SoftwareRasterizer::Target& target)
+{
+    const __m256 laneOffset = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x0), laneOffset);
+    __m256i columns = _mm256_cmpgt_epi32(_mm256_set1_epi32(x1 - x0), laneIndex);
+
+    __m256 e0 = _mm256_mul_ps(_mm256_set1_ps(tri.edgeA[0]), px);
+    __m256 e1 = _mm256_mul_ps(_mm256_set1_ps(tri.edgeA[1]), px);
+    __m256 e2 = _mm256_mul_ps(_mm256_set1_ps(tri.edgeA[2]), px);
+    __m256 zx = _mm256_mul_ps(_mm256_set1_ps(tri.zA), px);
+
+    bool written = false;
+    for (int y = y0; y < y1; ++y)
+    {
+        float py = y + 0.5f;
+        __m256 l0 = _mm256_add_ps(e0, _mm256_set1_ps(tri.edgeB[0] * py + tri.edgeC[0]));
+        __m256 l1 = _mm256_add_ps(e1, _mm256_set1_ps(tri.edgeB[1] * py + tri.edgeC[1]));
+        __m256 l2 = _mm256_add_ps(e2, _mm256_set1_ps(tri.edgeB[2] * py + tri.edgeC[2]));
+        __m256 z = _mm256_add_ps(zx, _mm256_set1_ps(tri.zB * py + tri.zC));
+
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(l0, zero, _CMP_GE_OQ), _mm256_cmp_ps(l1, zero, _CMP_GE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(l2, zero, _CMP_GE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(z, one, _CMP_LE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_castsi256_ps(columns));
+        if (_mm256_testz_ps(inside, inside))
+            continue;
+
+        size_t offset = (size_t)y * target.width + x0;
+        __m256 depth = _mm256_maskload_ps(target.depth + offset, columns);
+        __m256 pass = _mm256_and_ps(inside, _mm256_cmp_ps(z, depth, _CMP_LT_OQ));
+        if (_mm256_testz_ps(pass, pass))
+            continue;
+
+        __m256i passMask = _mm256_castps_si256(pass);
+        _mm256_maskstore_ps(target.depth + offset, passMask, z);
+        _mm256_maskstore_ps(target.lambda1 + offset, passMask, l1);
+        _mm256_maskstore_ps(target.lambda2 + offset, passMask, l2);
+        _mm256_maskstore_epi32((int*)(target.triangleId + offset), passMask, _mm256_set1_epi32((int)tri.id));
+        written = true;
+    }
+    return written;
+}
+
+#endif
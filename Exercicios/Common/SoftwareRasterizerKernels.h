@@ -0,0 +1,14 @@
+#pragma once
+#include "SoftwareRasterizer.h"
+
+// Kernels de visibilidade do SoftwareRasterizer. Cada um testa e grava um
+// triângulo numa região de um bloco 8x8 ([x0, x1) x [y0, y1), x0 alinhado ao
+// bloco) e devolve true se algum pixel passou no teste de profundidade.
+bool rasterizeBlockScalar(const SoftwareRasterizer::Triangle& tri, int x0, int y0, int x1, int y1,
+    const SoftwareRasterizer::Target& target);
+
+#ifdef SOFTRAST_HAS_AVX2
+// Compilado em SoftwareRasterizerAVX2.cpp com -mavx2; só chamar se a CPU suportar
+bool rasterizeBlockAvx2(const SoftwareRasterizer::Triangle& tri, int x0, int y0, int x1, int y1,
+    const SoftwareRasterizer::Target& target);
+#endif
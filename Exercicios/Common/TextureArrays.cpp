@@ -0,0 +1,311 @@
+#include "TextureArrays.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "Profiler.h"
+
+static const char* materialSource = R"glsl(
+struct ArrayMaterial
+{
+    vec4 uvRect;
+    vec3 kd;
+    uint layer;
+};
+)glsl";
+
+static const char* samplingSource = R"glsl(
+vec4 sampleArrayMaterial(sampler2DArray textures, ArrayMaterial material, vec2 uv)
+{
+    // Camada inteira: a repetição fica com o GL_REPEAT do array
+    if (material.uvRect.zw == vec2(1.0))
+        return texture(textures, vec3(uv, float(material.layer)));
+
+    // Atlas: repete dentro do retângulo, com o gradiente da UV contínua
+    vec2 atlasUv = material.uvRect.xy + fract(uv) * material.uvRect.zw;
+    return textureGrad(textures, vec3(atlasUv, float(material.layer)), dFdx(uv) * material.uvRect.zw,
+        dFdy(uv) * material.uvRect.zw);
+}
+)glsl";
+
+ImageData resampleImage(const ImageData& image, int width, int height)
+{
+    PROFILE_SCOPE("ResampleImage");
+    int channels = image.channels;
+
+    // Cada pixel de destino é a média dos pixels de origem que ele cobre, um eixo por vez
+    auto span = [](int i, int source, int destination, int& lo, int& hi) {
+        lo = (int)((int64_t)i * source / destination);
+        hi = std::max(lo + 1, (int)(((int64_t)(i + 1) * source + destination - 1) / destination));
+        hi = std::min(hi, source);
+    };
+
+    std::vector<float> rows((size_t)width * image.height * channels);
+    for (int y = 0; y < image.height; ++y)
+        for (int x = 0; x < width; ++x)
+        {
+            int lo, hi;
+            span(x, image.width, width, lo, hi);
+            for (int c = 0; c < channels; ++c)
+            {
+                float sum = 0.0f;
+                for (int sx = lo; sx < hi; ++sx)
+                    sum += image.pixels[((size_t)y * image.width + sx) * channels + c];
+                rows[((size_t)y * width + x) * channels + c] = sum / (hi - lo);
+            }
+        }
+
+    ImageData result;
+    result.width = width;
+    result.height = height;
+    result.channels = channels;
+    result.pixels.resize((size_t)width * height * channels);
+    for (int y = 0; y < height; ++y)
+    {
+        int lo, hi;
+        span(y, image.height, height, lo, hi);
+        for (int x = 0; x < width; ++x)
+            for (int c = 0; c < channels; ++c)
+            {
+                float sum = 0.0f;
+                for (int sy = lo; sy < hi; ++sy)
+                    sum += rows[((size_t)sy * width + x) * channels + c];
+                result.pixels[((size_t)y * width + x) * channels + c] = (unsigned char)(sum / (hi - lo) + 0.5f);
+            }
+    }
+    return result;
+}
+
+namespace
+{
+    ImageData toRgba(const ImageData& image)
+    {
+        if (image.channels == 4)
+            return image;
+        ImageData result;
+        result.width = image.width;
+        result.height = image.height;
+        result.channels = 4;
+        result.pixels.resize((size_t)image.width * image.height * 4);
+        for (size_t i = 0; i < (size_t)image.width * image.height; ++i)
+        {
+            const unsigned char* source = &image.pixels[i * image.channels];
+            unsigned char* destination = &result.pixels[i * 4];
+            for (int c = 0; c < 3; ++c)
+                destination[c] = source[image.channels >= 3 ? c : 0];
+            destination[3] = image.channels == 2 || image.channels == 4 ? source[image.channels - 1] : 255;
+        }
+        return result;
+    }
+
+    GLuint createArray(int width, int height, int layers, int channels, GLint wrap)
+    {
+        GLuint array;
+        glGenTextures(1, &array);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GLenum format = channels == 3 ? GL_RGB : GL_RGBA;
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, channels == 3 ? GL_RGB8 : GL_RGBA8, width, height, layers, 0, format,
+            GL_UNSIGNED_BYTE, nullptr);
+        return array;
+    }
+
+    void uploadLayer(int width, int height, int layer, int channels, const unsigned char* pixels)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, channels == 3 ? GL_RGB : GL_RGBA,
+            GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+}
+
+TextureArrayAllocator::TextureArrayAllocator(const TextureArraySettings& settings)
+    : m_settings(settings)
+{
+}
+
+uint32_t TextureArrayAllocator::add(const ImageData& image)
+{
+    if (m_settings.layerSize > 0)
+    {
+        ImageData rgba = toRgba(image);
+        if (rgba.width != m_settings.layerSize || rgba.height != m_settings.layerSize)
+            rgba = resampleImage(rgba, m_settings.layerSize, m_settings.layerSize);
+        m_images.push_back(std::move(rgba));
+    }
+    else
+    {
+        m_images.push_back(image.channels == 3 || image.channels == 4 ? image : toRgba(image));
+    }
+    m_slots.push_back(TextureSlot());
+    return (uint32_t)m_slots.size() - 1;
+}
+
+void TextureArrayAllocator::build()
+{
+    PROFILE_SCOPE("TextureArrays");
+    auto start = std::chrono::steady_clock::now();
+
+    std::map<std::tuple<int, int, int>, std::vector<uint32_t>> groups;
+    for (uint32_t i = 0; i < m_images.size(); ++i)
+        if (!m_images[i].pixels.empty())
+            groups[std::make_tuple(m_images[i].width, m_images[i].height, m_images[i].channels)].push_back(i);
+
+    int fit = m_settings.atlasSize - 2 * m_settings.atlasPadding;
+    std::vector<uint32_t> atlas;
+    for (const auto& group : groups)
+    {
+        int width = std::get<0>(group.first), height = std::get<1>(group.first);
+        if (group.second.size() >= m_settings.minGroup || m_settings.layerSize > 0)
+        {
+            buildArray(group.second, width, height, std::get<2>(group.first));
+            continue;
+        }
+        for (uint32_t image : group.second)
+        {
+            if (width <= fit && height <= fit)
+                atlas.push_back(image);
+            else
+                buildArray({ image }, width, height, std::get<2>(group.first));
+        }
+    }
+    if (!atlas.empty())
+        buildAtlas(atlas);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    m_images.clear();
+    m_images.shrink_to_fit();
+    m_buildMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TextureArrayAllocator::buildArray(const std::vector<uint32_t>& images, int width, int height, int channels)
+{
+    GLuint array = createArray(width, height, (int)images.size(), channels, GL_REPEAT);
+    for (size_t layer = 0; layer < images.size(); ++layer)
+    {
+        uploadLayer(width, height, (int)layer, channels, m_images[images[layer]].pixels.data());
+        TextureSlot& slot = m_slots[images[layer]];
+        slot.array = array;
+        slot.layer = (uint32_t)layer;
+    }
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    m_arrays.push_back(array);
+    m_layers += (uint32_t)images.size();
+    m_bytes += (uint64_t)width * height * channels * images.size() * 4 / 3;
+}
+
+void TextureArrayAllocator::buildAtlas(const std::vector<uint32_t>& images)
+{
+    int size = m_settings.atlasSize;
+    int padding = m_settings.atlasPadding;
+
+    // Prateleiras: as mais altas primeiro, da esquerda para a direita, nova prateleira quando não cabe
+    std::vector<uint32_t> order = images;
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return m_images[a].height > m_images[b].height;
+    });
+
+    struct Placement
+    {
+        uint32_t image;
+        int layer, x, y;
+    };
+    std::vector<Placement> placements;
+    int layer = 0, x = 0, y = 0, shelfHeight = 0;
+    for (uint32_t image : order)
+    {
+        int w = m_images[image].width + 2 * padding, h = m_images[image].height + 2 * padding;
+        if (x + w > size)
+        {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (y + h > size)
+        {
+            layer++;
+            x = y = shelfHeight = 0;
+        }
+        placements.push_back({ image, layer, x, y });
+        x += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+    int layers = layer + 1;
+
+    std::vector<unsigned char> pixels((size_t)size * size * 4 * layers, 0);
+    for (const Placement& p : placements)
+    {
+        ImageData rgba = toRgba(m_images[p.image]);
+        int w = rgba.width, h = rgba.height;
+        unsigned char* destination = &pixels[(size_t)p.layer * size * size * 4];
+
+        // Borda com a cópia do pixel mais próximo, para o filtro não pegar o vizinho
+        for (int ty = 0; ty < h + 2 * padding; ++ty)
+            for (int tx = 0; tx < w + 2 * padding; ++tx)
+            {
+                int sx = std::min(std::max(tx - padding, 0), w - 1);
+                int sy = std::min(std::max(ty - padding, 0), h - 1);
+                const unsigned char* source = &rgba.pixels[((size_t)sy * w + sx) * 4];
+                std::copy(source, source + 4, &destination[((size_t)(p.y + ty) * size + p.x + tx) * 4]);
+            }
+
+        TextureSlot& slot = m_slots[p.image];
+        slot.layer = p.layer;
+        slot.atlas = true;
+        slot.uvRect = glm::vec4((p.x + padding) / (float)size, (p.y + padding) / (float)size, w / (float)size,
+            h / (float)size);
+        m_atlasUsedArea += (double)w * h;
+    }
+
+    GLuint array = createArray(size, size, layers, 4, GL_CLAMP_TO_EDGE);
+    for (int l = 0; l < layers; ++l)
+        uploadLayer(size, size, l, 4, &pixels[(size_t)l * size * size * 4]);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    for (const Placement& p : placements)
+        m_slots[p.image].array = array;
+
+    m_arrays.push_back(array);
+    m_layers += layers;
+    m_atlasImages += (uint32_t)images.size();
+    m_atlasLayers += layers;
+    m_bytes += (uint64_t)size * size * 4 * layers * 4 / 3;
+}
+
+void TextureArrayAllocator::printStats() const
+{
+    std::cout << "TextureArrays: " << m_slots.size() << " texturas em " << m_arrays.size() << " arrays ("
+        << m_layers << " camadas)";
+    if (m_atlasLayers > 0)
+        std::cout << ", " << m_atlasImages << " no atlas (" << m_atlasLayers << " camadas, "
+            << 100.0 * m_atlasUsedArea / ((double)m_settings.atlasSize * m_settings.atlasSize * m_atlasLayers)
+            << "% ocupado)";
+    std::cout << ", " << m_bytes / (1024 * 1024) << " MB com mipmaps, " << m_buildMs << " ms" << std::endl;
+}
+
+void TextureArrayAllocator::destroy()
+{
+    if (!m_arrays.empty())
+        glDeleteTextures((GLsizei)m_arrays.size(), m_arrays.data());
+    m_arrays.clear();
+    m_slots.clear();
+}
+
+const char* TextureArrayAllocator::getMaterialSource()
+{
+    static_assert(sizeof(ArrayMaterial) == 32, "ArrayMaterial precisa do layout std430");
+    return materialSource;
+}
+
+const char* TextureArrayAllocator::getShaderSource()
+{
+    static const std::string source = std::string(materialSource) + samplingSource;
+    return source.c_str();
+}
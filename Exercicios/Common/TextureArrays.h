@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Geometry.h"
+
+// Texturas agrupadas em GL_TEXTURE_2D_ARRAY: objetos com texturas diferentes
+// que caem no mesmo array são desenhados juntos, com a camada vindo do
+// material (ArrayMaterial) em vez de um glBindTexture por objeto.
+//
+//   TextureArraySettings settings;
+//   settings.layerSize = 512;               // opcional: reamostra tudo para 512x512
+//   TextureArrayAllocator textures(settings);
+//   uint32_t wall = textures.add(wallImage);   // só CPU
+//   uint32_t face = textures.add(faceImage);
+//   textures.build();                       // cria os arrays e sobe tudo (contexto GL)
+//   const TextureSlot& slot = textures.getSlot(wall);
+//   ArrayMaterial material;
+//   material.uvRect = slot.uvRect;
+//   material.layer = slot.layer;            // slot.array vai no glBindTexture(GL_TEXTURE_2D_ARRAY, ...)
+//
+// Imagens do mesmo tamanho e número de canais, com pelo menos minGroup
+// imagens, viram as camadas de um array. As que sobram (tamanhos avulsos)
+// vão para um atlas: camadas RGBA de atlasSize x atlasSize num array próprio,
+// empacotadas em prateleiras com uma borda repetida de atlasPadding pixels.
+// No atlas, uvRect diz onde a imagem está na camada; sampleArrayMaterial()
+// (de getShaderSource()) repete a UV dentro do retângulo e usa o gradiente da
+// UV original, para o mipmap não saltar nas costuras. Imagens maiores que o
+// atlas ficam sozinhas num array de uma camada.
+
+struct TextureArraySettings
+{
+    int layerSize = 0;              // > 0: todas reamostradas para layerSize x layerSize (um array só)
+    uint32_t minGroup = 2;          // imagens do mesmo tamanho para valer um array
+    int atlasSize = 2048;
+    int atlasPadding = 4;
+};
+
+struct TextureSlot
+{
+    GLuint array = 0;
+    uint32_t layer = 0;
+    glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);   // início (xy) e tamanho (zw) na camada
+    bool atlas = false;
+};
+
+// Layout std430 (32 bytes), declarado também por getMaterialSource()/getShaderSource()
+struct ArrayMaterial
+{
+    glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    glm::vec3 kd = glm::vec3(0.7f);
+    uint32_t layer = 0;
+};
+
+// Reamostra pela média da área que cada pixel cobre (reduz sem serrilhar)
+ImageData resampleImage(const ImageData& image, int width, int height);
+
+class TextureArrayAllocator
+{
+public:
+    explicit TextureArrayAllocator(const TextureArraySettings& settings = TextureArraySettings());
+
+    TextureArrayAllocator(const TextureArrayAllocator&) = delete;
+    TextureArrayAllocator& operator=(const TextureArrayAllocator&) = delete;
+
+    // Guarda uma cópia na CPU; o índice vale para getSlot depois do build
+    uint32_t add(const ImageData& image);
+
+    // Cria os arrays, sobe as camadas e gera os mipmaps; libera as cópias
+    void build();
+
+    const TextureSlot& getSlot(uint32_t id) const { return m_slots[id]; }
+    const std::vector<GLuint>& getArrays() const { return m_arrays; }
+
+    void printStats() const;
+
+    // Apaga os arrays; chamar antes de destruir o contexto GL
+    void destroy();
+
+    // Só a struct ArrayMaterial (vertex shader: dFdx não existe fora do fragment)
+    static const char* getMaterialSource();
+
+    // ArrayMaterial e sampleArrayMaterial(), para o fragment shader
+    static const char* getShaderSource();
+
+private:
+    void buildArray(const std::vector<uint32_t>& images, int width, int height, int channels);
+    void buildAtlas(const std::vector<uint32_t>& images);
+
+    TextureArraySettings m_settings;
+    std::vector<ImageData> m_images;
+    std::vector<TextureSlot> m_slots;
+    std::vector<GLuint> m_arrays;
+    uint32_t m_layers = 0;
+    uint32_t m_atlasImages = 0;
+    uint32_t m_atlasLayers = 0;
+    double m_atlasUsedArea = 0.0;   // fração das camadas do atlas ocupada por imagens
+    uint64_t m_bytes = 0;
+    double m_buildMs = 0.0;
+};
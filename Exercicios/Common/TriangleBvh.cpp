@@ -0,0 +1,404 @@
+#include "TriangleBvh.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const int STACK_SIZE = 256;
+
+// Direção com componentes nulas vira um número minúsculo com o mesmo sinal,
+// para o inverso ficar finito e o slab não gerar NaN (0 * inf)
+static glm::vec3 safeInverse(const glm::vec3& direction)
+{
+    glm::vec3 inv;
+    for (int a = 0; a < 3; ++a)
+        inv[a] = 1.0f / (std::fabs(direction[a]) > 1e-20f ? direction[a] : std::copysign(1e-20f, direction[a]));
+    return inv;
+}
+
+TriangleBvh::TriangleBvh(JobSystem* jobs)
+    : m_jobs(jobs)
+{
+}
+
+void TriangleBvh::build(const std::vector<glm::vec3>& positions)
+{
+    m_nodes.clear();
+    m_triangles.clear();
+    m_bounds = Aabb();
+
+    size_t count = positions.size() / 3;
+    if (count == 0)
+        return;
+
+    std::vector<Aabb> boxes(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+            boxes[i].grow(positions[i * 3 + k]);
+        m_bounds.grow(boxes[i]);
+    }
+
+    InstanceBvh binary(m_jobs);
+    binary.build(boxes);
+
+    const std::vector<uint32_t>& order = binary.getLeafOrder();
+    m_triangles.resize(count);
+    for (size_t k = 0; k < count; ++k)
+    {
+        uint32_t id = order[k];
+        const glm::vec3& p0 = positions[(size_t)id * 3];
+        m_triangles[k] = { p0, positions[(size_t)id * 3 + 1] - p0, positions[(size_t)id * 3 + 2] - p0, id };
+    }
+
+    const InstanceBvh::Node& root = binary.getNodes()[0];
+    if (root.count == 0)
+    {
+        collapse(binary, 0);
+        return;
+    }
+
+    // Malha pequena: a raiz binária já é folha
+    Node node;
+    for (int c = 0; c < 4; ++c)
+    {
+        node.minX[c] = node.minY[c] = node.minZ[c] = 0.0f;
+        node.maxX[c] = node.maxY[c] = node.maxZ[c] = 0.0f;
+        node.child[c] = EMPTY;
+        node.count[c] = 0;
+    }
+    node.minX[0] = root.boundsMin.x; node.minY[0] = root.boundsMin.y; node.minZ[0] = root.boundsMin.z;
+    node.maxX[0] = root.boundsMax.x; node.maxY[0] = root.boundsMax.y; node.maxZ[0] = root.boundsMax.z;
+    node.child[0] = root.leftOrFirst;
+    node.count[0] = root.count;
+    m_nodes.push_back(node);
+}
+
+uint32_t TriangleBvh::collapse(const InstanceBvh& binary, uint32_t binaryNode)
+{
+    const std::vector<InstanceBvh::Node>& nodes = binary.getNodes();
+    uint32_t index = (uint32_t)m_nodes.size();
+    m_nodes.emplace_back();
+
+    // Começa pelos dois filhos e abre o interno de maior área até ter 4
+    uint32_t children[4] = { nodes[binaryNode].leftOrFirst, nodes[binaryNode].leftOrFirst + 1 };
+    int childCount = 2;
+    while (childCount < 4)
+    {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (int c = 0; c < childCount; ++c)
+        {
+            const InstanceBvh::Node& n = nodes[children[c]];
+            if (n.count > 0)
+                continue;
+            Aabb box;
+            box.min = n.boundsMin;
+            box.max = n.boundsMax;
+            float area = box.surfaceArea();
+            if (area > bestArea)
+            {
+                best = c;
+                bestArea = area;
+            }
+        }
+        if (best < 0)
+            break;
+        uint32_t left = nodes[children[best]].leftOrFirst;
+        children[best] = left;
+        children[childCount++] = left + 1;
+    }
+
+    Node node;
+    for (int c = 0; c < 4; ++c)
+    {
+        node.minX[c] = node.minY[c] = node.minZ[c] = 0.0f;
+        node.maxX[c] = node.maxY[c] = node.maxZ[c] = 0.0f;
+        node.child[c] = EMPTY;
+        node.count[c] = 0;
+        if (c >= childCount)
+            continue;
+
+        const InstanceBvh::Node& n = nodes[children[c]];
+        node.minX[c] = n.boundsMin.x; node.minY[c] = n.boundsMin.y; node.minZ[c] = n.boundsMin.z;
+        node.maxX[c] = n.boundsMax.x; node.maxY[c] = n.boundsMax.y; node.maxZ[c] = n.boundsMax.z;
+        node.count[c] = n.count;
+        node.child[c] = n.count > 0 ? n.leftOrFirst : collapse(binary, children[c]);
+    }
+    m_nodes[index] = node;
+    return index;
+}
+
+bool TriangleBvh::intersect(const BvhRay& ray, TriangleHit& hit) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    struct Entry
+    {
+        uint32_t index;
+        uint32_t count;     // 0 = nó interno
+        float tNear;
+    };
+
+    const glm::vec3 o = ray.origin, d = ray.direction, inv = safeInverse(d);
+    float closest = std::min(ray.tMax, hit.t);
+    bool found = false;
+
+    Entry stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = { 0, 0, 0.0f };
+
+    while (top > 0)
+    {
+        Entry entry = stack[--top];
+        if (entry.tNear >= closest)
+            continue;
+
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.index; i < entry.index + entry.count; ++i)
+            {
+                const Triangle& tri = m_triangles[i];
+                glm::vec3 p = glm::cross(d, tri.edge2);
+                float det = glm::dot(tri.edge1, p);
+                if (det == 0.0f)
+                    continue;
+                float invDet = 1.0f / det;
+                glm::vec3 s = o - tri.v0;
+                float u = glm::dot(s, p) * invDet;
+                if (u < 0.0f || u > 1.0f)
+                    continue;
+                glm::vec3 q = glm::cross(s, tri.edge1);
+                float v = glm::dot(d, q) * invDet;
+                if (v < 0.0f || u + v > 1.0f)
+                    continue;
+                float t = glm::dot(tri.edge2, q) * invDet;
+                if (t > 0.0f && t < closest)
+                {
+                    closest = t;
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = v;
+                    hit.triangle = tri.id;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // Os 4 slabs de uma vez (SoA, sem desvio dentro do laço)
+        const Node& node = m_nodes[entry.index];
+        float tNear[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            float tx0 = (node.minX[c] - o.x) * inv.x, tx1 = (node.maxX[c] - o.x) * inv.x;
+            float ty0 = (node.minY[c] - o.y) * inv.y, ty1 = (node.maxY[c] - o.y) * inv.y;
+            float tz0 = (node.minZ[c] - o.z) * inv.z, tz1 = (node.maxZ[c] - o.z) * inv.z;
+            float tMin = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+            float tMax = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), closest));
+            tNear[c] = tMin <= tMax ? tMin : 1e30f;
+        }
+
+        // Empilha do mais distante para o mais próximo: o mais próximo sai primeiro
+        int order[4], hits = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            if (node.child[c] == EMPTY || tNear[c] >= closest)
+                continue;
+            int k = hits++;
+            while (k > 0 && tNear[order[k - 1]] < tNear[c])
+            {
+                order[k] = order[k - 1];
+                --k;
+            }
+            order[k] = c;
+        }
+        for (int k = 0; k < hits && top < STACK_SIZE; ++k)
+        {
+            int c = order[k];
+            stack[top++] = { node.child[c], node.count[c], tNear[c] };
+        }
+    }
+    return found;
+}
+
+bool TriangleBvh::occluded(const BvhRay& ray) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    const glm::vec3 o = ray.origin, d = ray.direction, inv = safeInverse(d);
+    const float closest = ray.tMax;
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        for (int c = 0; c < 4; ++c)
+        {
+            if (node.child[c] == EMPTY)
+                continue;
+
+            float tx0 = (node.minX[c] - o.x) * inv.x, tx1 = (node.maxX[c] - o.x) * inv.x;
+            float ty0 = (node.minY[c] - o.y) * inv.y, ty1 = (node.maxY[c] - o.y) * inv.y;
+            float tz0 = (node.minZ[c] - o.z) * inv.z, tz1 = (node.maxZ[c] - o.z) * inv.z;
+            float tMin = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+            float tMax = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), closest));
+            if (tMin > tMax)
+                continue;
+
+            if (node.count[c] == 0)
+            {
+                if (top < STACK_SIZE)
+                    stack[top++] = node.child[c];
+                continue;
+            }
+
+            for (uint32_t i = node.child[c]; i < node.child[c] + node.count[c]; ++i)
+            {
+                const Triangle& tri = m_triangles[i];
+                glm::vec3 p = glm::cross(d, tri.edge2);
+                float det = glm::dot(tri.edge1, p);
+                if (det == 0.0f)
+                    continue;
+                float invDet = 1.0f / det;
+                glm::vec3 s = o - tri.v0;
+                float u = glm::dot(s, p) * invDet;
+                glm::vec3 q = glm::cross(s, tri.edge1);
+                float v = glm::dot(d, q) * invDet;
+                float t = glm::dot(tri.edge2, q) * invDet;
+                if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > 0.0f && t < closest)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t TriangleBvh::intersectPacket(const BvhRay* rays, TriangleHit* hits, int count) const
+{
+    if (m_nodes.empty())
+        return 0;
+
+    // Raios em SoA; as pistas sem raio ficam com closest negativo e nunca acertam
+    const int N = PACKET_SIZE;
+    float ox[N], oy[N], oz[N], dx[N], dy[N], dz[N], ix[N], iy[N], iz[N], closest[N];
+    float bestU[N], bestV[N];
+    uint32_t bestTriangle[N];
+    for (int k = 0; k < N; ++k)
+    {
+        const BvhRay& ray = rays[std::min(k, count - 1)];
+        glm::vec3 inv = safeInverse(ray.direction);
+        ox[k] = ray.origin.x; oy[k] = ray.origin.y; oz[k] = ray.origin.z;
+        dx[k] = ray.direction.x; dy[k] = ray.direction.y; dz[k] = ray.direction.z;
+        ix[k] = inv.x; iy[k] = inv.y; iz[k] = inv.z;
+        closest[k] = k < count ? std::min(ray.tMax, hits[k].t) : -1.0f;
+        bestU[k] = bestV[k] = 0.0f;
+        bestTriangle[k] = TriangleHit::NONE;
+    }
+
+    struct Entry
+    {
+        uint32_t index;
+        uint32_t count;
+        float tNear;        // menor entrada entre as pistas
+    };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = { 0, 0, 0.0f };
+
+    while (top > 0)
+    {
+        Entry entry = stack[--top];
+        float farthest = closest[0];
+        for (int k = 1; k < N; ++k)
+            farthest = std::max(farthest, closest[k]);
+        if (entry.tNear >= farthest)
+            continue;
+
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.index; i < entry.index + entry.count; ++i)
+            {
+                const Triangle& tri = m_triangles[i];
+                const glm::vec3 e1 = tri.edge1, e2 = tri.edge2, v0 = tri.v0;
+                for (int k = 0; k < N; ++k)
+                {
+                    float px = dy[k] * e2.z - dz[k] * e2.y;
+                    float py = dz[k] * e2.x - dx[k] * e2.z;
+                    float pz = dx[k] * e2.y - dy[k] * e2.x;
+                    float invDet = 1.0f / (e1.x * px + e1.y * py + e1.z * pz);
+                    float sx = ox[k] - v0.x, sy = oy[k] - v0.y, sz = oz[k] - v0.z;
+                    float u = (sx * px + sy * py + sz * pz) * invDet;
+                    float qx = sy * e1.z - sz * e1.y;
+                    float qy = sz * e1.x - sx * e1.z;
+                    float qz = sx * e1.y - sy * e1.x;
+                    float v = (dx[k] * qx + dy[k] * qy + dz[k] * qz) * invDet;
+                    float t = (e2.x * qx + e2.y * qy + e2.z * qz) * invDet;
+                    bool accept = u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > 0.0f && t < closest[k];
+                    closest[k] = accept ? t : closest[k];
+                    bestU[k] = accept ? u : bestU[k];
+                    bestV[k] = accept ? v : bestV[k];
+                    bestTriangle[k] = accept ? tri.id : bestTriangle[k];
+                }
+            }
+            continue;
+        }
+
+        const Node& node = m_nodes[entry.index];
+        float tNear[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            // Laço das pistas sem redução dentro, para vetorizar sem -ffast-math
+            float laneNear[N];
+            for (int k = 0; k < N; ++k)
+            {
+                float tx0 = (node.minX[c] - ox[k]) * ix[k], tx1 = (node.maxX[c] - ox[k]) * ix[k];
+                float ty0 = (node.minY[c] - oy[k]) * iy[k], ty1 = (node.maxY[c] - oy[k]) * iy[k];
+                float tz0 = (node.minZ[c] - oz[k]) * iz[k], tz1 = (node.maxZ[c] - oz[k]) * iz[k];
+                float tMin = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+                float tMax = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), closest[k]));
+                laneNear[k] = tMin <= tMax ? tMin : 1e30f;
+            }
+            float nearest = laneNear[0];
+            for (int k = 1; k < N; ++k)
+                nearest = std::min(nearest, laneNear[k]);
+            tNear[c] = node.child[c] == EMPTY ? 1e30f : nearest;
+        }
+
+        int order[4], hitCount = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            if (tNear[c] >= 1e30f)
+                continue;
+            int k = hitCount++;
+            while (k > 0 && tNear[order[k - 1]] < tNear[c])
+            {
+                order[k] = order[k - 1];
+                --k;
+            }
+            order[k] = c;
+        }
+        for (int k = 0; k < hitCount && top < STACK_SIZE; ++k)
+        {
+            int c = order[k];
+            stack[top++] = { node.child[c], node.count[c], tNear[c] };
+        }
+    }
+
+    uint32_t mask = 0;
+    for (int k = 0; k < count; ++k)
+    {
+        if (bestTriangle[k] == TriangleHit::NONE)
+            continue;
+        hits[k].t = closest[k];
+        hits[k].u = bestU[k];
+        hits[k].v = bestV[k];
+        hits[k].triangle = bestTriangle[k];
+        mask |= 1u << k;
+    }
+    return mask;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "InstanceBvh.h"
+#include "JobSystem.h"
+
+// BVH de 4 filhos sobre os triângulos de uma malha (espaço local), usada pelo
+// RayTracer como estrutura de baixo nível de cada MeshData.
+//
+//   TriangleBvh bvh(&jobs);
+//   bvh.build(mesh.positions);              // lista de triângulos, 3 vértices cada
+//   TriangleHit hit;
+//   if (bvh.intersect(ray, hit)) ...        // hit.triangle, hit.u, hit.v, hit.t
+//   bool blocked = bvh.occluded(shadowRay);
+//   uint32_t mask = bvh.intersectPacket(rays, hits, 8);
+//
+// A árvore binária SAH vem do InstanceBvh (sobre as caixas dos triângulos) e é
+// achatada para 4 filhos por nó: cada nó guarda as 4 caixas filhas em SoA
+// (minX[4], ..., maxZ[4]) num bloco de 128 bytes, e um raio testa os 4 slabs
+// num laço de 4 pistas que o compilador vetoriza. Os pacotes levam 8 raios
+// coerentes (primários de um bloco de pixels) juntos pela mesma descida.
+
+struct TriangleHit
+{
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    float t = 1e30f;
+    float u = 0.0f;             // baricêntricas: p = (1 - u - v) * v0 + u * v1 + v * v2
+    float v = 0.0f;
+    uint32_t triangle = NONE;   // índice do triângulo na malha original
+};
+
+class TriangleBvh
+{
+public:
+    explicit TriangleBvh(JobSystem* jobs = nullptr);
+
+    void build(const std::vector<glm::vec3>& positions);
+
+    // Acerto mais próximo antes de min(ray.tMax, hit.t); só atualiza "hit" (e
+    // retorna true) se achou um mais próximo, então o mesmo hit pode passar por
+    // várias malhas em sequência
+    bool intersect(const BvhRay& ray, TriangleHit& hit) const;
+
+    // Algum acerto antes de ray.tMax (raios de sombra); para no primeiro
+    bool occluded(const BvhRay& ray) const;
+
+    // Até PACKET_SIZE raios com a mesma regra de intersect(); retorna a máscara
+    // das pistas cujo hit mudou
+    uint32_t intersectPacket(const BvhRay* rays, TriangleHit* hits, int count) const;
+
+    const Aabb& getBounds() const { return m_bounds; }
+    uint32_t getTriangleCount() const { return (uint32_t)m_triangles.size(); }
+    uint32_t getNodeCount() const { return (uint32_t)m_nodes.size(); }
+
+    static const int PACKET_SIZE = 8;
+
+private:
+    static const uint32_t EMPTY = 0xFFFFFFFFu;
+
+    struct alignas(64) Node
+    {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        uint32_t child[4];      // interno: nó filho; folha: primeiro triângulo; EMPTY: posição sem filho
+        uint32_t count[4];      // triângulos da folha; 0 = nó interno
+    };
+
+    // Triângulo pronto para o Möller-Trumbore
+    struct Triangle
+    {
+        glm::vec3 v0;
+        glm::vec3 edge1;
+        glm::vec3 edge2;
+        uint32_t id;
+    };
+
+    uint32_t collapse(const InstanceBvh& binary, uint32_t binaryNode);
+
+    JobSystem* m_jobs;
+    Aabb m_bounds;
+    std::vector<Node> m_nodes;
+    std::vector<Triangle> m_triangles;      // na ordem das folhas
+};
@@ -0,0 +1,164 @@
+#include "VertexBaker.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#include "Profiler.h"
+
+// Vértice da malha desindexada identificado pelos bits de posição e normal
+struct BakeVertexKey
+{
+    float data[6];
+
+    bool operator==(const BakeVertexKey& other) const { return memcmp(data, other.data, sizeof(data)) == 0; }
+};
+
+struct BakeVertexKeyHash
+{
+    size_t operator()(const BakeVertexKey& key) const { return (size_t)DiskCache::hash(key.data, sizeof(key.data)); }
+};
+
+VertexBaker::VertexBaker(JobSystem* jobs, const DiskCache* cache) : m_jobs(jobs), m_cache(cache)
+{
+}
+
+void VertexBaker::setScene(const CpuScene& scene)
+{
+    m_scene = &scene;
+    m_tracer.reset();
+}
+
+uint64_t VertexBaker::cacheKey(size_t meshIndex, const VertexBakeSettings& settings) const
+{
+    uint64_t key = hashLighting(*m_scene, meshIndex, DiskCache::hash("vertexbake1"));
+    key = DiskCache::hash(&settings.aoSamples, sizeof(settings.aoSamples), key);
+    key = DiskCache::hash(&settings.aoDistance, sizeof(settings.aoDistance), key);
+    key = DiskCache::hash(&settings.indirectSamples, sizeof(settings.indirectSamples), key);
+    key = DiskCache::hash(&settings.maxBounces, sizeof(settings.maxBounces), key);
+    key = DiskCache::hash(&settings.seed, sizeof(settings.seed), key);
+    return key;
+}
+
+bool VertexBaker::bake(size_t meshIndex, const VertexBakeSettings& settings, std::vector<glm::vec3>& colors)
+{
+    PROFILE_SCOPE("VertexBake");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    m_stats = VertexBakeStats();
+    if (!m_scene || meshIndex >= m_scene->meshes.size())
+        return false;
+
+    const SceneMesh& sceneMesh = m_scene->meshes[meshIndex];
+    const MeshData& mesh = *sceneMesh.mesh;
+    size_t count = mesh.positions.size();
+    if (mesh.normals.size() != count)
+        return false;
+    m_stats.vertices = (uint32_t)count;
+
+    uint64_t key = 0;
+    if (m_cache)
+    {
+        key = cacheKey(meshIndex, settings);
+        std::vector<char> data;
+        if (m_cache->read(key, data) && data.size() == count * sizeof(glm::vec3))
+        {
+            colors.resize(count);
+            memcpy(colors.data(), data.data(), data.size());
+            m_stats.cached = true;
+            m_stats.bakeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            return true;
+        }
+    }
+
+    // Um representante por par (posição, normal); remap aponta cada vértice para o dele
+    std::vector<uint32_t> remap(count);
+    std::vector<uint32_t> unique;
+    {
+        std::unordered_map<BakeVertexKey, uint32_t, BakeVertexKeyHash> first;
+        first.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            BakeVertexKey vertexKey;
+            memcpy(vertexKey.data, &mesh.positions[i], sizeof(glm::vec3));
+            memcpy(vertexKey.data + 3, &mesh.normals[i], sizeof(glm::vec3));
+            auto inserted = first.emplace(vertexKey, (uint32_t)unique.size());
+            if (inserted.second)
+                unique.push_back((uint32_t)i);
+            remap[i] = inserted.first->second;
+        }
+    }
+    m_stats.uniqueVertices = (uint32_t)unique.size();
+
+    if (!m_tracer)
+    {
+        m_tracer = std::make_unique<RayTracer>(m_jobs);
+        m_tracer->setScene(*m_scene);
+    }
+
+    const SceneMaterial& material = sceneMesh.material;
+    glm::vec3 ambient = material.ka * (m_scene->lights.empty() ? glm::vec3(1.0f) : m_scene->lights[0].color);
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(sceneMesh.model)));
+    const RayTracer& tracer = *m_tracer;
+
+    std::vector<glm::vec3> baked(unique.size());
+    auto run = [&](size_t begin, size_t end)
+        {
+            for (size_t u = begin; u < end; ++u)
+            {
+                uint32_t v = unique[u];
+                glm::vec3 position = glm::vec3(sceneMesh.model * glm::vec4(mesh.positions[v], 1.0f));
+                glm::vec3 normal = normalMatrix * mesh.normals[v];
+                float length = glm::length(normal);
+                if (length <= 0.0f)
+                {
+                    baked[u] = ambient;
+                    continue;
+                }
+                normal /= length;
+
+                // Semente pelo índice único: o mesmo bake sempre dá o mesmo resultado
+                uint32_t seed = settings.seed * 0x9E3779B9u + (uint32_t)u * 0x85EBCA6Bu;
+                float occlusion = settings.aoSamples > 0
+                    ? tracer.ambientOcclusion(position, normal, settings.aoSamples, settings.aoDistance, seed)
+                    : 1.0f;
+                glm::vec3 irradiance = tracer.directLight(position, normal);
+                if (settings.indirectSamples > 0)
+                    irradiance += tracer.indirectLight(position, normal, settings.indirectSamples,
+                        settings.maxBounces, seed ^ 0x5bd1e995u);
+
+                baked[u] = ambient * occlusion + material.kd * irradiance;
+            }
+        };
+
+    if (m_jobs)
+        m_jobs->parallelFor(unique.size(), 64, run);
+    else
+        run(0, unique.size());
+
+    colors.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        colors[i] = baked[remap[i]];
+
+    if (m_cache)
+        m_cache->write(key, colors.data(), colors.size() * sizeof(glm::vec3));
+
+    m_stats.rays = (uint64_t)unique.size() *
+        (m_scene->lights.size() + settings.aoSamples + settings.indirectSamples);
+    m_stats.bakeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
+
+void VertexBaker::printStats() const
+{
+    if (m_stats.cached)
+    {
+        std::cout << "Bake por vertice: " << m_stats.vertices << " vertices lidos do cache em " << m_stats.bakeMs
+            << " ms" << std::endl;
+        return;
+    }
+
+    std::cout << "Bake por vertice: " << m_stats.uniqueVertices << " unicos de " << m_stats.vertices << " vertices, "
+        << m_stats.rays << " raios em " << m_stats.bakeMs << " ms" << std::endl;
+}
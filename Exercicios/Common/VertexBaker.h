@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CpuScene.h"
+#include "DiskCache.h"
+#include "JobSystem.h"
+#include "RayTracer.h"
+
+// Iluminação estática assada por vértice no atributo de cor (location 1), que
+// os loaders preenchem com um vermelho constante e o phong.fs não lê.
+//
+//   VertexBaker baker(&jobs, &cache);       // cache opcional (DiskCache)
+//   baker.setScene(scene);                  // mesma CpuScene do RayTracer
+//   baker.bake(0, settings, mesh.colors);   // um valor por vértice de scene.meshes[0]
+//   Geometry g = uploadGeometry(mesh, &image);
+//
+// O valor assado é a parte difusa do Phong sem a textura,
+//   ka * luz * AO + kd * (direta com sombra + indireta opcional),
+// então o shader baked.fs só multiplica pela textura. O especular depende da
+// câmera e fica de fora. Vale para a pose da instância no momento do bake:
+// a malha e as luzes não podem se mexer depois.
+//
+// Os vértices da malha desindexada se repetem por triângulo; cada par
+// (posição, normal) é assado uma vez só e copiado para as repetições, então
+// vértices compartilhados nunca ficam com cores diferentes. Os raios saem em
+// paralelo no JobSystem, um bloco de vértices por job. A BVH só é montada se
+// algum resultado não estiver no cache.
+
+struct VertexBakeSettings
+{
+    int aoSamples = 64;         // 0: sem oclusão ambiente
+    float aoDistance = 0.5f;    // alcance dos raios de AO, em unidades de mundo
+    int indirectSamples = 0;    // 0: só luz direta
+    int maxBounces = 2;
+    uint32_t seed = 1;
+};
+
+struct VertexBakeStats
+{
+    uint32_t vertices = 0;
+    uint32_t uniqueVertices = 0;
+    uint64_t rays = 0;
+    double bakeMs = 0.0;
+    bool cached = false;
+};
+
+class VertexBaker
+{
+public:
+    // Sem JobSystem tudo roda na thread que chama
+    explicit VertexBaker(JobSystem* jobs = nullptr, const DiskCache* cache = nullptr);
+
+    // As malhas, texturas e a cena precisam continuar vivas até o último bake
+    void setScene(const CpuScene& scene);
+
+    // colors recebe um valor por vértice de scene.meshes[meshIndex].mesh
+    bool bake(size_t meshIndex, const VertexBakeSettings& settings, std::vector<glm::vec3>& colors);
+
+    const VertexBakeStats& getStats() const { return m_stats; }
+    void printStats() const;
+
+private:
+    uint64_t cacheKey(size_t meshIndex, const VertexBakeSettings& settings) const;
+
+    JobSystem* m_jobs;
+    const DiskCache* m_cache;
+    const CpuScene* m_scene = nullptr;
+    std::unique_ptr<RayTracer> m_tracer;    // criado no primeiro bake fora do cache
+    VertexBakeStats m_stats;
+};
@@ -0,0 +1,289 @@
+#include "VertexPulling.h"
+
+#include <iostream>
+
+#include "Profiler.h"
+
+static const char* pullingSource = R"glsl(
+layout(std430, binding = 5) readonly buffer PulledVertices
+{
+    float pulledData[];
+};
+
+// 8 ints por formato: stride, position, color, uv, normal (offsets em floats, -1 = ausente)
+layout(std430, binding = 6) readonly buffer PulledFormats
+{
+    int pulledFormats[];
+};
+
+struct PulledVertex
+{
+    vec3 position;
+    vec3 color;
+    vec2 uv;
+    vec3 normal;
+    bool hasNormal;
+};
+
+vec3 pullVec3(uint first, int offset, vec3 fallback)
+{
+    if (offset < 0)
+        return fallback;
+    uint i = first + uint(offset);
+    return vec3(pulledData[i], pulledData[i + 1u], pulledData[i + 2u]);
+}
+
+PulledVertex pullVertex(uint format)
+{
+    uint f = format * 8u;
+    uint first = uint(gl_VertexID) * uint(pulledFormats[f]);
+
+    PulledVertex v;
+    v.position = pullVec3(first, pulledFormats[f + 1u], vec3(0.0));
+    v.color = pullVec3(first, pulledFormats[f + 2u], vec3(1.0, 0.0, 0.0));
+    int uv = pulledFormats[f + 3u];
+    v.uv = uv < 0 ? vec2(0.0) : vec2(pulledData[first + uint(uv)], pulledData[first + uint(uv) + 1u]);
+    v.hasNormal = pulledFormats[f + 4u] >= 0;
+    v.normal = pullVec3(first, pulledFormats[f + 4u], vec3(0.0, 0.0, 1.0));
+    return v;
+}
+)glsl";
+
+VertexFormat VertexFormat::geometry()
+{
+    return VertexFormat();
+}
+
+VertexFormat VertexFormat::primitive()
+{
+    VertexFormat format;
+    format.normal = 6;
+    format.uv = 9;
+    return format;
+}
+
+VertexFormat VertexFormat::colored()
+{
+    VertexFormat format;
+    format.stride = 6;
+    format.uv = -1;
+    format.normal = -1;
+    return format;
+}
+
+namespace
+{
+    void writeAttribute(float* vertex, int32_t offset, const float* value, int size)
+    {
+        if (offset >= 0)
+            for (int i = 0; i < size; ++i)
+                vertex[offset + i] = value[i];
+    }
+
+    void packVertex(const VertexFormat& format, float* vertex, const glm::vec3& p, const glm::vec3& c,
+        const glm::vec2& t, const glm::vec3& n)
+    {
+        writeAttribute(vertex, format.position, &p.x, 3);
+        writeAttribute(vertex, format.color, &c.x, 3);
+        writeAttribute(vertex, format.uv, &t.x, 2);
+        writeAttribute(vertex, format.normal, &n.x, 3);
+    }
+}
+
+VertexPullingPool::VertexPullingPool(uint32_t floatCapacity, uint32_t indexCapacity)
+    : m_floats(floatCapacity), m_indices(indexCapacity)
+{
+    m_supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+    if (!m_supported)
+    {
+        std::cout << "VertexPullingPool: requer OpenGL 4.3 (SSBO no vertex shader)" << std::endl;
+        return;
+    }
+    m_immutable = GLVersion.major > 4 || GLVersion.minor >= 4;
+
+    GLsizeiptr vertexBytes = (GLsizeiptr)floatCapacity * sizeof(float);
+    GLsizeiptr indexBytes = (GLsizeiptr)indexCapacity * sizeof(uint32_t);
+    GLsizeiptr formatBytes = MAX_FORMATS * 8 * sizeof(GLint);
+
+    // VAO sem atributos: só guarda o EBO
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_vertexBuffer);
+    glGenBuffers(1, &m_indexBuffer);
+    glGenBuffers(1, &m_formatBuffer);
+
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_vertexBuffer);
+    if (m_immutable)
+    {
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, vertexBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_formatBuffer);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, formatBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, vertexBytes, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_formatBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, formatBytes, nullptr, GL_STATIC_DRAW);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+uint32_t VertexPullingPool::addFormat(const VertexFormat& format)
+{
+    for (size_t i = 0; i < m_formats.size(); ++i)
+        if (m_formats[i] == format)
+            return (uint32_t)i;
+    if (m_formats.size() >= MAX_FORMATS)
+    {
+        std::cerr << "VertexPullingPool: mais de " << MAX_FORMATS << " formatos" << std::endl;
+        return NO_FORMAT;
+    }
+
+    m_formats.push_back(format);
+    uint32_t index = (uint32_t)m_formats.size() - 1;
+    if (m_supported)
+    {
+        const GLint packed[8] = { (GLint)format.stride, format.position, format.color, format.uv, format.normal };
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_formatBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(packed), sizeof(packed), packed);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    return index;
+}
+
+bool VertexPullingPool::add(const std::vector<float>& vertices, uint32_t format, const std::vector<uint32_t>& indices,
+    const Aabb& bounds, PulledMesh& out)
+{
+    if (!m_supported || format == NO_FORMAT || format >= m_formats.size() || indices.empty())
+        return false;
+    uint32_t stride = m_formats[format].stride;
+    uint32_t vertexCount = (uint32_t)(vertices.size() / stride);
+    if (vertexCount == 0)
+        return false;
+
+    // Folga de até stride - 1 floats para a malha começar num múltiplo do stride
+    uint32_t floatOffset = 0, indexOffset = 0;
+    uint32_t vertexBlock = m_floats.allocate(vertexCount * stride + stride - 1, floatOffset);
+    uint32_t indexBlock = vertexBlock != RangeAllocator::NONE ?
+        m_indices.allocate((uint32_t)indices.size(), indexOffset) : RangeAllocator::NONE;
+    if (indexBlock == RangeAllocator::NONE)
+    {
+        m_floats.free(vertexBlock);
+        ++m_failedAdds;
+        std::cerr << "VertexPullingPool: sem espaco para " << vertexCount << " vertices e " << indices.size()
+            << " indices" << std::endl;
+        return false;
+    }
+    uint32_t baseVertex = (floatOffset + stride - 1) / stride;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_vertexBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr)baseVertex * stride * sizeof(float),
+        (GLsizeiptr)vertexCount * stride * sizeof(float), vertices.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindVertexArray(m_VAO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)indexOffset * sizeof(uint32_t),
+        indices.size() * sizeof(uint32_t), indices.data());
+    glBindVertexArray(0);
+
+    out.baseVertex = (GLint)baseVertex;
+    out.firstIndex = indexOffset;
+    out.indexCount = (GLsizei)indices.size();
+    out.vertexCount = vertexCount;
+    out.bounds = bounds;
+    out.vertexBlock = vertexBlock;
+    out.indexBlock = indexBlock;
+    out.format = format;
+
+    ++m_meshes;
+    m_uploadedBytes += (uint64_t)vertexCount * stride * sizeof(float) + indices.size() * sizeof(uint32_t);
+    m_alignmentFloats += baseVertex * stride - floatOffset;
+    return true;
+}
+
+bool VertexPullingPool::add(const MeshData& mesh, uint32_t format, PulledMesh& out)
+{
+    PROFILE_SCOPE("VertexPullingPool::add");
+    MeshData vertices;
+    std::vector<uint32_t> indices;
+    if (format >= m_formats.size() || !indexMesh(mesh, vertices, indices))
+        return false;
+
+    const VertexFormat& f = m_formats[format];
+    bool hasColors = !vertices.colors.empty();
+    std::vector<float> packed(vertices.positions.size() * f.stride, 0.0f);
+    Aabb bounds;
+    for (size_t i = 0; i < vertices.positions.size(); ++i)
+    {
+        glm::vec3 c = hasColors ? vertices.colors[i] : glm::vec3(1.0f, 0.0f, 0.0f);
+        packVertex(f, &packed[i * f.stride], vertices.positions[i], c, vertices.uvs[i], vertices.normals[i]);
+        bounds.grow(vertices.positions[i]);
+    }
+    return add(packed, format, indices, bounds, out);
+}
+
+bool VertexPullingPool::add(const PrimitiveMesh& mesh, uint32_t format, PulledMesh& out)
+{
+    if (format >= m_formats.size())
+        return false;
+
+    const VertexFormat& f = m_formats[format];
+    std::vector<float> packed(mesh.positions.size() * f.stride, 0.0f);
+    for (size_t i = 0; i < mesh.positions.size(); ++i)
+        packVertex(f, &packed[i * f.stride], mesh.positions[i], mesh.colors[i], mesh.uvs[i], mesh.normals[i]);
+    return add(packed, format, mesh.indices, mesh.bounds, out);
+}
+
+void VertexPullingPool::remove(PulledMesh& mesh)
+{
+    if (!mesh.isValid())
+        return;
+    m_floats.free(mesh.vertexBlock);
+    m_indices.free(mesh.indexBlock);
+    --m_meshes;
+    mesh = PulledMesh();
+}
+
+void VertexPullingPool::bind() const
+{
+    glBindVertexArray(m_VAO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VERTEX_BINDING, m_vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FORMAT_BINDING, m_formatBuffer);
+}
+
+void VertexPullingPool::draw(const PulledMesh& mesh) const
+{
+    glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+        (void*)((size_t)mesh.firstIndex * sizeof(uint32_t)), mesh.baseVertex);
+}
+
+const char* VertexPullingPool::getShaderSource()
+{
+    return pullingSource;
+}
+
+void VertexPullingPool::printStats() const
+{
+    std::cout << "VertexPullingPool: " << m_meshes << " malhas em " << m_formats.size() << " formatos, "
+        << m_uploadedBytes / 1024 << " KB enviados, " << m_alignmentFloats << " floats de alinhamento";
+    if (m_failedAdds)
+        std::cout << ", " << m_failedAdds << " sem espaco";
+    std::cout << std::endl;
+    printRangeStats("floats", m_floats.getStats());
+    printRangeStats("indices", m_indices.getStats());
+}
+
+void VertexPullingPool::destroy()
+{
+    if (m_VAO)
+        glDeleteVertexArrays(1, &m_VAO);
+    GLuint buffers[] = { m_vertexBuffer, m_indexBuffer, m_formatBuffer };
+    for (GLuint buffer : buffers)
+        if (buffer)
+            glDeleteBuffers(1, &buffer);
+    m_VAO = m_vertexBuffer = m_indexBuffer = m_formatBuffer = 0;
+    m_supported = false;
+}
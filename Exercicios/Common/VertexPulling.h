@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Geometry.h"
+#include "GeometryPool.h"
+#include "Primitives.h"
+
+// Vertex pulling: malhas com formatos de vértice diferentes (os 11 floats do
+// uploadGeometry, os 11 floats em outra ordem da PrimitiveLibrary, os 6
+// floats dos cubos do Modulo2) lado a lado num mesmo buffer de floats, lido
+// como SSBO pelo vertex shader. Sem atributos não há formato no VAO, então
+// um só VAO (vazio, só com o EBO) e um só draw servem para todas.
+//
+//   VertexPullingPool pool;                 // GL 4.3 (SSBO no vertex shader)
+//   uint32_t colored = pool.addFormat(VertexFormat::colored());
+//   PulledMesh cube, suzanne;
+//   pool.add(primitives.getMesh(PrimitiveShape::cube()), colored, cube);
+//   pool.add(mesh, pool.addFormat(VertexFormat::geometry()), suzanne);
+//   ...
+//   pool.bind();                            // VAO, EBO e os dois SSBOs
+//   glUniform1ui(formatLoc, cube.format);   // ou o formato vindo da instância
+//   pool.draw(cube);
+//
+// No vertex shader, VertexPullingPool::getShaderSource() (depois do #version
+// 430) declara pullVertex(formato), que devolve posição, cor, uv e normal do
+// vértice atual. Cada malha começa num múltiplo do seu stride, então o
+// baseVertex do draw é o início dela em vértices do seu formato e
+// gl_VertexID (que já inclui o baseVertex) vezes o stride dá o primeiro
+// float do vértice; gl_BaseVertex (GL 4.6) não é necessário. O formato de
+// cada draw vem de um uniform ou, nos draws indiretos do GpuCuller, da
+// instância.
+
+// Offsets em floats dentro do vértice; -1 = atributo ausente
+struct VertexFormat
+{
+    uint32_t stride = 11;
+    int32_t position = 0;
+    int32_t color = 3;
+    int32_t uv = 6;
+    int32_t normal = 8;
+
+    static VertexFormat geometry();     // uploadGeometry: pos, cor, uv, normal
+    static VertexFormat primitive();    // PrimitiveLibrary: pos, cor, normal, uv
+    static VertexFormat colored();      // Modulo2: pos, cor
+
+    bool operator==(const VertexFormat& other) const
+    {
+        return stride == other.stride && position == other.position && color == other.color && uv == other.uv &&
+            normal == other.normal;
+    }
+};
+
+struct PulledMesh : PoolMesh
+{
+    uint32_t format = 0;
+};
+
+class VertexPullingPool
+{
+public:
+    VertexPullingPool(uint32_t floatCapacity = 1 << 22, uint32_t indexCapacity = 1 << 20);
+
+    VertexPullingPool(const VertexPullingPool&) = delete;
+    VertexPullingPool& operator=(const VertexPullingPool&) = delete;
+
+    bool isSupported() const { return m_supported; }
+
+    // Índice do formato (o mesmo se já existir); NO_FORMAT passados MAX_FORMATS
+    uint32_t addFormat(const VertexFormat& format);
+
+    // vertices já no formato; false se não couber
+    bool add(const std::vector<float>& vertices, uint32_t format, const std::vector<uint32_t>& indices,
+        const Aabb& bounds, PulledMesh& out);
+
+    // Convertidas para o formato (o que ele não tem fica de fora); a desindexada é soldada antes
+    bool add(const MeshData& mesh, uint32_t format, PulledMesh& out);
+    bool add(const PrimitiveMesh& mesh, uint32_t format, PulledMesh& out);
+
+    void remove(PulledMesh& mesh);
+
+    // Sem atributos de vértice; atributos por instância (attachInstanceIds do GpuCuller) podem entrar nele
+    GLuint getVAO() const { return m_VAO; }
+
+    // Liga o VAO e os SSBOs em VERTEX_BINDING e FORMAT_BINDING
+    void bind() const;
+
+    // Pool já ligado e o formato da malha já passado ao shader
+    void draw(const PulledMesh& mesh) const;
+
+    RangeStats getVertexStats() const { return m_floats.getStats(); }
+    RangeStats getIndexStats() const { return m_indices.getStats(); }
+    void printStats() const;
+
+    // Apaga o VAO e os buffers; chamar antes de destruir o contexto GL
+    void destroy();
+
+    static const char* getShaderSource();
+
+    static const GLuint VERTEX_BINDING = 5;     // acima dos bindings do GpuCuller
+    static const GLuint FORMAT_BINDING = 6;
+    static const uint32_t MAX_FORMATS = 16;
+    static const uint32_t NO_FORMAT = 0xFFFFFFFFu;  // tabela cheia; o add() recusa
+
+private:
+    bool m_supported = false;
+    RangeAllocator m_floats;
+    RangeAllocator m_indices;
+    std::vector<VertexFormat> m_formats;
+    GLuint m_VAO = 0;
+    GLuint m_vertexBuffer = 0;
+    GLuint m_indexBuffer = 0;
+    GLuint m_formatBuffer = 0;
+    bool m_immutable = false;
+    uint32_t m_meshes = 0;
+    uint64_t m_uploadedBytes = 0;
+    uint64_t m_alignmentFloats = 0;     // perdidos alinhando o começo das malhas ao stride
+    uint32_t m_failedAdds = 0;
+};
@@ -8,6 +8,18 @@
 #include <iostream>
 #include <vector>
 
+#include "FixedTimestep.h"
+#include "GpuProfiler.h"
+#include "InstanceBvh.h"
+#include "JobSystem.h"
+#include "OcclusionCuller.h"
+#include "Overdraw.h"
+#include "PipelineStats.h"
+#include "Primitives.h"
+#include "Profiler.h"
+#include "RedrawTracker.h"
+#include "ShaderCache.h"
+
 // Vertex shader GLSL
 const char* vertexShaderSource = R"glsl(
 #version 330 core
@@ -39,57 +51,6 @@ void main()
 }
 )glsl";
 
-// cubo com 36 vertices (6 faces * 2 tringulos * 3 vrtices), posio + cor
-float vertices[] = {
-    // face frontal (vermelha)
-    -0.5f, -0.5f,  0.5f,  1, 0, 0,
-     0.5f, -0.5f,  0.5f,  1, 0, 0,
-     0.5f,  0.5f,  0.5f,  1, 0, 0,
-     0.5f,  0.5f,  0.5f,  1, 0, 0,
-    -0.5f,  0.5f,  0.5f,  1, 0, 0,
-    -0.5f, -0.5f,  0.5f,  1, 0, 0,
-
-    // face traseira (verde)
-    -0.5f, -0.5f, -0.5f,  0, 1, 0,
-     0.5f, -0.5f, -0.5f,  0, 1, 0,
-     0.5f,  0.5f, -0.5f,  0, 1, 0,
-     0.5f,  0.5f, -0.5f,  0, 1, 0,
-    -0.5f,  0.5f, -0.5f,  0, 1, 0,
-    -0.5f, -0.5f, -0.5f,  0, 1, 0,
-
-    // face esquerda (azul)
-    -0.5f,  0.5f,  0.5f,  0, 0, 1,
-    -0.5f,  0.5f, -0.5f,  0, 0, 1,
-    -0.5f, -0.5f, -0.5f,  0, 0, 1,
-    -0.5f, -0.5f, -0.5f,  0, 0, 1,
-    -0.5f, -0.5f,  0.5f,  0, 0, 1,
-    -0.5f,  0.5f,  0.5f,  0, 0, 1,
-
-    // face direita (amarela)
-     0.5f,  0.5f,  0.5f,  1, 1, 0,
-     0.5f,  0.5f, -0.5f,  1, 1, 0,
-     0.5f, -0.5f, -0.5f,  1, 1, 0,
-     0.5f, -0.5f, -0.5f,  1, 1, 0,
-     0.5f, -0.5f,  0.5f,  1, 1, 0,
-     0.5f,  0.5f,  0.5f,  1, 1, 0,
-
-     // face superior (ciano)
-     -0.5f,  0.5f, -0.5f,  0, 1, 1,
-      0.5f,  0.5f, -0.5f,  0, 1, 1,
-      0.5f,  0.5f,  0.5f,  0, 1, 1,
-      0.5f,  0.5f,  0.5f,  0, 1, 1,
-     -0.5f,  0.5f,  0.5f,  0, 1, 1,
-     -0.5f,  0.5f, -0.5f,  0, 1, 1,
-
-     // face inferior (magenta)
-     -0.5f, -0.5f, -0.5f,  1, 0, 1,
-      0.5f, -0.5f, -0.5f,  1, 0, 1,
-      0.5f, -0.5f,  0.5f,  1, 0, 1,
-      0.5f, -0.5f,  0.5f,  1, 0, 1,
-     -0.5f, -0.5f,  0.5f,  1, 0, 1,
-     -0.5f, -0.5f, -0.5f,  1, 0, 1,
-};
-
 struct CubeInstance {
     glm::vec3 position;
     float scale = 1.0f;
@@ -98,50 +59,88 @@ struct CubeInstance {
     float rotZ = 0.0f;
 };
 
-// Globals para controle
-float moveSpeed = 0.05f;
-float scaleSpeed = 0.05f;
+// Globals para controle, por segundo (a simulacao roda em passos fixos,
+// entao a velocidade nao depende da taxa de frames nem do vsync)
+float moveSpeed = 3.0f;
+float scaleSpeed = 3.0f;
+float rotateSpeed = 60.0f;  // graus
 
 CubeInstance mainCube;
 std::vector<CubeInstance> cubes;
 
 unsigned int shaderProgram;
-unsigned int VAO;
+unsigned int overdrawProgram;
+
+// Modos de diagnstico (F1: contadores de pipeline em CSV, F2: overdraw)
+bool collectPipelineStats = false;
+bool showOverdraw = false;
+
+// F3: descarta na CPU os cubos escondidos atrs dos outros
+bool occlusionCulling = true;
+
+// V liga/desliga o vsync
+bool vsync = true;
+
+// Desenho sob demanda (F4 liga/desliga): s desenha enquanto algo se mexe;
+// parado, dorme at o prximo evento
+RedrawTracker redraw(0.0);
+
+// Cubo que recebe os comandos: -1 = cubo principal, seno ndice em cubes
+// (clique com o boto esquerdo para escolher)
+int selectedCube = -1;
+bool pickRequested = false;
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    redraw.markDirty();
+}
+
+// Janela exposta: o contedo precisa ser redesenhado
+void window_refresh_callback(GLFWwindow* window)
+{
+    redraw.markDirty();
 }
 
-void processInput(GLFWwindow* window)
+// Um passo da simulao, de deltaTime segundos; true se algo mudou
+bool processInput(GLFWwindow* window, float deltaTime)
 {
-    // Movimento do cubo principal
+    float move = moveSpeed * deltaTime;
+    float scale = scaleSpeed * deltaTime;
+    float rotate = rotateSpeed * deltaTime;
+
+    // Movimento do cubo selecionado
+    CubeInstance& active = selectedCube < 0 ? mainCube : cubes[selectedCube];
+    CubeInstance before = active;
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        mainCube.position.z -= moveSpeed;
+        active.position.z -= move;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        mainCube.position.z += moveSpeed;
+        active.position.z += move;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        mainCube.position.x -= moveSpeed;
+        active.position.x -= move;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        mainCube.position.x += moveSpeed;
+        active.position.x += move;
     if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
-        mainCube.position.y += moveSpeed;
+        active.position.y += move;
     if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)
-        mainCube.position.y -= moveSpeed;
+        active.position.y -= move;
 
     // Escala uniforme
     if (glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS)
-        mainCube.scale = std::max(0.1f, mainCube.scale - scaleSpeed);
+        active.scale = std::max(0.1f, active.scale - scale);
     if (glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS)
-        mainCube.scale += scaleSpeed;
+        active.scale += scale;
 
     // Rotao
     if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS)
-        mainCube.rotX += 1.0f;
+        active.rotX += rotate;
     if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS)
-        mainCube.rotY += 1.0f;
+        active.rotY += rotate;
     if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS)
-        mainCube.rotZ += 1.0f;
+        active.rotZ += rotate;
+
+    bool changed = active.position != before.position || active.scale != before.scale ||
+        active.rotX != before.rotX || active.rotY != before.rotY || active.rotZ != before.rotZ;
 
     // Instanciar novo cubo com tecla N
     static bool nPressedLastFrame = false;
@@ -150,51 +149,152 @@ void processInput(GLFWwindow* window)
     {
         CubeInstance newCube = mainCube; // copia posio, escala, rotao atual
         cubes.push_back(newCube);
+        changed = true;
         std::cout << "Instanciou cubo novo! Total: " << cubes.size() + 1 << "\n";
     }
     nPressedLastFrame = nPressed;
-}
 
-unsigned int compileShader(unsigned int type, const char* source)
-{
-    unsigned int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
-
-    // Check errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    // Bloco de 10x10x10 cubos atrs do cubo principal (cena densa para a ocluso)
+    static bool gPressedLastFrame = false;
+    bool gPressed = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+    if (gPressed && !gPressedLastFrame)
     {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        std::cerr << "ERRO COMPILANDO SHADER: " << infoLog << std::endl;
+        for (int x = 0; x < 10; ++x)
+            for (int y = 0; y < 10; ++y)
+                for (int z = 0; z < 10; ++z)
+                {
+                    CubeInstance newCube;
+                    newCube.position = mainCube.position + glm::vec3(x - 4.5f, y - 4.5f, -2.0f - z) * 1.1f;
+                    cubes.push_back(newCube);
+                }
+        changed = true;
+        std::cout << "Criou bloco de 1000 cubos! Total: " << cubes.size() + 1 << "\n";
     }
-    return shader;
-}
+    gPressedLastFrame = gPressed;
+
+    static bool f1PressedLastFrame = false;
+    bool f1Pressed = glfwGetKey(window, GLFW_KEY_F1) == GLFW_PRESS;
+    if (f1Pressed && !f1PressedLastFrame)
+        collectPipelineStats = !collectPipelineStats, changed = true;
+    f1PressedLastFrame = f1Pressed;
+
+    static bool f2PressedLastFrame = false;
+    bool f2Pressed = glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS;
+    if (f2Pressed && !f2PressedLastFrame)
+        showOverdraw = !showOverdraw, changed = true;
+    f2PressedLastFrame = f2Pressed;
+
+    static bool f3PressedLastFrame = false;
+    bool f3Pressed = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+    if (f3Pressed && !f3PressedLastFrame)
+    {
+        occlusionCulling = !occlusionCulling;
+        changed = true;
+        std::cout << "Oclusao " << (occlusionCulling ? "ligada" : "desligada") << "\n";
+    }
+    f3PressedLastFrame = f3Pressed;
 
-unsigned int createShaderProgram()
-{
-    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    unsigned int program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-
-    // Check linking errors
-    int success;
-    char infoLog[512];
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success)
+    static bool vPressedLastFrame = false;
+    bool vPressed = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+    if (vPressed && !vPressedLastFrame)
+    {
+        vsync = !vsync;
+        changed = true;
+        glfwSwapInterval(vsync ? 1 : 0);
+        std::cout << "Vsync " << (vsync ? "ligado" : "desligado") << "\n";
+    }
+    vPressedLastFrame = vPressed;
+
+    static bool f4PressedLastFrame = false;
+    bool f4Pressed = glfwGetKey(window, GLFW_KEY_F4) == GLFW_PRESS;
+    if (f4Pressed && !f4PressedLastFrame)
     {
-        glGetProgramInfoLog(program, 512, NULL, infoLog);
-        std::cerr << "ERRO LINKANDO PROGRAMA: " << infoLog << std::endl;
+        redraw.setEnabled(!redraw.isEnabled());
+        std::cout << "Desenho sob demanda " << (redraw.isEnabled() ? "ligado" : "desligado") << "\n";
     }
+    f4PressedLastFrame = f4Pressed;
+
+    static bool clickLastFrame = false;
+    bool click = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    if (click && !clickLastFrame)
+        pickRequested = true, changed = true;
+    clickLastFrame = click;
+    return changed;
+}
+
+glm::mat4 cubeModel(const CubeInstance& cube)
+{
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, cube.position);
+    model = glm::rotate(model, glm::radians(cube.rotX), glm::vec3(1, 0, 0));
+    model = glm::rotate(model, glm::radians(cube.rotY), glm::vec3(0, 1, 0));
+    model = glm::rotate(model, glm::radians(cube.rotZ), glm::vec3(0, 0, 1));
+    model = glm::scale(model, glm::vec3(cube.scale));
+    return model;
+}
+
+// Estado desenhado entre dois passos da simulao (t = alpha do FixedTimestep)
+CubeInstance lerpCube(const CubeInstance& a, const CubeInstance& b, float t)
+{
+    CubeInstance cube;
+    cube.position = glm::mix(a.position, b.position, t);
+    cube.scale = glm::mix(a.scale, b.scale, t);
+    cube.rotX = glm::mix(a.rotX, b.rotX, t);
+    cube.rotY = glm::mix(a.rotY, b.rotY, t);
+    cube.rotZ = glm::mix(a.rotZ, b.rotZ, t);
+    return cube;
+}
+
+// Distncia do raio at o cubo unitrio de "model" (negativa se errar)
+float rayCube(const glm::mat4& model, const BvhRay& ray)
+{
+    // No espao local o cubo  [-0.5, 0.5]; o t continua o mesmo do espao de mundo
+    glm::mat4 inverse = glm::inverse(model);
+    glm::vec3 origin = glm::vec3(inverse * glm::vec4(ray.origin, 1.0f));
+    glm::vec3 invDir = 1.0f / glm::vec3(inverse * glm::vec4(ray.direction, 0.0f));
+    glm::vec3 t0 = (glm::vec3(-0.5f) - origin) * invDir;
+    glm::vec3 t1 = (glm::vec3(0.5f) - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+    return enter <= exit ? enter : -1.0f;
+}
+
+// Seleciona o cubo sob o cursor: a BVH acha os candidatos e rayCube confirma
+void pickCube(GLFWwindow* window, const glm::mat4& view, const glm::mat4& projection, const InstanceBvh& bvh)
+{
+    double cursorX, cursorY;
+    int width, height;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    glfwGetWindowSize(window, &width, &height);
+    glm::vec2 ndc(2.0f * (float)cursorX / width - 1.0f, 1.0f - 2.0f * (float)cursorY / height);
+
+    glm::mat4 inverse = glm::inverse(projection * view);
+    glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+    BvhRay ray;
+    ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+    ray.direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - ray.origin);
+
+    BvhHit hit = bvh.intersectRay(ray, [](uint32_t instance, const BvhRay& r) { return rayCube(cubeModel(cubes[instance]), r); });
+    float tMain = rayCube(cubeModel(mainCube), ray);
+    if (tMain >= 0.0f && tMain < hit.t)
+        hit.instance = BvhHit::NONE;
+
+    selectedCube = hit.instance == BvhHit::NONE ? -1 : (int)hit.instance;
+    if (selectedCube < 0)
+        std::cout << "Selecionado: cubo principal\n";
+    else
+        std::cout << "Selecionado: cubo " << selectedCube + 1 << " de " << cubes.size() << "\n";
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+unsigned int createShaderProgram()
+{
+    // Busca o binario no cache (shader_cache/); compila so no cache frio
+    ShaderCache cache("shader_cache", (GLADloadproc)glfwGetProcAddress);
+    unsigned int program = cache.getProgram("cores", vertexShaderSource, fragmentShaderSource);
+    overdrawProgram = createOverdrawProgram(cache);
+    cache.printReport();
 
     return program;
 }
@@ -225,29 +325,18 @@ int main()
 
     glViewport(0, 0, 800, 600);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     // Compila shaders
     shaderProgram = createShaderProgram();
 
-    // Setup buffers e arrays
-    unsigned int VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // posies
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // cores
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindVertexArray(0);
+    // Cubo indexado da PrimitiveLibrary (24 vertices, 36 indices), com as cores
+    // por face; o shader s usa posio (location 0) e cor (location 1)
+    PrimitiveLibrary primitives;
+    PrimitiveLayout cubeLayout;
+    cubeLayout.normal = -1;
+    cubeLayout.uv = -1;
+    const Primitive& cube = primitives.get(PrimitiveShape::cube(), cubeLayout);
 
     // Cubo principal inicial
     mainCube.position = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -259,57 +348,182 @@ int main()
 
     glEnable(GL_DEPTH_TEST);
 
+    GpuProfiler gpuProfiler;
+    PipelineStats pipelineStats("pipeline_stats.csv");
+
+    // Ocluso: os tringulos do cubo (s posies) servem de oclusor
+    std::vector<glm::vec3> cubePositions = expandTriangles(*cube.mesh);
+    JobSystem jobs;
+    OcclusionCuller culler(256, 192, &jobs);
+    std::vector<glm::mat4> instanceModels;
+
+    // BVH dos cubos instanciados (frustum culling e picking)
+    InstanceBvh bvh(&jobs);
+    std::vector<Aabb> instanceBounds;
+    std::vector<uint32_t> inFrustum;
+    Aabb unitCube;
+    unitCube.min = glm::vec3(-0.5f);
+    unitCube.max = glm::vec3(0.5f);
+
+    // Simulao em passos fixos; o desenho interpola entre os dois ltimos
+    FixedTimestep timestep(1.0 / 60.0);
+    CubeInstance previousMain = mainCube;
+    std::vector<CubeInstance> previousCubes;
+    glfwSwapInterval(1);
+
     // Loop principal
     while (!glfwWindowShouldClose(window))
     {
-        processInput(window);
+        PROFILE_FRAME();
+        {
+            PROFILE_SCOPE("Input");
+            int steps = timestep.advance(glfwGetTime());
+            for (int i = 0; i < steps; ++i)
+            {
+                previousMain = mainCube;
+                previousCubes = cubes;
+                bool changed = processInput(window, (float)timestep.getStep());
+                if (changed)
+                    redraw.markDirty();
+                redraw.setAnimating(changed);
+            }
+        }
+
+        // Nada se mexeu no ltimo passo: dorme at um evento em vez de redesenhar
+        // o mesmo frame. Ao acordar, a simulao recomea um passo atrs, para o
+        // que acordou (tecla, clique) j ser simulado na prxima volta
+        if (!redraw.needsRedraw(glfwGetTime()))
+        {
+            PROFILE_SCOPE("Idle");
+            redraw.beginWait();
+            glfwWaitEventsTimeout(redraw.getIdleTimeout());
+            redraw.endWait();
+            timestep.resync(glfwGetTime() - timestep.getStep());
+            continue;
+        }
 
-        glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Se no der para ligar, o F1 volta a desligado em vez de tentar todo frame
+        if (collectPipelineStats != pipelineStats.isEnabled() && !pipelineStats.setEnabled(collectPipelineStats))
+            collectPipelineStats = false;
 
-        glUseProgram(shaderProgram);
+        // Cubo criado neste passo ainda no tem estado anterior
+        float alpha = timestep.getAlpha();
+        glm::mat4 model = cubeModel(lerpCube(previousMain, mainCube, alpha));
+        instanceModels.clear();
+        for (size_t i = 0; i < cubes.size(); ++i)
+            instanceModels.push_back(cubeModel(i < previousCubes.size() ? lerpCube(previousCubes[i], cubes[i], alpha) : cubes[i]));
+
+        // Cubos novos (N/G) reconstroem a BVH; mexer no cubo selecionado s
+        // corrige as caixas do caminho at a raiz, at a rvore degradar demais
+        if (bvh.getInstanceCount() != cubes.size())
+        {
+            instanceBounds.clear();
+            for (const glm::mat4& modelInst : instanceModels)
+                instanceBounds.push_back(transformAabb(modelInst, unitCube));
+            bvh.build(instanceBounds);
+        }
+        else if (selectedCube >= 0)
+        {
+            instanceBounds[selectedCube] = transformAabb(instanceModels[selectedCube], unitCube);
+            bvh.update(selectedCube, instanceBounds[selectedCube]);
+            if (bvh.needsRebuild())
+                bvh.build(instanceBounds);
+        }
+
+        if (pickRequested)
+        {
+            pickCube(window, view, projection, bvh);
+            pickRequested = false;
+        }
+
+        bvh.queryFrustum(projection * view, inFrustum);
+
+        // Antes dos comandos deste frame: os workers testam os cubos enquanto a
+        // GPU ainda desenha o frame anterior. Instncia 0 = cubo principal,
+        // k + 1 = inFrustum[k].
+        if (occlusionCulling)
+        {
+            culler.beginFrame(projection * view);
+            culler.addInstance(model, glm::vec3(-0.5f), glm::vec3(0.5f), &cubePositions);
+            for (uint32_t i : inFrustum)
+                culler.addInstance(instanceModels[i], glm::vec3(-0.5f), glm::vec3(0.5f), &cubePositions);
+            culler.cull();
+        }
+
+        PROFILE_SCOPE("Render");
+        gpuProfiler.beginFrame();
+        pipelineStats.beginFrame();
+        {
+            GPU_PROFILE_SCOPE(gpuProfiler, "Clear");
+            glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        // No modo overdraw todos os cubos usam o shader de cor constante com blend aditivo
+        unsigned int program = showOverdraw ? overdrawProgram : shaderProgram;
+        if (showOverdraw)
+            beginOverdraw();
+        glUseProgram(program);
 
         // set uniforms fixos view e projection
-        int viewLoc = glGetUniformLocation(shaderProgram, "view");
-        int projLoc = glGetUniformLocation(shaderProgram, "projection");
+        int viewLoc = glGetUniformLocation(program, "view");
+        int projLoc = glGetUniformLocation(program, "projection");
         glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
         glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
-        int modelLoc = glGetUniformLocation(shaderProgram, "model");
+        int modelLoc = glGetUniformLocation(program, "model");
 
         // Desenhar cubo principal
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, mainCube.position);
-        model = glm::rotate(model, glm::radians(mainCube.rotX), glm::vec3(1, 0, 0));
-        model = glm::rotate(model, glm::radians(mainCube.rotY), glm::vec3(0, 1, 0));
-        model = glm::rotate(model, glm::radians(mainCube.rotZ), glm::vec3(0, 0, 1));
-        model = glm::scale(model, glm::vec3(mainCube.scale));
         glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
 
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glBindVertexArray(cube.VAO);
+        if (!occlusionCulling || culler.isVisible(0))
+        {
+            GPU_PROFILE_SCOPE(gpuProfiler, "MainCube");
+            PIPELINE_STATS_SCOPE(pipelineStats, "MainCube");
+            glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, nullptr);
+        }
 
         // Desenhar cubos instanciados
-        for (const CubeInstance& c : cubes)
         {
-            glm::mat4 modelInst = glm::mat4(1.0f);
-            modelInst = glm::translate(modelInst, c.position);
-            modelInst = glm::rotate(modelInst, glm::radians(c.rotX), glm::vec3(1, 0, 0));
-            modelInst = glm::rotate(modelInst, glm::radians(c.rotY), glm::vec3(0, 1, 0));
-            modelInst = glm::rotate(modelInst, glm::radians(c.rotZ), glm::vec3(0, 0, 1));
-            modelInst = glm::scale(modelInst, glm::vec3(c.scale));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelInst));
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            GPU_PROFILE_SCOPE(gpuProfiler, "Instances");
+            PIPELINE_STATS_SCOPE(pipelineStats, "Instances");
+            for (size_t k = 0; k < inFrustum.size(); ++k)
+            {
+                if (occlusionCulling && !culler.isVisible((uint32_t)k + 1))
+                    continue;
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(instanceModels[inFrustum[k]]));
+
+                glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, nullptr);
+            }
         }
+        if (showOverdraw)
+            endOverdraw();
+        pipelineStats.endFrame();
+        gpuProfiler.endFrame();
 
-        glfwSwapBuffers(window);
+        {
+            PROFILE_SCOPE("Swap");
+            glfwSwapBuffers(window);
+        }
+        redraw.frameDrawn(glfwGetTime());
         glfwPollEvents();
     }
 
+    gpuProfiler.printStats();
+    gpuProfiler.destroy();
+    pipelineStats.destroy();
+    pipelineStats.printReport();
+    culler.printStats();
+    timestep.printStats();
+    redraw.printStats();
+    PROFILE_EXPORT("profile_trace.json");
+
     // Limpeza
-    glDeleteVertexArrays(1, &VAO);
+    primitives.printStats();
+    primitives.destroy();
     glDeleteProgram(shaderProgram);
+    glDeleteProgram(overdrawProgram);
 
     glfwTerminate();
     return 0;
@@ -15,10 +15,15 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Profiler.h"
+#include "RedrawTracker.h"
+#include "ShaderCache.h"
+
 using namespace std;
 
 // ======= Prottipos =======
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void window_refresh_callback(GLFWwindow* window);
 GLuint setupShader();
 struct Geometry loadGeometry(const char* filepath);
 
@@ -32,6 +37,10 @@ struct Geometry {
 
 // ======= Variveis globais =======
 bool rotateX = false, rotateY = false, rotateZ = false;
+
+// Desenho sob demanda (F4 liga/desliga): s redesenha quando uma tecla muda a
+// cena ou com a rotao ligada (a 60 frames por segundo); parado, dorme
+RedrawTracker redraw(1.0 / 60.0);
 glm::vec3 translate_vector = { 0.0f, 0.0f, 0.0f };
 glm::vec3 scale_vector = { 1.0f, 1.0f, 1.0f };
 
@@ -81,6 +90,7 @@ int main()
     glfwMakeContextCurrent(window);
 
     glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -108,8 +118,18 @@ int main()
 
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        PROFILE_FRAME();
+        {
+            PROFILE_SCOPE("Input");
+            redraw.setAnimating(rotateX || rotateY || rotateZ);
+            redraw.beginWait();
+            glfwWaitEventsTimeout(redraw.getWaitTimeout(glfwGetTime()));
+            redraw.endWait();
+        }
+        if (!redraw.needsRedraw(glfwGetTime()))
+            continue;
 
+        PROFILE_SCOPE("Render");
         glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -136,9 +156,15 @@ int main()
         glBindVertexArray(0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
+        PROFILE_SCOPE("Swap");
         glfwSwapBuffers(window);
+        redraw.frameDrawn(glfwGetTime());
     }
 
+    redraw.printStats();
+
+    PROFILE_EXPORT("profile_trace.json");
+
     glDeleteVertexArrays(1, &g.VAO);
     glDeleteTextures(1, &g.textureID);
     glfwTerminate();
@@ -149,6 +175,15 @@ int main()
 // ======= CALLBACK DE TECLADO =======
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+    if (action == GLFW_PRESS)
+        redraw.markDirty();
+
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        redraw.setEnabled(!redraw.isEnabled());
+        cout << "Desenho sob demanda " << (redraw.isEnabled() ? "ligado" : "desligado") << endl;
+    }
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 
@@ -186,47 +221,19 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         scale_vector += glm::vec3(-0.1f);
 }
 
+// Janela exposta ou redimensionada: o contedo precisa ser redesenhado
+void window_refresh_callback(GLFWwindow* window)
+{
+    redraw.markDirty();
+}
+
 // ======= SETUP SHADER =======
 GLuint setupShader()
 {
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Programa vem do cache de binarios quando possivel; so compila no cache frio
+    ShaderCache cache("shader_cache", (GLADloadproc)glfwGetProcAddress);
+    GLuint shaderProgram = cache.getProgram("textured", vertexShaderSource, fragmentShaderSource);
+    cache.printReport();
 
     return shaderProgram;
 }
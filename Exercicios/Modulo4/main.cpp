@@ -14,23 +14,30 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Geometry.h"
+#include "LightmapBaker.h"
+#include "Profiler.h"
+#include "RedrawTracker.h"
+#include "ShaderCache.h"
+
 using namespace std;
 
 // ======= Prottipos =======
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
-GLuint setupShader();
+void window_refresh_callback(GLFWwindow* window);
+void setupShaders(GLuint& phongProgram, GLuint& lightmapProgram);
 struct Geometry loadGeometry(const char* filepath);
+bool bakeLightmap(const glm::mat4& model, GLuint& lightmapTexture);
 
 // ======= Estrutura =======
-struct Geometry {
-    GLuint VAO;
-    GLuint vertexCount;
-    GLuint textureID = 0;
-    string textureFilePath;
-};
+// Geometry (VAO, vertexCount, textureID, textureFilePath) vem do Common/Geometry.h
 
 // ======= Variveis globais =======
 bool rotateX = false, rotateY = false, rotateZ = false;
+
+// Desenho sob demanda (F4 liga/desliga): s redesenha quando uma tecla muda a
+// cena ou com a rotao ligada (a 60 frames por segundo); parado, dorme
+RedrawTracker redraw(1.0 / 60.0);
 glm::vec3 translate_vector = { 0.0f, 0.0f, 0.0f };
 glm::vec3 scale_vector = { 1.0f, 1.0f, 1.0f };
 
@@ -39,6 +46,10 @@ glm::vec3 lightPos = glm::vec3(2.0f, 3.0f, 4.0f);
 glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
 glm::vec3 camPos = glm::vec3(0.0f, 0.0f, 3.0f);
 
+// M alterna entre o Phong e o lightmap assado com a pose atual
+bool toggleLightmap = false;
+bool useLightmap = false;
+
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 
 // ======= Shaders GLSL =======
@@ -110,6 +121,26 @@ void main()
 }
 )";
 
+// Fragment shader com a iluminao esttica do lightmap (difuso, sombras e
+// luz indireta assados na CPU) no lugar do Phong
+const GLchar* lightmapFragmentShaderSource = R"(
+#version 450 core
+in vec2 texCoord;
+
+uniform sampler2D tex_buffer;
+uniform sampler2D lightmap;
+
+out vec4 color;
+
+void main()
+{
+    // O lightmap guarda v = 0 na linha 0; texCoord j vem com o v invertido
+    vec3 light = texture(lightmap, vec2(texCoord.x, 1.0 - texCoord.y)).rgb;
+    vec3 texColor = texture(tex_buffer, texCoord).rgb;
+    color = vec4(light * texColor, 1.0);
+}
+)";
+
 // ======= MAIN =======
 int main()
 {
@@ -119,6 +150,7 @@ int main()
     glfwMakeContextCurrent(window);
 
     glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -133,7 +165,8 @@ int main()
     glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
     glViewport(0, 0, fbWidth, fbHeight);
 
-    GLuint shaderID = setupShader();
+    GLuint shaderID, lightmapShaderID;
+    setupShaders(shaderID, lightmapShaderID);
 
     Geometry g = loadGeometry("assets/Modelos3d/Suzanne.obj");
     if (g.VAO == 0)
@@ -162,12 +195,29 @@ int main()
     glUniform3fv(camPosLoc, 1, glm::value_ptr(camPos));
     glUniform3fv(lightColorLoc, 1, glm::value_ptr(lightColor));
 
+    // Programa do lightmap: a textura na unidade 0 e o lightmap na 1
+    glUseProgram(lightmapShaderID);
+    GLint lightmapModelLoc = glGetUniformLocation(lightmapShaderID, "model");
+    glUniform1i(glGetUniformLocation(lightmapShaderID, "tex_buffer"), 0);
+    glUniform1i(glGetUniformLocation(lightmapShaderID, "lightmap"), 1);
+    GLuint lightmapTexture = 0;
+
     glEnable(GL_DEPTH_TEST);
 
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        PROFILE_FRAME();
+        {
+            PROFILE_SCOPE("Input");
+            redraw.setAnimating(rotateX || rotateY || rotateZ);
+            redraw.beginWait();
+            glfwWaitEventsTimeout(redraw.getWaitTimeout(glfwGetTime()));
+            redraw.endWait();
+        }
+        if (!redraw.needsRedraw(glfwGetTime()))
+            continue;
 
+        PROFILE_SCOPE("Render");
         glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -185,19 +235,36 @@ int main()
 
         model = glm::scale(model, scale_vector + glm::vec3(-0.7f, -0.7f, -0.7f));
 
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        if (toggleLightmap)
+        {
+            toggleLightmap = false;
+            useLightmap = !useLightmap && bakeLightmap(model, lightmapTexture);
+        }
 
+        glUseProgram(useLightmap ? lightmapShaderID : shaderID);
+        glUniformMatrix4fv(useLightmap ? lightmapModelLoc : modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, useLightmap ? lightmapTexture : 0);
+        glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, g.textureID);
         glBindVertexArray(g.VAO);
         glDrawArrays(GL_TRIANGLES, 0, g.vertexCount);
         glBindVertexArray(0);
         glBindTexture(GL_TEXTURE_2D, 0);
 
+        PROFILE_SCOPE("Swap");
         glfwSwapBuffers(window);
+        redraw.frameDrawn(glfwGetTime());
     }
 
+    redraw.printStats();
+
+    PROFILE_EXPORT("profile_trace.json");
+
     glDeleteVertexArrays(1, &g.VAO);
     glDeleteTextures(1, &g.textureID);
+    glDeleteTextures(1, &lightmapTexture);
     glfwTerminate();
 
     return 0;
@@ -206,6 +273,15 @@ int main()
 // ======= CALLBACK DE TECLADO =======
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+    if (action == GLFW_PRESS)
+        redraw.markDirty();
+
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        redraw.setEnabled(!redraw.isEnabled());
+        cout << "Desenho sob demanda " << (redraw.isEnabled() ? "ligado" : "desligado") << endl;
+    }
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 
@@ -241,51 +317,66 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
     if (key == GLFW_KEY_L && action == GLFW_PRESS)
         scale_vector += glm::vec3(-0.1f);
+
+    if (key == GLFW_KEY_M && action == GLFW_PRESS)
+        toggleLightmap = true;
 }
 
-// ======= SETUP SHADER =======
-GLuint setupShader()
+// Janela exposta ou redimensionada: o contedo precisa ser redesenhado
+void window_refresh_callback(GLFWwindow* window)
 {
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << endl;
-    }
+    redraw.markDirty();
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+// ======= SETUP SHADER =======
+void setupShaders(GLuint& phongProgram, GLuint& lightmapProgram)
+{
+    // Programas vem do cache de binarios quando possivel; so compilam no cache frio
+    ShaderCache cache("shader_cache", (GLADloadproc)glfwGetProcAddress);
+    size_t phong = cache.request("phong", { { GL_VERTEX_SHADER, vertexShaderSource }, { GL_FRAGMENT_SHADER, fragmentShaderSource } });
+    size_t lightmap = cache.request("lightmap",
+        { { GL_VERTEX_SHADER, vertexShaderSource }, { GL_FRAGMENT_SHADER, lightmapFragmentShaderSource } });
+    cache.build();
+    cache.printReport();
+
+    phongProgram = cache.program(phong);
+    lightmapProgram = cache.program(lightmap);
+}
 
-    return shaderProgram;
+// ======= BAKE DO LIGHTMAP =======
+// Luz direta com sombras, luz indireta e ocluso ambiente da Suzanne na pose
+// "model", traadas na CPU em todos os ncleos e gravadas nas UVs do .obj.
+// O resultado fica em bake_cache (o mesmo bake s l o arquivo) e em lightmap.hdr.
+bool bakeLightmap(const glm::mat4& model, GLuint& lightmapTexture)
+{
+    MeshData mesh;
+    ImageData image;
+    if (!parseObj("assets/Modelos3d/Suzanne.obj", mesh) || !decodeImage(mesh.texturePath, true, image))
+        return false;
+
+    SceneMaterial material;
+    material.texture = &image;
+
+    CpuScene scene;
+    scene.lights.push_back({ lightPos, lightColor });
+    scene.meshes.push_back({ &mesh, model, material });
+
+    LightmapSettings settings;
+    settings.size = 512;
+
+    JobSystem jobs;
+    DiskCache cache("bake_cache");
+    LightmapBaker baker(&jobs, &cache);
+    baker.setScene(scene);
+    Lightmap lightmap;
+    if (!baker.bake(0, settings, lightmap))
+        return false;
+    baker.printStats();
+    writeHdr("lightmap.hdr", lightmap);
+
+    glDeleteTextures(1, &lightmapTexture);
+    lightmapTexture = uploadLightmap(lightmap);
+    return true;
 }
 
 // ======= LOAD GEOMETRY =======
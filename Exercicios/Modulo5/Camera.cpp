@@ -60,30 +60,30 @@ void Camera::initCamera(GLuint shaderID)
     glUniformMatrix4fv(m_viewLoc, 1, GL_FALSE, glm::value_ptr(view));
 }
 
-void Camera::update(GLFWwindow* window)
+void Camera::update(GLFWwindow* window, float deltaTime)
 {
-    processInput(window);
+    processInput(window, deltaTime);
     glm::mat4 view = glm::lookAt(m_position, m_position + m_lookAt, m_cameraUp);
     glUniformMatrix4fv(m_viewLoc, 1, GL_FALSE, glm::value_ptr(view));
 }
 
-void Camera::processInput(GLFWwindow* window)
+void Camera::processInput(GLFWwindow* window, float deltaTime)
 {
-    const float speed = 0.1f;
+    float step = speed * deltaTime;
 
     glm::vec3 Right = glm::normalize(glm::cross(m_lookAt, m_cameraUp));
     glm::vec3 Up = glm::normalize(glm::cross(Right, m_lookAt));
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        m_position += m_lookAt * speed;
+        m_position += m_lookAt * step;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        m_position -= m_lookAt * speed;
+        m_position -= m_lookAt * step;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        m_position -= Right * speed;
+        m_position -= Right * step;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        m_position += Right * speed;
+        m_position += Right * step;
     if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-        m_position += Up * speed;
+        m_position += Up * step;
     if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-        m_position -= Up * speed;
+        m_position -= Up * step;
 }
\ No newline at end of file
@@ -12,7 +12,9 @@ public:
 	void setLookAt(glm::vec3 lookAt) { m_lookAt = lookAt; }
 	void mouseCallback(double xpos, double ypos);
 	void initCamera(GLuint shaderID);
-	void update(struct GLFWwindow* window);
+	void update(struct GLFWwindow* window, float deltaTime);
+	// Movimento pelo teclado em deltaTime segundos, sem GL (a simulacao chama a cada passo)
+	void processInput(struct GLFWwindow* window, float deltaTime);
 	glm::vec3 getPosition() const { return m_position; }
 	glm::vec3 getLookAt() const { return m_lookAt; }
 	glm::vec3 getCameraUp() const { return m_cameraUp; }
@@ -21,7 +23,6 @@ public:
 		return glm::lookAt(m_position, m_position + m_lookAt, m_cameraUp);
 	}
 private:
-	void processInput(struct GLFWwindow* window);
 	glm::vec3 m_position;
 	glm::vec3 m_lookAt = glm::vec3(0.0f, 0.0f, 0.0f);
 	glm::vec3 m_cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
@@ -39,4 +40,7 @@ private:
 
 	// Sensibilidade do mouse
 	float sensitivity = 0.1f;
+
+	// Unidades por segundo (os antigos 0.1 por frame a 60 Hz)
+	float speed = 6.0f;
 };
@@ -0,0 +1,16 @@
+#version 450 core
+
+// Iluminacao difusa assada por vertice (VertexBaker) na cor do vertice:
+// ambiente com oclusao + difuso com sombras. So falta a textura.
+in vec2 texCoord;
+in vec4 vertexColor;
+
+uniform sampler2D tex_buffer;
+
+out vec4 color;
+
+void main()
+{
+    vec3 texColor = texture(tex_buffer, texCoord).rgb;
+    color = vec4(vertexColor.rgb * texColor, 1.0);
+}
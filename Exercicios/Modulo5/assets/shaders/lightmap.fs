@@ -0,0 +1,18 @@
+#version 450 core
+
+// Iluminacao assada no lightmap (LightmapBaker) nas UVs da malha: ambiente
+// com oclusao + difuso com sombras e luz indireta. So falta a textura.
+in vec2 texCoord;
+
+uniform sampler2D tex_buffer;
+uniform sampler2D lightmap;
+
+out vec4 color;
+
+void main()
+{
+    // phong.vs inverte o v para a textura; o lightmap guarda v = 0 na linha 0
+    vec3 light = texture(lightmap, vec2(texCoord.x, 1.0 - texCoord.y)).rgb;
+    vec3 texColor = texture(tex_buffer, texCoord).rgb;
+    color = vec4(light * texColor, 1.0);
+}
@@ -0,0 +1,39 @@
+#version 450 core
+
+in vec2 texCoord;
+in vec4 vertexColor;
+in vec3 vNormal;
+in vec3 fragPos;
+
+uniform sampler2D tex_buffer;
+
+uniform vec3 lightPos;
+uniform vec3 camPos;
+uniform vec3 lightColor;
+
+uniform vec3 ka;
+uniform vec3 kd;
+uniform vec3 ks;
+uniform float q;
+
+out vec4 color;
+
+void main()
+{
+    vec3 ambient = lightColor * ka;
+
+    vec3 N = normalize(vNormal);
+    vec3 L = normalize(lightPos - fragPos);
+    float diff = max(dot(N, L), 0.0);
+    vec3 diffuse = diff * lightColor * kd;
+
+    vec3 V = normalize(camPos - fragPos);
+    vec3 R = reflect(-L, N);
+    float spec = pow(max(dot(R, V), 0.0), q);
+    vec3 specular = spec * ks * lightColor;
+
+    vec3 texColor = texture(tex_buffer, texCoord).rgb;
+
+    vec3 result = (ambient + diffuse) * texColor + specular;
+    color = vec4(result, 1.0);
+}
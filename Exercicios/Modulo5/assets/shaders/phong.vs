@@ -0,0 +1,25 @@
+#version 450 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec2 texc;
+layout (location = 3) in vec3 normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texCoord;
+out vec4 vertexColor;
+out vec3 vNormal;
+out vec3 fragPos;
+
+void main()
+{
+    fragPos = vec3(model * vec4(position, 1.0));
+    vNormal = mat3(transpose(inverse(model))) * normal;
+
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    vertexColor = vec4(color, 1.0);
+    texCoord = vec2(texc.x, 1.0 - texc.y);
+}
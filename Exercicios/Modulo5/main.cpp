@@ -4,6 +4,7 @@
 #include <sstream>
 #include <vector>
 #include <cassert>
+#include <atomic>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -16,94 +17,114 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Camera.h"
+#include "CpuScene.h"
+#include "FixedTimestep.h"
+#include "Geometry.h"
+#include "GpuProfiler.h"
+#include "HotReload.h"
+#include "JobSystem.h"
+#include "LightmapBaker.h"
+#include "LodGenerator.h"
+#include "PipelineStats.h"
+#include "Profiler.h"
+#include "RedrawTracker.h"
+#include "RayTracer.h"
+#include "RenderThread.h"
+#include "ShaderCache.h"
+#include "VertexBaker.h"
 
 using namespace std;
 
-const GLchar* vertexShaderSource = R"(
-#version 450 core
+// Diretorio de assets da arvore de codigo (definido no CMakeLists). Os shaders
+// ficam em assets/shaders e sao recarregados quando o arquivo e salvo.
+#ifndef ASSETS_SOURCE_DIR
+#define ASSETS_SOURCE_DIR "assets"
+#endif
 
-layout (location = 0) in vec3 position;
-layout (location = 1) in vec3 color;
-layout (location = 2) in vec2 texc;
-layout (location = 3) in vec3 normal;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-out vec2 texCoord;
-out vec4 vertexColor;
-out vec3 vNormal;
-out vec3 fragPos;
-
-void main()
-{
-    fragPos = vec3(model * vec4(position, 1.0));
-    vNormal = mat3(transpose(inverse(model))) * normal;
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos);
+void window_refresh_callback(GLFWwindow* window);
+// Phong por pixel, luz assada nos vertices (B) ou no lightmap (M)
+enum Lighting { PHONG, BAKED_VERTICES, BAKED_LIGHTMAP, LIGHTING_COUNT };
 
-    gl_Position = projection * view * model * vec4(position, 1.0);
-    vertexColor = vec4(color, 1.0);
-    texCoord = vec2(texc.x, 1.0 - texc.y);
-}
-)";
+// Programa de cada modo: shaders/phong.vs + shaders/<nome>.fs
+const char* lightingPrograms[LIGHTING_COUNT] = { "phong", "baked", "lightmap" };
 
-const GLchar* fragmentShaderSource = R"(
-#version 450 core
+void setupShaders(const HotReload& assets, GLuint programs[LIGHTING_COUNT]);
+bool bakeVertexLighting(const HotReload& assets, JobSystem& jobs, const glm::mat4& model, Geometry& baked);
+bool bakeLightmap(const HotReload& assets, JobSystem& jobs, const glm::mat4& model, GLuint& lightmapTexture);
+bool buildLod(const HotReload& assets, LodGeometry& lod);
+void renderRayTracedStill(const HotReload& assets, JobSystem& jobs, const glm::mat4& model, const glm::mat4& view,
+    const glm::mat4& projection, const glm::vec3& camPos);
 
-in vec2 texCoord;
-in vec4 vertexColor;
-in vec3 vNormal;
-in vec3 fragPos;
+bool rotateX = false, rotateY = false, rotateZ = false;
+glm::vec3 translate_vector = { 0.0f, 0.0f, 0.0f };
+glm::vec3 scale_vector = { 1.0f, 1.0f, 1.0f };
 
-uniform sampler2D tex_buffer;
+// F1 liga/desliga os contadores de pipeline (pipeline_stats.csv); a thread
+// de render volta para false se nao der para ligar
+std::atomic<bool> collectPipelineStats{ false };
 
-uniform vec3 lightPos;
-uniform vec3 camPos;
-uniform vec3 lightColor;
+// F5 grava a vista atual com o RayTracer (raytrace.ppm e raytrace.pfm); cada
+// tecla conta um pedido, atendido pela thread de render
+uint32_t stillRequests = 0;
 
-uniform vec3 ka;
-uniform vec3 kd;
-uniform vec3 ks;
-uniform float q;
+// K liga/desliga os niveis de detalhe (escolhidos pelo erro projetado na tela)
+bool useLod = true;
 
-out vec4 color;
+// V liga/desliga o vsync; a velocidade do movimento nao muda
+bool vsync = true;
 
-void main()
-{
-    vec3 ambient = lightColor * ka;
+// Desenho sob demanda (F4 liga/desliga): com a cena e a camera paradas a
+// simulacao e a thread de render dormem ate o proximo evento. A espera
+// ociosa acorda 4 vezes por segundo so para o hot reload olhar os arquivos
+RedrawTracker redraw(0.0, 0.25);
 
-    vec3 N = normalize(vNormal);
-    vec3 L = normalize(lightPos - fragPos);
-    float diff = max(dot(N, L), 0.0);
-    vec3 diffuse = diff * lightColor * kd;
+// B/M alternam para a luz assada nos vertices (baked.fs) ou no lightmap
+// (lightmap.fs), calculada com a pose atual. O bake roda na thread de render,
+// que devolve em activeLighting o modo em uso (PHONG se o bake falhar)
+Lighting requestedLighting = PHONG;
+uint32_t lightingRequests = 0;
+std::atomic<int> activeLighting{ PHONG };
 
-    vec3 V = normalize(camPos - fragPos);
-    vec3 R = reflect(-L, N);
-    float spec = pow(max(dot(R, V), 0.0), q);
-    vec3 specular = spec * ks * lightColor;
+// Passo fixo da simulacao (teclado, camera e pose do objeto), independente
+// do ritmo da thread de render
+const double SIMULATION_STEP = 1.0 / 60.0;
 
-    vec3 texColor = texture(tex_buffer, texCoord).rgb;
+// Limite de frames da thread de render; 0 = so o vsync (ou sem limite com V)
+const double RENDER_FPS_LIMIT = 0.0;
 
-    vec3 result = (ambient + diffuse) * texColor + specular;
-    color = vec4(result, 1.0);
-}
-)";
+// Estado de um passo da simulacao. A thread de render desenha a mistura dos
+// dois ultimos passos conforme o tempo desde o ultimo, entao o movimento sai
+// suave com qualquer taxa de frames
+struct SimulationState
+{
+    glm::vec3 translate = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    float angle = 0.0f;
+    glm::vec3 camPos = glm::vec3(0.0f);
+    glm::vec3 camLookAt = glm::vec3(0.0f);
+};
 
-void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
-void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos);
-GLuint setupShader();
-struct Geometry loadGeometry(const char* filepath);
-
-struct Geometry {
-    GLuint VAO;
-    GLuint vertexCount;
-    GLuint textureID = 0;
-    string textureFilePath;
+// Tudo o que a thread de render precisa de um passo da simulacao
+struct FrameSnapshot
+{
+    SimulationState previous;
+    SimulationState current;
+    double stepTime = 0.0;                      // glfwGetTime() em que current passou a valer
+    glm::vec3 rotationAxis = glm::vec3(0.0f);   // zero = sem rotacao
+    Lighting lighting = PHONG;
+    uint32_t lightingRequests = 0;
+    uint32_t stillRequests = 0;
+    bool useLod = true;
+    bool collectPipelineStats = false;
+    bool vsync = true;
+    bool onDemand = true;
 };
 
-bool rotateX = false, rotateY = false, rotateZ = false;
-glm::vec3 translate_vector = { 0.0f, 0.0f, 0.0f };
-glm::vec3 scale_vector = { 1.0f, 1.0f, 1.0f };
+SimulationState mixStates(const SimulationState& a, const SimulationState& b, float t);
+bool sameState(const SimulationState& a, const SimulationState& b);
+glm::mat4 objectModel(const SimulationState& state, const glm::vec3& rotationAxis);
 
 glm::vec3 lightPos = glm::vec3(2.0f, 3.0f, 4.0f);
 glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -124,6 +145,7 @@ int main()
     }
     glfwMakeContextCurrent(window);
     glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -138,34 +160,27 @@ int main()
     glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
     glViewport(0, 0, fbWidth, fbHeight);
 
-    GLuint shaderID = setupShader();
+    JobSystem jobs;
+    AssetLoader loader(jobs);
+    HotReload hotReload(HotReload::resolveAssetsDir(ASSETS_SOURCE_DIR, "assets"), loader,
+        (GLADloadproc)glfwGetProcAddress);
+
+    GLuint programs[LIGHTING_COUNT];
+    setupShaders(hotReload, programs);
 
-    Geometry g = loadGeometry("assets/Modelos3d/Suzanne.obj");
+    Geometry g = loadGeometry(hotReload.path("Modelos3D/Suzanne.obj"), hotReload.path("tex/pixelWall.png"), false);
     if (g.VAO == 0)
         return -1;
 
-    glUseProgram(shaderID);
-
-    GLint modelLoc = glGetUniformLocation(shaderID, "model");
-    GLint viewLoc = glGetUniformLocation(shaderID, "view");
-    GLint projLoc = glGetUniformLocation(shaderID, "projection");
-
-    GLint kaLoc = glGetUniformLocation(shaderID, "ka");
-    GLint kdLoc = glGetUniformLocation(shaderID, "kd");
-    GLint ksLoc = glGetUniformLocation(shaderID, "ks");
-    GLint qLoc = glGetUniformLocation(shaderID, "q");
+    // Mesma malha com a iluminacao estatica na cor do vertice (criada no B) e
+    // lightmap nas UVs da malha (criado no M)
+    Geometry bakedGeometry;
+    GLuint lightmapTexture = 0;
 
-    GLint lightPosLoc = glGetUniformLocation(shaderID, "lightPos");
-    GLint camPosLoc = glGetUniformLocation(shaderID, "camPos");
-    GLint lightColorLoc = glGetUniformLocation(shaderID, "lightColor");
-
-    glUniform3f(kaLoc, 0.1f, 0.1f, 0.1f);
-    glUniform3f(kdLoc, 0.7f, 0.7f, 0.7f);
-    glUniform3f(ksLoc, 1.0f, 1.0f, 1.0f);
-    glUniform1f(qLoc, 32.0f);
-
-    glUniform3fv(lightPosLoc, 1, glm::value_ptr(lightPos));
-    glUniform3fv(lightColorLoc, 1, glm::value_ptr(lightColor));
+    // Niveis de detalhe da mesma malha, gerados na carga (e refeitos no hot reload)
+    LodGeometry lod;
+    GLuint lodSourceVAO = 0;
+    int lodLevel = -1;
 
     Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
     g_camera = &camera;
@@ -174,56 +189,293 @@ int main()
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
-    glEnable(GL_DEPTH_TEST);
+    GLint modelLoc, viewLoc, camPosLoc;
 
-    glUniform1i(glGetUniformLocation(shaderID, "tex_buffer"), 0);
+    // Modo de luz em uso; so a thread de render mexe nele depois do start
+    Lighting lighting = PHONG;
 
-    while (!glfwWindowShouldClose(window))
+    // Uniforms que so mudam quando o programa e trocado (no inicio ou num hot reload)
+    auto configureProgram = [&](GLuint program)
+        {
+            glUseProgram(program);
+
+            modelLoc = glGetUniformLocation(program, "model");
+            viewLoc = glGetUniformLocation(program, "view");
+            camPosLoc = glGetUniformLocation(program, "camPos");
+
+            glUniform3f(glGetUniformLocation(program, "ka"), 0.1f, 0.1f, 0.1f);
+            glUniform3f(glGetUniformLocation(program, "kd"), 0.7f, 0.7f, 0.7f);
+            glUniform3f(glGetUniformLocation(program, "ks"), 1.0f, 1.0f, 1.0f);
+            glUniform1f(glGetUniformLocation(program, "q"), 32.0f);
+
+            glUniform3fv(glGetUniformLocation(program, "lightPos"), 1, glm::value_ptr(lightPos));
+            glUniform3fv(glGetUniformLocation(program, "lightColor"), 1, glm::value_ptr(lightColor));
+
+            glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniform1i(glGetUniformLocation(program, "tex_buffer"), 0);
+            glUniform1i(glGetUniformLocation(program, "lightmap"), 1);
+        };
+    configureProgram(programs[PHONG]);
+
+    // So o programa em uso e reconfigurado; os outros sao configurados na troca (B/M)
+    for (int i = 0; i < LIGHTING_COUNT; ++i)
     {
-        glfwPollEvents();
+        hotReload.watchProgram(&programs[i], lightingPrograms[i], "shaders/phong.vs",
+            string("shaders/") + lightingPrograms[i] + ".fs",
+            [&, i](GLuint program) { if (lighting == i) configureProgram(program); });
+    }
+    hotReload.watchGeometry(&g, "Modelos3D/Suzanne.obj", "tex/pixelWall.png", false);
+
+    glEnable(GL_DEPTH_TEST);
 
-        glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    GpuProfiler gpuProfiler;
+    PipelineStats pipelineStats("pipeline_stats.csv");
+
+    // Pedidos (B/M/F5) ja atendidos pela thread de render
+    uint32_t handledLightingRequests = 0;
+    uint32_t handledStillRequests = 0;
+    bool requestedPipelineStats = false;
+
+    // A thread principal bombeia os eventos e simula; a de render e a dona do
+    // contexto GL e desenha o snapshot mais recente, entao um swap preso no
+    // vsync nao atrasa o teclado nem a simulacao
+    TripleBuffer<FrameSnapshot> frames;
+    RenderThread renderThread;
+    RenderThreadCallbacks callbacks;
+    bool swapVsync = true;
+    bool settled = false;
+    glm::vec3 camUp = camera.getCameraUp();
+    callbacks.begin = [&]()
+        {
+            glfwMakeContextCurrent(window);
+            glfwSwapInterval(1);
+        };
+    callbacks.swap = [&]() { glfwSwapBuffers(window); };
+    callbacks.end = [&]() { glfwMakeContextCurrent(nullptr); };
+    callbacks.frame = [&]() -> bool
+        {
+            // Sem passo novo, o mesmo snapshot serve com um alpha maior
+            bool fresh = frames.acquire();
+            const FrameSnapshot& frame = frames.front();
+
+            // Troca shaders/assets recarregados antes de comecar o frame
+            bool reloaded = hotReload.update();
+
+            // Sob demanda: sem snapshot novo, sem asset trocado e com a
+            // interpolacao ja no fim, a tela ja mostra o estado certo
+            float alpha = glm::clamp((float)((glfwGetTime() - frame.stepTime) / SIMULATION_STEP), 0.0f, 1.0f);
+            if (frame.onDemand && !fresh && !reloaded && settled)
+                return false;
+            settled = alpha >= 1.0f;
+
+            SimulationState state = mixStates(frame.previous, frame.current, alpha);
+            glm::mat4 model = objectModel(state, frame.rotationAxis);
+            glm::mat4 view = glm::lookAt(state.camPos, state.camPos + state.camLookAt, camUp);
+            glm::vec3 camPos = state.camPos;
+
+            if (frame.vsync != swapVsync)
+            {
+                swapVsync = frame.vsync;
+                glfwSwapInterval(swapVsync ? 1 : 0);
+            }
 
-        float angle = (float)glfwGetTime();
+            if (g.VAO != lodSourceVAO)
+            {
+                lodSourceVAO = g.VAO;
+                buildLod(hotReload, lod);
+            }
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, translate_vector + glm::vec3(0.0f, 0.25f, 0.0f));
+            // Cada pedido do F1 e tentado uma vez so; snapshots antigos ainda
+            // com o pedido que falhou nao tentam de novo
+            if (frame.collectPipelineStats != requestedPipelineStats)
+            {
+                requestedPipelineStats = frame.collectPipelineStats;
+                if (!pipelineStats.setEnabled(requestedPipelineStats))
+                    collectPipelineStats = false;
+            }
 
-        if (rotateX)
-            model = glm::rotate(model, angle, glm::vec3(1, 0, 0));
-        else if (rotateY)
-            model = glm::rotate(model, angle, glm::vec3(0, 1, 0));
-        else if (rotateZ)
-            model = glm::rotate(model, angle, glm::vec3(0, 0, 1));
+            gpuProfiler.beginFrame();
+            pipelineStats.beginFrame();
+            {
+                GPU_PROFILE_SCOPE(gpuProfiler, "Clear");
+                glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
 
-        model = glm::scale(model, scale_vector * 0.7f);
+            if (frame.lightingRequests != handledLightingRequests)
+            {
+                handledLightingRequests = frame.lightingRequests;
+                bool baked = frame.lighting == PHONG ||
+                    (frame.lighting == BAKED_VERTICES && bakeVertexLighting(hotReload, jobs, model, bakedGeometry)) ||
+                    (frame.lighting == BAKED_LIGHTMAP && bakeLightmap(hotReload, jobs, model, lightmapTexture));
+                lighting = baked ? frame.lighting : PHONG;
+                activeLighting = lighting;
+                configureProgram(programs[lighting]);
+            }
 
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            glUniform3fv(camPosLoc, 1, glm::value_ptr(camPos));
 
-        camera.update(window);
+            if (frame.stillRequests != handledStillRequests)
+            {
+                handledStillRequests = frame.stillRequests;
+                renderRayTracedStill(hotReload, jobs, model, view, projection, camPos);
+            }
 
-        glm::mat4 view = camera.GetViewMatrix();
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            {
+                PROFILE_SCOPE("Submit");
+                const char* passNames[LIGHTING_COUNT] = { "Phong", "Baked", "Lightmap" };
+                GPU_PROFILE_SCOPE(gpuProfiler, passNames[lighting]);
+                PIPELINE_STATS_SCOPE(pipelineStats, passNames[lighting]);
+                const Geometry& drawn = lighting == BAKED_VERTICES ? bakedGeometry : g;
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, lighting == BAKED_LIGHTMAP ? lightmapTexture : 0);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, drawn.textureID);
+
+                // Os niveis mantem as UVs, entao servem tambem para o lightmap; a luz
+                // assada nos vertices so existe na malha inteira
+                if (frame.useLod && lighting != BAKED_VERTICES && !lod.levels.empty())
+                {
+                    int level = selectLod(lod, model, camPos, lodProjectionScale(projection, fbHeight), 1.0f);
+                    if (level != lodLevel)
+                    {
+                        lodLevel = level;
+                        cout << "LOD: nivel " << level << " (" << lod.levels[level].count / 3 << " triangulos)" << endl;
+                    }
+                    glBindVertexArray(lod.geometry.VAO);
+                    glDrawArrays(GL_TRIANGLES, lod.levels[level].first, lod.levels[level].count);
+                }
+                else
+                {
+                    glBindVertexArray(drawn.VAO);
+                    glDrawArrays(GL_TRIANGLES, 0, drawn.vertexCount);
+                }
+                glBindVertexArray(0);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            pipelineStats.endFrame();
+            gpuProfiler.endFrame();
+            return true;
+        };
+
+    // Estado da simulacao nos dois ultimos passos; o angulo so anda com a
+    // rotacao ligada, entao objeto parado = estado igual entre os passos
+    FixedTimestep timestep(SIMULATION_STEP);
+    float rotationAngle = 0.0f;
+    auto simulationState = [&]()
+        {
+            SimulationState state;
+            state.translate = translate_vector;
+            state.scale = scale_vector;
+            state.angle = rotationAngle;
+            state.camPos = camera.getPosition();
+            state.camLookAt = camera.getLookAt();
+            return state;
+        };
+    SimulationState previousState = simulationState();
+    SimulationState currentState = previousState;
+
+    auto publishSnapshot = [&]()
+        {
+            FrameSnapshot& frame = frames.back();
+            frame.previous = previousState;
+            frame.current = currentState;
+            frame.stepTime = timestep.getStepTime();
+            frame.rotationAxis = rotateX ? glm::vec3(1, 0, 0) : rotateY ? glm::vec3(0, 1, 0) :
+                rotateZ ? glm::vec3(0, 0, 1) : glm::vec3(0.0f);
+            frame.lighting = requestedLighting;
+            frame.lightingRequests = lightingRequests;
+            frame.stillRequests = stillRequests;
+            frame.useLod = useLod;
+            frame.collectPipelineStats = collectPipelineStats;
+            frame.vsync = vsync;
+            frame.onDemand = redraw.isEnabled();
+            frames.publish();
+            renderThread.notify();
+        };
+
+    glfwMakeContextCurrent(nullptr);
+    renderThread.setContinuous(true, RENDER_FPS_LIMIT);
+    renderThread.start(callbacks);
+    timestep.advance(glfwGetTime());
+    publishSnapshot();
 
-        glm::vec3 camPos = camera.getPosition();
-        glUniform3fv(camPosLoc, 1, glm::value_ptr(camPos));
+    while (!glfwWindowShouldClose(window))
+    {
+        PROFILE_FRAME();
+        {
+            PROFILE_SCOPE("Input");
+            glfwPollEvents();
+        }
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, g.textureID);
+        // So simula quando vence um passo; varios seguidos se ficou para tras
+        int steps = timestep.advance(glfwGetTime());
+        if (steps > 0)
+        {
+            PROFILE_SCOPE("Simulate");
+            SimulationState published = currentState;
+            for (int i = 0; i < steps; ++i)
+            {
+                previousState = currentState;
+                camera.processInput(window, (float)SIMULATION_STEP);
+                if (rotateX || rotateY || rotateZ)
+                    rotationAngle += (float)SIMULATION_STEP;
+                currentState = simulationState();
+            }
 
-        glBindVertexArray(g.VAO);
-        glDrawArrays(GL_TRIANGLES, 0, g.vertexCount);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+            // Objeto ou camera em movimento pedem um snapshot por passo
+            bool moving = !sameState(published, currentState);
+            if (moving)
+                redraw.markDirty();
+            redraw.setAnimating(moving);
+            if (redraw.needsRedraw(glfwGetTime()))
+            {
+                publishSnapshot();
+                redraw.frameDrawn(glfwGetTime());
+            }
+        }
+
+        // Tudo parado: dorme ate um evento. Ao acordar a simulacao recomeca um
+        // passo atras, para o que acordou (tecla, mouse) ja entrar no proximo
+        // passo, e a thread de render confere o hot reload
+        if (redraw.isIdle())
+        {
+            PROFILE_SCOPE("Idle");
+            redraw.beginWait();
+            glfwWaitEventsTimeout(redraw.getIdleTimeout());
+            redraw.endWait();
+            timestep.resync(glfwGetTime() - SIMULATION_STEP);
+            renderThread.notify();
+            continue;
+        }
 
-        glfwSwapBuffers(window);
+        // Ate o proximo passo os eventos sao atendidos assim que chegam
+        PROFILE_SCOPE("Wait");
+        glfwWaitEventsTimeout(timestep.getTimeToNextStep(glfwGetTime()));
     }
 
-    glDeleteVertexArrays(1, &g.VAO);
-    glDeleteTextures(1, &g.textureID);
+    // O contexto volta para a thread principal para a limpeza
+    renderThread.stop();
+    glfwMakeContextCurrent(window);
+    renderThread.printStats();
+    timestep.printStats();
+    redraw.printStats();
+
+    gpuProfiler.printStats();
+    gpuProfiler.destroy();
+    pipelineStats.destroy();
+    pipelineStats.printReport();
+    PROFILE_EXPORT("profile_trace.json");
+
+    destroyGeometry(g);
+    destroyGeometry(bakedGeometry);
+    destroyLodGeometry(lod);
+    glDeleteTextures(1, &lightmapTexture);
+    for (GLuint program : programs)
+        glDeleteProgram(program);
     glfwTerminate();
 
     return 0;
@@ -231,6 +483,15 @@ int main()
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+    if (action == GLFW_PRESS)
+        redraw.markDirty();
+
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        redraw.setEnabled(!redraw.isEnabled());
+        cout << "Desenho sob demanda " << (redraw.isEnabled() ? "ligado" : "desligado") << endl;
+    }
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 
@@ -266,200 +527,214 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
     if (key == GLFW_KEY_L && action == GLFW_PRESS)
         scale_vector += glm::vec3(-0.1f);
-}
 
-void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
-{
-    if (g_camera)
-        g_camera->mouseCallback(xpos, ypos);
-}
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+        collectPipelineStats = !collectPipelineStats;
 
-GLuint setupShader()
-{
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << endl;
-    }
+    if (key == GLFW_KEY_F5 && action == GLFW_PRESS)
+        stillRequests++;
+
+    if (key == GLFW_KEY_K && action == GLFW_PRESS)
+        useLod = !useLod;
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+        vsync = !vsync;
 
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    if (key == GLFW_KEY_B && action == GLFW_PRESS)
     {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << endl;
+        requestedLighting = activeLighting == BAKED_VERTICES ? PHONG : BAKED_VERTICES;
+        lightingRequests++;
     }
 
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
+    if (key == GLFW_KEY_M && action == GLFW_PRESS)
     {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << endl;
+        requestedLighting = activeLighting == BAKED_LIGHTMAP ? PHONG : BAKED_LIGHTMAP;
+        lightingRequests++;
     }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
 }
 
-Geometry loadGeometry(const char* filepath)
+void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
 {
-    vector<GLfloat> vertices;
-    vector<glm::vec3> v;
-    vector<glm::vec2> uvs;
-    vector<glm::vec3> normals;
-
-    ifstream file(filepath);
-    if (!file)
-    {
-        cerr << "Failed to open file: " << filepath << endl;
-        return {};
-    }
-
-    vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-    vector<glm::vec3> temp_vertices;
-    vector<glm::vec2> temp_uvs;
-    vector<glm::vec3> temp_normals;
-
-    string line;
-    while (getline(file, line))
-    {
-        istringstream iss(line);
-        string type;
-        iss >> type;
-
-        if (type == "v")
-        {
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            temp_vertices.push_back(vertex);
-        }
-        else if (type == "vt")
-        {
-            glm::vec2 uv;
-            iss >> uv.x >> uv.y;
-            temp_uvs.push_back(uv);
-        }
-        else if (type == "vn")
-        {
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-        }
-        else if (type == "f")
-        {
-            unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-            char slash;
-
-            for (int i = 0; i < 3; ++i)
-            {
-                iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-                vertexIndices.push_back(vertexIndex[i]);
-                uvIndices.push_back(uvIndex[i]);
-                normalIndices.push_back(normalIndex[i]);
-            }
-        }
-    }
-
-    file.close();
-
-    for (size_t i = 0; i < vertexIndices.size(); ++i)
-    {
-        unsigned int vi = vertexIndices[i];
-        unsigned int ui = uvIndices[i];
-        unsigned int ni = normalIndices[i];
-
-        glm::vec3 vert = temp_vertices[vi - 1];
-        glm::vec2 uv = temp_uvs[ui - 1];
-        glm::vec3 norm = temp_normals[ni - 1];
-
-        v.push_back(vert);
-        uvs.push_back(uv);
-        normals.push_back(norm);
-    }
-
-    vertices.reserve(v.size() * 11);
-    for (size_t i = 0; i < v.size(); ++i)
-    {
-        vertices.insert(vertices.end(), {
-            v[i].x, v[i].y, v[i].z,
-            1.0f, 0.0f, 0.0f,
-            uvs[i].x, uvs[i].y,
-            normals[i].x, normals[i].y, normals[i].z
-            });
-    }
-
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+    if (g_camera)
+        g_camera->mouseCallback(xpos, ypos);
+}
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)0);
-    glEnableVertexAttribArray(0);
+void window_refresh_callback(GLFWwindow* window)
+{
+    redraw.markDirty();
+}
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
+// Estado entre dois passos da simulacao (t = 0 em a, 1 em b)
+SimulationState mixStates(const SimulationState& a, const SimulationState& b, float t)
+{
+    SimulationState state;
+    state.translate = glm::mix(a.translate, b.translate, t);
+    state.scale = glm::mix(a.scale, b.scale, t);
+    state.angle = glm::mix(a.angle, b.angle, t);
+    state.camPos = glm::mix(a.camPos, b.camPos, t);
+    state.camLookAt = glm::mix(a.camLookAt, b.camLookAt, t);
+    return state;
+}
 
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
+// Nada mudou entre os dois estados (objeto e camera parados)
+bool sameState(const SimulationState& a, const SimulationState& b)
+{
+    return a.translate == b.translate && a.scale == b.scale && a.angle == b.angle &&
+        a.camPos == b.camPos && a.camLookAt == b.camLookAt;
+}
 
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void*)(8 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(3);
+// Matriz model do objeto no estado; eixo zero = sem rotacao
+glm::mat4 objectModel(const SimulationState& state, const glm::vec3& rotationAxis)
+{
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), state.translate + glm::vec3(0.0f, 0.25f, 0.0f));
+    if (rotationAxis != glm::vec3(0.0f))
+        model = glm::rotate(model, state.angle, rotationAxis);
+    return glm::scale(model, state.scale * 0.7f);
+}
 
-    glBindVertexArray(0);
+// Mesma cena do loop (malha, textura, luz e material do phong.fs) tracada na
+// CPU com luz indireta. A malha e a imagem sao lidas de novo a cada still para
+// acompanhar o hot reload.
+void renderRayTracedStill(const HotReload& assets, JobSystem& jobs, const glm::mat4& model, const glm::mat4& view,
+    const glm::mat4& projection, const glm::vec3& camPos)
+{
+    MeshData mesh;
+    ImageData image;
+    if (!parseObj(assets.path("Modelos3D/Suzanne.obj"), mesh) || !decodeImage(assets.path("tex/pixelWall.png"), false, image))
+        return;
+
+    CpuScene scene;
+    scene.view = view;
+    scene.projection = projection;
+    scene.cameraPos = camPos;
+    scene.lights.push_back({ lightPos, lightColor });
+
+    SceneMaterial material;
+    material.texture = &image;
+    scene.meshes.push_back({ &mesh, model, material });
+
+    RayTracerSettings settings;
+    settings.mode = RayTracerSettings::PATH;
+    settings.samplesPerPixel = 16;
+
+    RayTracer tracer(&jobs);
+    tracer.setScene(scene);
+    tracer.render(WIDTH, HEIGHT, settings);
+    tracer.writePpm("raytrace.ppm");
+    tracer.writePfm("raytrace.pfm");
+
+    const RayTracerStats& stats = tracer.getStats();
+    cout << "RayTracer: raytrace.ppm/.pfm em " << stats.renderMs << " ms, " << stats.mraysPerSecond << " Mrays/s ("
+        << settings.samplesPerPixel << " amostras por pixel)" << endl;
+}
 
-    GLuint textureID = 0;
-    string texPath = "assets/tex/pixelWall.png";
-    int texWidth, texHeight, texChannels;
-    unsigned char* image = stbi_load(texPath.c_str(), &texWidth, &texHeight, &texChannels, 0);
-    if (image)
-    {
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+// Luz difusa, sombras e oclusao ambiente assadas por vertice com o RayTracer,
+// para a malha parada na pose "model". O resultado fica em bake_cache, entao
+// repetir o B com a mesma pose so le o arquivo.
+bool bakeVertexLighting(const HotReload& assets, JobSystem& jobs, const glm::mat4& model, Geometry& baked)
+{
+    MeshData mesh;
+    ImageData image;
+    if (!parseObj(assets.path("Modelos3D/Suzanne.obj"), mesh) || !decodeImage(assets.path("tex/pixelWall.png"), false, image))
+        return false;
+
+    CpuScene scene;
+    scene.lights.push_back({ lightPos, lightColor });
+    scene.meshes.push_back({ &mesh, model, SceneMaterial() });
+
+    VertexBakeSettings settings;
+    settings.indirectSamples = 16;
+
+    DiskCache cache("bake_cache");
+    VertexBaker baker(&jobs, &cache);
+    baker.setScene(scene);
+    if (!baker.bake(0, settings, mesh.colors))
+        return false;
+    baker.printStats();
+
+    destroyGeometry(baked);
+    baked = uploadGeometry(mesh, &image);
+    return true;
+}
 
-        GLenum format = (texChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, texWidth, texHeight, 0, format, GL_UNSIGNED_BYTE, image);
+// Difuso com sombras, luz indireta e oclusao ambiente no lightmap de 512x512
+// nas UVs da Suzanne, tracados em todos os nucleos. Tambem vai para bake_cache
+// e para lightmap.hdr (para conferir num visualizador de HDR).
+bool bakeLightmap(const HotReload& assets, JobSystem& jobs, const glm::mat4& model, GLuint& lightmapTexture)
+{
+    MeshData mesh;
+    ImageData image;
+    if (!parseObj(assets.path("Modelos3D/Suzanne.obj"), mesh) || !decodeImage(assets.path("tex/pixelWall.png"), false, image))
+        return false;
+
+    SceneMaterial material;
+    material.texture = &image;
+
+    CpuScene scene;
+    scene.lights.push_back({ lightPos, lightColor });
+    scene.meshes.push_back({ &mesh, model, material });
+
+    LightmapSettings settings;
+    settings.size = 512;
+
+    DiskCache cache("bake_cache");
+    LightmapBaker baker(&jobs, &cache);
+    baker.setScene(scene);
+    Lightmap lightmap;
+    if (!baker.bake(0, settings, lightmap))
+        return false;
+    baker.printStats();
+    writeHdr("lightmap.hdr", lightmap);
+
+    glDeleteTextures(1, &lightmapTexture);
+    lightmapTexture = uploadLightmap(lightmap);
+    return true;
+}
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+void setupShaders(const HotReload& assets, GLuint programs[LIGHTING_COUNT])
+{
+    for (int i = 0; i < LIGHTING_COUNT; ++i)
+        programs[i] = 0;
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Programas vem do cache de binarios quando possivel; so compilam no cache frio
+    ShaderCache cache("shader_cache", (GLADloadproc)glfwGetProcAddress);
+    string vertexSource;
+    if (!HotReload::readTextFile(assets.path("shaders/phong.vs"), vertexSource))
+        return;
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-        stbi_image_free(image);
-    }
-    else
+    size_t requests[LIGHTING_COUNT];
+    for (int i = 0; i < LIGHTING_COUNT; ++i)
     {
-        cerr << "Failed to load texture: " << texPath << endl;
+        string fragmentSource;
+        if (!HotReload::readTextFile(assets.path(string("shaders/") + lightingPrograms[i] + ".fs"), fragmentSource))
+            return;
+        requests[i] = cache.request(lightingPrograms[i],
+            { { GL_VERTEX_SHADER, vertexSource }, { GL_FRAGMENT_SHADER, fragmentSource } });
     }
+    cache.build();
+    cache.printReport();
 
-    Geometry geom;
-    geom.VAO = VAO;
-    geom.vertexCount = (GLuint)v.size();
-    geom.textureID = textureID;
-    geom.textureFilePath = texPath;
+    for (int i = 0; i < LIGHTING_COUNT; ++i)
+        programs[i] = cache.program(requests[i]);
+}
 
-    return geom;
+// Cadeia de LOD da Suzanne (100%, 50%, 25% e 12,5% dos triangulos) por
+// simplificacao com quadricas, guardada em lod_cache. A textura e a da
+// geometria principal, entao os niveis vao para a GPU sem imagem.
+bool buildLod(const HotReload& assets, LodGeometry& lod)
+{
+    MeshData mesh;
+    if (!parseObj(assets.path("Modelos3D/Suzanne.obj"), mesh))
+        return false;
+
+    DiskCache cache("lod_cache");
+    LodGenerator generator(&cache);
+    LodChain chain;
+    if (!generator.generate(mesh, LodSettings(), chain))
+        return false;
+    generator.printStats(chain);
+
+    destroyLodGeometry(lod);
+    lod = uploadLodChain(chain, nullptr);
+    return true;
 }
@@ -28,6 +28,11 @@ using namespace std;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "Primitives.h"
+#include "Profiler.h"
+#include "ShaderCache.h"
+#include "ShadowMaps.h"
+
 using namespace glm;
 
 #include <cmath>
@@ -36,11 +41,10 @@ using namespace glm;
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
-int setupShader();
+int setupShader(ShaderCache& cache);
 GLuint loadTexture(string filePath, int& width, int& height);
 
-void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color = vec3(1.0, 0.0, 0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
-GLuint generateSphere(float radius, int latSegments, int lonSegments, int& nVertices);
+void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nIndices, vec3 color = vec3(1.0, 0.0, 0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 800;
@@ -65,12 +69,13 @@ const GLchar* vertexShaderSource = R"(
         gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
      fragPos = model * vec4(position.x, position.y, position.z, 1.0);
      texCoord = texc;
-     vNormal = normal;
+     vNormal = mat3(transpose(inverse(model))) * normal;
      vColor = vec4(color,1.0);
  })";
 
+// Sem o #version: o setupShader coloca a versão e as funções de sombra
+// (ShadowMaps::getShaderSource) antes deste código
 const GLchar* fragmentShaderSource = R"(
-     #version 400
      in vec2 texCoord;
      uniform sampler2D texBuff;
      uniform vec3 lightPos;
@@ -111,6 +116,7 @@ const GLchar* fragmentShaderSource = R"(
          float spec1 = max(dot(R1, V), 0.0);
          spec1 = pow(spec1, q);
          vec3 specular1 = ks * spec1 * lightColor;
+         float shadow1 = pointShadow(0, vec3(fragPos), N);
      
          // ===== Luz 2 =====
          vec3 dir2 = lightPos2 - vec3(fragPos);
@@ -125,6 +131,7 @@ const GLchar* fragmentShaderSource = R"(
          float spec2 = max(dot(R2, V), 0.0);
          spec2 = pow(spec2, q);
          vec3 specular2 = ks * spec2 * lightColor;
+         float shadow2 = pointShadow(1, vec3(fragPos), N);
      
          // ===== Luz 3 =====
          vec3 dir3 = lightPos3 - vec3(fragPos);
@@ -139,9 +146,10 @@ const GLchar* fragmentShaderSource = R"(
          float spec3 = max(dot(R3, V), 0.0);
          spec3 = pow(spec3, q);
          vec3 specular3 = ks * spec3 * lightColor;
+         float shadow3 = pointShadow(2, vec3(fragPos), N);
      
-         vec3 diffuse = (diffuse1 * float(light1On)) + (diffuse2 * float(light2On)) + (diffuse3 * float(light3On));
-         vec3 specular = (specular1 * float(light1On)) + (specular2 * float(light2On)) + (specular3 * float(light3On));
+         vec3 diffuse = (diffuse1 * shadow1 * float(light1On)) + (diffuse2 * shadow2 * float(light2On)) + (diffuse3 * shadow3 * float(light3On));
+         vec3 specular = (specular1 * shadow1 * float(light1On)) + (specular2 * shadow2 * float(light2On)) + (specular3 * shadow3 * float(light3On));
          vec3 result = (ambient + diffuse) * vec3(objectColor) + specular;
          color = vec4(result, 1.0);
      }
@@ -153,6 +161,8 @@ vec3 lightPos3 = vec3(0.0, -0.7, 0.5);
 bool light1Ligada = true;
 bool light2Ligada = true;
 bool light3Ligada = true;
+// Posição da esfera (setas movem); a sombra só é redesenhada quando ela anda
+vec3 spherePos = vec3(0.0, 0.0, 0.0);
 // Função MAIN
 int main()
 {
@@ -197,11 +207,25 @@ int main()
     glViewport(0, 0, width, height);
 
     // Compilando e buildando o programa de shader
-    GLuint shaderID = setupShader();
-
-    // Gerando um buffer simples, com a geometria de um triângulo
-    int nVertices;
-    GLuint VAO = generateSphere(0.5, 16, 16, nVertices);
+    ShaderCache cache("shader_cache", (GLADloadproc)glfwGetProcAddress);
+    GLuint shaderID = setupShader(cache);
+
+    // Esfera e parede indexadas, no layout deste shader (posição 0, cor 1,
+    // normal 2, uv 3, o padrão do PrimitiveLayout)
+    PrimitiveLibrary primitives;
+    const Primitive& sphere = primitives.get(PrimitiveShape::uvSphere(0.5f, 16, 16));
+
+    // Parede atrás da esfera para receber as sombras: plano 2x2 em pé (ver o draw)
+    const Primitive& wall = primitives.get(PrimitiveShape::plane(2.0f, 2.0f, 1, vec3(0.8f, 0.8f, 0.8f)));
+
+    // Sombras das três luzes: um cube map por luz, desenhados num passe só e
+    // mantidos em cache enquanto a esfera não se mexe
+    ShadowMaps shadows(cache);
+    cache.printReport();
+    shadows.addPointLight(lightPos, 4.0f);
+    shadows.addPointLight(lightPos2, 4.0f);
+    shadows.addPointLight(lightPos3, 4.0f);
+    int sphereCaster = shadows.addCaster(sphere.VAO, sphere.indexCount, sphere.bounds, true);
 
     // Carregando uma textura e armazenando seu id
     int imgWidth, imgHeight;
@@ -237,32 +261,56 @@ int main()
     mat4 model = mat4(1); // matriz identidade
     glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
 
+    glEnable(GL_DEPTH_TEST);
+
     // Loop da aplicação - "game loop"
     while (!glfwWindowShouldClose(window))
     {
+        PROFILE_FRAME();
+
         // Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-        glfwPollEvents();
+        {
+            PROFILE_SCOPE("Input");
+            glfwPollEvents();
+        }
+
+        {
+            PROFILE_SCOPE("Shadows");
+            shadows.setCasterTransform(sphereCaster, translate(mat4(1), spherePos));
+            shadows.update(mat4(1), projection);
+        }
+
+        PROFILE_SCOPE("Render");
 
         // Limpa o buffer de cor
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
-        glClear(GL_COLOR_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glUseProgram(shaderID);
+        shadows.bind(shaderID, 1);
 
-        glBindVertexArray(VAO);              // Conectando ao buffer de geometria
         glBindTexture(GL_TEXTURE_2D, texID); // conectando com o buffer de textura que será usado no draw
 
         glUniform1i(glGetUniformLocation(shaderID, "light1On"), light1Ligada);
         glUniform1i(glGetUniformLocation(shaderID, "light2On"), light2Ligada);
         glUniform1i(glGetUniformLocation(shaderID, "light3On"), light3Ligada);
-        // Primeiro Triângulo
-        drawGeometry(shaderID, VAO, vec3(0, 0, 0), vec3(1, 1, 1), 0.0, nVertices);
+        // Esfera e parede
+        drawGeometry(shaderID, sphere.VAO, spherePos, vec3(1, 1, 1), 0.0, sphere.indexCount);
+        // O plano nasce virado para +y; 90 graus em x o deixam virado para +z (a câmera)
+        drawGeometry(shaderID, wall.VAO, vec3(0, 0, -0.8f), vec3(1, 1, 1), 90.0, wall.indexCount, vec3(0.8f), vec3(1, 0, 0));
 
         glBindVertexArray(0); // Desconectando o buffer de geometria
 
         // Troca os buffers da tela
+        PROFILE_SCOPE("Swap");
         glfwSwapBuffers(window);
     }
+    PROFILE_EXPORT("profile_trace.json");
+    shadows.printStats();
+    shadows.destroy();
+    primitives.printStats();
     // Pede pra OpenGL desalocar os buffers
-    glDeleteVertexArrays(1, &VAO);
+    primitives.destroy();
     // Finaliza a execução da GLFW, limpando os recursos alocados por ela
     glfwTerminate();
     return 0;
@@ -287,56 +335,29 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     {
         light3Ligada = !light3Ligada;
     }
+    // Setas movem a esfera
+    if (action == GLFW_PRESS || action == GLFW_REPEAT)
+    {
+        if (key == GLFW_KEY_LEFT)
+            spherePos.x -= 0.05f;
+        if (key == GLFW_KEY_RIGHT)
+            spherePos.x += 0.05f;
+        if (key == GLFW_KEY_UP)
+            spherePos.y += 0.05f;
+        if (key == GLFW_KEY_DOWN)
+            spherePos.y -= 0.05f;
+    }
 }
 
-// Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
-//  shader simples e único neste exemplo de código
-//  O código fonte do vertex e fragment shader está nos arrays vertexShaderSource e
-//  fragmentShader source no iniçio deste arquivo
+// Monta o programa de shader a partir dos arrays vertexShaderSource e
+//  fragmentShaderSource do início deste arquivo (com as funções de sombra
+//  antes do fragment shader). O binário linkado fica no cache em disco
+//  (shader_cache/), então só o primeiro run compila o GLSL
 //  A função retorna o identificador do programa de shader
-int setupShader()
+int setupShader(ShaderCache& cache)
 {
-    // Vertex shader
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    // Checando erros de compilação (exibição via log no terminal)
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-            << infoLog << std::endl;
-    }
-    // Fragment shader
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    // Checando erros de compilação (exibição via log no terminal)
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-            << infoLog << std::endl;
-    }
-    // Linkando os shaders e criando o identificador do programa de shader
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    // Checando por erros de linkagem
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-            << infoLog << std::endl;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    string fragmentSource = string("#version 400\n") + ShadowMaps::getShaderSource() + fragmentShaderSource;
+    GLuint shaderProgram = cache.getProgram("phong3_shadows", vertexShaderSource, fragmentSource.c_str());
 
     return shaderProgram;
 }
@@ -385,8 +406,10 @@ GLuint loadTexture(string filePath, int& width, int& height)
     return texID;
 }
 
-void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color, vec3 axis)
+void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nIndices, vec3 color, vec3 axis)
 {
+    glBindVertexArray(VAO); // Conectando ao buffer de geometria
+
     // Matriz de modelo: transformações na geometria (objeto)
     mat4 model = mat4(1); // matriz identidade
     // Translação
@@ -399,89 +422,6 @@ void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, f
 
     // glUniform4f(glGetUniformLocation(shaderID, "inputColor"), color.r, color.g, color.b, 1.0f); // enviando cor para variável uniform inputColor
     //   Chamada de desenho - drawcall
-    //   Poligono Preenchido - GL_TRIANGLES
-    glDrawArrays(GL_TRIANGLES, 0, nVertices);
+    //   Poligono Preenchido - GL_TRIANGLES, indexado (PrimitiveLibrary)
+    glDrawElements(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT, nullptr);
 }
-
-GLuint generateSphere(float radius, int latSegments, int lonSegments, int& nVertices)
-{
-    vector<GLfloat> vBuffer; // Posição + Cor + Normal + UV
-
-    vec3 color = vec3(1.0f, 0.0f, 0.0f); // Laranja
-
-    auto calcPosUVNormal = [&](int lat, int lon, vec3& pos, vec2& uv, vec3& normal)
-        {
-            float theta = lat * pi<float>() / latSegments;
-            float phi = lon * 2.0f * pi<float>() / lonSegments;
-
-            pos = vec3(
-                radius * cos(phi) * sin(theta),
-                radius * cos(theta),
-                radius * sin(phi) * sin(theta));
-
-            uv = vec2(
-                phi / (2.0f * pi<float>()), // u
-                theta / pi<float>()         // v
-            );
-
-            // Normal é a posição normalizada (posição/radius)
-            normal = normalize(pos);
-        };
-
-    for (int i = 0; i < latSegments; ++i)
-    {
-        for (int j = 0; j < lonSegments; ++j)
-        {
-            vec3 v0, v1, v2, v3;
-            vec2 uv0, uv1, uv2, uv3;
-            vec3 n0, n1, n2, n3;
-
-            calcPosUVNormal(i, j, v0, uv0, n0);
-            calcPosUVNormal(i + 1, j, v1, uv1, n1);
-            calcPosUVNormal(i, j + 1, v2, uv2, n2);
-            calcPosUVNormal(i + 1, j + 1, v3, uv3, n3);
-
-            // Primeiro triângulo
-            vBuffer.insert(vBuffer.end(), { v0.x, v0.y, v0.z, color.r, color.g, color.b, n0.x, n0.y, n0.z, uv0.x, uv0.y });
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
-
-            // Segundo triângulo
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v3.x, v3.y, v3.z, color.r, color.g, color.b, n3.x, n3.y, n3.z, uv3.x, uv3.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
-        }
-    }
-
-    // Criar VAO e VBO
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
-
-    // Layout da posição (location 0)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(0));
-    glEnableVertexAttribArray(0);
-
-    // Layout da cor (location 1)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-
-    // Layout da normal (location 2)
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-
-    // Layout da UV (location 3)
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(9 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(3);
-
-    glBindVertexArray(0);
-
-    nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
-
-    return VAO;
-}
\ No newline at end of file